@@ -0,0 +1,130 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <glib.h>
+
+#include "bitset.h"
+
+#define BITSET_WORD_BITS 64
+
+trg_bitset *trg_bitset_new(void)
+{
+    return g_new0(trg_bitset, 1);
+}
+
+void trg_bitset_free(trg_bitset * bs)
+{
+    g_free(bs->words);
+    g_free(bs);
+}
+
+static void trg_bitset_grow(trg_bitset * bs, guint n_words)
+{
+    guint size = MAX(bs->n_words, 4);
+
+    while (size < n_words)
+        size *= 2;
+
+    bs->words = g_renew(guint64, bs->words, size);
+    memset(bs->words + bs->n_words, 0,
+           (size - bs->n_words) * sizeof(guint64));
+    bs->n_words = size;
+}
+
+void trg_bitset_set(trg_bitset * bs, guint i, gboolean value)
+{
+    guint word = i / BITSET_WORD_BITS;
+    guint64 mask = G_GUINT64_CONSTANT(1) << (i % BITSET_WORD_BITS);
+
+    if (word >= bs->n_words) {
+        if (!value)
+            return;
+        trg_bitset_grow(bs, word + 1);
+    }
+
+    if (value)
+        bs->words[word] |= mask;
+    else
+        bs->words[word] &= ~mask;
+}
+
+gboolean trg_bitset_get(const trg_bitset * bs, guint i)
+{
+    guint word = i / BITSET_WORD_BITS;
+
+    return word < bs->n_words
+        && (bs->words[word] >> (i % BITSET_WORD_BITS)) & 1;
+}
+
+void trg_bitset_clear(trg_bitset * bs)
+{
+    if (bs->n_words > 0)
+        memset(bs->words, 0, bs->n_words * sizeof(guint64));
+}
+
+void trg_bitset_copy(trg_bitset * dst, const trg_bitset * src)
+{
+    trg_bitset_clear(dst);
+    trg_bitset_or(dst, src);
+}
+
+void trg_bitset_or(trg_bitset * dst, const trg_bitset * src)
+{
+    guint i;
+
+    if (src->n_words > dst->n_words)
+        trg_bitset_grow(dst, src->n_words);
+
+    for (i = 0; i < src->n_words; i++)
+        dst->words[i] |= src->words[i];
+}
+
+/* The first member at or after from, or -1 if there isn't one. */
+gint trg_bitset_next(const trg_bitset * bs, guint from)
+{
+    guint word = from / BITSET_WORD_BITS;
+    guint64 bits;
+
+    if (word >= bs->n_words)
+        return -1;
+
+    bits = bs->words[word]
+        & (~G_GUINT64_CONSTANT(0) << (from % BITSET_WORD_BITS));
+
+    for (;;) {
+        if (bits) {
+            guint bit = 0;
+
+            while (!((bits >> bit) & 1))
+                bit++;
+
+            return (gint) (word * BITSET_WORD_BITS + bit);
+        }
+
+        if (++word >= bs->n_words)
+            return -1;
+
+        bits = bs->words[word];
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef BITSET_H_
+#define BITSET_H_
+
+#include <glib.h>
+
+/* A growable set of small integers, one bit each. Used for the torrents in
+ * each filter category, by their slot in the torrent model.
+ */
+typedef struct {
+    guint64 *words;
+    guint n_words;
+} trg_bitset;
+
+trg_bitset *trg_bitset_new(void);
+void trg_bitset_free(trg_bitset * bs);
+void trg_bitset_set(trg_bitset * bs, guint i, gboolean value);
+gboolean trg_bitset_get(const trg_bitset * bs, guint i);
+void trg_bitset_clear(trg_bitset * bs);
+void trg_bitset_copy(trg_bitset * dst, const trg_bitset * src);
+void trg_bitset_or(trg_bitset * dst, const trg_bitset * src);
+gint trg_bitset_next(const trg_bitset * bs, guint from);
+
+#endif                          /* BITSET_H_ */
@@ -0,0 +1,674 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+#include "protocol-constants.h"
+#include "torrent-record.h"
+#include "json-stream.h"
+
+/* A decoder for RPC responses which is fed the body a piece at a time, as
+ * it arrives, so nothing waits for or holds the whole of it.
+ *
+ * Responses are built up into a JsonObject like the parser would, except
+ * for the torrents of a torrent-get when there's a function to take them.
+ * Those are decoded member by member straight into a trg_torrent_update,
+ * with only the per-file, per-peer and per-tracker arrays built as JSON,
+ * and each is handed over as soon as it ends. The response is left with an
+ * empty torrents array.
+ */
+
+#define FNV_OFFSET_BASIS G_GUINT64_CONSTANT(14695981039346656037)
+#define FNV_PRIME G_GUINT64_CONSTANT(1099511628211)
+
+/* The token being read. */
+enum {
+    STREAM_LEX_NONE,
+    STREAM_LEX_STRING,
+    STREAM_LEX_ESCAPE,
+    STREAM_LEX_UNICODE,
+    STREAM_LEX_BARE             /* a number, true, false or null */
+};
+
+/* What a container takes next. */
+enum {
+    STREAM_EXPECT_KEY_OR_END,
+    STREAM_EXPECT_KEY,
+    STREAM_EXPECT_COLON,
+    STREAM_EXPECT_VALUE_OR_END,
+    STREAM_EXPECT_VALUE,
+    STREAM_EXPECT_COMMA_OR_END
+};
+
+/* What a container's values are decoded into. */
+enum {
+    STREAM_INTO_NODE,
+    STREAM_INTO_TORRENTS,
+    STREAM_INTO_TORRENT,
+    STREAM_INTO_PEERSFROM,
+    STREAM_INTO_NOTHING
+};
+
+typedef struct {
+    gboolean isObject;
+    gboolean isArguments;
+    gint expect;
+    gint into;
+    gint field;                 /* of a torrent, the member being read */
+    gchar *key;                 /* otherwise, its name */
+    JsonNode *node;             /* when it's built into a node */
+} trg_json_frame;
+
+/* A number, string, boolean (in i) or null (G_TYPE_NONE). */
+typedef struct {
+    GType type;
+    gint64 i;
+    gdouble d;
+    const gchar *s;
+} trg_json_scalar;
+
+struct _trg_json_stream {
+    trg_json_stream_torrent_func func;
+    gpointer data;
+    GArray *frames;
+    JsonNode *root;
+    gint lex;
+    GString *token;
+    gunichar unicode;
+    guint unicodeDigits;
+    gunichar highSurrogate;
+    trg_torrent_update update;
+    gboolean hashing;           /* the text of a torrent */
+    guint64 fingerprint;
+    const gchar *hashFrom;
+    const gchar *piece;         /* being fed */
+    const gchar *at;            /* in it */
+    gsize offset;               /* of it in the body */
+    GError *error;
+};
+
+static trg_json_frame *stream_top(trg_json_stream * stream)
+{
+    return stream->frames->len > 0 ?
+        &g_array_index(stream->frames, trg_json_frame,
+                       stream->frames->len - 1) : NULL;
+}
+
+static void stream_error(trg_json_stream * stream, const gchar * what)
+{
+    if (!stream->error)
+        stream->error =
+            g_error_new(JSON_PARSER_ERROR, JSON_PARSER_ERROR_PARSE,
+                        "%s at byte %" G_GSIZE_FORMAT, what,
+                        stream->offset + (stream->at - stream->piece));
+}
+
+static void stream_hash(trg_json_stream * stream, const gchar * end)
+{
+    const guchar *p = (const guchar *) stream->hashFrom;
+    guint64 h = stream->fingerprint;
+
+    for (; p < (const guchar *) end; p++) {
+        h ^= *p;
+        h *= FNV_PRIME;
+    }
+
+    stream->fingerprint = h;
+    stream->hashFrom = end;
+}
+
+/* Whether a value can go where the stream is, with an error if not. */
+static gboolean stream_expect_value(trg_json_stream * stream)
+{
+    trg_json_frame *f = stream_top(stream);
+
+    if (f ? f->expect == STREAM_EXPECT_VALUE
+        || f->expect == STREAM_EXPECT_VALUE_OR_END : !stream->root)
+        return TRUE;
+
+    stream_error(stream, "Unexpected value");
+    return FALSE;
+}
+
+/* Hand a finished node to the container it's in, which takes it. */
+static void stream_add_node(trg_json_stream * stream, JsonNode * node)
+{
+    trg_json_frame *f = stream_top(stream);
+
+    if (!f) {
+        stream->root = node;
+    } else if (f->into == STREAM_INTO_NODE && f->isObject) {
+        json_object_set_member(json_node_get_object(f->node), f->key,
+                               node);
+        g_free(f->key);
+        f->key = NULL;
+    } else if (f->into == STREAM_INTO_NODE) {
+        json_array_add_element(json_node_get_array(f->node), node);
+    } else if (f->into == STREAM_INTO_TORRENT) {
+        trg_torrent_update_set_array(&stream->update, f->field,
+                                     json_node_get_array(node));
+        json_node_free(node);
+    } else {
+        json_node_free(node);
+    }
+}
+
+static JsonNode *stream_scalar_node(const trg_json_scalar * v)
+{
+    JsonNode *node;
+
+    if (v->type == G_TYPE_NONE)
+        return json_node_new(JSON_NODE_NULL);
+
+    node = json_node_new(JSON_NODE_VALUE);
+
+    switch (v->type) {
+    case G_TYPE_INT64:
+        json_node_set_int(node, v->i);
+        break;
+    case G_TYPE_DOUBLE:
+        json_node_set_double(node, v->d);
+        break;
+    case G_TYPE_BOOLEAN:
+        json_node_set_boolean(node, (gboolean) v->i);
+        break;
+    default:
+        json_node_set_string(node, v->s);
+        break;
+    }
+
+    return node;
+}
+
+static void
+stream_torrent_member(trg_torrent_update * update, gint field,
+                      const trg_json_scalar * v)
+{
+    if (field < 0)
+        return;
+
+    switch (v->type) {
+    case G_TYPE_INT64:
+    case G_TYPE_BOOLEAN:
+        trg_torrent_update_set_int(update, field, v->i);
+        break;
+    case G_TYPE_DOUBLE:
+        trg_torrent_update_set_double(update, field, v->d);
+        break;
+    case G_TYPE_STRING:
+        trg_torrent_update_set_string(update, field, v->s);
+        break;
+    default:
+        break;
+    }
+}
+
+static void stream_scalar(trg_json_stream * stream, const trg_json_scalar * v)
+{
+    trg_json_frame *f;
+
+    if (!stream_expect_value(stream))
+        return;
+
+    if (!(f = stream_top(stream))) {
+        stream_error(stream, "Expected an object");
+        return;
+    }
+
+    switch (f->into) {
+    case STREAM_INTO_NODE:
+        stream_add_node(stream, stream_scalar_node(v));
+        break;
+    case STREAM_INTO_TORRENT:
+        stream_torrent_member(&stream->update, f->field, v);
+        break;
+    case STREAM_INTO_PEERSFROM:
+        if (v->type == G_TYPE_INT64)
+            trg_torrent_update_set_peerfrom(&stream->update, f->key, v->i);
+        g_free(f->key);
+        f->key = NULL;
+        break;
+    default:
+        break;
+    }
+
+    f->expect = STREAM_EXPECT_COMMA_OR_END;
+}
+
+static void stream_begin(trg_json_stream * stream, gboolean isObject)
+{
+    trg_json_frame *parent = stream_top(stream);
+    trg_json_frame f;
+
+    if (!stream_expect_value(stream))
+        return;
+
+    memset(&f, 0, sizeof(f));
+    f.isObject = isObject;
+    f.expect = isObject ? STREAM_EXPECT_KEY_OR_END :
+        STREAM_EXPECT_VALUE_OR_END;
+    f.field = -1;
+    f.into = STREAM_INTO_NODE;
+
+    if (!parent && !isObject) {
+        stream_error(stream, "Expected an object");
+        return;
+    } else if (!parent) {
+        /* The response itself. */
+    } else if (parent->into == STREAM_INTO_NODE) {
+        if (stream->frames->len == 1 && isObject
+            && !g_strcmp0(parent->key, PARAM_ARGUMENTS)) {
+            f.isArguments = TRUE;
+        } else if (parent->isArguments && !isObject && stream->func
+                   && !g_strcmp0(parent->key, FIELD_TORRENTS)) {
+            json_object_set_array_member(json_node_get_object
+                                         (parent->node), parent->key,
+                                         json_array_new());
+            g_free(parent->key);
+            parent->key = NULL;
+            f.into = STREAM_INTO_TORRENTS;
+        }
+    } else if (parent->into == STREAM_INTO_TORRENTS && isObject) {
+        f.into = STREAM_INTO_TORRENT;
+        stream->hashing = TRUE;
+        stream->hashFrom = stream->at;
+        stream->fingerprint = FNV_OFFSET_BASIS;
+    } else if (parent->into == STREAM_INTO_TORRENT && isObject
+               && parent->field == TORRENT_FIELD_PEERSFROM) {
+        f.into = STREAM_INTO_PEERSFROM;
+    } else if (parent->into == STREAM_INTO_TORRENT && !isObject
+               && torrent_field_is_array(parent->field)) {
+        /* Built, then set on the update when it ends. */
+    } else {
+        f.into = STREAM_INTO_NOTHING;
+    }
+
+    if (f.into == STREAM_INTO_NODE && isObject) {
+        f.node = json_node_new(JSON_NODE_OBJECT);
+        json_node_take_object(f.node, json_object_new());
+    } else if (f.into == STREAM_INTO_NODE) {
+        f.node = json_node_new(JSON_NODE_ARRAY);
+        json_node_take_array(f.node, json_array_new());
+    }
+
+    g_array_append_val(stream->frames, f);
+}
+
+static void stream_end(trg_json_stream * stream, gboolean isObject)
+{
+    trg_json_frame *f = stream_top(stream);
+    trg_json_frame done;
+
+    if (!f || f->isObject != isObject
+        || (f->expect != STREAM_EXPECT_COMMA_OR_END
+            && f->expect != (isObject ? STREAM_EXPECT_KEY_OR_END :
+                             STREAM_EXPECT_VALUE_OR_END))) {
+        stream_error(stream, "Unexpected end of container");
+        return;
+    }
+
+    done = *f;
+    g_array_set_size(stream->frames, stream->frames->len - 1);
+    g_free(done.key);
+
+    if (done.into == STREAM_INTO_NODE) {
+        stream_add_node(stream, done.node);
+    } else if (done.into == STREAM_INTO_TORRENT) {
+        stream_hash(stream, stream->at + 1);
+        stream->hashing = FALSE;
+
+        if (stream->update.present & TORRENT_FIELD_BIT(TORRENT_FIELD_ID))
+            stream->func(&stream->update, stream->fingerprint,
+                         stream->data);
+
+        trg_torrent_update_clear(&stream->update);
+    }
+
+    if ((f = stream_top(stream)))
+        f->expect = STREAM_EXPECT_COMMA_OR_END;
+}
+
+static void stream_key(trg_json_stream * stream, const gchar * key)
+{
+    trg_json_frame *f = stream_top(stream);
+
+    if (f->into == STREAM_INTO_TORRENT) {
+        f->field = torrent_field_lookup(key);
+    } else if (f->into == STREAM_INTO_NODE
+               || f->into == STREAM_INTO_PEERSFROM) {
+        g_free(f->key);
+        f->key = g_strdup(key);
+    }
+
+    f->expect = STREAM_EXPECT_COLON;
+}
+
+static void stream_colon(trg_json_stream * stream)
+{
+    trg_json_frame *f = stream_top(stream);
+
+    if (!f || f->expect != STREAM_EXPECT_COLON)
+        stream_error(stream, "Unexpected ':'");
+    else
+        f->expect = STREAM_EXPECT_VALUE;
+}
+
+static void stream_comma(trg_json_stream * stream)
+{
+    trg_json_frame *f = stream_top(stream);
+
+    if (!f || f->expect != STREAM_EXPECT_COMMA_OR_END)
+        stream_error(stream, "Unexpected ','");
+    else
+        f->expect = f->isObject ? STREAM_EXPECT_KEY : STREAM_EXPECT_VALUE;
+}
+
+/* A string has ended, which in an object may be a member's name. */
+static void stream_string(trg_json_stream * stream)
+{
+    trg_json_frame *f = stream_top(stream);
+
+    if (f && f->isObject && (f->expect == STREAM_EXPECT_KEY_OR_END
+                             || f->expect == STREAM_EXPECT_KEY)) {
+        stream_key(stream, stream->token->str);
+    } else {
+        trg_json_scalar v = { G_TYPE_STRING, 0, 0.0, NULL };
+        v.s = stream->token->str;
+        stream_scalar(stream, &v);
+    }
+}
+
+static void stream_bare(trg_json_stream * stream)
+{
+    const gchar *s = stream->token->str;
+    trg_json_scalar v = { G_TYPE_NONE, 0, 0.0, NULL };
+    gchar *end;
+
+    if (!strcmp(s, "true") || !strcmp(s, "false")) {
+        v.type = G_TYPE_BOOLEAN;
+        v.i = s[0] == 't';
+    } else if (!strcmp(s, "null")) {
+        /* G_TYPE_NONE */
+    } else if (s[0] == '-' || g_ascii_isdigit(s[0])) {
+        if (strpbrk(s, ".eE")) {
+            v.type = G_TYPE_DOUBLE;
+            v.d = g_ascii_strtod(s, &end);
+        } else {
+            errno = 0;
+            v.type = G_TYPE_INT64;
+            v.i = g_ascii_strtoll(s, &end, 10);
+            if (errno == ERANGE) {
+                v.type = G_TYPE_DOUBLE;
+                v.d = g_ascii_strtod(s, &end);
+            }
+        }
+
+        if (*end) {
+            stream_error(stream, "Invalid number");
+            return;
+        }
+    } else {
+        stream_error(stream, "Invalid value");
+        return;
+    }
+
+    stream_scalar(stream, &v);
+}
+
+/* A \u escape of half a surrogate pair with no other half. */
+static void stream_flush_surrogate(trg_json_stream * stream)
+{
+    if (stream->highSurrogate) {
+        g_string_append_unichar(stream->token, 0xfffd);
+        stream->highSurrogate = 0;
+    }
+}
+
+static void stream_unichar(trg_json_stream * stream, gunichar c)
+{
+    if (stream->highSurrogate && c >= 0xdc00 && c <= 0xdfff) {
+        c = 0x10000 + ((stream->highSurrogate - 0xd800) << 10) +
+            (c - 0xdc00);
+        stream->highSurrogate = 0;
+    } else {
+        stream_flush_surrogate(stream);
+
+        if (c >= 0xd800 && c <= 0xdbff) {
+            stream->highSurrogate = c;
+            return;
+        } else if (c >= 0xdc00 && c <= 0xdfff) {
+            c = 0xfffd;
+        }
+    }
+
+    g_string_append_unichar(stream->token, c);
+}
+
+static void stream_escape(trg_json_stream * stream, gchar c)
+{
+    static const gchar from[] = "\"\\/bfnrt";
+    static const gchar to[] = "\"\\/\b\f\n\r\t";
+    const gchar *e = c ? strchr(from, c) : NULL;
+
+    stream->lex = STREAM_LEX_STRING;
+
+    if (c == 'u') {
+        stream->lex = STREAM_LEX_UNICODE;
+        stream->unicode = 0;
+        stream->unicodeDigits = 0;
+    } else if (!e) {
+        stream_error(stream, "Invalid escape");
+    } else {
+        stream_flush_surrogate(stream);
+        g_string_append_c(stream->token, to[e - from]);
+    }
+}
+
+trg_json_stream *trg_json_stream_new(trg_json_stream_torrent_func func,
+                                     gpointer data)
+{
+    trg_json_stream *stream = g_new0(trg_json_stream, 1);
+
+    stream->func = func;
+    stream->data = data;
+    stream->frames = g_array_new(FALSE, FALSE, sizeof(trg_json_frame));
+    stream->token = g_string_sized_new(64);
+    trg_torrent_update_init(&stream->update);
+
+    return stream;
+}
+
+/* Decode the next piece of the body. Errors are kept until it's finished. */
+void
+trg_json_stream_feed(trg_json_stream * stream, const gchar * data,
+                     gsize len)
+{
+    const gchar *p = data, *end = data + len;
+
+    stream->piece = data;
+    if (stream->hashing)
+        stream->hashFrom = data;
+
+    while (p < end && !stream->error) {
+        stream->at = p;
+
+        switch (stream->lex) {
+        case STREAM_LEX_STRING:{
+                const gchar *run = p;
+
+                /* Most of a string can be copied as it is. */
+                while (p < end && *p != '"' && *p != '\\'
+                       && (guchar) *p >= 0x20)
+                    p++;
+
+                if (p > run || (p < end && *p != '\\'))
+                    stream_flush_surrogate(stream);
+                g_string_append_len(stream->token, run, p - run);
+
+                if (p == end)
+                    break;
+
+                stream->at = p;
+                if (*p == '"') {
+                    stream->lex = STREAM_LEX_NONE;
+                    stream_string(stream);
+                } else if (*p == '\\') {
+                    stream->lex = STREAM_LEX_ESCAPE;
+                } else {
+                    stream_error(stream, "Control character in a string");
+                }
+                p++;
+                break;
+            }
+        case STREAM_LEX_ESCAPE:
+            stream_escape(stream, *p++);
+            break;
+        case STREAM_LEX_UNICODE:{
+                gint digit = g_ascii_xdigit_value(*p++);
+
+                if (digit < 0) {
+                    stream_error(stream, "Invalid unicode escape");
+                } else {
+                    stream->unicode = (stream->unicode << 4) | digit;
+                    if (++stream->unicodeDigits == 4) {
+                        stream->lex = STREAM_LEX_STRING;
+                        stream_unichar(stream, stream->unicode);
+                    }
+                }
+                break;
+            }
+        case STREAM_LEX_BARE:{
+                const gchar *run = p;
+
+                while (p < end && (g_ascii_isalnum(*p) || *p == '-'
+                                   || *p == '+' || *p == '.'))
+                    p++;
+
+                g_string_append_len(stream->token, run, p - run);
+
+                /* It may go on into the next piece. */
+                if (p < end) {
+                    stream->at = p;
+                    stream->lex = STREAM_LEX_NONE;
+                    stream_bare(stream);
+                }
+                break;
+            }
+        default:
+            switch (*p) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                break;
+            case '{':
+                stream_begin(stream, TRUE);
+                break;
+            case '[':
+                stream_begin(stream, FALSE);
+                break;
+            case '}':
+                stream_end(stream, TRUE);
+                break;
+            case ']':
+                stream_end(stream, FALSE);
+                break;
+            case ':':
+                stream_colon(stream);
+                break;
+            case ',':
+                stream_comma(stream);
+                break;
+            case '"':
+                g_string_truncate(stream->token, 0);
+                stream->lex = STREAM_LEX_STRING;
+                break;
+            default:
+                if (*p == '-' || g_ascii_isalnum(*p)) {
+                    g_string_truncate(stream->token, 0);
+                    stream->lex = STREAM_LEX_BARE;
+                    continue;
+                }
+                stream_error(stream, "Unexpected character");
+                break;
+            }
+            p++;
+            break;
+        }
+    }
+
+    if (stream->hashing)
+        stream_hash(stream, end);
+
+    stream->offset += len;
+    stream->piece = stream->at = NULL;
+}
+
+/* The response, once the whole of the body has been fed. */
+JsonObject *trg_json_stream_finish(trg_json_stream * stream,
+                                   GError ** error)
+{
+    if (!stream->error && stream->lex == STREAM_LEX_BARE) {
+        stream->lex = STREAM_LEX_NONE;
+        stream_bare(stream);
+    }
+
+    if (!stream->error && (!stream->root || stream->lex != STREAM_LEX_NONE))
+        stream_error(stream, "Unexpected end of data");
+
+    if (stream->error) {
+        g_propagate_error(error, stream->error);
+        stream->error = NULL;
+        return NULL;
+    }
+
+    return json_node_dup_object(stream->root);
+}
+
+void trg_json_stream_free(trg_json_stream * stream)
+{
+    guint i;
+
+    for (i = 0; i < stream->frames->len; i++) {
+        trg_json_frame *f =
+            &g_array_index(stream->frames, trg_json_frame, i);
+        g_free(f->key);
+        if (f->node)
+            json_node_free(f->node);
+    }
+
+    g_array_free(stream->frames, TRUE);
+    g_string_free(stream->token, TRUE);
+    trg_torrent_update_clear(&stream->update);
+
+    if (stream->root)
+        json_node_free(stream->root);
+
+    if (stream->error)
+        g_error_free(stream->error);
+
+    g_free(stream);
+}
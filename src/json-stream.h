@@ -0,0 +1,46 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef JSON_STREAM_H_
+#define JSON_STREAM_H_
+
+#include <glib-object.h>
+#include <json-glib/json-glib.h>
+
+#include "torrent-record.h"
+
+typedef struct _trg_json_stream trg_json_stream;
+
+/* Given each torrent of a torrent-get response as soon as it has been
+ * decoded, with a fingerprint of its text. It may take over what's in the
+ * update, anything left is freed after.
+ */
+typedef void (*trg_json_stream_torrent_func) (trg_torrent_update * update,
+                                              guint64 fingerprint,
+                                              gpointer data);
+
+trg_json_stream *trg_json_stream_new(trg_json_stream_torrent_func func,
+                                     gpointer data);
+void trg_json_stream_feed(trg_json_stream * stream, const gchar * data,
+                          gsize len);
+JsonObject *trg_json_stream_finish(trg_json_stream * stream,
+                                   GError ** error);
+void trg_json_stream_free(trg_json_stream * stream);
+
+#endif                          /* JSON_STREAM_H_ */
@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include <string.h>
 #include <glib-object.h>
 #include <glib/gprintf.h>
 #include <json-glib/json-glib.h>
@@ -0,0 +1,91 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/* trg-mock-daemon: serve a synthetic session on an RPC port, to point the
+ * client (or trg-bench --mock-port) at. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <glib.h>
+#include <glib-object.h>
+
+#include "trg-synthetic.h"
+#include "trg-mock-daemon.h"
+
+static gint mock_port = 9091;
+static gint mock_torrents = 1000;
+static gint mock_files = 1000;
+static gint mock_peers = 50;
+static gdouble mock_churn = 0.1;
+static gint mock_latency = 0;
+
+static GOptionEntry mock_entries[] = {
+    {"port", 'p', 0, G_OPTION_ARG_INT, &mock_port, "Port to listen on",
+     "PORT"},
+    {"torrents", 't', 0, G_OPTION_ARG_INT, &mock_torrents,
+     "Number of torrents", "N"},
+    {"files", 'f', 0, G_OPTION_ARG_INT, &mock_files,
+     "Files in each torrent's details", "N"},
+    {"peers", 0, 0, G_OPTION_ARG_INT, &mock_peers,
+     "Peers in each torrent's details", "N"},
+    {"churn", 'c', 0, G_OPTION_ARG_DOUBLE, &mock_churn,
+     "Share of torrents active in each poll", "RATIO"},
+    {"latency", 'l', 0, G_OPTION_ARG_INT, &mock_latency,
+     "Delay before each response", "MS"},
+    {NULL}
+};
+
+int main(int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError *error = NULL;
+    trg_synthetic_session s;
+    TrgMockDaemon *daemon;
+
+    context = g_option_context_new(NULL);
+    g_option_context_add_main_entries(context, mock_entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        g_printerr("%s\n", error->message);
+        return EXIT_FAILURE;
+    }
+    g_option_context_free(context);
+
+    s.torrents = mock_torrents;
+    s.files = mock_files;
+    s.peers = mock_peers;
+    s.churn = mock_churn;
+
+    daemon = trg_mock_daemon_new(&s, (guint16) mock_port, mock_latency,
+                                 &error);
+    if (!daemon) {
+        g_printerr("%s\n", error->message);
+        return EXIT_FAILURE;
+    }
+
+    g_print("Serving %u torrents on port %u\n", s.torrents,
+            trg_mock_daemon_get_port(daemon));
+
+    g_main_loop_run(g_main_loop_new(NULL, FALSE));
+
+    return EXIT_SUCCESS;
+}
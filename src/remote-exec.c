@@ -56,25 +56,22 @@ static const char json_exceptions[] = { 0x7f, 0x80, 0x81, 0x82, 0x83, 0x84,
     0xfd, 0xfe, 0xff, '\0'      /* g_strescape() expects a NUL-terminated string */
 };
 
-static gchar *dump_json_value(JsonNode * node)
+static gchar *dump_value(const GValue * value)
 {
-    GValue value = G_VALUE_INIT;
     GString *buffer;
 
     buffer = g_string_new("");
 
-    json_node_get_value(node, &value);
-
-    switch (G_VALUE_TYPE(&value)) {
+    switch (G_VALUE_TYPE(value)) {
     case G_TYPE_INT64:
         g_string_append_printf(buffer, "%" G_GINT64_FORMAT,
-                               g_value_get_int64(&value));
+                               g_value_get_int64(value));
         break;
     case G_TYPE_STRING:
         {
             gchar *tmp;
 
-            tmp = g_strescape(g_value_get_string(&value), json_exceptions);
+            tmp = g_strescape(g_value_get_string(value), json_exceptions);
             g_string_append(buffer, tmp);
 
             g_free(tmp);
@@ -86,21 +83,31 @@ static gchar *dump_json_value(JsonNode * node)
 
             g_string_append(buffer,
                             g_ascii_dtostr(buf, sizeof(buf),
-                                           g_value_get_double(&value)));
+                                           g_value_get_double(value)));
         }
         break;
     case G_TYPE_BOOLEAN:
         g_string_append_printf(buffer, "%s",
-                               g_value_get_boolean(&value) ? "true" :
+                               g_value_get_boolean(value) ? "true" :
                                "false");
         break;
     default:
         break;
     }
 
+    return g_string_free(buffer, FALSE);
+}
+
+static gchar *dump_json_value(JsonNode * node)
+{
+    GValue value = G_VALUE_INIT;
+    gchar *str;
+
+    json_node_get_value(node, &value);
+    str = dump_value(&value);
     g_value_unset(&value);
 
-    return g_string_free(buffer, FALSE);
+    return str;
 }
 
 gchar *build_remote_exec_cmd(TrgClient * tc, GtkTreeModel * model,
@@ -145,27 +152,32 @@ gchar *build_remote_exec_cmd(TrgClient * tc, GtkTreeModel * model,
                 GString *gs = g_string_new("");
                 GList *li;
                 GtkTreeIter iter;
-                JsonObject *json;
+                const trg_torrent_record *rec;
+                GValue value = G_VALUE_INIT;
                 gchar *piece;
 
                 for (li = selection; li; li = g_list_next(li)) {
                     piece = NULL;
                     gtk_tree_model_get_iter(model, &iter,
                                             (GtkTreePath *) li->data);
-                    gtk_tree_model_get(model, &iter, TORRENT_COLUMN_JSON,
-                                       &json, -1);
-                    if (json_object_has_member(json, id)) {
-                        replacement = json_object_get_member(json, id);
-                        if (JSON_NODE_HOLDS_VALUE(replacement)) {
-                            piece = dump_json_value(replacement);
-                        }
+                    gtk_tree_model_get(model, &iter, TORRENT_COLUMN_RECORD,
+                                       &rec, -1);
+                    if (trg_torrent_record_get_value(rec, id, &value)) {
+                        piece = dump_value(&value);
+                        g_value_unset(&value);
                     }
 
                     if (!piece) {
                         if (!g_strcmp0(id, "full-dir")) {
-                            piece = torrent_get_full_dir(json);
+                            piece =
+                                trg_torrent_record_get_full_dir(rec,
+                                                                trg_torrent_model_get_details
+                                                                (TRG_TORRENT_MODEL
+                                                                 (trg_client_get_torrent_model
+                                                                  (tc)),
+                                                                 rec->id));
                         } else if (!g_strcmp0(id, "full-path")) {
-                            piece = torrent_get_full_path(json);
+                            piece = trg_torrent_record_get_full_path(rec);
                         }
                     }
 
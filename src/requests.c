@@ -152,6 +152,11 @@ JsonNode *torrent_remove(JsonArray * array, gboolean removeData)
 }
 
 JsonNode *torrent_get(gint64 id)
+{
+    return torrent_get_fields(id, TORRENT_GET_FIELDS_ALL);
+}
+
+JsonNode *torrent_get_fields(gint64 id, guint fieldSets)
 {
     JsonNode *root = base_request(METHOD_TORRENT_GET);
     JsonObject *args = node_get_arguments(root);
@@ -164,60 +169,84 @@ JsonNode *torrent_get(gint64 id)
         JsonArray *ids = json_array_new();
         json_array_add_int_element(ids, id);
         json_object_set_array_member(args, PARAM_IDS, ids);
+        request_set_tag(root, id);
+    }
+
+    if (fieldSets & TORRENT_GET_FIELDS_LIST) {
+        json_array_add_string_element(fields, FIELD_ID);
+        json_array_add_string_element(fields, FIELD_NAME);
+        json_array_add_string_element(fields, FIELD_STATUS);
+        json_array_add_string_element(fields, FIELD_ERROR);
+        json_array_add_string_element(fields, FIELD_ERROR_STRING);
+        json_array_add_string_element(fields, FIELD_ISFINISHED);
+        json_array_add_string_element(fields, FIELD_RATEUPLOAD);
+        json_array_add_string_element(fields, FIELD_RATEDOWNLOAD);
+        json_array_add_string_element(fields, FIELD_ETA);
+        json_array_add_string_element(fields, FIELD_PERCENTDONE);
+        json_array_add_string_element(fields, FIELD_RECHECK_PROGRESS);
+        json_array_add_string_element(fields,
+                                      FIELD_METADATAPERCENTCOMPLETE);
+        json_array_add_string_element(fields, FIELD_SIZEWHENDONE);
+        json_array_add_string_element(fields, FIELD_LEFT_UNTIL_DONE);
+        json_array_add_string_element(fields, FIELD_TOTAL_SIZE);
+        json_array_add_string_element(fields, FIELD_HAVEVALID);
+        json_array_add_string_element(fields, FIELD_HAVEUNCHECKED);
+        json_array_add_string_element(fields, FIELD_DOWNLOADEDEVER);
+        json_array_add_string_element(fields, FIELD_UPLOADEDEVER);
+        json_array_add_string_element(fields, FIELD_PEERS_CONNECTED);
+        json_array_add_string_element(fields, FIELD_PEERS_SENDING_TO_US);
+        json_array_add_string_element(fields, FIELD_PEERS_GETTING_FROM_US);
+        json_array_add_string_element(fields,
+                                      FIELD_WEB_SEEDS_SENDING_TO_US);
+        json_array_add_string_element(fields, FIELD_ADDED_DATE);
+        json_array_add_string_element(fields, FIELD_DOWNLOAD_DIR);
+        json_array_add_string_element(fields, FIELD_SEED_RATIO_LIMIT);
+        json_array_add_string_element(fields, FIELD_SEED_RATIO_MODE);
+        json_array_add_string_element(fields, FIELD_HASH_STRING);
+    }
+
+    if (fieldSets & TORRENT_GET_FIELDS_PEERSFROM)
+        json_array_add_string_element(fields, FIELD_PEERSFROM);
+
+    if (fieldSets & TORRENT_GET_FIELDS_TRACKERSTATS)
+        json_array_add_string_element(fields, FIELD_TRACKER_STATS);
+
+    if (fieldSets & TORRENT_GET_FIELDS_PRIORITY)
+        json_array_add_string_element(fields, FIELD_BANDWIDTH_PRIORITY);
+
+    if (fieldSets & TORRENT_GET_FIELDS_QUEUE)
+        json_array_add_string_element(fields, FIELD_QUEUE_POSITION);
+
+    if (fieldSets & TORRENT_GET_FIELDS_DATES) {
+        json_array_add_string_element(fields, FIELD_DONE_DATE);
+        json_array_add_string_element(fields, FIELD_ACTIVITY_DATE);
+    }
+
+    if (fieldSets & TORRENT_GET_FIELDS_FILES) {
+        json_array_add_string_element(fields, FIELD_FILES);
+        json_array_add_string_element(fields, FIELD_WANTED);
+        json_array_add_string_element(fields, FIELD_PRIORITIES);
+    }
+
+    if (fieldSets & TORRENT_GET_FIELDS_PEERS)
+        json_array_add_string_element(fields, FIELD_PEERS);
+
+    if (fieldSets & TORRENT_GET_FIELDS_DETAIL) {
+        json_array_add_string_element(fields, FIELD_COMMENT);
+        json_array_add_string_element(fields, FIELD_CREATOR);
+        json_array_add_string_element(fields, FIELD_DATE_CREATED);
+        json_array_add_string_element(fields, FIELD_ISPRIVATE);
+        json_array_add_string_element(fields, FIELD_MAGNETLINK);
+        json_array_add_string_element(fields, FIELD_ANNOUNCE_URL);
+        json_array_add_string_element(fields, FIELD_CORRUPTEVER);
+        json_array_add_string_element(fields, FIELD_HONORS_SESSION_LIMITS);
+        json_array_add_string_element(fields, FIELD_UPLOAD_LIMIT);
+        json_array_add_string_element(fields, FIELD_UPLOAD_LIMITED);
+        json_array_add_string_element(fields, FIELD_DOWNLOAD_LIMIT);
+        json_array_add_string_element(fields, FIELD_DOWNLOAD_LIMITED);
+        json_array_add_string_element(fields, FIELD_PEER_LIMIT);
     }
 
-    json_array_add_string_element(fields, FIELD_ETA);
-    json_array_add_string_element(fields, FIELD_PEERS);
-    json_array_add_string_element(fields, FIELD_PEERSFROM);
-    json_array_add_string_element(fields, FIELD_FILES);
-    json_array_add_string_element(fields, FIELD_PEERS_SENDING_TO_US);
-    json_array_add_string_element(fields, FIELD_PEERS_GETTING_FROM_US);
-    json_array_add_string_element(fields, FIELD_WEB_SEEDS_SENDING_TO_US);
-    json_array_add_string_element(fields, FIELD_PEERS_CONNECTED);
-    json_array_add_string_element(fields, FIELD_HAVEVALID);
-    json_array_add_string_element(fields, FIELD_HAVEUNCHECKED);
-    json_array_add_string_element(fields, FIELD_RATEUPLOAD);
-    json_array_add_string_element(fields, FIELD_RATEDOWNLOAD);
-    json_array_add_string_element(fields, FIELD_STATUS);
-    json_array_add_string_element(fields, FIELD_ISFINISHED);
-    json_array_add_string_element(fields, FIELD_ISPRIVATE);
-    json_array_add_string_element(fields, FIELD_ADDED_DATE);
-    json_array_add_string_element(fields, FIELD_DOWNLOADEDEVER);
-    json_array_add_string_element(fields, FIELD_UPLOADEDEVER);
-    json_array_add_string_element(fields, FIELD_CORRUPTEVER);
-    json_array_add_string_element(fields, FIELD_SIZEWHENDONE);
-    json_array_add_string_element(fields, FIELD_QUEUE_POSITION);
-    json_array_add_string_element(fields, FIELD_ID);
-    json_array_add_string_element(fields, FIELD_NAME);
-    json_array_add_string_element(fields, FIELD_PERCENTDONE);
-    json_array_add_string_element(fields, FIELD_COMMENT);
-    json_array_add_string_element(fields, FIELD_TOTAL_SIZE);
-    json_array_add_string_element(fields, FIELD_METADATAPERCENTCOMPLETE);
-    json_array_add_string_element(fields, FIELD_LEFT_UNTIL_DONE);
-    json_array_add_string_element(fields, FIELD_ANNOUNCE_URL);
-    json_array_add_string_element(fields, FIELD_ERROR_STRING);
-    json_array_add_string_element(fields, FIELD_TRACKER_STATS);
-    json_array_add_string_element(fields, FIELD_DATE_CREATED);
-    json_array_add_string_element(fields, FIELD_DOWNLOAD_DIR);
-    json_array_add_string_element(fields, FIELD_CREATOR);
-    json_array_add_string_element(fields, FIELD_HASH_STRING);
-    json_array_add_string_element(fields, FIELD_DONE_DATE);
-    json_array_add_string_element(fields, FIELD_HONORS_SESSION_LIMITS);
-    json_array_add_string_element(fields, FIELD_UPLOAD_LIMIT);
-    json_array_add_string_element(fields, FIELD_UPLOAD_LIMITED);
-    json_array_add_string_element(fields, FIELD_DOWNLOAD_LIMIT);
-    json_array_add_string_element(fields, FIELD_DOWNLOAD_LIMITED);
-    json_array_add_string_element(fields, FIELD_BANDWIDTH_PRIORITY);
-    json_array_add_string_element(fields, FIELD_SEED_RATIO_LIMIT);
-    json_array_add_string_element(fields, FIELD_SEED_RATIO_MODE);
-    json_array_add_string_element(fields, FIELD_PEER_LIMIT);
-    json_array_add_string_element(fields, FIELD_ACTIVITY_DATE);
-    json_array_add_string_element(fields, FIELD_MAGNETLINK);
-    json_array_add_string_element(fields, FIELD_ERROR);
-    json_array_add_string_element(fields, FIELD_ERROR_STRING);
-    json_array_add_string_element(fields, FIELD_WANTED);
-    json_array_add_string_element(fields, FIELD_PRIORITIES);
-    json_array_add_string_element(fields, FIELD_RECHECK_PROGRESS);
     json_object_set_array_member(args, PARAM_FIELDS, fields);
     return root;
 }
@@ -233,56 +262,72 @@ JsonNode *torrent_add_url(const gchar * url, gboolean paused)
     return root;
 }
 
-JsonNode *torrent_add_from_response(trg_response *response, gint flags) {
+/* The metainfo isn't encoded here, but set aside in *metainfo to be base64
+ * encoded straight into the request body as it's sent. */
+
+JsonNode *torrent_add_from_response(trg_response *response, gint flags,
+                                    GBytes ** metainfo) {
     JsonNode *root = base_request(METHOD_TORRENT_ADD);
     JsonObject *args = node_get_arguments(root);
-    gchar *encoded = g_base64_encode((guchar *)response->raw, response->size);
 
-    json_object_set_string_member(args, PARAM_METAINFO,
-                                  encoded);
-    g_free(encoded);
+    /* Take the body rather than copying it, the response isn't read again. */
+    *metainfo = g_bytes_new_take(response->raw, response->size);
+    response->raw = NULL;
+    response->size = 0;
+    response->capacity = 0;
 
+    json_object_set_string_member(args, PARAM_METAINFO, "");
     json_object_set_boolean_member(args, PARAM_PAUSED,
                                    (flags & TORRENT_ADD_FLAG_PAUSED));
 
     return root;
 }
 
-JsonNode *torrent_add_from_file(gchar * target, gint flags)
+JsonNode *torrent_add_from_file(gchar * target, gint flags,
+                                GBytes ** metainfo)
 {
     JsonNode *root;
     JsonObject *args;
     gboolean isMagnet = is_magnet(target);
     gboolean isUri = isMagnet || is_url(target);
-    gchar *encodedFile;
+
+    *metainfo = NULL;
 
     if (!isUri && !g_file_test(target, G_FILE_TEST_IS_REGULAR)) {
         g_message("file \"%s\" does not exist.", target);
         return NULL;
     }
 
+    if (!isUri && !(*metainfo = trg_map_file(target))) {
+        g_message("unable to read file \"%s\".", target);
+        return NULL;
+    }
+
     root = base_request(METHOD_TORRENT_ADD);
     args = node_get_arguments(root);
 
-    if (isUri) {
+    if (isUri)
         json_object_set_string_member(args, PARAM_FILENAME, target);
-    } else {
-        encodedFile = trg_base64encode(target);
-        if (encodedFile) {
-            json_object_set_string_member(args, PARAM_METAINFO,
-                                          encodedFile);
-            g_free(encodedFile);
-        } else {
-            g_error("unable to base64 encode file \"%s\".", target);
-            return NULL;
-        }
-    }
+    else
+        json_object_set_string_member(args, PARAM_METAINFO, "");
 
     json_object_set_boolean_member(args, PARAM_PAUSED,
                                    (flags & TORRENT_ADD_FLAG_PAUSED));
 
-    if ((flags & TORRENT_ADD_FLAG_DELETE))
+    if ((flags & TORRENT_ADD_FLAG_DELETE)) {
+#ifdef WIN32
+        /* A mapped file can't be removed on Windows, so copy it first. */
+        if (*metainfo) {
+            GBytes *mapped = *metainfo;
+            gsize len;
+            gconstpointer data = g_bytes_get_data(mapped, &len);
+
+            *metainfo = g_bytes_new(data, len);
+            g_bytes_unref(mapped);
+        }
+#endif
         g_unlink(target);
+    }
 
     return root;
 }
@@ -25,19 +25,48 @@
 
 #include "trg-client.h"
 
+/* Field sets which can be combined for a torrent-get request. The list set is
+ * what every torrent needs for its flags, status, stats and always-present
+ * columns. The optional sets only fill columns (or filters) which might not
+ * be showing. The detail, files and peers sets are what only the notebook
+ * panels and dialogs use, which are only requested for the torrents they
+ * show, and only for the panels which are showing.
+ */
+#define TORRENT_GET_FIELDS_LIST          (1 << 0)
+#define TORRENT_GET_FIELDS_DETAIL        (1 << 1)
+#define TORRENT_GET_FIELDS_PEERSFROM     (1 << 2)
+#define TORRENT_GET_FIELDS_TRACKERSTATS  (1 << 3)
+#define TORRENT_GET_FIELDS_PRIORITY      (1 << 4)
+#define TORRENT_GET_FIELDS_QUEUE         (1 << 5)
+#define TORRENT_GET_FIELDS_DATES         (1 << 6)
+#define TORRENT_GET_FIELDS_FILES         (1 << 7)
+#define TORRENT_GET_FIELDS_PEERS         (1 << 8)
+#define TORRENT_GET_FIELDS_ALL           (TORRENT_GET_FIELDS_LIST \
+                                          | TORRENT_GET_FIELDS_DETAIL \
+                                          | TORRENT_GET_FIELDS_FILES \
+                                          | TORRENT_GET_FIELDS_PEERS \
+                                          | TORRENT_GET_FIELDS_PEERSFROM \
+                                          | TORRENT_GET_FIELDS_TRACKERSTATS \
+                                          | TORRENT_GET_FIELDS_PRIORITY \
+                                          | TORRENT_GET_FIELDS_QUEUE \
+                                          | TORRENT_GET_FIELDS_DATES)
+
 JsonNode *generic_request(gchar * method, JsonArray * array);
 
 JsonNode *session_set(void);
 JsonNode *session_get(void);
 JsonNode *torrent_get(gint64 id);
+JsonNode *torrent_get_fields(gint64 id, guint fieldSets);
 JsonNode *torrent_set(JsonArray * array);
 JsonNode *torrent_pause(JsonArray * array);
 JsonNode *torrent_start(JsonArray * array);
 JsonNode *torrent_verify(JsonArray * array);
 JsonNode *torrent_reannounce(JsonArray * array);
 JsonNode *torrent_remove(JsonArray * array, int removeData);
-JsonNode *torrent_add_from_response(trg_response *response, gint flags);
-JsonNode *torrent_add_from_file(gchar * filename, gint flags);
+JsonNode *torrent_add_from_response(trg_response *response, gint flags,
+                                    GBytes ** metainfo);
+JsonNode *torrent_add_from_file(gchar * filename, gint flags,
+                                GBytes ** metainfo);
 JsonNode *torrent_add_url(const gchar * url, gboolean paused);
 JsonNode *torrent_set_location(JsonArray * array, gchar * location,
                                gboolean move);
@@ -25,33 +25,13 @@
 #include "icons.h"
 #include "trg-client.h"
 #include "torrent.h"
+#include "torrent-record.h"
 #include "util.h"
 #include "torrent-cell-renderer.h"
 
 enum {
-    P_STATUS = 1,
+    P_RECORD = 1,
     P_CLIENT,
-    P_RATIO,
-    P_SEEDRATIOLIMIT,
-    P_SEEDRATIOMODE,
-    P_DOWNLOADED,
-    P_HAVEVALID,
-    P_HAVEUNCHECKED,
-    P_ERROR,
-    P_SIZEWHENDONE,
-    P_TOTALSIZE,
-    P_UPLOADED,
-    P_PERCENTCOMPLETE,
-    P_METADATAPERCENTCOMPLETE,
-    P_UPSPEED,
-    P_DOWNSPEED,
-    P_PEERSGETTINGFROMUS,
-    P_WEBSEEDSTOUS,
-    P_PEERSTOUS,
-    P_ETA,
-    P_JSON,
-    P_CONNECTED,
-    P_FILECOUNT,
     P_BAR_HEIGHT,
     P_OWNER,
     P_COMPACT
@@ -93,28 +73,9 @@ struct TorrentCellRendererPrivate {
     GString *gstr2;
     int bar_height;
 
-    guint flags;
-    guint fileCount;
-    gint64 uploadedEver;
-    gint64 sizeWhenDone;
-    gint64 totalSize;
-    gint64 downloaded;
-    gint64 haveValid;
-    gint64 haveUnchecked;
-    gint64 upSpeed;
-    gint64 downSpeed;
-    gint64 peersFromUs;
-    gint64 webSeedsToUs;
-    gint64 peersToUs;
-    gint64 connected;
-    gint64 eta;
-    gint64 error;
-    gint64 seedRatioMode;
+    const trg_torrent_record *rec;
     gdouble done;
-    gdouble metadataPercentComplete;
     gdouble ratio;
-    gdouble seedRatioLimit;
-    gpointer json;
     TrgClient *client;
     GtkTreeView *owner;
     gboolean compact;
@@ -124,12 +85,12 @@ static gboolean getSeedRatio(TorrentCellRenderer * r, gdouble * ratio)
 {
     struct TorrentCellRendererPrivate *p = r->priv;
 
-    if ((p->seedRatioMode == 0)
+    if ((p->rec->seedRatioMode == 0)
         && (trg_client_get_seed_ratio_limited(p->client) == TRUE)) {
         *ratio = trg_client_get_seed_ratio_limit(p->client);
         return TRUE;
-    } else if (p->seedRatioMode == 1) {
-        *ratio = p->seedRatioLimit;
+    } else if (p->rec->seedRatioMode == 1) {
+        *ratio = p->rec->seedRatioLimit;
         return TRUE;
     }
 
@@ -140,20 +101,20 @@ static void getProgressString(GString * gstr, TorrentCellRenderer * r)
 {
     struct TorrentCellRendererPrivate *p = r->priv;
 
-    const gint64 haveTotal = p->haveUnchecked + p->haveValid;
-    const int isSeed = p->haveValid >= p->totalSize;
+    const gint64 haveTotal = p->rec->haveUnchecked + p->rec->haveValid;
+    const int isSeed = p->rec->haveValid >= p->rec->totalSize;
     char buf1[32], buf2[32], buf3[32], buf4[32], buf5[32], buf6[32];
     double seedRatio;
     const gboolean hasSeedRatio = getSeedRatio(r, &seedRatio);
 
-    if (p->flags & TORRENT_FLAG_DOWNLOADING) {  /* downloading */
+    if (p->rec->flags & TORRENT_FLAG_DOWNLOADING) {  /* downloading */
         g_string_append_printf(gstr,
                                /* %1$s is how much we've got,
                                   %2$s is how much we'll have when done,
                                   %3$s%% is a percentage of the two */
                                _("%1$s of %2$s (%3$s)"),
                                tr_strlsize(buf1, haveTotal, sizeof(buf1)),
-                               tr_strlsize(buf2, p->sizeWhenDone,
+                               tr_strlsize(buf2, p->rec->sizeWhenDone,
                                            sizeof(buf2)),
                                tr_strlpercent(buf3, p->done,
                                               sizeof(buf3)));
@@ -164,11 +125,11 @@ static void getProgressString(GString * gstr, TorrentCellRenderer * r)
                                    ("%1$s of %2$s (%3$s), uploaded %4$s (Ratio: %5$s Goal: %6$s)"),
                                    tr_strlsize(buf1, haveTotal,
                                                sizeof(buf1)),
-                                   tr_strlsize(buf2, p->totalSize,
+                                   tr_strlsize(buf2, p->rec->totalSize,
                                                sizeof(buf2)),
                                    tr_strlpercent(buf3, p->done,
                                                   sizeof(buf3)),
-                                   tr_strlsize(buf4, p->uploadedEver,
+                                   tr_strlsize(buf4, p->rec->uploadedEver,
                                                sizeof(buf4)),
                                    tr_strlratio(buf5, p->ratio,
                                                 sizeof(buf5)),
@@ -180,11 +141,11 @@ static void getProgressString(GString * gstr, TorrentCellRenderer * r)
                                    ("%1$s of %2$s (%3$s), uploaded %4$s (Ratio: %5$s)"),
                                    tr_strlsize(buf1, haveTotal,
                                                sizeof(buf1)),
-                                   tr_strlsize(buf2, p->totalSize,
+                                   tr_strlsize(buf2, p->rec->totalSize,
                                                sizeof(buf2)),
                                    tr_strlpercent(buf3, p->done,
                                                   sizeof(buf3)),
-                                   tr_strlsize(buf4, p->uploadedEver,
+                                   tr_strlsize(buf4, p->rec->uploadedEver,
                                                sizeof(buf4)),
                                    tr_strlratio(buf5, p->ratio,
                                                 sizeof(buf5)));
@@ -195,9 +156,9 @@ static void getProgressString(GString * gstr, TorrentCellRenderer * r)
             g_string_append_printf(gstr,
                                    _
                                    ("%1$s, uploaded %2$s (Ratio: %3$s Goal: %4$s)"),
-                                   tr_strlsize(buf1, p->totalSize,
+                                   tr_strlsize(buf1, p->rec->totalSize,
                                                sizeof(buf1)),
-                                   tr_strlsize(buf2, p->uploadedEver,
+                                   tr_strlsize(buf2, p->rec->uploadedEver,
                                                sizeof(buf2)),
                                    tr_strlratio(buf3, p->ratio,
                                                 sizeof(buf3)),
@@ -209,9 +170,9 @@ static void getProgressString(GString * gstr, TorrentCellRenderer * r)
                                       %2$s is how much we've uploaded,
                                       %3$s is our upload-to-download ratio */
                                    _("%1$s, uploaded %2$s (Ratio: %3$s)"),
-                                   tr_strlsize(buf1, p->sizeWhenDone,
+                                   tr_strlsize(buf1, p->rec->sizeWhenDone,
                                                sizeof(buf1)),
-                                   tr_strlsize(buf2, p->uploadedEver,
+                                   tr_strlsize(buf2, p->rec->uploadedEver,
                                                sizeof(buf2)),
                                    tr_strlratio(buf3, p->ratio,
                                                 sizeof(buf3)));
@@ -219,9 +180,9 @@ static void getProgressString(GString * gstr, TorrentCellRenderer * r)
     }
 
     /* add time when downloading */
-    if ((p->flags & TORRENT_FLAG_DOWNLOADING)
-        || (hasSeedRatio && (p->flags & TORRENT_FLAG_SEEDING))) {
-        gint64 eta = p->eta;
+    if ((p->rec->flags & TORRENT_FLAG_DOWNLOADING)
+        || (hasSeedRatio && (p->rec->flags & TORRENT_FLAG_SEEDING))) {
+        gint64 eta = p->rec->eta;
         g_string_append(gstr, " - ");
         if (eta < 0)
             g_string_append(gstr, _("Remaining time unknown"));
@@ -240,15 +201,16 @@ static char *getShortTransferString(TorrentCellRenderer * r,
     struct TorrentCellRendererPrivate *priv = r->priv;
 
     char downStr[32], upStr[32];
-    const gboolean haveMeta = priv->fileCount > 0;
-    const gboolean haveUp = haveMeta && priv->peersFromUs > 0;
-    const gboolean haveDown = haveMeta && priv->peersToUs > 0;
+    const trg_torrent_record *rec = priv->rec;
+    const gboolean haveMeta = rec->fileCount > 0;
+    const gboolean haveUp = haveMeta && rec->peersGettingFromUs > 0;
+    const gboolean haveDown = haveMeta && rec->peersSendingToUs > 0;
 
     if (haveDown)
-        tr_formatter_speed_KBps(downStr, priv->downSpeed / speed_K,
+        tr_formatter_speed_KBps(downStr, rec->rateDownload / speed_K,
                                 sizeof(downStr));
     if (haveUp)
-        tr_formatter_speed_KBps(upStr, priv->upSpeed / speed_K,
+        tr_formatter_speed_KBps(upStr, rec->rateUpload / speed_K,
                                 sizeof(upStr));
 
     if (haveDown && haveUp)
@@ -274,7 +236,7 @@ static char *getShortTransferString(TorrentCellRenderer * r,
 static void getShortStatusString(GString * gstr, TorrentCellRenderer * r)
 {
     struct TorrentCellRendererPrivate *priv = r->priv;
-    guint flags = priv->flags;
+    guint flags = priv->rec->flags;
 
     if (flags & TORRENT_FLAG_PAUSED) {
         g_string_append(gstr,
@@ -309,53 +271,59 @@ static void getStatusString(GString * gstr, TorrentCellRenderer * r)
     struct TorrentCellRendererPrivate *priv = r->priv;
     char buf[256];
 
-    if (priv->error) {
+    if (priv->rec->error) {
         const char *fmt[] = { NULL, N_("Tracker gave a warning: \"%s\""),
             N_("Tracker gave an error: \"%s\""),
             N_("Error: %s")
         };
-        g_string_append_printf(gstr, _(fmt[priv->error]),
-                               torrent_get_errorstr(priv->json));
-    } else if ((priv->flags & TORRENT_FLAG_PAUSED)
-               || (priv->flags & TORRENT_FLAG_WAITING_CHECK)
-               || (priv->flags & TORRENT_FLAG_CHECKING)
-               || (priv->flags & TORRENT_FLAG_DOWNLOADING_WAIT)
-               || (priv->flags & TORRENT_FLAG_SEEDING_WAIT)) {
+        g_string_append_printf(gstr, _(fmt[priv->rec->error]),
+                               priv->rec->errorString);
+    } else if ((priv->rec->flags & TORRENT_FLAG_PAUSED)
+               || (priv->rec->flags & TORRENT_FLAG_WAITING_CHECK)
+               || (priv->rec->flags & TORRENT_FLAG_CHECKING)
+               || (priv->rec->flags & TORRENT_FLAG_DOWNLOADING_WAIT)
+               || (priv->rec->flags & TORRENT_FLAG_SEEDING_WAIT)) {
         getShortStatusString(gstr, r);
-    } else if (priv->flags & TORRENT_FLAG_DOWNLOADING) {
-        if (priv->fileCount > 0) {
+    } else if (priv->rec->flags & TORRENT_FLAG_DOWNLOADING) {
+        if (priv->rec->fileCount > 0) {
             g_string_append_printf(gstr,
                                    ngettext
                                    ("Downloading from %1$"G_GUINT64_FORMAT" of %2$"G_GUINT64_FORMAT" connected peer",
                                     "Downloading from %1$"G_GUINT64_FORMAT" of %2$"G_GUINT64_FORMAT" connected peers",
-                                    priv->webSeedsToUs + priv->peersToUs),
-                                   priv->webSeedsToUs + priv->peersToUs,
-                                   priv->webSeedsToUs + priv->connected);
+                                    priv->rec->webseedsSendingToUs +
+                                    priv->rec->peersSendingToUs),
+                                   (guint64) (priv->rec->webseedsSendingToUs +
+                                              priv->rec->peersSendingToUs),
+                                   (guint64) (priv->rec->webseedsSendingToUs +
+                                              priv->rec->peersConnected));
         } else {
             g_string_append_printf(gstr,
                                    ngettext
                                    ("Downloading metadata from %1$"G_GUINT64_FORMAT" peer (%2$s done)",
                                     "Downloading metadata from %1$"G_GUINT64_FORMAT" peers (%2$s done)",
-                                    priv->connected + priv->webSeedsToUs),
-                                   priv->connected + priv->webSeedsToUs,
+                                    priv->rec->peersConnected +
+                                    priv->rec->webseedsSendingToUs),
+                                   (guint64) (priv->rec->peersConnected +
+                                              priv->rec->webseedsSendingToUs),
                                    tr_strlpercent(buf,
-                                                  priv->metadataPercentComplete,
+                                                  priv->rec->metadataPercentComplete,
                                                   sizeof(buf)));
         }
-    } else if (priv->flags & TORRENT_FLAG_SEEDING) {
+    } else if (priv->rec->flags & TORRENT_FLAG_SEEDING) {
         g_string_append_printf(gstr,
                                ngettext
                                ("Seeding to %1$"G_GUINT64_FORMAT" of %2$"G_GUINT64_FORMAT" connected peer",
                                 "Seeding to %1$"G_GUINT64_FORMAT" of %2$"G_GUINT64_FORMAT" connected peers",
-                                priv->connected), priv->peersFromUs,
-                               priv->connected);
+                                priv->rec->peersConnected),
+                               (guint64) priv->rec->peersGettingFromUs,
+                               (guint64) priv->rec->peersConnected);
     }
 
-    if ((priv->flags & ~TORRENT_FLAG_WAITING_CHECK) &&
-        (priv->flags & ~TORRENT_FLAG_CHECKING) &&
-        (priv->flags & ~TORRENT_FLAG_DOWNLOADING_WAIT) &&
-        (priv->flags & ~TORRENT_FLAG_SEEDING_WAIT) &&
-        (priv->flags & ~TORRENT_FLAG_PAUSED)) {
+    if ((priv->rec->flags & ~TORRENT_FLAG_WAITING_CHECK) &&
+        (priv->rec->flags & ~TORRENT_FLAG_CHECKING) &&
+        (priv->rec->flags & ~TORRENT_FLAG_DOWNLOADING_WAIT) &&
+        (priv->rec->flags & ~TORRENT_FLAG_SEEDING_WAIT) &&
+        (priv->rec->flags & ~TORRENT_FLAG_PAUSED)) {
         getShortTransferString(r, buf, sizeof(buf));
         if (*buf)
             g_string_append_printf(gstr, " - %s", buf);
@@ -373,9 +341,9 @@ static GdkPixbuf *get_icon(TorrentCellRenderer * r, GtkIconSize icon_size,
 
     const char *mime_type;
 
-    if (p->fileCount == 0)
+    if (p->rec->fileCount == 0 || p->rec->fileCount == TORRENT_FILE_COUNT_UNKNOWN)
         mime_type = UNKNOWN_MIME_TYPE;
-    else if (p->fileCount > 1)
+    else if (p->rec->fileCount > 1)
         mime_type = DIRECTORY_MIME_TYPE;
     /*else if( strchr( info->files[0].name, '/' ) != NULL )
        mime_type = DIRECTORY_MIME_TYPE;
@@ -424,7 +392,7 @@ get_size_compact(TorrentCellRenderer * cell,
     g_object_set(p->icon_renderer, "pixbuf", icon, NULL);
     gtr_cell_renderer_get_preferred_size(p->icon_renderer, widget, NULL,
                                          &icon_size);
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->rec->name,
                  "ellipsize", PANGO_ELLIPSIZE_NONE, "scale", 1.0, NULL);
     gtr_cell_renderer_get_preferred_size(p->text_renderer, widget, NULL,
                                          &name_size);
@@ -476,7 +444,7 @@ get_size_full(TorrentCellRenderer * cell,
     g_object_set(p->icon_renderer, "pixbuf", icon, NULL);
     gtr_cell_renderer_get_preferred_size(p->icon_renderer, widget, NULL,
                                          &icon_size);
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->rec->name,
                  "weight", PANGO_WEIGHT_BOLD, "scale", 1.0, "ellipsize",
                  PANGO_ELLIPSIZE_NONE, NULL);
     gtr_cell_renderer_get_preferred_size(p->text_renderer, widget, NULL,
@@ -553,9 +521,9 @@ get_text_color(TorrentCellRenderer * r, GtkWidget * widget,
     struct TorrentCellRendererPrivate *p = r->priv;
     static const GdkRGBA red = { 1.0, 0, 0, 0 };
 
-    if (p->error)
+    if (p->rec->error)
         *setme = red;
-    else if (p->flags & TORRENT_FLAG_PAUSED)
+    else if (p->rec->flags & TORRENT_FLAG_PAUSED)
         gtk_style_context_get_color(gtk_widget_get_style_context(widget),
                                     GTK_STATE_FLAG_INSENSITIVE, setme);
     else
@@ -568,13 +536,15 @@ static double get_percent_done(TorrentCellRenderer * r, gboolean * seed)
     struct TorrentCellRendererPrivate *priv = r->priv;
     gdouble d;
 
-    if ((priv->flags & TORRENT_FLAG_SEEDING) && getSeedRatio(r, &d)) {
+    if ((priv->rec->flags & TORRENT_FLAG_SEEDING) && getSeedRatio(r, &d)) {
         *seed = TRUE;
         const gint64 baseline =
-            priv->downloaded ? priv->downloaded : priv->sizeWhenDone;
-        const gint64 goal = baseline * priv->seedRatioLimit;
+            priv->rec->downloadedEver ? priv->rec->downloadedEver :
+            priv->rec->sizeWhenDone;
+        const gint64 goal = baseline * priv->rec->seedRatioLimit;
         const gint64 bytesLeft =
-            goal > priv->uploadedEver ? goal - priv->uploadedEver : 0;
+            goal > priv->rec->uploadedEver ?
+            goal - priv->rec->uploadedEver : 0;
         float seedRatioPercentDone = (gdouble) (goal - bytesLeft) / goal;
 
         d = MAX(0.0, seedRatioPercentDone * 100.0);
@@ -626,65 +596,12 @@ static void torrent_cell_renderer_set_property(GObject * object,
     struct TorrentCellRendererPrivate *p = self->priv;
 
     switch (property_id) {
-    case P_JSON:
-        p->json = g_value_get_pointer(v);
-        break;
-    case P_STATUS:
-        p->flags = g_value_get_uint(v);
-        break;
-    case P_TOTALSIZE:
-        p->totalSize = g_value_get_int64(v);
-        break;
-    case P_SIZEWHENDONE:
-        p->sizeWhenDone = g_value_get_int64(v);
-        break;
-    case P_DOWNLOADED:
-        p->downloaded = g_value_get_int64(v);
-        break;
-    case P_HAVEVALID:
-        p->haveValid = g_value_get_int64(v);
-        break;
-    case P_HAVEUNCHECKED:
-        p->haveUnchecked = g_value_get_int64(v);
-        break;
-    case P_UPLOADED:
-        p->uploadedEver = g_value_get_int64(v);
-        break;
-    case P_UPSPEED:
-        p->upSpeed = g_value_get_int64(v);
-        break;
-    case P_DOWNSPEED:
-        p->downSpeed = g_value_get_int64(v);
-        break;
-    case P_PEERSGETTINGFROMUS:
-        p->peersFromUs = g_value_get_int64(v);
-        break;
-    case P_WEBSEEDSTOUS:
-        p->webSeedsToUs = g_value_get_int64(v);
-        break;
-    case P_CONNECTED:
-        p->connected = g_value_get_int64(v);
-        break;
-    case P_FILECOUNT:
-        p->fileCount = g_value_get_uint(v);
-        break;
-    case P_ETA:
-        p->eta = g_value_get_int64(v);
-        break;
-    case P_PEERSTOUS:
-        p->peersToUs = g_value_get_int64(v);
-        break;
-    case P_ERROR:
-        p->error = g_value_get_int64(v);
-        break;
-    case P_RATIO:
-        p->ratio = g_value_get_double(v);
-        break;
-    case P_PERCENTCOMPLETE:
-        p->done = g_value_get_double(v);
-        break;
-    case P_METADATAPERCENTCOMPLETE:
-        p->metadataPercentComplete = g_value_get_double(v);
+    case P_RECORD:
+        p->rec = g_value_get_pointer(v);
+        if (p->rec) {
+            p->done = trg_torrent_record_get_progress(p->rec);
+            p->ratio = trg_torrent_record_get_ratio(p->rec);
+        }
         break;
     case P_BAR_HEIGHT:
         p->bar_height = g_value_get_int(v);
@@ -692,12 +609,6 @@ static void torrent_cell_renderer_set_property(GObject * object,
     case P_COMPACT:
         p->compact = g_value_get_boolean(v);
         break;
-    case P_SEEDRATIOMODE:
-        p->seedRatioMode = g_value_get_int64(v);
-        break;
-    case P_SEEDRATIOLIMIT:
-        p->seedRatioLimit = g_value_get_double(v);
-        break;
     case P_CLIENT:
         p->client = g_value_get_pointer(v);
         break;
@@ -752,9 +663,9 @@ torrent_cell_renderer_class_init(TorrentCellRendererClass * klass)
     gobject_class->get_property = torrent_cell_renderer_get_property;
     gobject_class->dispose = torrent_cell_renderer_dispose;
 
-    g_object_class_install_property(gobject_class, P_JSON,
-                                    g_param_spec_pointer("json", NULL,
-                                                         "json",
+    g_object_class_install_property(gobject_class, P_RECORD,
+                                    g_param_spec_pointer("record", NULL,
+                                                         "record",
                                                          G_PARAM_READWRITE));
 
     g_object_class_install_property(gobject_class, P_CLIENT,
@@ -767,139 +678,6 @@ torrent_cell_renderer_class_init(TorrentCellRendererClass * klass)
                                                          "owner",
                                                          G_PARAM_READWRITE));
 
-    g_object_class_install_property(gobject_class, P_RATIO,
-                                    g_param_spec_double("ratio", NULL,
-                                                        "ratio",
-                                                        0, G_MAXDOUBLE, 0,
-                                                        G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_SEEDRATIOLIMIT,
-                                    g_param_spec_double("seedRatioLimit",
-                                                        NULL,
-                                                        "seedRatioLimit",
-                                                        0, G_MAXDOUBLE, 0,
-                                                        G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_SEEDRATIOMODE,
-                                    g_param_spec_int64("seedRatioMode",
-                                                       NULL,
-                                                       "seedRatioMode", 0,
-                                                       2, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_PERCENTCOMPLETE,
-                                    g_param_spec_double("percentComplete",
-                                                        NULL,
-                                                        "percentComplete",
-                                                        0, 100.00, 0,
-                                                        G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class,
-                                    P_METADATAPERCENTCOMPLETE,
-                                    g_param_spec_double
-                                    ("metadataPercentComplete", NULL,
-                                     "metadataPercentComplete", 0, 100.00,
-                                     0, G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_TOTALSIZE,
-                                    g_param_spec_int64("totalSize", NULL,
-                                                       "totalSize",
-                                                       0, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_SIZEWHENDONE,
-                                    g_param_spec_int64("sizeWhenDone",
-                                                       NULL,
-                                                       "sizeWhenDone", 0,
-                                                       G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_STATUS,
-                                    g_param_spec_uint("status", NULL,
-                                                      "status",
-                                                      0, G_MAXUINT, 0,
-                                                      G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_FILECOUNT,
-                                    g_param_spec_uint("fileCount", NULL,
-                                                      "fileCount",
-                                                      0, G_MAXUINT, 0,
-                                                      G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_ERROR,
-                                    g_param_spec_int64("error", NULL,
-                                                       "error",
-                                                       0, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_UPSPEED,
-                                    g_param_spec_int64("upSpeed", NULL,
-                                                       "upSpeed",
-                                                       0, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_DOWNSPEED,
-                                    g_param_spec_int64("downSpeed", NULL,
-                                                       "downSpeed",
-                                                       0, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_DOWNLOADED,
-                                    g_param_spec_int64("downloaded", NULL,
-                                                       "downloaded",
-                                                       0, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_HAVEVALID,
-                                    g_param_spec_int64("haveValid", NULL,
-                                                       "haveValid",
-                                                       0, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_HAVEUNCHECKED,
-                                    g_param_spec_int64("haveUnchecked",
-                                                       NULL,
-                                                       "haveUnchecked", 0,
-                                                       G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_UPLOADED,
-                                    g_param_spec_int64("uploaded", NULL,
-                                                       "uploaded",
-                                                       0, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_PEERSGETTINGFROMUS,
-                                    g_param_spec_int64
-                                    ("peersGettingFromUs", NULL,
-                                     "peersGettingFromUs", -1, G_MAXINT64,
-                                     0, G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_PEERSTOUS,
-                                    g_param_spec_int64("peersToUs", NULL,
-                                                       "peersToUs",
-                                                       -1, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_WEBSEEDSTOUS,
-                                    g_param_spec_int64("webSeedsToUs",
-                                                       NULL,
-                                                       "webSeedsToUs", 0,
-                                                       G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_ETA,
-                                    g_param_spec_int64("eta", NULL,
-                                                       "eta",
-                                                       -2, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
-    g_object_class_install_property(gobject_class, P_CONNECTED,
-                                    g_param_spec_int64("connected", NULL,
-                                                       "connected",
-                                                       0, G_MAXINT64, 0,
-                                                       G_PARAM_READWRITE));
-
     g_object_class_install_property(gobject_class, P_BAR_HEIGHT,
                                     g_param_spec_int("bar-height", NULL,
                                                      "Bar Height",
@@ -962,11 +740,11 @@ render_compact(TorrentCellRenderer * cell,
     gboolean seed;
 
     struct TorrentCellRendererPrivate *p = cell->priv;
-    const gboolean active = (p->flags & ~TORRENT_FLAG_PAUSED)
-        && (p->flags & ~TORRENT_FLAG_DOWNLOADING_WAIT)
-        && (p->flags & ~TORRENT_FLAG_SEEDING_WAIT);
+    const gboolean active = (p->rec->flags & ~TORRENT_FLAG_PAUSED)
+        && (p->rec->flags & ~TORRENT_FLAG_DOWNLOADING_WAIT)
+        && (p->rec->flags & ~TORRENT_FLAG_SEEDING_WAIT);
     const double percentDone = get_percent_done(cell, &seed);
-    const gboolean sensitive = active || p->error;
+    const gboolean sensitive = active || p->rec->error;
     GString *gstr_stat = p->gstr1;
 
     icon = get_icon(cell, COMPACT_ICON_SIZE, widget);
@@ -987,7 +765,7 @@ render_compact(TorrentCellRenderer * cell,
     gtr_cell_renderer_get_preferred_size(p->icon_renderer, widget, NULL,
                                          &size);
     icon_area.width = size.width;
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->rec->name,
                  "ellipsize", PANGO_ELLIPSIZE_NONE, "scale", 1.0, NULL);
     gtr_cell_renderer_get_preferred_size(p->text_renderer, widget, NULL,
                                          &size);
@@ -1023,7 +801,7 @@ render_compact(TorrentCellRenderer * cell,
                  FOREGROUND_COLOR_KEY, &text_color, NULL);
     gtr_cell_renderer_render(p->text_renderer, window, widget, &stat_area,
                              flags);
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->rec->name,
                  "scale", 1.0, FOREGROUND_COLOR_KEY, &text_color, NULL);
     gtr_cell_renderer_render(p->text_renderer, window, widget, &name_area,
                              flags);
@@ -1052,10 +830,10 @@ render_full(TorrentCellRenderer * cell,
     gboolean seed;
 
     struct TorrentCellRendererPrivate *p = cell->priv;
-    const gboolean active = (p->flags & ~TORRENT_FLAG_PAUSED)
-        && (p->flags & ~TORRENT_FLAG_DOWNLOADING_WAIT)
-        && (p->flags & ~TORRENT_FLAG_SEEDING_WAIT);
-    const gboolean sensitive = active || p->error;
+    const gboolean active = (p->rec->flags & ~TORRENT_FLAG_PAUSED)
+        && (p->rec->flags & ~TORRENT_FLAG_DOWNLOADING_WAIT)
+        && (p->rec->flags & ~TORRENT_FLAG_SEEDING_WAIT);
+    const gboolean sensitive = active || p->rec->error;
     const double percentDone = get_percent_done(cell, &seed);
     GString *gstr_prog = p->gstr1;
     GString *gstr_stat = p->gstr2;
@@ -1074,7 +852,7 @@ render_full(TorrentCellRenderer * cell,
                                          &size);
     icon_area.width = size.width;
     icon_area.height = size.height;
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->rec->name,
                  "weight", PANGO_WEIGHT_BOLD, "ellipsize",
                  PANGO_ELLIPSIZE_NONE, "scale", 1.0, NULL);
     gtr_cell_renderer_get_preferred_size(p->text_renderer, widget, NULL,
@@ -1137,7 +915,7 @@ render_full(TorrentCellRenderer * cell,
                  NULL);
     gtr_cell_renderer_render(p->icon_renderer, window, widget, &icon_area,
                              flags);
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->rec->name,
                  "scale", 1.0, FOREGROUND_COLOR_KEY, &text_color,
                  "ellipsize", PANGO_ELLIPSIZE_END, "weight",
                  PANGO_WEIGHT_BOLD, NULL);
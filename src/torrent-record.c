@@ -0,0 +1,795 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+#include "torrent.h"
+#include "torrent-record.h"
+#include "protocol-constants.h"
+#include "util.h"
+
+/* Packed torrents. Each kept field has an entry in a table saying where
+ * it goes in the record and what it holds, so an update can be filled in
+ * by name as its members are decoded, then merged into the kept record
+ * field by field without looking anything up by name again.
+ */
+
+enum {
+    TORRENT_KIND_INT64,
+    TORRENT_KIND_INT32,
+    TORRENT_KIND_DOUBLE,
+    TORRENT_KIND_PROGRESS,
+    TORRENT_KIND_BOOLEAN,
+    TORRENT_KIND_STRING,
+    TORRENT_KIND_PEERSFROM,
+    TORRENT_KIND_ARRAY
+};
+
+typedef struct {
+    const gchar *name;
+    gint kind;
+    glong offset;
+} torrent_field;
+
+#define TORRENT_FIELD(name, kind, member) \
+    { name, kind, G_STRUCT_OFFSET(trg_torrent_record, member) }
+
+/* In the order of the TORRENT_FIELD_ enum. */
+static const torrent_field torrent_fields[TORRENT_FIELD_COUNT] = {
+    TORRENT_FIELD(FIELD_ID, TORRENT_KIND_INT64, id),
+    TORRENT_FIELD(FIELD_NAME, TORRENT_KIND_STRING, name),
+    TORRENT_FIELD(FIELD_STATUS, TORRENT_KIND_INT32, status),
+    TORRENT_FIELD(FIELD_ERROR, TORRENT_KIND_INT32, error),
+    TORRENT_FIELD(FIELD_ERROR_STRING, TORRENT_KIND_STRING, errorString),
+    TORRENT_FIELD(FIELD_ISFINISHED, TORRENT_KIND_BOOLEAN, isFinished),
+    TORRENT_FIELD(FIELD_RATEUPLOAD, TORRENT_KIND_INT64, rateUpload),
+    TORRENT_FIELD(FIELD_RATEDOWNLOAD, TORRENT_KIND_INT64, rateDownload),
+    TORRENT_FIELD(FIELD_ETA, TORRENT_KIND_INT64, eta),
+    TORRENT_FIELD(FIELD_PERCENTDONE, TORRENT_KIND_PROGRESS, percentDone),
+    TORRENT_FIELD(FIELD_RECHECK_PROGRESS, TORRENT_KIND_PROGRESS,
+                  recheckProgress),
+    TORRENT_FIELD(FIELD_METADATAPERCENTCOMPLETE, TORRENT_KIND_PROGRESS,
+                  metadataPercentComplete),
+    TORRENT_FIELD(FIELD_SIZEWHENDONE, TORRENT_KIND_INT64, sizeWhenDone),
+    TORRENT_FIELD(FIELD_LEFTUNTILDONE, TORRENT_KIND_INT64, leftUntilDone),
+    TORRENT_FIELD(FIELD_TOTAL_SIZE, TORRENT_KIND_INT64, totalSize),
+    TORRENT_FIELD(FIELD_HAVEVALID, TORRENT_KIND_INT64, haveValid),
+    TORRENT_FIELD(FIELD_HAVEUNCHECKED, TORRENT_KIND_INT64, haveUnchecked),
+    TORRENT_FIELD(FIELD_DOWNLOADEDEVER, TORRENT_KIND_INT64,
+                  downloadedEver),
+    TORRENT_FIELD(FIELD_UPLOADEDEVER, TORRENT_KIND_INT64, uploadedEver),
+    TORRENT_FIELD(FIELD_PEERS_CONNECTED, TORRENT_KIND_INT32,
+                  peersConnected),
+    TORRENT_FIELD(FIELD_PEERS_SENDING_TO_US, TORRENT_KIND_INT32,
+                  peersSendingToUs),
+    TORRENT_FIELD(FIELD_PEERS_GETTING_FROM_US, TORRENT_KIND_INT32,
+                  peersGettingFromUs),
+    TORRENT_FIELD(FIELD_WEB_SEEDS_SENDING_TO_US, TORRENT_KIND_INT32,
+                  webseedsSendingToUs),
+    TORRENT_FIELD(FIELD_ADDED_DATE, TORRENT_KIND_INT64, addedDate),
+    TORRENT_FIELD(FIELD_DOWNLOAD_DIR, TORRENT_KIND_STRING, downloadDir),
+    TORRENT_FIELD(FIELD_SEED_RATIO_LIMIT, TORRENT_KIND_DOUBLE,
+                  seedRatioLimit),
+    TORRENT_FIELD(FIELD_SEED_RATIO_MODE, TORRENT_KIND_INT32,
+                  seedRatioMode),
+    TORRENT_FIELD(FIELD_HASH_STRING, TORRENT_KIND_STRING, hashString),
+    {FIELD_PEERSFROM, TORRENT_KIND_PEERSFROM, -1},
+    {FIELD_TRACKER_STATS, TORRENT_KIND_ARRAY, -1},
+    TORRENT_FIELD(FIELD_BANDWIDTH_PRIORITY, TORRENT_KIND_INT32,
+                  bandwidthPriority),
+    TORRENT_FIELD(FIELD_QUEUE_POSITION, TORRENT_KIND_INT32,
+                  queuePosition),
+    TORRENT_FIELD(FIELD_DONE_DATE, TORRENT_KIND_INT64, doneDate),
+    TORRENT_FIELD(FIELD_ACTIVITY_DATE, TORRENT_KIND_INT64, activityDate),
+    {FIELD_FILES, TORRENT_KIND_ARRAY, -1},
+    {FIELD_WANTED, TORRENT_KIND_ARRAY, -1},
+    {FIELD_PRIORITIES, TORRENT_KIND_ARRAY, -1},
+    {FIELD_PEERS, TORRENT_KIND_ARRAY, -1},
+    TORRENT_FIELD(FIELD_COMMENT, TORRENT_KIND_STRING, comment),
+    TORRENT_FIELD(FIELD_CREATOR, TORRENT_KIND_STRING, creator),
+    TORRENT_FIELD(FIELD_DATE_CREATED, TORRENT_KIND_INT64, dateCreated),
+    TORRENT_FIELD(FIELD_ISPRIVATE, TORRENT_KIND_BOOLEAN, isPrivate),
+    TORRENT_FIELD(FIELD_MAGNETLINK, TORRENT_KIND_STRING, magnetLink),
+    TORRENT_FIELD(FIELD_CORRUPTEVER, TORRENT_KIND_INT64, corruptEver),
+    TORRENT_FIELD(FIELD_HONORS_SESSION_LIMITS, TORRENT_KIND_BOOLEAN,
+                  honorsSessionLimits),
+    TORRENT_FIELD(FIELD_UPLOAD_LIMIT, TORRENT_KIND_INT64, uploadLimit),
+    TORRENT_FIELD(FIELD_UPLOAD_LIMITED, TORRENT_KIND_BOOLEAN,
+                  uploadLimited),
+    TORRENT_FIELD(FIELD_DOWNLOAD_LIMIT, TORRENT_KIND_INT64,
+                  downloadLimit),
+    TORRENT_FIELD(FIELD_DOWNLOAD_LIMITED, TORRENT_KIND_BOOLEAN,
+                  downloadLimited),
+    TORRENT_FIELD(FIELD_PEER_LIMIT, TORRENT_KIND_INT32, peerLimit)
+};
+
+/* The members of peersFrom, which all come and go together. */
+static const torrent_field torrent_peerfrom_fields[] = {
+    TORRENT_FIELD(TPEERFROM_FROMTRACKERS, TORRENT_KIND_INT32,
+                  fromTrackers),
+    TORRENT_FIELD(TPEERFROM_FROMINCOMING, TORRENT_KIND_INT32,
+                  fromIncoming),
+    TORRENT_FIELD(TPEERFROM_FROMLTEP, TORRENT_KIND_INT32, fromLtep),
+    TORRENT_FIELD(TPEERFROM_FROMDHT, TORRENT_KIND_INT32, fromDht),
+    TORRENT_FIELD(TPEERFROM_FROMPEX, TORRENT_KIND_INT32, fromPex),
+    TORRENT_FIELD(TPEERFROM_FROMLPD, TORRENT_KIND_INT32, fromLpd),
+    TORRENT_FIELD(TPEERFROM_FROMRESUME, TORRENT_KIND_INT32, fromResume)
+};
+
+/* Strings which aren't fetched, but are kept in the pool all the same. */
+static const glong torrent_derived_strings[] = {
+    G_STRUCT_OFFSET(trg_torrent_record, trackerHost),
+    G_STRUCT_OFFSET(trg_torrent_record, shortDownloadDir)
+};
+
+trg_string_pool *trg_string_pool_new(void)
+{
+    trg_string_pool *pool = g_new0(trg_string_pool, 1);
+    pool->strings = g_hash_table_new(g_str_hash, g_str_equal);
+    return pool;
+}
+
+void trg_string_pool_free(trg_string_pool * pool)
+{
+    GHashTableIter iter;
+    gpointer key;
+
+    g_hash_table_iter_init(&iter, pool->strings);
+    while (g_hash_table_iter_next(&iter, &key, NULL))
+        g_free(key);
+
+    g_hash_table_destroy(pool->strings);
+    g_free(pool);
+}
+
+/* The pool's copy of a string, with a reference taken on it. */
+const gchar *trg_string_pool_ref(trg_string_pool * pool, const gchar * str)
+{
+    gpointer key, count;
+
+    if (!str)
+        return NULL;
+
+    if (g_hash_table_lookup_extended(pool->strings, str, &key, &count)) {
+        g_hash_table_insert(pool->strings, key,
+                            GUINT_TO_POINTER(GPOINTER_TO_UINT(count) + 1));
+    } else {
+        key = g_strdup(str);
+        g_hash_table_insert(pool->strings, key, GUINT_TO_POINTER(1));
+    }
+
+    return (const gchar *) key;
+}
+
+void trg_string_pool_unref(trg_string_pool * pool, const gchar * str)
+{
+    guint count;
+
+    if (!str)
+        return;
+
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(pool->strings, str));
+
+    if (count > 1) {
+        g_hash_table_insert(pool->strings, (gpointer) str,
+                            GUINT_TO_POINTER(count - 1));
+    } else {
+        g_hash_table_remove(pool->strings, str);
+        g_free((gpointer) str);
+    }
+}
+
+/* Point a record's string at the pool's copy of another, if it differs. */
+void
+trg_string_pool_set(trg_string_pool * pool, const gchar ** member,
+                    const gchar * str)
+{
+    const gchar *old = *member;
+
+    if (old == str || !g_strcmp0(old, str))
+        return;
+
+    *member = trg_string_pool_ref(pool, str);
+    trg_string_pool_unref(pool, old);
+}
+
+static gpointer torrent_field_lookup_init(gpointer data G_GNUC_UNUSED)
+{
+    GHashTable *table = g_hash_table_new(g_str_hash, g_str_equal);
+    gint i;
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++)
+        g_hash_table_insert(table, (gpointer) torrent_fields[i].name,
+                            GINT_TO_POINTER(i + 1));
+
+    return table;
+}
+
+/* Which kept field a torrent-get member is, or -1. Safe on any thread. */
+gint torrent_field_lookup(const gchar * name)
+{
+    static GOnce once = G_ONCE_INIT;
+    GHashTable *table = g_once(&once, torrent_field_lookup_init, NULL);
+
+    return GPOINTER_TO_INT(g_hash_table_lookup(table, name)) - 1;
+}
+
+const gchar *torrent_field_name(gint field)
+{
+    return torrent_fields[field].name;
+}
+
+/* Whether a field is one of the per-file, per-peer or per-tracker arrays. */
+gboolean torrent_field_is_array(gint field)
+{
+    return field >= 0 && torrent_fields[field].kind == TORRENT_KIND_ARRAY;
+}
+
+static inline gpointer
+torrent_field_member(trg_torrent_record * rec, const torrent_field * f)
+{
+    return G_STRUCT_MEMBER_P(rec, f->offset);
+}
+
+static gsize torrent_field_size(const torrent_field * f)
+{
+    switch (f->kind) {
+    case TORRENT_KIND_INT64:
+        return sizeof(gint64);
+    case TORRENT_KIND_INT32:
+        return sizeof(gint32);
+    case TORRENT_KIND_DOUBLE:
+    case TORRENT_KIND_PROGRESS:
+        return sizeof(gdouble);
+    case TORRENT_KIND_BOOLEAN:
+        return sizeof(guint8);
+    default:
+        return 0;
+    }
+}
+
+/* Numbers are converted to whatever the field holds, as the daemon sends
+ * whole doubles as integers.
+ */
+static void
+torrent_field_set_number(trg_torrent_record * rec,
+                         const torrent_field * f, gint64 i, gdouble d,
+                         gboolean isDouble)
+{
+    gpointer member = torrent_field_member(rec, f);
+
+    switch (f->kind) {
+    case TORRENT_KIND_INT64:
+        *(gint64 *) member = isDouble ? (gint64) d : i;
+        break;
+    case TORRENT_KIND_INT32:
+        *(gint32 *) member = isDouble ? (gint32) d : (gint32) i;
+        break;
+    case TORRENT_KIND_DOUBLE:
+        *(gdouble *) member = isDouble ? d : (gdouble) i;
+        break;
+    case TORRENT_KIND_PROGRESS:
+        *(gdouble *) member = (isDouble ? d : (gdouble) i) * 100.0;
+        break;
+    case TORRENT_KIND_BOOLEAN:
+        *(guint8 *) member = isDouble ? d != 0.0 : i != 0;
+        break;
+    }
+}
+
+void trg_torrent_record_init(trg_torrent_record * rec)
+{
+    memset(rec, 0, sizeof(trg_torrent_record));
+    rec->metadataPercentComplete = 100.0;
+    rec->queuePosition = -1;
+    rec->fromLpd = -1;
+}
+
+void trg_torrent_update_init(trg_torrent_update * update)
+{
+    memset(update, 0, sizeof(trg_torrent_update));
+    trg_torrent_record_init(&update->rec);
+}
+
+static JsonArray **trg_torrent_update_array(trg_torrent_update * update,
+                                            gint field)
+{
+    switch (field) {
+    case TORRENT_FIELD_TRACKER_STATS:
+        return &update->trackerStats;
+    case TORRENT_FIELD_FILES:
+        return &update->files;
+    case TORRENT_FIELD_WANTED:
+        return &update->wanted;
+    case TORRENT_FIELD_PRIORITIES:
+        return &update->priorities;
+    case TORRENT_FIELD_PEERS:
+        return &update->peers;
+    default:
+        return NULL;
+    }
+}
+
+void trg_torrent_update_clear(trg_torrent_update * update)
+{
+    gint i;
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++) {
+        const torrent_field *f = &torrent_fields[i];
+        JsonArray **array;
+
+        if (f->kind == TORRENT_KIND_STRING)
+            g_free(*(gchar **) torrent_field_member(&update->rec, f));
+        else if ((array = trg_torrent_update_array(update, i)) && *array)
+            json_array_unref(*array);
+    }
+
+    trg_torrent_update_init(update);
+}
+
+void
+trg_torrent_update_set_int(trg_torrent_update * update, gint field,
+                           gint64 value)
+{
+    const torrent_field *f = &torrent_fields[field];
+
+    if (torrent_field_size(f) > 0) {
+        torrent_field_set_number(&update->rec, f, value, 0, FALSE);
+        update->present |= TORRENT_FIELD_BIT(field);
+    }
+}
+
+void
+trg_torrent_update_set_double(trg_torrent_update * update, gint field,
+                              gdouble value)
+{
+    const torrent_field *f = &torrent_fields[field];
+
+    if (torrent_field_size(f) > 0) {
+        torrent_field_set_number(&update->rec, f, 0, value, TRUE);
+        update->present |= TORRENT_FIELD_BIT(field);
+    }
+}
+
+void
+trg_torrent_update_set_string(trg_torrent_update * update, gint field,
+                              const gchar * value)
+{
+    const torrent_field *f = &torrent_fields[field];
+    gchar **member;
+
+    if (f->kind != TORRENT_KIND_STRING)
+        return;
+
+    member = (gchar **) torrent_field_member(&update->rec, f);
+    g_free(*member);
+    *member = g_strdup(value);
+
+    if (field == TORRENT_FIELD_DOWNLOAD_DIR)
+        rm_trailing_slashes(*member);
+
+    update->present |= TORRENT_FIELD_BIT(field);
+}
+
+/* Takes a reference on the array. */
+void
+trg_torrent_update_set_array(trg_torrent_update * update, gint field,
+                             JsonArray * array)
+{
+    JsonArray **member = trg_torrent_update_array(update, field);
+
+    if (!member)
+        return;
+
+    if (*member)
+        json_array_unref(*member);
+
+    *member = json_array_ref(array);
+    update->present |= TORRENT_FIELD_BIT(field);
+}
+
+void
+trg_torrent_update_set_peerfrom(trg_torrent_update * update,
+                                const gchar * name, gint64 value)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(torrent_peerfrom_fields); i++) {
+        if (!strcmp(torrent_peerfrom_fields[i].name, name)) {
+            torrent_field_set_number(&update->rec,
+                                     &torrent_peerfrom_fields[i], value,
+                                     0, FALSE);
+            update->present |=
+                TORRENT_FIELD_BIT(TORRENT_FIELD_PEERSFROM);
+            break;
+        }
+    }
+}
+
+static void
+trg_torrent_update_peerfrom_foreach(JsonObject * object G_GNUC_UNUSED,
+                                    const gchar * name, JsonNode * node,
+                                    gpointer data)
+{
+    if (JSON_NODE_HOLDS_VALUE(node))
+        trg_torrent_update_set_peerfrom((trg_torrent_update *) data, name,
+                                        json_node_get_int(node));
+}
+
+/* Decode one member of a torrent, if it's kept. */
+void
+trg_torrent_update_set_member(trg_torrent_update * update,
+                              const gchar * name, JsonNode * node)
+{
+    gint field = torrent_field_lookup(name);
+
+    if (field < 0)
+        return;
+
+    switch (JSON_NODE_TYPE(node)) {
+    case JSON_NODE_VALUE:
+        switch (json_node_get_value_type(node)) {
+        case G_TYPE_INT64:
+            trg_torrent_update_set_int(update, field,
+                                       json_node_get_int(node));
+            break;
+        case G_TYPE_DOUBLE:
+            trg_torrent_update_set_double(update, field,
+                                          json_node_get_double(node));
+            break;
+        case G_TYPE_BOOLEAN:
+            trg_torrent_update_set_int(update, field,
+                                       json_node_get_boolean(node));
+            break;
+        case G_TYPE_STRING:
+            trg_torrent_update_set_string(update, field,
+                                          json_node_get_string(node));
+            break;
+        }
+        break;
+    case JSON_NODE_OBJECT:
+        if (field == TORRENT_FIELD_PEERSFROM)
+            json_object_foreach_member(json_node_get_object(node),
+                                       trg_torrent_update_peerfrom_foreach,
+                                       update);
+        break;
+    case JSON_NODE_ARRAY:
+        trg_torrent_update_set_array(update, field,
+                                     json_node_get_array(node));
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+trg_torrent_update_member_foreach(JsonObject * object G_GNUC_UNUSED,
+                                  const gchar * name, JsonNode * node,
+                                  gpointer data)
+{
+    trg_torrent_update_set_member((trg_torrent_update *) data, name, node);
+}
+
+/* One pass over a torrent's members. */
+void trg_torrent_update_from_json(trg_torrent_update * update,
+                                  JsonObject * t)
+{
+    json_object_foreach_member(t, trg_torrent_update_member_foreach,
+                               update);
+}
+
+static guint64
+trg_torrent_record_merge_value(trg_torrent_record * rec,
+                               const trg_torrent_update * update,
+                               const torrent_field * f, guint64 bit)
+{
+    gpointer dst = torrent_field_member(rec, f);
+    gconstpointer src =
+        torrent_field_member((trg_torrent_record *) & update->rec, f);
+    gsize size = torrent_field_size(f);
+
+    if (!memcmp(dst, src, size))
+        return 0;
+
+    memcpy(dst, src, size);
+    return bit;
+}
+
+/* Copy the fields an update had into a kept record, interning strings.
+ * Returns the mask of those whose values changed.
+ */
+guint64
+trg_torrent_record_merge(trg_torrent_record * rec,
+                         const trg_torrent_update * update,
+                         trg_string_pool * pool)
+{
+    guint64 changed = 0;
+    gint i;
+    guint j;
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++) {
+        const torrent_field *f = &torrent_fields[i];
+        guint64 bit = TORRENT_FIELD_BIT(i);
+
+        if (!(update->present & bit))
+            continue;
+
+        switch (f->kind) {
+        case TORRENT_KIND_STRING:{
+                const gchar **member =
+                    (const gchar **) torrent_field_member(rec, f);
+                const gchar *old = *member;
+
+                trg_string_pool_set(pool, member,
+                                    *(const gchar **) torrent_field_member
+                                    ((trg_torrent_record *) &
+                                     update->rec, f));
+                if (*member != old)
+                    changed |= bit;
+                break;
+            }
+        case TORRENT_KIND_PEERSFROM:
+            for (j = 0; j < G_N_ELEMENTS(torrent_peerfrom_fields); j++)
+                changed |=
+                    trg_torrent_record_merge_value(rec, update,
+                                                   &torrent_peerfrom_fields
+                                                   [j], bit);
+            break;
+        case TORRENT_KIND_ARRAY:
+            break;
+        default:
+            changed |= trg_torrent_record_merge_value(rec, update, f, bit);
+            break;
+        }
+    }
+
+    rec->fetched |= update->present;
+
+    return changed;
+}
+
+/* Give back a record's strings, and leave it as new. */
+void trg_torrent_record_clear(trg_torrent_record * rec,
+                              trg_string_pool * pool)
+{
+    guint i;
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++)
+        if (torrent_fields[i].kind == TORRENT_KIND_STRING)
+            trg_string_pool_unref(pool,
+                                  *(const gchar **) torrent_field_member
+                                  (rec, &torrent_fields[i]));
+
+    for (i = 0; i < G_N_ELEMENTS(torrent_derived_strings); i++)
+        trg_string_pool_unref(pool,
+                              G_STRUCT_MEMBER(const gchar *, rec,
+                                              torrent_derived_strings[i]));
+
+    trg_torrent_record_init(rec);
+}
+
+/* A field by its torrent-get name, as the daemon would have sent it, for
+ * the remote commands. Only fields which have been fetched have values.
+ */
+gboolean
+trg_torrent_record_get_value(const trg_torrent_record * rec,
+                             const gchar * name, GValue * value)
+{
+    gint field = torrent_field_lookup(name);
+    const torrent_field *f;
+    gconstpointer member;
+
+    if (field < 0 || !(rec->fetched & TORRENT_FIELD_BIT(field)))
+        return FALSE;
+
+    f = &torrent_fields[field];
+    if (f->offset < 0)
+        return FALSE;
+
+    member = G_STRUCT_MEMBER_P(rec, f->offset);
+
+    switch (f->kind) {
+    case TORRENT_KIND_INT64:
+        g_value_init(value, G_TYPE_INT64);
+        g_value_set_int64(value, *(const gint64 *) member);
+        break;
+    case TORRENT_KIND_INT32:
+        g_value_init(value, G_TYPE_INT64);
+        g_value_set_int64(value, *(const gint32 *) member);
+        break;
+    case TORRENT_KIND_DOUBLE:
+        g_value_init(value, G_TYPE_DOUBLE);
+        g_value_set_double(value, *(const gdouble *) member);
+        break;
+    case TORRENT_KIND_PROGRESS:
+        g_value_init(value, G_TYPE_DOUBLE);
+        g_value_set_double(value, *(const gdouble *) member / 100.0);
+        break;
+    case TORRENT_KIND_BOOLEAN:
+        g_value_init(value, G_TYPE_BOOLEAN);
+        g_value_set_boolean(value, *(const guint8 *) member);
+        break;
+    case TORRENT_KIND_STRING:
+        g_value_init(value, G_TYPE_STRING);
+        g_value_set_string(value, *(const gchar * const *) member);
+        break;
+    default:
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+guint32
+trg_torrent_record_get_flags(const trg_torrent_record * rec, gint64 rpcv)
+{
+    guint32 flags = 0;
+
+    if (rec->fileCount > 0 && rec->leftUntilDone <= 0)
+        flags |= TORRENT_FLAG_COMPLETE;
+    else
+        flags |= TORRENT_FLAG_INCOMPLETE;
+
+    if (rpcv >= NEW_STATUS_RPC_VERSION) {
+        switch (rec->status) {
+        case TR_STATUS_STOPPED:
+            flags |= TORRENT_FLAG_PAUSED;
+            break;
+        case TR_STATUS_CHECK_WAIT:
+            flags |= TORRENT_FLAG_WAITING_CHECK;
+            flags |= TORRENT_FLAG_CHECKING_ANY;
+            break;
+        case TR_STATUS_CHECK:
+            flags |= TORRENT_FLAG_CHECKING;
+            flags |= TORRENT_FLAG_CHECKING_ANY;
+            break;
+        case TR_STATUS_DOWNLOAD_WAIT:
+            flags |= TORRENT_FLAG_DOWNLOADING_WAIT;
+            flags |= TORRENT_FLAG_QUEUED;
+            break;
+        case TR_STATUS_DOWNLOAD:
+            if (!(flags & TORRENT_FLAG_COMPLETE))
+                flags |= TORRENT_FLAG_DOWNLOADING;
+
+            if (rec->fileCount == 0)
+                flags |= TORRENT_FLAG_DOWNLOADING_METADATA;
+
+            flags |= TORRENT_FLAG_ACTIVE;
+            break;
+        case TR_STATUS_SEED_WAIT:
+            flags |= TORRENT_FLAG_SEEDING_WAIT;
+            break;
+        case TR_STATUS_SEED:
+            flags |= TORRENT_FLAG_SEEDING;
+            if (rec->peersGettingFromUs)
+                flags |= TORRENT_FLAG_ACTIVE;
+            break;
+        }
+    } else {
+        switch (rec->status) {
+        case OLD_STATUS_DOWNLOADING:
+            flags |= TORRENT_FLAG_DOWNLOADING;
+            break;
+        case OLD_STATUS_PAUSED:
+            flags |= TORRENT_FLAG_PAUSED;
+            break;
+        case OLD_STATUS_SEEDING:
+            flags |= TORRENT_FLAG_SEEDING;
+            break;
+        case OLD_STATUS_CHECKING:
+            flags |= TORRENT_FLAG_CHECKING;
+            break;
+        case OLD_STATUS_WAITING_TO_CHECK:
+            flags |= TORRENT_FLAG_WAITING_CHECK;
+            flags |= TORRENT_FLAG_CHECKING;
+            break;
+        }
+
+        if (rec->rateDownload > 0 || rec->rateUpload > 0)
+            flags |= TORRENT_FLAG_ACTIVE;
+    }
+
+    if (rec->error > 0)
+        flags |= TORRENT_FLAG_ERROR;
+
+    return flags;
+}
+
+/* What the progress bar shows, which is the verification while checking. */
+gdouble trg_torrent_record_get_progress(const trg_torrent_record * rec)
+{
+    return (rec->flags & TORRENT_FLAG_CHECKING) ? rec->recheckProgress :
+        rec->percentDone;
+}
+
+gdouble trg_torrent_record_get_ratio(const trg_torrent_record * rec)
+{
+    return rec->uploadedEver > 0 && rec->haveValid > 0 ?
+        (gdouble) rec->uploadedEver / (gdouble) rec->haveValid : 0;
+}
+
+gchar *trg_torrent_record_get_peer_sources(const trg_torrent_record * rec)
+{
+    if (!(rec->fetched & TORRENT_FIELD_BIT(TORRENT_FIELD_PEERSFROM))
+        || !(rec->flags & TORRENT_FLAG_ACTIVE))
+        return NULL;
+    else if (rec->fromLpd >= 0)
+        return g_strdup_printf("%d / %d / %d / %d / %d / %d / %d",
+                               rec->fromTrackers, rec->fromIncoming,
+                               rec->fromLtep, rec->fromDht, rec->fromPex,
+                               rec->fromLpd, rec->fromResume);
+    else
+        return g_strdup_printf("%d / %d / %d / %d / %d / N/A / %d",
+                               rec->fromTrackers, rec->fromIncoming,
+                               rec->fromLtep, rec->fromDht, rec->fromPex,
+                               rec->fromResume);
+}
+
+gchar *trg_torrent_record_get_full_path(const trg_torrent_record * rec)
+{
+    return g_strdup_printf("%s/%s", rec->downloadDir, rec->name);
+}
+
+/* The directory a torrent's files are in, which needs its files. */
+gchar *trg_torrent_record_get_full_dir(const trg_torrent_record * rec,
+                                       const trg_torrent_details *
+                                       details)
+{
+    JsonArray *files = details && details->id == rec->id ?
+        details->files : NULL;
+    gchar *containing_path, *name, *delim;
+
+    if (!files || json_array_get_length(files) < 1)
+        return g_strdup(rec->downloadDir);
+
+    name = g_strdup(file_get_name(json_array_get_object_element(files, 0)));
+
+    if ((delim = g_strstr_len(name, -1, "/"))) {
+        *delim = '\0';
+        containing_path = g_strdup_printf("%s/%s", rec->downloadDir, name);
+    } else {
+        containing_path = g_strdup(rec->downloadDir);
+    }
+
+    g_free(name);
+    return containing_path;
+}
+
+void trg_torrent_details_clear(trg_torrent_details * details)
+{
+    if (details->trackerStats)
+        json_array_unref(details->trackerStats);
+    if (details->files)
+        json_array_unref(details->files);
+    if (details->wanted)
+        json_array_unref(details->wanted);
+    if (details->priorities)
+        json_array_unref(details->priorities);
+    if (details->peers)
+        json_array_unref(details->peers);
+
+    memset(details, 0, sizeof(trg_torrent_details));
+    details->id = -1;
+}
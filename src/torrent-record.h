@@ -0,0 +1,239 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TORRENT_RECORD_H_
+#define TORRENT_RECORD_H_
+
+#include <glib-object.h>
+#include <json-glib/json-glib.h>
+
+/* The torrent-get fields which are kept, and the bit of each in the mask of
+ * those an update had.
+ */
+enum {
+    TORRENT_FIELD_ID,
+    TORRENT_FIELD_NAME,
+    TORRENT_FIELD_STATUS,
+    TORRENT_FIELD_ERROR,
+    TORRENT_FIELD_ERROR_STRING,
+    TORRENT_FIELD_IS_FINISHED,
+    TORRENT_FIELD_RATE_UPLOAD,
+    TORRENT_FIELD_RATE_DOWNLOAD,
+    TORRENT_FIELD_ETA,
+    TORRENT_FIELD_PERCENT_DONE,
+    TORRENT_FIELD_RECHECK_PROGRESS,
+    TORRENT_FIELD_METADATA_PERCENT_COMPLETE,
+    TORRENT_FIELD_SIZE_WHEN_DONE,
+    TORRENT_FIELD_LEFT_UNTIL_DONE,
+    TORRENT_FIELD_TOTAL_SIZE,
+    TORRENT_FIELD_HAVE_VALID,
+    TORRENT_FIELD_HAVE_UNCHECKED,
+    TORRENT_FIELD_DOWNLOADED_EVER,
+    TORRENT_FIELD_UPLOADED_EVER,
+    TORRENT_FIELD_PEERS_CONNECTED,
+    TORRENT_FIELD_PEERS_SENDING_TO_US,
+    TORRENT_FIELD_PEERS_GETTING_FROM_US,
+    TORRENT_FIELD_WEB_SEEDS_SENDING_TO_US,
+    TORRENT_FIELD_ADDED_DATE,
+    TORRENT_FIELD_DOWNLOAD_DIR,
+    TORRENT_FIELD_SEED_RATIO_LIMIT,
+    TORRENT_FIELD_SEED_RATIO_MODE,
+    TORRENT_FIELD_HASH_STRING,
+    TORRENT_FIELD_PEERSFROM,
+    TORRENT_FIELD_TRACKER_STATS,
+    TORRENT_FIELD_BANDWIDTH_PRIORITY,
+    TORRENT_FIELD_QUEUE_POSITION,
+    TORRENT_FIELD_DONE_DATE,
+    TORRENT_FIELD_ACTIVITY_DATE,
+    TORRENT_FIELD_FILES,
+    TORRENT_FIELD_WANTED,
+    TORRENT_FIELD_PRIORITIES,
+    TORRENT_FIELD_PEERS,
+    TORRENT_FIELD_COMMENT,
+    TORRENT_FIELD_CREATOR,
+    TORRENT_FIELD_DATE_CREATED,
+    TORRENT_FIELD_IS_PRIVATE,
+    TORRENT_FIELD_MAGNETLINK,
+    TORRENT_FIELD_CORRUPT_EVER,
+    TORRENT_FIELD_HONORS_SESSION_LIMITS,
+    TORRENT_FIELD_UPLOAD_LIMIT,
+    TORRENT_FIELD_UPLOAD_LIMITED,
+    TORRENT_FIELD_DOWNLOAD_LIMIT,
+    TORRENT_FIELD_DOWNLOAD_LIMITED,
+    TORRENT_FIELD_PEER_LIMIT,
+    TORRENT_FIELD_COUNT
+};
+
+#define TORRENT_FIELD_BIT(f) (G_GUINT64_CONSTANT(1) << (f))
+
+/* What's kept of a torrent, with fixed width fields in place of the JSON
+ * members they come from. Progress is a percentage, as it's shown.
+ *
+ * In the torrent model, strings are interned in its trg_string_pool, so
+ * one hasn't changed if it's still the same pointer. In an update they're
+ * just owned by it.
+ */
+typedef struct {
+    gint64 id;
+    guint64 fetched;            /* the fields any update has had */
+    gint64 totalSize;
+    gint64 sizeWhenDone;
+    gint64 leftUntilDone;
+    gint64 haveValid;
+    gint64 haveUnchecked;
+    gint64 downloadedEver;
+    gint64 uploadedEver;
+    gint64 corruptEver;
+    gint64 rateDownload;
+    gint64 rateUpload;
+    gint64 eta;
+    gint64 addedDate;
+    gint64 doneDate;
+    gint64 activityDate;
+    gint64 dateCreated;
+    gint64 downloadLimit;
+    gint64 uploadLimit;
+    gdouble percentDone;
+    gdouble recheckProgress;
+    gdouble metadataPercentComplete;
+    gdouble seedRatioLimit;
+    gint32 status;
+    gint32 error;
+    gint32 peersConnected;
+    gint32 peersSendingToUs;
+    gint32 peersGettingFromUs;
+    gint32 webseedsSendingToUs;
+    gint32 bandwidthPriority;
+    gint32 queuePosition;
+    gint32 seedRatioMode;
+    gint32 peerLimit;
+    /* peersFrom, where fromLpd is -1 if the daemon doesn't report it. */
+    gint32 fromTrackers;
+    gint32 fromIncoming;
+    gint32 fromLtep;
+    gint32 fromDht;
+    gint32 fromPex;
+    gint32 fromLpd;
+    gint32 fromResume;
+    /* Worked out by the torrent model, rather than fetched. */
+    gint32 seeders;
+    gint32 leechers;
+    gint32 downloads;
+    guint32 fileCount;
+    guint32 flags;
+    guint8 isFinished;
+    guint8 isPrivate;
+    guint8 honorsSessionLimits;
+    guint8 downloadLimited;
+    guint8 uploadLimited;
+    const gchar *name;
+    const gchar *downloadDir;
+    const gchar *errorString;
+    const gchar *hashString;
+    const gchar *comment;
+    const gchar *creator;
+    const gchar *magnetLink;
+    const gchar *trackerHost;
+    const gchar *shortDownloadDir;
+} trg_torrent_record;
+
+/* A torrent from one torrent-get response, as it's decoded on the parse
+ * worker. Only the fields in present were in the response.
+ *
+ * The per-file, per-peer and per-tracker arrays are left as JSON. They're
+ * only fetched for torrents whose details are showing, and only kept
+ * until the next update of the torrent.
+ */
+typedef struct {
+    trg_torrent_record rec;
+    guint64 present;
+    JsonArray *trackerStats;
+    JsonArray *files;
+    JsonArray *wanted;
+    JsonArray *priorities;
+    JsonArray *peers;
+} trg_torrent_update;
+
+/* The arrays kept for a torrent whose details are showing. */
+typedef struct {
+    gint64 id;
+    JsonArray *trackerStats;
+    JsonArray *files;
+    JsonArray *wanted;
+    JsonArray *priorities;
+    JsonArray *peers;
+} trg_torrent_details;
+
+/* Reference counted strings, one copy of each. */
+typedef struct {
+    GHashTable *strings;
+} trg_string_pool;
+
+trg_string_pool *trg_string_pool_new(void);
+void trg_string_pool_free(trg_string_pool * pool);
+const gchar *trg_string_pool_ref(trg_string_pool * pool,
+                                 const gchar * str);
+void trg_string_pool_unref(trg_string_pool * pool, const gchar * str);
+void trg_string_pool_set(trg_string_pool * pool, const gchar ** member,
+                         const gchar * str);
+
+gint torrent_field_lookup(const gchar * name);
+const gchar *torrent_field_name(gint field);
+gboolean torrent_field_is_array(gint field);
+
+void trg_torrent_update_init(trg_torrent_update * update);
+void trg_torrent_update_clear(trg_torrent_update * update);
+void trg_torrent_update_set_int(trg_torrent_update * update, gint field,
+                                gint64 value);
+void trg_torrent_update_set_double(trg_torrent_update * update,
+                                   gint field, gdouble value);
+void trg_torrent_update_set_string(trg_torrent_update * update,
+                                   gint field, const gchar * value);
+void trg_torrent_update_set_array(trg_torrent_update * update,
+                                  gint field, JsonArray * array);
+void trg_torrent_update_set_peerfrom(trg_torrent_update * update,
+                                     const gchar * name, gint64 value);
+void trg_torrent_update_set_member(trg_torrent_update * update,
+                                   const gchar * name, JsonNode * node);
+void trg_torrent_update_from_json(trg_torrent_update * update,
+                                  JsonObject * t);
+
+void trg_torrent_record_init(trg_torrent_record * rec);
+guint64 trg_torrent_record_merge(trg_torrent_record * rec,
+                                 const trg_torrent_update * update,
+                                 trg_string_pool * pool);
+void trg_torrent_record_clear(trg_torrent_record * rec,
+                              trg_string_pool * pool);
+gboolean trg_torrent_record_get_value(const trg_torrent_record * rec,
+                                      const gchar * name, GValue * value);
+
+guint32 trg_torrent_record_get_flags(const trg_torrent_record * rec,
+                                     gint64 rpcv);
+gdouble trg_torrent_record_get_progress(const trg_torrent_record * rec);
+gdouble trg_torrent_record_get_ratio(const trg_torrent_record * rec);
+gchar *trg_torrent_record_get_peer_sources(const trg_torrent_record *
+                                           rec);
+gchar *trg_torrent_record_get_full_dir(const trg_torrent_record * rec,
+                                       const trg_torrent_details *
+                                       details);
+gchar *trg_torrent_record_get_full_path(const trg_torrent_record * rec);
+
+void trg_torrent_details_clear(trg_torrent_details * details);
+
+#endif                          /* TORRENT_RECORD_H_ */
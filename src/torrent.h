@@ -44,64 +44,19 @@
 #define TORRENT_ADD_FLAG_PAUSED        (1 << 0) /* 0x01 */
 #define TORRENT_ADD_FLAG_DELETE        (1 << 1) /* 0x02 */
 
-gint64 torrent_get_total_size(JsonObject * t);
-gint64 torrent_get_size_when_done(JsonObject * t);
-const gchar *torrent_get_name(JsonObject * t);
-gint64 torrent_get_rate_down(JsonObject * t);
-gint64 torrent_get_rate_up(JsonObject * t);
-gint64 torrent_get_eta(JsonObject * t);
-gint64 torrent_get_uploaded(JsonObject * t);
-gint64 torrent_get_corrupted(JsonObject * t);
-gint64 torrent_get_downloaded(JsonObject * t);
-const gchar *torrent_get_errorstr(JsonObject * t);
-gint64 torrent_get_error(JsonObject * t);
-const gchar *torrent_get_download_dir(JsonObject * t);
-const gchar *torrent_get_comment(JsonObject * t);
-gint64 torrent_get_have_unchecked(JsonObject * t);
-gint64 torrent_get_have_valid(JsonObject * t);
-gint64 torrent_get_status(JsonObject * t);
-const gchar *torrent_get_creator(JsonObject * t);
-gint64 torrent_get_date_created(JsonObject * t);
-const gchar *torrent_get_hash(JsonObject * t);
+/* Has files, but how many isn't known until its details are fetched. */
+#define TORRENT_FILE_COUNT_UNKNOWN     G_MAXUINT
+
 gchar *torrent_get_status_string(gint64 rpcv, gint64 value, guint flags);
 gchar *torrent_get_status_icon(gint64 rpcv, guint flags);
-guint32 torrent_get_flags(JsonObject * t, gint64 rpcv, gint64 status,
-                          gint64 fileCount, gint64 downRate,
-                          gint64 upRate);
 JsonArray *torrent_get_peers(JsonObject * t);
-JsonObject *torrent_get_peersfrom(JsonObject * t);
 JsonArray *torrent_get_tracker_stats(JsonObject * t);
 JsonArray *torrent_get_wanted(JsonObject * t);
 JsonArray *torrent_get_priorities(JsonObject * t);
 gint64 torrent_get_id(JsonObject * t);
 JsonArray *torrent_get_files(JsonObject * args);
-gint64 torrent_get_peers_getting_from_us(JsonObject * args);
-gint64 torrent_get_peers_sending_to_us(JsonObject * args);
-gint64 torrent_get_web_seeds_sending_to_us(JsonObject * args);
-gint64 torrent_get_peers_connected(JsonObject * args);
-gdouble torrent_get_percent_done(JsonObject * t);
-gdouble torrent_get_recheck_progress(JsonObject * t);
-gint64 torrent_get_left_until_done(JsonObject * t);
-gboolean torrent_get_is_finished(JsonObject * t);
-gboolean torrent_get_is_private(JsonObject * t);
 gboolean torrent_get_honors_session_limits(JsonObject * t);
-gint64 torrent_get_bandwidth_priority(JsonObject * t);
-gint64 torrent_get_upload_limit(JsonObject * t);
-const gchar *torrent_get_magnetlink(JsonObject * t);
-gint64 torrent_get_added_date(JsonObject * t);
-gint64 torrent_get_done_date(JsonObject * t);
-gboolean torrent_get_upload_limited(JsonObject * t);
-gint64 torrent_get_download_limit(JsonObject * t);
-gboolean torrent_get_download_limited(JsonObject * t);
-gdouble torrent_get_seed_ratio_limit(JsonObject * t);
-gint64 torrent_get_seed_ratio_mode(JsonObject * t);
 gint64 torrent_get_peer_limit(JsonObject * t);
-gboolean torrent_has_tracker(JsonObject * t, GRegex * rx, gchar * search);
-gint64 torrent_get_queue_position(JsonObject * args);
-gint64 torrent_get_activity_date(JsonObject * t);
-gchar *torrent_get_full_dir(JsonObject * obj);
-gchar *torrent_get_full_path(JsonObject * obj);
-gdouble torrent_get_metadata_percent_complete(JsonObject * t);
 
 /* outer response object */
 
@@ -142,11 +97,4 @@ gint64 peer_get_rate_to_peer(JsonObject * p);
 gboolean peer_get_is_uploading_to(JsonObject * p);
 gboolean peer_get_is_downloading_from(JsonObject * p);
 
-gint64 peerfrom_get_pex(JsonObject * pf);
-gint64 peerfrom_get_dht(JsonObject * pf);
-gint64 peerfrom_get_trackers(JsonObject * pf);
-gint64 peerfrom_get_ltep(JsonObject * pf);
-gint64 peerfrom_get_resume(JsonObject * pf);
-gint64 peerfrom_get_incoming(JsonObject * pf);
-gint64 peerfrom_get_lpd(JsonObject * pf);
 #endif                          /* TORRENT_H_ */
@@ -0,0 +1,596 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* Replays torrent-get responses through the parse and model layers, as the
+ * main window would apply them, and reports what each poll cost. Built and
+ * run with "make bench".
+ *
+ * Responses are generated for each of --sizes, or replayed from recorded
+ * files given on the command line (the first as a full update, the rest as
+ * the recently-active updates they're likely to be). The files and peers
+ * models and the state selector need widgets, so they're only included
+ * when there's a display.
+ *
+ * With --mock, or --mock-port for one already running, the polls are made
+ * through TrgClient's dispatch to a mock daemon instead, to measure their
+ * latency end to end.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+#include <json-glib/json-glib.h>
+#ifndef G_OS_WIN32
+#include <sys/resource.h>
+#endif
+
+#include "json.h"
+#include "json-stream.h"
+#include "protocol-constants.h"
+#include "torrent.h"
+#include "trg-client.h"
+#include "trg-prefs.h"
+#include "requests.h"
+#include "trg-mock-daemon.h"
+#include "trg-torrent-model.h"
+#include "trg-files-model.h"
+#include "trg-peers-model.h"
+#include "trg-peers-tree-view.h"
+#include "trg-state-selector.h"
+#include "trg-synthetic.h"
+
+/* Count allocations by wrapping glibc's malloc. Elsewhere they're not
+ * counted. */
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static volatile gint bench_allocs = 0;
+
+void *malloc(size_t size)
+{
+    g_atomic_int_inc(&bench_allocs);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    g_atomic_int_inc(&bench_allocs);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    g_atomic_int_inc(&bench_allocs);
+    return __libc_realloc(ptr, size);
+}
+
+#define BENCH_ALLOCS() g_atomic_int_get(&bench_allocs)
+#else
+#define BENCH_ALLOCS() 0
+#endif
+
+typedef struct {
+    TrgClient *client;
+    gboolean display;
+    TrgTorrentModel *torrentModel;
+    TrgStateSelector *selector;
+    TrgFilesModel *filesModel;
+    GtkWidget *filesTreeView;
+    TrgPeersModel *peersModel;
+    TrgPeersTreeView *peersTreeView;
+
+    /* Driving a mock daemon. */
+    GMainLoop *loop;
+    guint n;
+    guint poll;
+    gint64 sent;
+    gint64 started;
+    gint64 latencyTotal;
+    gint64 latencyMax;
+    gboolean failed;
+} trg_bench;
+
+static gchar *bench_sizes = "100,1000,10000,50000";
+static gint bench_polls = 5;
+static gint bench_files = 1000;
+static gint bench_peers = 50;
+static gdouble bench_churn = 0.1;
+static gboolean bench_full = FALSE;
+static gboolean bench_mock = FALSE;
+static gint bench_mock_port = 0;
+static gint bench_latency = 0;
+
+static GOptionEntry bench_entries[] = {
+    {"sizes", 's', 0, G_OPTION_ARG_STRING, &bench_sizes,
+     "Numbers of torrents to generate, comma separated", "N,..."},
+    {"polls", 'p', 0, G_OPTION_ARG_INT, &bench_polls,
+     "Polls for each size, after the first", "N"},
+    {"files", 'f', 0, G_OPTION_ARG_INT, &bench_files,
+     "Files in the selected torrent", "N"},
+    {"peers", 0, 0, G_OPTION_ARG_INT, &bench_peers,
+     "Peers of the selected torrent", "N"},
+    {"churn", 'c', 0, G_OPTION_ARG_DOUBLE, &bench_churn,
+     "Share of torrents active in each poll", "RATIO"},
+    {"full", 0, 0, G_OPTION_ARG_NONE, &bench_full,
+     "Poll for every torrent, not only the recently active", NULL},
+    {"mock", 'm', 0, G_OPTION_ARG_NONE, &bench_mock,
+     "Poll a mock daemon started for each size", NULL},
+    {"mock-port", 0, 0, G_OPTION_ARG_INT, &bench_mock_port,
+     "Poll a mock daemon already running on this port", "PORT"},
+    {"latency", 'l', 0, G_OPTION_ARG_INT, &bench_latency,
+     "Delay the started mock daemon adds to each response", "MS"},
+    {NULL}
+};
+
+static glong bench_peak_rss(void)
+{
+#ifndef G_OS_WIN32
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+
+static void bench_drain(void)
+{
+    while (g_main_context_iteration(NULL, FALSE));
+}
+
+static void bench_models_new(trg_bench * b)
+{
+    b->torrentModel = trg_torrent_model_new();
+
+    if (b->display) {
+        b->selector = trg_state_selector_new(b->client, b->torrentModel);
+        g_object_ref_sink(b->selector);
+        b->filesModel = trg_files_model_new();
+        b->filesTreeView = g_object_ref_sink(gtk_tree_view_new());
+        b->peersModel = trg_peers_model_new();
+        b->peersTreeView =
+            g_object_ref_sink(trg_peers_tree_view_new
+                              (trg_client_get_prefs(b->client),
+                               b->peersModel, NULL));
+    }
+}
+
+static void bench_models_free(trg_bench * b)
+{
+    if (b->display) {
+        gtk_widget_destroy(GTK_WIDGET(b->selector));
+        g_object_unref(b->selector);
+        gtk_widget_destroy(b->filesTreeView);
+        g_object_unref(b->filesTreeView);
+        g_object_unref(b->filesModel);
+        gtk_widget_destroy(GTK_WIDGET(b->peersTreeView));
+        g_object_unref(b->peersTreeView);
+        g_object_unref(b->peersModel);
+    }
+
+    bench_drain();
+    g_object_unref(b->torrentModel);
+}
+
+/* As much as curl hands over at a time. */
+#define BENCH_PIECE_SIZE 16384
+
+typedef struct {
+    trg_bench *b;
+    trg_response *response;
+    gint64 prepUsec;
+} bench_stream;
+
+static void
+bench_prepare(trg_torrent_update * update, guint64 fingerprint,
+              gpointer data)
+{
+    bench_stream *bs = (bench_stream *) data;
+    gint64 start = g_get_monotonic_time();
+
+    trg_torrent_model_prepare(bs->b->client, bs->response, update,
+                              fingerprint, bs->b->torrentModel);
+    bs->prepUsec += g_get_monotonic_time() - start;
+}
+
+/* Decode a response in pieces, as the client does. With a bench, its
+ * torrents are prepared for the torrent model as they're decoded, and
+ * that's timed apart from the parse. The raw response is taken. */
+static trg_response *bench_parse(trg_bench * b, gchar * raw, gsize size,
+                                 gint64 * usec, gint64 * prepUsec)
+{
+    trg_response *response = g_new0(trg_response, 1);
+    bench_stream bs = { b, response, 0 };
+    trg_json_stream *stream =
+        trg_json_stream_new(b ? bench_prepare : NULL, &bs);
+    GError *error = NULL;
+    gint64 start = g_get_monotonic_time();
+    gsize at;
+
+    for (at = 0; at < size; at += BENCH_PIECE_SIZE)
+        trg_json_stream_feed(stream, raw + at,
+                             MIN(BENCH_PIECE_SIZE, size - at));
+
+    response->obj = trg_json_stream_finish(stream, &error);
+    trg_json_stream_free(stream);
+    g_free(raw);
+
+    *usec = g_get_monotonic_time() - start - bs.prepUsec;
+    if (prepUsec)
+        *prepUsec = bs.prepUsec;
+
+    if (error) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        trg_response_free(response);
+        return NULL;
+    }
+
+    return response;
+}
+
+static void bench_header(void)
+{
+    g_print("%8s %5s %10s %9s %9s %9s %9s %10s %10s\n", "torrents",
+            "poll", "bytes", "parse ms", "prep ms", "apply ms",
+            "detail ms", "allocs", "peak KiB");
+}
+
+/* Apply one torrent-get, and a detailed one for the selected torrent when
+ * there's a display, timing each step. A negative mode is taken from the
+ * response. */
+static void
+bench_poll(trg_bench * b, guint n, guint poll, gint mode, gchar * raw,
+           gsize size, gchar * detailRaw, gsize detailSize)
+{
+    trg_torrent_model_update_stats *stats;
+    trg_response *response;
+    gint64 parseUsec, prepUsec, applyUsec, detailUsec = 0, start;
+    gint allocs = BENCH_ALLOCS();
+
+    response = bench_parse(b, raw, size, &parseUsec, &prepUsec);
+    if (!response) {
+        g_free(detailRaw);
+        return;
+    }
+
+    /* Recorded responses were recently-active ones if they list removals. */
+    if (mode < 0)
+        mode = json_object_has_member(get_arguments(response->obj),
+                                      FIELD_REMOVED) ?
+            TORRENT_GET_MODE_ACTIVE : TORRENT_GET_MODE_UPDATE;
+
+    start = g_get_monotonic_time();
+    stats = trg_torrent_model_update(b->torrentModel, b->client,
+                                     response->obj, response->prepared,
+                                     mode);
+    if (b->selector)
+        trg_state_selector_stats_update(b->selector, stats);
+    applyUsec = g_get_monotonic_time() - start;
+
+    trg_response_free(response);
+
+    if (detailRaw && b->display) {
+        gint64 detailParse;
+
+        response = bench_parse(NULL, detailRaw, detailSize, &detailParse,
+                               NULL);
+        if (response) {
+            JsonArray *torrents = get_torrents(get_arguments(response->obj));
+            JsonObject *t = json_array_get_object_element(torrents, 0);
+            gint64 serial = trg_client_get_serial(b->client);
+            trg_torrent_details details = {
+                torrent_get_id(t), torrent_get_tracker_stats(t),
+                torrent_get_files(t), torrent_get_wanted(t),
+                torrent_get_priorities(t), torrent_get_peers(t)
+            };
+
+            start = g_get_monotonic_time();
+            trg_files_model_update(b->filesModel,
+                                   GTK_TREE_VIEW(b->filesTreeView),
+                                   serial, &details, mode);
+            trg_peers_model_update(b->peersModel,
+                                   TRG_TREE_VIEW(b->peersTreeView),
+                                   serial, &details, mode);
+            /* The first files update builds its tree on a worker. */
+            bench_drain();
+            detailUsec = detailParse + g_get_monotonic_time() - start;
+
+            trg_response_free(response);
+        }
+    } else {
+        g_free(detailRaw);
+    }
+
+    trg_client_inc_serial(b->client);
+
+    g_print("%8u %5u %10" G_GSIZE_FORMAT " %9.2f %9.2f %9.2f %9.2f %10d "
+            "%10ld\n", n, poll, size, parseUsec / 1000.0,
+            prepUsec / 1000.0, applyUsec / 1000.0, detailUsec / 1000.0,
+            BENCH_ALLOCS() - allocs, bench_peak_rss());
+}
+
+static gint bench_poll_tag(guint poll)
+{
+    return poll == 0 || bench_full ? TORRENT_GET_TAG_MODE_FULL :
+        TORRENT_GET_TAG_MODE_UPDATE;
+}
+
+/* As the main window applies them: recently-active polls with their list
+ * of removed IDs, and full polls finding the removed torrents itself. */
+static gint bench_poll_mode(guint poll)
+{
+    return poll == 0 ? TORRENT_GET_MODE_FIRST :
+        bench_full ? TORRENT_GET_MODE_UPDATE : TORRENT_GET_MODE_ACTIVE;
+}
+
+static void bench_synthetic(trg_bench * b, guint n)
+{
+    trg_synthetic_session s;
+    guint poll;
+
+    s.torrents = n;
+    s.files = bench_files;
+    s.peers = bench_peers;
+    s.churn = bench_churn;
+
+    bench_models_new(b);
+
+    for (poll = 0; poll <= (guint) bench_polls; poll++) {
+        gint mode = bench_poll_mode(poll);
+        GString *body =
+            trg_synthetic_torrent_get(&s, poll, bench_poll_tag(poll));
+        GString *detail = trg_synthetic_torrent_get(&s, poll, 0);
+        gsize size = body->len, detailSize = detail->len;
+
+        bench_poll(b, n, poll, mode, g_string_free(body, FALSE), size,
+                   g_string_free(detail, FALSE), detailSize);
+    }
+
+    bench_models_free(b);
+}
+
+static void bench_mock_header(void)
+{
+    g_print("%8s %5s %10s %9s %10s %10s\n", "torrents", "poll",
+            "rtt ms", "apply ms", "allocs", "peak KiB");
+}
+
+static gboolean on_mock_torrent_get(gpointer data);
+
+/* One poll at a time, the next sent as the last is applied, as the main
+ * window does. */
+static void bench_mock_send(trg_bench * b)
+{
+    b->sent = g_get_monotonic_time();
+    dispatch_async_prepared(b->client,
+                            torrent_get_fields(bench_poll_tag(b->poll),
+                                               TORRENT_GET_FIELDS_ALL),
+                            trg_torrent_model_prepare, b->torrentModel,
+                            on_mock_torrent_get, b);
+}
+
+static gboolean on_mock_torrent_get(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    trg_bench *b = (trg_bench *) response->cb_data;
+    gint64 rtt = g_get_monotonic_time() - b->sent, start;
+    gint allocs = BENCH_ALLOCS();
+    trg_torrent_model_update_stats *stats;
+
+    if (response->status != CURLE_OK) {
+        g_printerr("torrent-get failed with status %d\n", response->status);
+        b->failed = TRUE;
+        trg_response_free(response);
+        g_main_loop_quit(b->loop);
+        return FALSE;
+    }
+
+    start = g_get_monotonic_time();
+    stats = trg_torrent_model_update(b->torrentModel, b->client,
+                                     response->obj, response->prepared,
+                                     bench_poll_mode(b->poll));
+    if (b->selector)
+        trg_state_selector_stats_update(b->selector, stats);
+    trg_response_free(response);
+
+    g_print("%8u %5u %10.2f %9.2f %10d %10ld\n", b->n, b->poll,
+            rtt / 1000.0, (g_get_monotonic_time() - start) / 1000.0,
+            BENCH_ALLOCS() - allocs, bench_peak_rss());
+
+    b->latencyTotal += rtt;
+    b->latencyMax = MAX(b->latencyMax, rtt);
+
+    if (b->poll++ < (guint) bench_polls)
+        bench_mock_send(b);
+    else
+        g_main_loop_quit(b->loop);
+
+    return FALSE;
+}
+
+static void bench_connect(trg_bench * b, guint16 port)
+{
+    TrgPrefs *prefs = trg_client_get_prefs(b->client);
+    JsonObject *profile = trg_prefs_new_profile(prefs);
+
+    /* A profile of its own, which is never saved. */
+    trg_prefs_set_profile(prefs, profile);
+    trg_prefs_set_string(prefs, TRG_PREFS_KEY_HOSTNAME, "127.0.0.1",
+                         TRG_PREFS_PROFILE);
+    trg_prefs_set_int(prefs, TRG_PREFS_KEY_PORT, port, TRG_PREFS_PROFILE);
+    trg_prefs_set_bool(prefs, TRG_PREFS_KEY_SSL, FALSE, TRG_PREFS_PROFILE);
+    trg_client_populate_with_settings(b->client);
+}
+
+static void bench_mock_run(trg_bench * b, guint n)
+{
+    TrgMockDaemon *daemon = NULL;
+    gint64 elapsed;
+
+    if (bench_mock_port == 0) {
+        trg_synthetic_session s;
+        GError *error = NULL;
+
+        s.torrents = n;
+        s.files = bench_files;
+        s.peers = bench_peers;
+        s.churn = bench_churn;
+
+        daemon = trg_mock_daemon_new(&s, 0, bench_latency, &error);
+        if (!daemon) {
+            g_printerr("%s\n", error->message);
+            g_error_free(error);
+            b->failed = TRUE;
+            return;
+        }
+
+        bench_connect(b, trg_mock_daemon_get_port(daemon));
+    }
+
+    bench_models_new(b);
+
+    b->n = n;
+    b->poll = 0;
+    b->latencyTotal = b->latencyMax = 0;
+    b->started = g_get_monotonic_time();
+
+    bench_mock_send(b);
+    g_main_loop_run(b->loop);
+
+    elapsed = g_get_monotonic_time() - b->started;
+
+    if (!b->failed && b->poll > 0)
+        g_print("%8u polls in %.2f s, %.1f/s, rtt mean %.2f ms, "
+                "max %.2f ms\n", b->poll, elapsed / 1000000.0,
+                b->poll / (elapsed / 1000000.0),
+                b->latencyTotal / 1000.0 / b->poll,
+                b->latencyMax / 1000.0);
+
+    bench_models_free(b);
+
+    if (daemon) {
+        /* Including the session id handshake. */
+        g_print("%8u requests reached the daemon\n",
+                trg_mock_daemon_get_requests(daemon));
+        trg_mock_daemon_free(daemon);
+    }
+}
+
+static void bench_recorded(trg_bench * b, gchar ** files)
+{
+    guint i;
+
+    bench_models_new(b);
+
+    for (i = 0; files[i]; i++) {
+        GError *error = NULL;
+        gchar *raw;
+        gsize size;
+
+        if (!g_file_get_contents(files[i], &raw, &size, &error)) {
+            g_printerr("%s\n", error->message);
+            g_error_free(error);
+            continue;
+        }
+
+        bench_poll(b, 0, i, i == 0 ? TORRENT_GET_MODE_FIRST : -1, raw,
+                   size, NULL, 0);
+    }
+
+    bench_models_free(b);
+}
+
+int main(int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError *error = NULL;
+    trg_bench b;
+    trg_response *session;
+    gchar *sessionRaw;
+    gint64 usec;
+
+    memset(&b, 0, sizeof(trg_bench));
+
+    context = g_option_context_new("[RECORDED-RESPONSE...]");
+    g_option_context_add_main_entries(context, bench_entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        g_printerr("%s\n", error->message);
+        return EXIT_FAILURE;
+    }
+    g_option_context_free(context);
+
+    b.display = gtk_init_check(&argc, &argv);
+    if (!b.display)
+        g_printerr("No display, so only the torrent model is measured.\n");
+
+    b.client = trg_client_new();
+
+    sessionRaw = trg_synthetic_session_get();
+    session = bench_parse(NULL, sessionRaw, strlen(sessionRaw), &usec, NULL);
+    trg_client_set_session(b.client, get_arguments(session->obj));
+
+    if (bench_mock || bench_mock_port > 0) {
+        gchar **sizes = g_strsplit(bench_sizes, ",", -1);
+        guint i;
+
+        b.loop = g_main_loop_new(NULL, FALSE);
+
+        if (bench_mock_port > 0)
+            bench_connect(&b, (guint16) bench_mock_port);
+
+        bench_mock_header();
+
+        /* A running daemon has its own number of torrents. */
+        for (i = 0; sizes[i] && !b.failed; i++)
+            bench_mock_run(&b, bench_mock_port > 0 ? 0 : (guint) atoi(sizes[i]));
+
+        g_strfreev(sizes);
+        g_main_loop_unref(b.loop);
+        trg_response_free(session);
+
+        return b.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    bench_header();
+
+    if (argc > 1) {
+        bench_recorded(&b, &argv[1]);
+    } else {
+        gchar **sizes = g_strsplit(bench_sizes, ",", -1);
+        guint i;
+
+        for (i = 0; sizes[i]; i++)
+            bench_synthetic(&b, (guint) atoi(sizes[i]));
+
+        g_strfreev(sizes);
+    }
+
+    trg_response_free(session);
+
+    return EXIT_SUCCESS;
+}
@@ -27,6 +27,7 @@
 #include <glib.h>
 #include <glib/gprintf.h>
 #include <glib/gi18n.h>
+#include <gio/gio.h>
 
 #ifdef HAVE_LIBPROXY
 #include <proxy.h>
@@ -36,17 +37,19 @@
 #include <curl/easy.h>
 
 #include "json.h"
+#include "json-stream.h"
 #include "trg-prefs.h"
 #include "protocol-constants.h"
 #include "util.h"
 #include "requests.h"
+#include "trg-metrics.h"
 #include "trg-client.h"
 
 /* This class manages/does quite a few things, and is passed around a lot. It:
  *
  * 1) Holds/inits the single TrgPrefs object for managing configuration.
- * 2) Manages a thread pool for making requests
- *    (each thread has its own CURL client in thread local storage)
+ * 2) Makes requests on a curl multi handle run from the main loop
+ *    (responses are parsed on a worker thread)
  * 3) Holds current connection details needed by CURL clients.
  *    (session ID, username, password, URL, ssl, proxy)
  * 4) Holds a hash table for looking up a torrent by its ID.
@@ -55,6 +58,7 @@
  *    connect/disconnect.
  * 7) Provides a mutex for locking updates.
  * 8) Holds the latest session object sent in a session-get response.
+ * 9) Times each request, for the diagnostics dialog.
  */
 
 G_DEFINE_TYPE(TrgClient, trg_client, G_TYPE_OBJECT)
@@ -74,24 +78,31 @@ struct _TrgClientPrivate {
     JsonObject *session;
     gboolean ssl;
     gboolean ssl_validate;
+    gboolean compressRequests;
     gdouble version;
     char *url;
     char *username;
     char *password;
     char *proxy;
-    GHashTable *torrentTable;
-    GThreadPool *pool;
+    GObject *torrentModel;
+    CURLM *multi;
+    CURLSH *share;
+    GQueue *idleHandles;
+    GQueue *pending;
+    GHashTable *inFlight;
+    guint flushSource;
+    guint timerSource;
+    GThreadPool *parsePool;
+    TrgMetrics *metrics;
     TrgPrefs *prefs;
-    GPrivate tlsKey;
-    gint configSerial;
-    guint http_class;
     GMutex configMutex;
     gboolean seedRatioLimited;
     gdouble seedRatioLimit;
 };
 
-static void dispatch_async_threadfunc(trg_request * reqrsp,
-                                      TrgClient * tc);
+static void trg_client_init_multi(TrgClient * tc);
+static void trg_client_schedule_flush(TrgClient * tc);
+static void dispatch_parse_threadfunc(gpointer data, gpointer user_data);
 
 static void
 trg_client_get_property(GObject * object, guint property_id,
@@ -160,12 +171,16 @@ TrgClient *trg_client_new(void)
     trg_prefs_load(prefs);
 
     g_mutex_init(&priv->configMutex);
-    //priv->tlsKey = g_private_new(NULL);
     priv->seedRatioLimited = FALSE;
     priv->seedRatioLimit = 0.00;
 
-    priv->pool = g_thread_pool_new((GFunc) dispatch_async_threadfunc, tc,
-                                   DISPATCH_POOL_SIZE, TRUE, NULL);
+    trg_client_init_multi(tc);
+    priv->metrics = trg_metrics_new();
+
+    /* One thread, so responses are still handed back in order, and the
+     * pieces of each are decoded in order. */
+    priv->parsePool =
+        g_thread_pool_new(dispatch_parse_threadfunc, tc, 1, TRUE, NULL);
 
     tr_formatter_size_init(disk_K, _(disk_K_str), _(disk_M_str),
                            _(disk_G_str), _(disk_T_str));
@@ -276,6 +291,10 @@ int trg_client_populate_with_settings(TrgClient * tc)
     priv->username = trg_prefs_get_string(prefs, TRG_PREFS_KEY_USERNAME,
                                           TRG_PREFS_CONNECTION);
 
+    priv->compressRequests =
+        trg_prefs_get_bool(prefs, TRG_PREFS_KEY_COMPRESS_REQUESTS,
+                           TRG_PREFS_CONNECTION);
+
     priv->password = trg_prefs_get_string(prefs, TRG_PREFS_KEY_PASSWORD,
                                           TRG_PREFS_CONNECTION);
 
@@ -302,7 +321,6 @@ int trg_client_populate_with_settings(TrgClient * tc)
     }
 #endif
 
-    priv->configSerial++;
     g_mutex_unlock(&priv->configMutex);
     return 0;
 }
@@ -362,12 +380,6 @@ JsonObject *trg_client_get_session(TrgClient * tc)
     return tc->priv->session;
 }
 
-void
-trg_client_thread_pool_push(TrgClient * tc, gpointer data, GError ** err)
-{
-    g_thread_pool_push(tc->priv->pool, data, err);
-}
-
 void trg_client_inc_serial(TrgClient * tc)
 {
     TrgClientPrivate *priv = tc->priv;
@@ -396,16 +408,17 @@ gchar *trg_client_get_proxy(TrgClient * tc)
     return tc->priv->proxy;
 }
 
-void trg_client_set_torrent_table(TrgClient * tc, GHashTable * table)
+void trg_client_set_torrent_model(TrgClient * tc, GObject * model)
 {
     TrgClientPrivate *priv = tc->priv;
-    priv->torrentTable = table;
+    priv->torrentModel = model;
 }
 
-GHashTable *trg_client_get_torrent_table(TrgClient * tc)
+/* The TrgTorrentModel, for the records of torrents by ID. */
+GObject *trg_client_get_torrent_model(TrgClient * tc)
 {
     TrgClientPrivate *priv = tc->priv;
-    return priv->torrentTable;
+    return priv->torrentModel;
 }
 
 gboolean trg_client_is_connected(TrgClient * tc)
@@ -451,26 +464,13 @@ void trg_response_free(trg_response * response)
 		if (response->raw)
 			g_free(response->raw);
 
+		if (response->prepared && response->prepared_free)
+			response->prepared_free(response->prepared);
+
 		g_free(response);
 	}
 }
 
-static size_t
-http_receive_callback(void *ptr, size_t size, size_t nmemb, void *data)
-{
-    size_t realsize = size * nmemb;
-    trg_response *mem = (trg_response *) data;
-
-    mem->raw = g_realloc(mem->raw, mem->size + realsize + 1);
-    if (mem->raw) {
-        memcpy(&(mem->raw[mem->size]), ptr, realsize);
-        mem->size += realsize;
-        mem->raw[mem->size] = 0;
-    }
-
-    return realsize;
-}
-
 static size_t
 header_callback(void *ptr, size_t size, size_t nmemb, void *data)
 {
@@ -493,252 +493,1156 @@ header_callback(void *ptr, size_t size, size_t nmemb, void *data)
     return (nmemb * size);
 }
 
-static trg_tls *trg_tls_new(TrgClient * tc)
-{
-    trg_tls *tls = g_new0(trg_tls, 1);
+/* Requests are made on a single curl multi handle, driven from the GLib main
+ * loop. Its easy handles share one connection cache, DNS and TLS sessions,
+ * and multiplex over HTTP/2 where the server (or a proxy in front of the
+ * daemon) offers it. Only decoding the JSON is handed to a worker, which is
+ * given each piece of a response as it arrives.
+ */
 
-    tls->curl = curl_easy_init();
-    tls->serial = -1;
+typedef struct {
+    TrgClient *tc;
+    trg_request *req;
+    trg_response *rsp;
+    CURL *curl;
+    struct curl_slist *headers;
+    guint http_class;
+    gboolean retried;
+    gchar *key;
+    gboolean batch;
+    gsize sent;                 /* of a body with a payload */
+    GConverter *compressor;     /* if the body is sent gzipped */
+    gchar *staged;              /* body read, but not yet compressed */
+    gsize stagedLen;
+    gsize stagedAt;
+    gboolean compressed;        /* all of it */
+    gint64 queued;
+    gint64 parsed;
+    trg_metrics_sample sample;
+    trg_json_stream *stream;    /* fed the body on the parse worker */
+    gint64 decodeUsec;          /* spent on the parse worker */
+    gint64 prepareUsec;
+} trg_transfer;
+
+/* Work for the parse worker, which takes it in the order it was pushed: the
+ * pieces of a Transmission response as they arrive, then the transfer once
+ * it's done. */
+typedef struct {
+    trg_transfer *transfer;
+    GBytes *piece;              /* or NULL when it's done */
+} trg_parse_job;
+
+/* Handed to the main loop with a response, to time its callback. */
+typedef struct {
+    TrgClient *tc;
+    GSourceFunc callback;
+    trg_response *response;
+    gint64 parsed;
+    trg_metrics_sample sample;
+} trg_dispatched;
+
+static void trg_transfer_push_parse(trg_transfer * transfer, GBytes * piece)
+{
+    trg_parse_job *job = g_new(trg_parse_job, 1);
 
-    return tls;
+    job->transfer = transfer;
+    job->piece = piece;
+    g_thread_pool_push(transfer->tc->priv->parsePool, job, NULL);
 }
 
-static trg_tls *get_tls(TrgClient *tc) {
-	TrgClientPrivate *priv = tc->priv;
-	gpointer threadLocalStorage = g_private_get(&priv->tlsKey);
-	trg_tls *tls;
-
-    if (!threadLocalStorage) {
-        tls = trg_tls_new(tc);
-        g_private_set(&priv->tlsKey, tls);
-    } else {
-        tls = (trg_tls *) threadLocalStorage;
-    }
+/* Runs on the parse worker, as the stream decodes each torrent. */
+static void
+trg_transfer_prepare_torrent(trg_torrent_update * update,
+                             guint64 fingerprint, gpointer data)
+{
+    trg_transfer *transfer = (trg_transfer *) data;
+    trg_request *req = transfer->req;
+    gint64 start = g_get_monotonic_time();
 
-    return tls;
+    req->prepare(transfer->tc, transfer->rsp, update, fingerprint,
+                 req->prepare_data);
+    transfer->prepareUsec += g_get_monotonic_time() - start;
 }
 
-static CURL* get_curl(TrgClient *tc, guint http_class)
+static size_t
+http_receive_callback(void *ptr, size_t size, size_t nmemb, void *data)
 {
-	TrgClientPrivate *priv = tc->priv;
-	TrgPrefs *prefs = trg_client_get_prefs(tc);
-	trg_tls *tls = get_tls(tc);
-	CURL *curl = tls->curl;
-
-    g_mutex_lock(&priv->configMutex);
+    size_t realsize = size * nmemb;
+    trg_transfer *transfer = (trg_transfer *) data;
+    trg_response *mem = transfer->rsp;
+    gsize needed;
 
-    if (priv->configSerial > tls->serial || http_class != priv->http_class) {
-    	gchar *proxy;
+    /* A successful Transmission response isn't buffered, each piece is
+     * decoded on the parse worker while the rest is still arriving. The
+     * body of anything else (a 409 with the session ID) isn't wanted. */
+    if (transfer->http_class == HTTP_CLASS_TRANSMISSION) {
+        long httpCode = 0;
 
-        curl_easy_reset(curl);
+        curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE,
+                          &httpCode);
 
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, PACKAGE_NAME);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
-                         &http_receive_callback);
+        if (httpCode == HTTP_OK) {
 #ifdef DEBUG
-        if (g_getenv("TRG_CURL_VERBOSE") != NULL)
-        	curl_easy_setopt(curl, CURLOPT_VERBOSE, 1);
+            if (g_getenv("TRG_SHOW_INCOMING") != NULL)
+                g_debug("<=(INcoming)<=: %.*s", (int) realsize,
+                        (const gchar *) ptr);
 #endif
+            if (!transfer->stream)
+                transfer->stream =
+                    trg_json_stream_new(transfer->req->prepare ?
+                                        trg_transfer_prepare_torrent :
+                                        NULL, transfer);
 
-        if (http_class == HTTP_CLASS_TRANSMISSION) {
-        	curl_easy_setopt(curl, CURLOPT_WRITEHEADER, (void *) tc);
-        	curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
-        	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &header_callback);
-            curl_easy_setopt(curl, CURLOPT_PASSWORD,
-                             trg_client_get_password(tc));
-            curl_easy_setopt(curl, CURLOPT_USERNAME,
-                             trg_client_get_username(tc));
-            curl_easy_setopt(curl, CURLOPT_URL, trg_client_get_url(tc));
+            trg_transfer_push_parse(transfer, g_bytes_new(ptr, realsize));
         }
 
-    #ifndef CURL_NO_SSL
-        if (trg_client_get_ssl(tc) && !trg_client_get_ssl_validate(tc)) {
+        return realsize;
+    }
 
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
-        }
-    #endif
+    needed = mem->size + realsize + 1;
+
+    /* Grow the buffer geometrically rather than by each chunk, so a large
+     * response costs a handful of reallocs and copies instead of one for
+     * every few kilobytes curl hands us. */
+    if (needed > mem->capacity) {
+        gsize capacity = MAX(mem->capacity, HTTP_RECEIVE_INITIAL_SIZE);
+
+        while (capacity < needed)
+            capacity *= 2;
+
+        mem->raw = g_realloc(mem->raw, capacity);
+        mem->capacity = capacity;
+    }
+
+    memcpy(&(mem->raw[mem->size]), ptr, realsize);
+    mem->size += realsize;
+    mem->raw[mem->size] = 0;
 
-        proxy = trg_client_get_proxy(tc);
-        if (proxy) {
-            curl_easy_setopt(curl, CURLOPT_PROXYTYPE, CURLPROXY_HTTP);
-            curl_easy_setopt(curl, CURLOPT_PROXY, proxy);
+    return realsize;
+}
+
+typedef struct {
+    TrgClient *tc;
+    curl_socket_t fd;
+    int what;
+    guint source;
+} trg_socket;
+
+static void trg_client_check_multi_info(TrgClient * tc);
+
+static gboolean
+trg_client_socket_event(GIOChannel * channel G_GNUC_UNUSED,
+                        GIOCondition cond, gpointer data)
+{
+    trg_socket *sock = (trg_socket *) data;
+    TrgClient *tc = sock->tc;
+    int action = 0;
+    int running;
+
+    if (cond & (G_IO_IN | G_IO_HUP))
+        action |= CURL_CSELECT_IN;
+    if (cond & G_IO_OUT)
+        action |= CURL_CSELECT_OUT;
+    if (cond & G_IO_ERR)
+        action |= CURL_CSELECT_ERR;
+
+    /* This may remove the watch and free sock, so don't use it after. */
+    curl_multi_socket_action(tc->priv->multi, sock->fd, action, &running);
+    trg_client_check_multi_info(tc);
+
+    return TRUE;
+}
+
+static int
+trg_client_socket_cb(CURL * easy G_GNUC_UNUSED, curl_socket_t s, int what,
+                     void *userp, void *socketp)
+{
+    TrgClient *tc = TRG_CLIENT(userp);
+    trg_socket *sock = (trg_socket *) socketp;
+    GIOCondition cond = 0;
+    GIOChannel *channel;
+
+    if (what == CURL_POLL_REMOVE) {
+        if (sock) {
+            g_source_remove(sock->source);
+            g_free(sock);
         }
+        return 0;
+    }
 
-        tls->serial = priv->configSerial;
-        priv->http_class = http_class;
+    if (!sock) {
+        sock = g_new0(trg_socket, 1);
+        sock->tc = tc;
+        sock->fd = s;
+        curl_multi_assign(tc->priv->multi, s, sock);
+    } else if (sock->what == what) {
+        return 0;
+    } else {
+        g_source_remove(sock->source);
     }
 
-    if (http_class == HTTP_CLASS_TRANSMISSION)
-    	curl_easy_setopt(curl, CURLOPT_URL, trg_client_get_url(tc));
+    if (what & CURL_POLL_IN)
+        cond |= G_IO_IN | G_IO_HUP | G_IO_ERR;
+    if (what & CURL_POLL_OUT)
+        cond |= G_IO_OUT | G_IO_ERR;
 
-	curl_easy_setopt(curl, CURLOPT_TIMEOUT,
-					 (long) trg_prefs_get_int(prefs, TRG_PREFS_KEY_TIMEOUT,
-											  TRG_PREFS_CONNECTION));
+#ifdef WIN32
+    channel = g_io_channel_win32_new_socket(s);
+#else
+    channel = g_io_channel_unix_new(s);
+#endif
+    sock->what = what;
+    sock->source = g_io_add_watch(channel, cond, trg_client_socket_event,
+                                  sock);
+    g_io_channel_unref(channel);
 
-    g_mutex_unlock(&priv->configMutex);
+    return 0;
+}
 
-    /* Headers are set on each use, then freed, so make sure invalid headers aren't still around. */
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, NULL);
+static gboolean trg_client_timeout(gpointer data)
+{
+    TrgClient *tc = TRG_CLIENT(data);
+    int running;
 
-    return curl;
+    tc->priv->timerSource = 0;
+    curl_multi_socket_action(tc->priv->multi, CURL_SOCKET_TIMEOUT, 0,
+                             &running);
+    trg_client_check_multi_info(tc);
 
+    return FALSE;
 }
 
-static inline int
-trg_http_perform_inner(TrgClient * tc, trg_request * request,
-                       trg_response * response, gboolean recurse)
+static int
+trg_client_timer_cb(CURLM * multi G_GNUC_UNUSED, long timeout_ms,
+                    void *userp)
 {
-    CURL* curl = get_curl(tc, HTTP_CLASS_TRANSMISSION);
-	struct curl_slist *headers = NULL;
-	gchar *session_id = NULL;
-    long httpCode = 0;
+    TrgClient *tc = TRG_CLIENT(userp);
+    TrgClientPrivate *priv = tc->priv;
 
-    response->size = 0;
-    response->raw = NULL;
+    if (priv->timerSource) {
+        g_source_remove(priv->timerSource);
+        priv->timerSource = 0;
+    }
 
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->body);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *) response);
+    /* Even a zero timeout goes through the main loop, curl doesn't want
+     * to be called back into from here. */
+    if (timeout_ms >= 0)
+        priv->timerSource = g_timeout_add(timeout_ms, trg_client_timeout,
+                                          tc);
 
-	session_id = trg_client_get_session_id(tc);
-	if (session_id)
-		headers = curl_slist_append(NULL, session_id);
+    return 0;
+}
 
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+static void trg_client_init_multi(TrgClient * tc)
+{
+    TrgClientPrivate *priv = tc->priv;
 
-    response->status = curl_easy_perform(curl);
+    priv->share = curl_share_init();
+    curl_share_setopt(priv->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(priv->share, CURLSHOPT_SHARE,
+                      CURL_LOCK_DATA_SSL_SESSION);
+
+    priv->multi = curl_multi_init();
+    curl_multi_setopt(priv->multi, CURLMOPT_SOCKETFUNCTION,
+                      trg_client_socket_cb);
+    curl_multi_setopt(priv->multi, CURLMOPT_SOCKETDATA, tc);
+    curl_multi_setopt(priv->multi, CURLMOPT_TIMERFUNCTION,
+                      trg_client_timer_cb);
+    curl_multi_setopt(priv->multi, CURLMOPT_TIMERDATA, tc);
+    curl_multi_setopt(priv->multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                      (long) DISPATCH_MAX_HOST_CONNECTIONS);
+#if LIBCURL_VERSION_NUM >= 0x072b00
+    curl_multi_setopt(priv->multi, CURLMOPT_PIPELINING,
+                      (long) CURLPIPE_MULTIPLEX);
+#endif
 
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    priv->idleHandles = g_queue_new();
+    priv->pending = g_queue_new();
+    priv->inFlight = g_hash_table_new(g_str_hash, g_str_equal);
+}
 
-    g_free(session_id);
+static CURL *get_curl(TrgClient * tc, guint http_class)
+{
+    TrgClientPrivate *priv = tc->priv;
+    TrgPrefs *prefs = trg_client_get_prefs(tc);
+    CURL *curl = g_queue_pop_head(priv->idleHandles);
+    gchar *proxy;
 
-    if (headers)
-    	curl_slist_free_all(headers);
+    if (curl)
+        curl_easy_reset(curl);
+    else
+        curl = curl_easy_init();
 
-    if (response->status == CURLE_OK) {
-        if (httpCode == HTTP_CONFLICT && recurse == TRUE)
-            return trg_http_perform_inner(tc, request, response, FALSE);
-        else if (httpCode != HTTP_OK)
-            response->status = (-httpCode) - 100;
+    g_mutex_lock(&priv->configMutex);
+
+    curl_easy_setopt(curl, CURLOPT_SHARE, priv->share);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, PACKAGE_NAME);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &http_receive_callback);
+    /* Offer every encoding curl was built with. A proxy in front of the
+     * daemon can compress torrent-get responses several times over, and
+     * curl decodes them as they arrive, into the buffer that's parsed. */
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION,
+                     (long) CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+#endif
+#ifdef DEBUG
+    if (g_getenv("TRG_CURL_VERBOSE") != NULL)
+        curl_easy_setopt(curl, CURLOPT_VERBOSE, 1);
+#endif
+
+    if (http_class == HTTP_CLASS_TRANSMISSION) {
+        curl_easy_setopt(curl, CURLOPT_WRITEHEADER, (void *) tc);
+        curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &header_callback);
+        curl_easy_setopt(curl, CURLOPT_PASSWORD,
+                         trg_client_get_password(tc));
+        curl_easy_setopt(curl, CURLOPT_USERNAME,
+                         trg_client_get_username(tc));
+        curl_easy_setopt(curl, CURLOPT_URL, trg_client_get_url(tc));
+    }
+
+#ifndef CURL_NO_SSL
+    if (trg_client_get_ssl(tc) && !trg_client_get_ssl_validate(tc)) {
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
     }
+#endif
+
+    proxy = trg_client_get_proxy(tc);
+    if (proxy) {
+        curl_easy_setopt(curl, CURLOPT_PROXYTYPE, CURLPROXY_HTTP);
+        curl_easy_setopt(curl, CURLOPT_PROXY, proxy);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT,
+                     (long) trg_prefs_get_int(prefs, TRG_PREFS_KEY_TIMEOUT,
+                                              TRG_PREFS_CONNECTION));
+
+    g_mutex_unlock(&priv->configMutex);
 
-    return response->status;
+    return curl;
 }
 
-int trg_http_perform(TrgClient * tc, trg_request *request, trg_response * rsp)
+static void release_curl(TrgClient * tc, CURL * curl)
 {
-    return trg_http_perform_inner(tc, request, rsp, TRUE);
+    TrgClientPrivate *priv = tc->priv;
+
+    if (g_queue_get_length(priv->idleHandles) < DISPATCH_IDLE_HANDLES)
+        g_queue_push_head(priv->idleHandles, curl);
+    else
+        curl_easy_cleanup(curl);
+}
+
+/* (Re)set the headers, which for Transmission include the session ID. */
+static void trg_transfer_set_headers(trg_transfer * transfer)
+{
+    trg_request *req = transfer->req;
+
+    if (transfer->headers) {
+        curl_slist_free_all(transfer->headers);
+        transfer->headers = NULL;
+    }
+
+    if (transfer->http_class == HTTP_CLASS_TRANSMISSION) {
+        gchar *session_id = trg_client_get_session_id(transfer->tc);
+
+        if (session_id)
+            transfer->headers = curl_slist_append(NULL, session_id);
+
+        /* Don't wait for a 100 Continue before sending a large body. */
+        if (req->payload || transfer->compressor)
+            transfer->headers =
+                curl_slist_append(transfer->headers, "Expect:");
+
+        if (transfer->compressor)
+            transfer->headers =
+                curl_slist_append(transfer->headers,
+                                  "Content-Encoding: gzip");
+
+        g_free(session_id);
+    } else if (req->cookie) {
+        gchar *cookie_header = g_strdup_printf("Cookie: %s", req->cookie);
+        transfer->headers = curl_slist_append(NULL, cookie_header);
+        g_free(cookie_header);
+    }
+
+    curl_easy_setopt(transfer->curl, CURLOPT_HTTPHEADER,
+                     transfer->headers);
 }
 
 static void trg_request_free(trg_request *req) {
 	g_free(req->body);
 	g_free(req->url);
 	g_free(req->cookie);
+	g_free(req->payload_member);
+
+	if (req->payload)
+		g_bytes_unref(req->payload);
 
 	if (req->node)
 		json_node_free(req->node);
 }
 
-/* formerly dispatch.c */
+/* A request with a payload is sent from its body serialized with the payload
+ * member empty, and the payload is base64 encoded into curl's buffer between
+ * the quotes as they're reached. Only whole groups of three bytes are encoded
+ * until the end, so that no state needs to be carried between calls.
+ */
+#define BASE64_ENCODED_LENGTH(n) ((((n) + 2) / 3) * 4)
+
+static void trg_request_serialize_payload(trg_request * req)
+{
+    JsonObject *args = node_get_arguments(req->node);
+    gchar *placeholder = g_strdup_printf("trg-payload-%p", (void *) req);
+    gsize len = strlen(placeholder);
+    gchar *at;
+
+    json_object_set_string_member(args, req->payload_member, placeholder);
+    req->body = trg_serialize(req->node);
+
+    at = strstr(req->body, placeholder);
+    req->payload_at = at - req->body;
+    memmove(at, at + len, strlen(at + len) + 1);
+
+    g_free(placeholder);
+}
+
+static gsize trg_request_body_length(trg_request * req)
+{
+    return strlen(req->body) + (req->payload ?
+                                BASE64_ENCODED_LENGTH(g_bytes_get_size
+                                                      (req->payload)) :
+                                0);
+}
+
+static gsize
+trg_transfer_read_body(trg_transfer * transfer, gchar * ptr, gsize room)
+{
+    trg_request *req = transfer->req;
+    gsize bodyLen = strlen(req->body);
+    gsize payloadLen = 0;
+    const guchar *payload = req->payload ?
+        (const guchar *) g_bytes_get_data(req->payload, &payloadLen) : NULL;
+    gsize encodedLen = BASE64_ENCODED_LENGTH(payloadLen);
+    gsize out = 0;
+
+    while (room > 0) {
+        gsize pos = transfer->sent;
+        gsize n;
+
+        if (pos < req->payload_at) {
+            n = MIN(room, req->payload_at - pos);
+            memcpy(ptr + out, req->body + pos, n);
+        } else if (pos < req->payload_at + encodedLen) {
+            gsize in = (pos - req->payload_at) / 4 * 3;
+            gsize left = payloadLen - in;
+            gint state = 0, save = 0;
+
+            if (left >= 3) {
+                gsize chunk = MIN(left / 3, room / 4) * 3;
+
+                if (chunk == 0)
+                    break;
+
+                n = g_base64_encode_step(payload + in, chunk, FALSE,
+                                         ptr + out, &state, &save);
+            } else {
+                if (room < 4)
+                    break;
+
+                n = g_base64_encode_step(payload + in, left, FALSE,
+                                         ptr + out, &state, &save);
+                n += g_base64_encode_close(FALSE, ptr + out + n, &state,
+                                           &save);
+            }
+        } else if (pos < bodyLen + encodedLen) {
+            n = MIN(room, bodyLen + encodedLen - pos);
+            memcpy(ptr + out, req->body + pos - encodedLen, n);
+        } else {
+            break;
+        }
+
+        transfer->sent += n;
+        out += n;
+        room -= n;
+    }
+
+    return out;
+}
+
+/* Large bodies can be sent gzipped, to a server which has been set up to
+ * take them (HTTP has no way to ask first). They're compressed as they're
+ * read, so the length isn't known and they go chunked. */
+#define COMPRESS_MIN_SIZE 65536
+#define COMPRESS_STAGE_SIZE 16384
+
+static gboolean trg_transfer_should_compress(trg_transfer * transfer)
+{
+    TrgClientPrivate *priv = transfer->tc->priv;
+    trg_request *req = transfer->req;
+
+    return priv->compressRequests
+        && transfer->http_class == HTTP_CLASS_TRANSMISSION
+        && trg_request_body_length(req) >= COMPRESS_MIN_SIZE;
+}
+
+static gssize
+trg_transfer_read_compressed(trg_transfer * transfer, gchar * ptr,
+                             gsize room)
+{
+    gsize out = 0;
+
+    while (out < room && !transfer->compressed) {
+        gboolean end;
+        GConverterResult result;
+        GError *error = NULL;
+        gsize read = 0, written = 0;
+
+        if (transfer->stagedAt == transfer->stagedLen) {
+            transfer->stagedLen =
+                trg_transfer_read_body(transfer, transfer->staged,
+                                       COMPRESS_STAGE_SIZE);
+            transfer->stagedAt = 0;
+        }
+
+        end = transfer->sent == trg_request_body_length(transfer->req);
+
+        result = g_converter_convert(transfer->compressor,
+                                     transfer->staged +
+                                     transfer->stagedAt,
+                                     transfer->stagedLen -
+                                     transfer->stagedAt, ptr + out,
+                                     room - out,
+                                     end ? G_CONVERTER_INPUT_AT_END :
+                                     G_CONVERTER_NO_FLAGS, &read,
+                                     &written, &error);
+
+        if (result == G_CONVERTER_ERROR) {
+            gboolean full = g_error_matches(error, G_IO_ERROR,
+                                            G_IO_ERROR_NO_SPACE);
+
+            g_error_free(error);
+
+            if (full && out > 0)
+                break;
+
+            return -1;
+        }
+
+        transfer->stagedAt += read;
+        out += written;
+
+        if (result == G_CONVERTER_FINISHED)
+            transfer->compressed = TRUE;
+    }
+
+    return out;
+}
+
+static size_t
+http_send_callback(char *ptr, size_t size, size_t nmemb, void *data)
+{
+    trg_transfer *transfer = (trg_transfer *) data;
+    gssize out;
+
+    if (!transfer->compressor)
+        return trg_transfer_read_body(transfer, ptr, size * nmemb);
+
+    out = trg_transfer_read_compressed(transfer, ptr, size * nmemb);
+
+    return out < 0 ? CURL_READFUNC_ABORT : (size_t) out;
+}
+
+/* Back to the start of the body, to send it again. */
+static void trg_transfer_rewind(trg_transfer * transfer)
+{
+    transfer->sent = 0;
+
+    if (transfer->compressor) {
+        g_converter_reset(transfer->compressor);
+        transfer->stagedLen = transfer->stagedAt = 0;
+        transfer->compressed = FALSE;
+    }
+}
+
+static void trg_transfer_free_compressor(trg_transfer * transfer)
+{
+    if (transfer->compressor) {
+        g_object_unref(transfer->compressor);
+        g_free(transfer->staged);
+        transfer->compressor = NULL;
+        transfer->staged = NULL;
+    }
+}
+
+static int http_seek_callback(void *data, curl_off_t offset, int origin)
+{
+    trg_transfer *transfer = (trg_transfer *) data;
+
+    if (origin != SEEK_SET || offset != 0)
+        return CURL_SEEKFUNC_CANTSEEK;
+
+    trg_transfer_rewind(transfer);
+
+    return CURL_SEEKFUNC_OK;
+}
+
+/* Set how the body's sent, which for an uncompressed body without a
+ * payload is straight from the string. */
+static void trg_transfer_set_body(trg_transfer * transfer)
+{
+    trg_request *req = transfer->req;
+    CURL *curl = transfer->curl;
+
+    if (trg_transfer_should_compress(transfer) && !transfer->compressor) {
+        transfer->compressor =
+            G_CONVERTER(g_zlib_compressor_new
+                        (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+        transfer->staged = g_malloc(COMPRESS_STAGE_SIZE);
+    }
+
+    trg_transfer_rewind(transfer);
+
+    if (req->payload || transfer->compressor) {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE,
+                         transfer->compressor ? (curl_off_t) -1 :
+                         (curl_off_t) trg_request_body_length(req));
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, &http_send_callback);
+        curl_easy_setopt(curl, CURLOPT_READDATA, (void *) transfer);
+        curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, &http_seek_callback);
+        curl_easy_setopt(curl, CURLOPT_SEEKDATA, (void *) transfer);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE,
+                         (curl_off_t) -1);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, req->body);
+    }
+}
 
-trg_response *dispatch(TrgClient * tc, trg_request *req)
+static gboolean trg_client_start_transfer(gpointer data)
 {
-    trg_response *response = g_new0(trg_response, 1);
-    GError *decode_error = NULL;
-    JsonNode *result;
+    trg_transfer *transfer = (trg_transfer *) data;
+    trg_request *req = transfer->req;
+
+    trg_metrics_sample_add(&transfer->sample, TRG_METRIC_QUEUE,
+                           g_get_monotonic_time() - transfer->queued);
 
-	if (req->node && !req->body)
-		req->body = trg_serialize(req->node);
+    if (req->url)
+        g_strlcpy(transfer->sample.method, req->url,
+                  sizeof(transfer->sample.method));
+    else
+        g_strlcpy(transfer->sample.method,
+                  json_object_get_string_member(json_node_get_object
+                                                (req->node),
+                                                PARAM_METHOD),
+                  sizeof(transfer->sample.method));
+
+    transfer->http_class =
+        req->url ? HTTP_CLASS_PUBLIC : HTTP_CLASS_TRANSMISSION;
+    transfer->curl = get_curl(transfer->tc, transfer->http_class);
+    transfer->rsp = g_new0(trg_response, 1);
+    /* The session is replaced on the main loop, so the parse worker gets
+     * its RPC version from here. */
+    if (transfer->tc->priv->session)
+        transfer->rsp->rpcv =
+            session_get_rpc_version(transfer->tc->priv->session);
+
+    if (transfer->http_class == HTTP_CLASS_PUBLIC) {
+        curl_easy_setopt(transfer->curl, CURLOPT_URL, req->url);
+    } else {
+        if (req->payload && !req->body)
+            trg_request_serialize_payload(req);
+        else if (req->node && !req->body)
+            req->body = trg_serialize(req->node);
 
 #ifdef DEBUG
-    if (g_getenv("TRG_SHOW_OUTGOING"))
-        g_message("=>(OUTgoing)=>: %s", req->body);
+        if (g_getenv("TRG_SHOW_OUTGOING"))
+            g_message("=>(OUTgoing)=>: %s", req->body);
 #endif
 
-    trg_http_perform(tc, req, response);
+        trg_transfer_set_body(transfer);
+    }
+
+    curl_easy_setopt(transfer->curl, CURLOPT_WRITEDATA, (void *) transfer);
+    curl_easy_setopt(transfer->curl, CURLOPT_PRIVATE, (void *) transfer);
+    trg_transfer_set_headers(transfer);
+
+    curl_multi_add_handle(transfer->tc->priv->multi, transfer->curl);
+
+    return FALSE;
+}
+
+static gboolean trg_client_dispatch_callback(gpointer data)
+{
+    trg_dispatched *dispatched = (trg_dispatched *) data;
+    gint64 start = g_get_monotonic_time();
+
+    trg_metrics_sample_add(&dispatched->sample, TRG_METRIC_IDLE,
+                           start - dispatched->parsed);
+
+    dispatched->callback(dispatched->response);
+
+    trg_metrics_sample_add(&dispatched->sample, TRG_METRIC_APPLY,
+                           g_get_monotonic_time() - start);
+    trg_metrics_add(dispatched->tc->priv->metrics, &dispatched->sample);
+
+    g_free(dispatched);
+
+    return FALSE;
+}
 
-    if (response->status == CURLE_OK)
-        response->obj = trg_deserialize(response, &decode_error);
+#ifdef DEBUG
+static void trg_client_show_incoming(JsonObject * obj)
+{
+    JsonGenerator *pg;
+    JsonNode *root;
+    gchar *pgdata;
+    gsize len;
 
-    g_free(response->raw);
-    response->raw = NULL;
+    root = json_node_new(JSON_NODE_OBJECT);
+    json_node_set_object(root, obj);
 
-    if (response->status != CURLE_OK)
-        return response;
+    pg = json_generator_new();
+    g_object_set(pg, "pretty", TRUE, NULL);
+    json_generator_set_root(pg, root);
 
-    if (decode_error) {
-        g_error("JSON decoding error: %s", decode_error->message);
-        g_error_free(decode_error);
-        response->status = FAIL_JSON_DECODE;
-        return response;
+    pgdata = json_generator_to_data(pg, &len);
+    g_debug("<=(incoming)<=:\n%s\n", pgdata);
+    g_free(pgdata);
+
+    g_object_unref(pg);
+    json_node_free(root);
+}
+#endif
+
+/* Runs on the parse worker. Each piece of a Transmission response is fed
+ * to its stream as it arrives, then once the transfer is done the response
+ * is checked for success and the callback is run from the main loop.
+ */
+static void dispatch_parse_threadfunc(gpointer data, gpointer user_data)
+{
+    trg_parse_job *job = (trg_parse_job *) data;
+    trg_transfer *transfer = job->transfer;
+    TrgClient *tc = TRG_CLIENT(user_data);
+    TrgClientPrivate *priv = tc->priv;
+    trg_request *req = transfer->req;
+    trg_response *response = transfer->rsp;
+
+    if (job->piece) {
+        gint64 start = g_get_monotonic_time();
+        gsize len;
+        const gchar *piece =
+            (const gchar *) g_bytes_get_data(job->piece, &len);
+
+        trg_json_stream_feed(transfer->stream, piece, len);
+        transfer->decodeUsec += g_get_monotonic_time() - start;
+
+        g_bytes_unref(job->piece);
+        g_free(job);
+        return;
+    }
+
+    g_free(job);
+
+    if (transfer->http_class == HTTP_CLASS_TRANSMISSION
+        && response->status == CURLE_OK) {
+        GError *decode_error = NULL;
+        JsonNode *result;
+
+        if (transfer->stream)
+            response->obj =
+                trg_json_stream_finish(transfer->stream, &decode_error);
+        else
+            decode_error =
+                g_error_new_literal(JSON_PARSER_ERROR,
+                                    JSON_PARSER_ERROR_PARSE,
+                                    "Empty response");
+
+        /* Preparing is done as each torrent is decoded, so it's timed
+         * within decoding. */
+        trg_metrics_sample_add(&transfer->sample, TRG_METRIC_PARSE,
+                               transfer->decodeUsec -
+                               transfer->prepareUsec);
+        trg_metrics_sample_add(&transfer->sample, TRG_METRIC_PREPARE,
+                               transfer->prepareUsec);
+
+        if (decode_error) {
+            g_error("JSON decoding error: %s", decode_error->message);
+            g_error_free(decode_error);
+            response->status = FAIL_JSON_DECODE;
+        } else {
+#ifdef DEBUG
+            if (g_getenv("TRG_SHOW_INCOMING_PRETTY") != NULL)
+                trg_client_show_incoming(response->obj);
+#endif
+            result = json_object_get_member(response->obj, FIELD_RESULT);
+            if (!result
+                || g_strcmp0(json_node_get_string(result), FIELD_SUCCESS))
+                response->status = FAIL_RESPONSE_UNSUCCESSFUL;
+        }
+    }
+
+    /* Torrents were prepared as they arrived, before it was known whether
+     * the response would fail. */
+    if (response->status != CURLE_OK && response->prepared) {
+        response->prepared_free(response->prepared);
+        response->prepared = NULL;
     }
 
-    result = json_object_get_member(response->obj, FIELD_RESULT);
-    if (!result || g_strcmp0(json_node_get_string(result), FIELD_SUCCESS))
-        response->status = FAIL_RESPONSE_UNSUCCESSFUL;
+    if (transfer->stream)
+        trg_json_stream_free(transfer->stream);
 
-    return response;
+    response->cb_data = req->cb_data;
+    transfer->sample.status = response->status;
+
+    if (req->callback && req->connid == g_atomic_int_get(&priv->connid)) {
+        trg_dispatched *dispatched = g_new(trg_dispatched, 1);
+        dispatched->tc = tc;
+        dispatched->callback = req->callback;
+        dispatched->response = response;
+        dispatched->parsed = g_get_monotonic_time();
+        dispatched->sample = transfer->sample;
+        g_idle_add(trg_client_dispatch_callback, dispatched);
+    } else {
+        trg_metrics_add(priv->metrics, &transfer->sample);
+        trg_response_free(response);
+    }
+
+    trg_request_free(req);
+    g_free(req);
+    g_free(transfer->key);
+    g_free(transfer);
 }
 
-trg_response *dispatch_public_http(TrgClient *tc, trg_request *req) {
-	trg_response *response = g_new0(trg_response, 1);
-    CURL* curl = get_curl(tc, HTTP_CLASS_PUBLIC);
-    struct curl_slist *headers = NULL;
+/* curl's times are each from the start of the attempt. */
+static void trg_transfer_add_timings(trg_transfer * transfer)
+{
+    trg_metrics_sample *s = &transfer->sample;
+    double dns = 0, connect = 0, tls = 0, pretransfer = 0, start = 0,
+        total = 0, sent = 0, received = 0;
+    long headers = 0;
+
+    curl_easy_getinfo(transfer->curl, CURLINFO_NAMELOOKUP_TIME, &dns);
+    curl_easy_getinfo(transfer->curl, CURLINFO_CONNECT_TIME, &connect);
+    curl_easy_getinfo(transfer->curl, CURLINFO_APPCONNECT_TIME, &tls);
+    curl_easy_getinfo(transfer->curl, CURLINFO_PRETRANSFER_TIME,
+                      &pretransfer);
+    curl_easy_getinfo(transfer->curl, CURLINFO_STARTTRANSFER_TIME, &start);
+    curl_easy_getinfo(transfer->curl, CURLINFO_TOTAL_TIME, &total);
+    curl_easy_getinfo(transfer->curl, CURLINFO_SIZE_UPLOAD, &sent);
+    curl_easy_getinfo(transfer->curl, CURLINFO_SIZE_DOWNLOAD, &received);
+    curl_easy_getinfo(transfer->curl, CURLINFO_HEADER_SIZE, &headers);
+
+    trg_metrics_sample_add(s, TRG_METRIC_DNS, dns * G_USEC_PER_SEC);
+    trg_metrics_sample_add(s, TRG_METRIC_CONNECT,
+                           MAX(connect - dns, 0) * G_USEC_PER_SEC);
+    trg_metrics_sample_add(s, TRG_METRIC_TLS,
+                           tls > 0 ? (tls - connect) * G_USEC_PER_SEC : 0);
+    trg_metrics_sample_add(s, TRG_METRIC_DAEMON,
+                           MAX(start - pretransfer, 0) * G_USEC_PER_SEC);
+    trg_metrics_sample_add(s, TRG_METRIC_TRANSFER,
+                           MAX(total - start, 0) * G_USEC_PER_SEC);
+    trg_metrics_sample_add(s, TRG_METRIC_SENT, sent);
+    trg_metrics_sample_add(s, TRG_METRIC_RECEIVED, received + headers);
+}
+
+static void
+trg_client_transfer_done(TrgClient * tc, trg_transfer * transfer,
+                         CURLcode result)
+{
+    TrgClientPrivate *priv = tc->priv;
+    trg_response *response = transfer->rsp;
     long httpCode = 0;
-    gchar *cookie_header = NULL;
 
-    response->size = 0;
-    response->raw = NULL;
+    curl_multi_remove_handle(priv->multi, transfer->curl);
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    trg_transfer_add_timings(transfer);
 
-	curl_easy_setopt(curl, CURLOPT_URL, req->url);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *) response);
+    response->status = result;
 
-	if (req->cookie) {
-		cookie_header = g_strdup_printf("Cookie: %s", req->cookie);
-		headers = curl_slist_append(NULL, cookie_header);
-	}
+    if (response->status == CURLE_OK) {
+        /* The header callback has picked up the new session ID, so try
+         * again once with it. */
+        if (httpCode == HTTP_CONFLICT && !transfer->retried
+            && transfer->http_class == HTTP_CLASS_TRANSMISSION) {
+            transfer->retried = TRUE;
+            trg_transfer_rewind(transfer);
+            trg_transfer_set_headers(transfer);
+            curl_multi_add_handle(priv->multi, transfer->curl);
+            return;
+        } else if (httpCode == HTTP_UNSUPPORTED_MEDIA_TYPE
+                   && transfer->compressor) {
+            /* It doesn't take compressed bodies after all, so send this
+             * one again plain, and no more until the next connect. */
+            priv->compressRequests = FALSE;
+            trg_transfer_free_compressor(transfer);
+            trg_transfer_set_body(transfer);
+            trg_transfer_set_headers(transfer);
+            curl_multi_add_handle(priv->multi, transfer->curl);
+            return;
+        } else if (httpCode != HTTP_OK) {
+            response->status = (-httpCode) - 100;
+        }
+    }
 
-	if (headers)
-		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    if (transfer->headers)
+        curl_slist_free_all(transfer->headers);
 
-    response->status = curl_easy_perform(curl);
+    release_curl(tc, transfer->curl);
+    transfer->curl = NULL;
+    trg_transfer_free_compressor(transfer);
 
-    trg_request_free(req);
+    /* Let an identical request which was held back go now. */
+    if (transfer->key && !transfer->batch) {
+        g_hash_table_remove(priv->inFlight, transfer->key);
+        trg_client_schedule_flush(tc);
+    }
 
-    g_free(cookie_header);
+    trg_transfer_push_parse(transfer, NULL);
+}
 
-    if (headers)
-    	curl_slist_free_all(headers);
+static void trg_client_check_multi_info(TrgClient * tc)
+{
+    CURLM *multi = tc->priv->multi;
+    CURLMsg *msg;
+    int pending;
+
+    while ((msg = curl_multi_info_read(multi, &pending))) {
+        if (msg->msg == CURLMSG_DONE) {
+            CURL *curl = msg->easy_handle;
+            CURLcode result = msg->data.result;
+            trg_transfer *transfer;
+
+            curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **) &transfer);
+            trg_client_transfer_done(tc, transfer, result);
+        }
+    }
+}
 
-    //g_message(response->raw);
+/* Requests to the daemon are queued until the main loop is next idle, so
+ * that ones made together can be coalesced before any are sent. A
+ * torrent-get which is the same as one already queued for the same callback
+ * replaces it, and isn't sent while the same one is still in flight.
+ * Actions on torrents which only differ in their IDs are sent as one
+ * request for all of them, as long as that doesn't reorder them with other
+ * actions on the same torrents.
+ */
+static const gchar *trg_client_batch_methods[] = {
+    METHOD_TORRENT_START, METHOD_TORRENT_START_NOW, METHOD_TORRENT_STOP,
+    METHOD_TORRENT_VERIFY, METHOD_TORRENT_REANNOUNCE, METHOD_TORRENT_SET,
+    METHOD_TORRENT_REMOVE, NULL
+};
+
+static void trg_transfer_free(trg_transfer * transfer)
+{
+    trg_request_free(transfer->req);
+    g_free(transfer->req);
+    g_free(transfer->key);
+    g_free(transfer);
+}
 
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+static gboolean trg_client_is_batch_method(const gchar * method)
+{
+    const gchar **m;
+
+    for (m = trg_client_batch_methods; *m; m++)
+        if (!g_strcmp0(method, *m))
+            return TRUE;
 
-    if (response->status == CURLE_OK && httpCode != HTTP_OK) {
-      response->status = (-httpCode) - 100;
+    return FALSE;
+}
+
+static void trg_transfer_set_key(trg_transfer * transfer)
+{
+    trg_request *req = transfer->req;
+    JsonObject *root = json_node_get_object(req->node);
+    const gchar *method =
+        json_object_get_string_member(root, PARAM_METHOD);
+    JsonObject *args = node_get_arguments(req->node);
+    JsonNode *ids = args ? json_object_get_member(args, PARAM_IDS) : NULL;
+
+    if (!g_strcmp0(method, METHOD_TORRENT_GET)) {
+        req->body = trg_serialize(req->node);
+        transfer->key = g_strdup_printf("%p %p %s", req->callback,
+                                        req->cb_data, req->body);
+    } else if (ids && json_node_get_node_type(ids) == JSON_NODE_ARRAY
+               && trg_client_is_batch_method(method)) {
+        JsonObject *rest = json_object_new();
+        JsonNode *restNode = json_node_new(JSON_NODE_OBJECT);
+        GList *members = json_object_get_members(args);
+        GList *li;
+        gchar *restBody;
+
+        for (li = members; li; li = g_list_next(li))
+            if (g_strcmp0(li->data, PARAM_IDS))
+                json_object_set_member(rest, li->data,
+                                       json_node_copy
+                                       (json_object_get_member
+                                        (args, li->data)));
+
+        g_list_free(members);
+        json_node_take_object(restNode, rest);
+        restBody = trg_serialize(restNode);
+        json_node_free(restNode);
+
+        transfer->key = g_strdup_printf("%p %p %s %s", req->callback,
+                                        req->cb_data, method, restBody);
+        transfer->batch = TRUE;
+        g_free(restBody);
     }
+}
 
-	return response;
+static void trg_transfer_merge_ids(trg_transfer * into, trg_transfer * from)
+{
+    JsonArray *ids =
+        json_object_get_array_member(node_get_arguments(into->req->node),
+                                     PARAM_IDS);
+    JsonArray *more =
+        json_object_get_array_member(node_get_arguments(from->req->node),
+                                     PARAM_IDS);
+    guint i, n = json_array_get_length(more);
+
+    for (i = 0; i < n; i++)
+        json_array_add_element(ids,
+                               json_node_copy(json_array_get_element
+                                              (more, i)));
+
+    request_set_tag_from_ids(into->req->node, ids);
 }
 
-static void dispatch_async_threadfunc(trg_request * req, TrgClient * tc)
+/* Whether a queued request could act on any of the torrents a batched one
+ * would, in which case the batched one can't be merged into an earlier
+ * request ahead of it. Ones without a list of IDs act on all of them.
+ */
+static gboolean
+trg_transfer_overlaps(trg_transfer * queued, trg_transfer * transfer)
 {
+    JsonObject *root = json_node_get_object(queued->req->node);
+    const gchar *method =
+        json_object_get_string_member(root, PARAM_METHOD);
+    JsonObject *args = node_get_arguments(queued->req->node);
+    JsonNode *ids = args ? json_object_get_member(args, PARAM_IDS) : NULL;
+    JsonArray *theirs, *mine;
+    guint i, j;
+
+    if (!method || !g_str_has_prefix(method, "torrent-")
+        || !g_strcmp0(method, METHOD_TORRENT_GET))
+        return FALSE;
+
+    if (!ids || json_node_get_node_type(ids) != JSON_NODE_ARRAY)
+        return TRUE;
+
+    theirs = json_node_get_array(ids);
+    mine =
+        json_object_get_array_member(node_get_arguments
+                                     (transfer->req->node), PARAM_IDS);
+
+    for (i = 0; i < json_array_get_length(mine); i++) {
+        JsonNode *a = json_array_get_element(mine, i);
+
+        for (j = 0; j < json_array_get_length(theirs); j++) {
+            JsonNode *b = json_array_get_element(theirs, j);
+
+            if (json_node_get_value_type(a) != json_node_get_value_type(b))
+                continue;
+            else if (json_node_get_value_type(a) == G_TYPE_STRING ?
+                     !g_strcmp0(json_node_get_string(a),
+                                json_node_get_string(b)) :
+                     json_node_get_int(a) == json_node_get_int(b))
+                return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static gboolean trg_client_flush_pending(gpointer data)
+{
+    TrgClient *tc = TRG_CLIENT(data);
     TrgClientPrivate *priv = tc->priv;
-    trg_response *rsp;
+    GList *li, *next;
+
+    priv->flushSource = 0;
+
+    for (li = priv->pending->head; li; li = next) {
+        trg_transfer *transfer = (trg_transfer *) li->data;
+        next = g_list_next(li);
+
+        if (transfer->req->connid != g_atomic_int_get(&priv->connid)) {
+            g_queue_delete_link(priv->pending, li);
+            trg_transfer_free(transfer);
+            continue;
+        } else if (transfer->key && !transfer->batch
+                   && g_hash_table_contains(priv->inFlight,
+                                            transfer->key)) {
+            continue;
+        }
 
-    if (req->url)
-    	rsp = dispatch_public_http(tc, req);
-    else
-        rsp = dispatch(tc, req);
+        g_queue_delete_link(priv->pending, li);
 
-    rsp->cb_data = req->cb_data;
+        if (transfer->key && !transfer->batch)
+            g_hash_table_add(priv->inFlight, transfer->key);
 
-    if (req->callback && req->connid == g_atomic_int_get(&priv->connid))
-        g_idle_add(req->callback, rsp);
-    else
-        trg_response_free(rsp);
+        trg_client_start_transfer(transfer);
+    }
 
-    g_free(req);
+    return FALSE;
+}
+
+static void trg_client_schedule_flush(TrgClient * tc)
+{
+    TrgClientPrivate *priv = tc->priv;
+
+    if (!priv->flushSource && !g_queue_is_empty(priv->pending))
+        priv->flushSource = g_idle_add(trg_client_flush_pending, tc);
+}
+
+static gboolean trg_client_queue_transfer(gpointer data)
+{
+    trg_transfer *transfer = (trg_transfer *) data;
+    TrgClient *tc = transfer->tc;
+    TrgClientPrivate *priv = tc->priv;
+    GList *li;
+
+    if (transfer->req->url)
+        return trg_client_start_transfer(transfer);
+
+    trg_transfer_set_key(transfer);
+
+    if (transfer->batch) {
+        /* Only join the last like request, and only if nothing queued
+         * since then acts on the same torrents. Otherwise stop, start,
+         * stop would be sent as stop, stop then start.
+         */
+        for (li = priv->pending->tail; li; li = g_list_previous(li)) {
+            trg_transfer *queued = (trg_transfer *) li->data;
+
+            if (!g_strcmp0(queued->key, transfer->key)) {
+                trg_transfer_merge_ids(queued, transfer);
+                trg_transfer_free(transfer);
+                return FALSE;
+            } else if (trg_transfer_overlaps(queued, transfer)) {
+                break;
+            }
+        }
+    } else if (transfer->key) {
+        for (li = priv->pending->head; li; li = g_list_next(li)) {
+            trg_transfer *queued = (trg_transfer *) li->data;
+
+            if (!g_strcmp0(queued->key, transfer->key)) {
+                g_queue_delete_link(priv->pending, li);
+                trg_transfer_free(queued);
+                break;
+            }
+        }
+    }
+
+    g_queue_push_tail(priv->pending, transfer);
+    trg_client_schedule_flush(tc);
+
+    return FALSE;
 }
 
 static gboolean
@@ -747,21 +1651,23 @@ dispatch_async_common(TrgClient * tc,
                       GSourceFunc callback, gpointer data)
 {
     TrgClientPrivate *priv = tc->priv;
-    GError *error = NULL;
+    trg_transfer *transfer = g_new0(trg_transfer, 1);
 
     trg_req->callback = callback;
     trg_req->cb_data = data;
     trg_req->connid = g_atomic_int_get(&priv->connid);
 
-    trg_client_thread_pool_push(tc, trg_req, &error);
-    if (error) {
-        g_error("thread creation error: %s\n", error->message);
-        g_error_free(error);
-        g_free(trg_req);
-        return FALSE;
-    } else {
-        return TRUE;
-    }
+    transfer->tc = tc;
+    transfer->req = trg_req;
+    transfer->queued = g_get_monotonic_time();
+    trg_metrics_sample_init(&transfer->sample);
+    transfer->sample.when = g_get_real_time();
+
+    /* The multi handle and the queue belong to the main loop. This runs
+     * straight away when called from it, which is almost always. */
+    g_main_context_invoke(NULL, trg_client_queue_transfer, transfer);
+
+    return TRUE;
 }
 
 gboolean
@@ -774,6 +1680,38 @@ dispatch_async(TrgClient * tc, JsonNode * req,
     return dispatch_async_common(tc, trg_req, callback, data);
 }
 
+gboolean
+dispatch_async_prepared(TrgClient * tc, JsonNode * req,
+                        trg_response_prepare_func prepare,
+                        gpointer prepare_data, GSourceFunc callback,
+                        gpointer data)
+{
+    trg_request *trg_req = g_new0(trg_request, 1);
+    trg_req->node = req;
+    trg_req->prepare = prepare;
+    trg_req->prepare_data = prepare_data;
+
+    return dispatch_async_common(tc, trg_req, callback, data);
+}
+
+/* The payload is taken, and base64 encoded as the value of the string
+ * argument named member while the request is sent. */
+gboolean
+dispatch_async_payload(TrgClient * tc, JsonNode * req,
+                       const gchar * member, GBytes * payload,
+                       GSourceFunc callback, gpointer data)
+{
+    trg_request *trg_req = g_new0(trg_request, 1);
+    trg_req->node = req;
+
+    if (payload) {
+        trg_req->payload = payload;
+        trg_req->payload_member = g_strdup(member);
+    }
+
+    return dispatch_async_common(tc, trg_req, callback, data);
+}
+
 gboolean async_http_request(TrgClient *tc, gchar *url, const gchar *cookie, GSourceFunc callback, gpointer data) {
 	trg_request *trg_req = g_new0(trg_request, 1);
 	trg_req->url = g_strdup(url);
@@ -799,3 +1737,8 @@ gboolean trg_client_get_seed_ratio_limited(TrgClient * tc)
 {
     return tc->priv->seedRatioLimited;
 }
+
+TrgMetrics *trg_client_get_metrics(TrgClient * tc)
+{
+    return tc->priv->metrics;
+}
@@ -30,6 +30,8 @@
 
 #include "trg-prefs.h"
 #include "session-get.h"
+#include "trg-metrics.h"
+#include "torrent-record.h"
 
 #define TRANSMISSION_MIN_SUPPORTED 2.0
 #define X_TRANSMISSION_SESSION_ID_HEADER_PREFIX "X-Transmission-Session-Id: "
@@ -48,22 +50,44 @@
 #define HTTPS_URI_PREFIX "https"
 #define HTTP_OK 200
 #define HTTP_CONFLICT 409
+#define HTTP_UNSUPPORTED_MEDIA_TYPE 415
 
 #define FAIL_JSON_DECODE -2
 #define FAIL_RESPONSE_UNSUCCESSFUL -3
-#define DISPATCH_POOL_SIZE 3
+/* Connections kept to one host, further requests queue in curl. HTTP/2
+ * servers multiplex them over a single connection instead. */
+#define DISPATCH_MAX_HOST_CONNECTIONS 4
+#define DISPATCH_IDLE_HANDLES 8
 
 #define HTTP_CLASS_TRANSMISSION 0
 #define HTTP_CLASS_PUBLIC 1
 
+#define HTTP_RECEIVE_INITIAL_SIZE 16384
+
 typedef struct {
     int status;
     int size;
+    gsize capacity;
     char *raw;
     JsonObject *obj;
+    gint64 rpcv;                /* of the session when it was sent */
     gpointer cb_data;
+    gpointer prepared;
+    GDestroyNotify prepared_free;
 } trg_response;
 
+/* Run on the parse worker with each torrent of a torrent-get response as
+ * it's decoded, to work out whatever the callback needs from it into
+ * response->prepared. The torrents aren't kept in response->obj, and the
+ * update's contents may be taken over. Anything prepared is dropped if the
+ * response turns out to have failed. */
+struct _TrgClient;
+typedef void (*trg_response_prepare_func) (struct _TrgClient * tc,
+                                           trg_response * response,
+                                           trg_torrent_update * update,
+                                           guint64 fingerprint,
+                                           gpointer data);
+
 typedef struct {
     gint connid;
     JsonNode *node;
@@ -71,7 +95,12 @@ typedef struct {
     gchar *url;
     GSourceFunc callback;
     gpointer cb_data;
+    trg_response_prepare_func prepare;
+    gpointer prepare_data;
     gchar *cookie;
+    GBytes *payload;            /* base64 encoded into the body as it's sent */
+    gchar *payload_member;      /* as the value of this string argument */
+    gsize payload_at;           /* where in the body it goes */
 } trg_request;
 
 typedef struct _TrgClientPrivate TrgClientPrivate;
@@ -88,7 +117,7 @@ G_BEGIN_DECLS
   (G_TYPE_CHECK_CLASS_TYPE ((klass), TRG_TYPE_CLIENT))
 #define TRG_CLIENT_GET_CLASS(obj) \
   (G_TYPE_INSTANCE_GET_CLASS ((obj), TRG_TYPE_CLIENT, TrgClientClass))
-    typedef struct {
+    typedef struct _TrgClient {
     GObject parent;
     TrgClientPrivate *priv;
 } TrgClient;
@@ -100,31 +129,21 @@ typedef struct {
 
 } TrgClientClass;
 
-/* Thread local storage (TLS).
- * CURL clients can't be used concurrently.
- * So create one instance for each thread in the thread pool.
- */
-typedef struct {
-    /* Use a serial to figure out when there's been a configuration change
-     * by comparing with priv->serial.
-     * We lock updating (and checking for updates) with priv->configMutex
-     */
-    int serial;
-    guint client_class;
-    CURL *curl;
-} trg_tls;
-
 /* stuff that used to be in http.h */
 void trg_response_free(trg_response * response);
-int trg_http_perform(TrgClient * tc, trg_request *request, trg_response * rsp);
 
 /* end http.h*/
 
 /* stuff that used to be in dispatch.c */
-trg_response *dispatch(TrgClient * tc, trg_request *req);
-trg_response *dispatch_public_http(TrgClient *tc, trg_request *req);
 gboolean dispatch_async(TrgClient * client, JsonNode * req,
                         GSourceFunc callback, gpointer data);
+gboolean dispatch_async_prepared(TrgClient * client, JsonNode * req,
+                                 trg_response_prepare_func prepare,
+                                 gpointer prepare_data,
+                                 GSourceFunc callback, gpointer data);
+gboolean dispatch_async_payload(TrgClient * client, JsonNode * req,
+                                const gchar * member, GBytes * payload,
+                                GSourceFunc callback, gpointer data);
 gboolean async_http_request(TrgClient *tc, gchar *url, const gchar *cookie, GSourceFunc callback, gpointer data);
 
 /* end dispatch.c*/
@@ -149,10 +168,8 @@ gboolean trg_client_get_ssl_validate(TrgClient * tc);
 #endif
 gchar *trg_client_get_proxy(TrgClient * tc);
 gint64 trg_client_get_serial(TrgClient * tc);
-void trg_client_thread_pool_push(TrgClient * tc, gpointer data,
-                                 GError ** err);
-void trg_client_set_torrent_table(TrgClient * tc, GHashTable * table);
-GHashTable *trg_client_get_torrent_table(TrgClient * tc);
+void trg_client_set_torrent_model(TrgClient * tc, GObject * model);
+GObject *trg_client_get_torrent_model(TrgClient * tc);
 JsonObject *trg_client_get_session(TrgClient * tc);
 void trg_client_status_change(TrgClient * tc, gboolean connected);
 gboolean trg_client_is_connected(TrgClient * tc);
@@ -167,6 +184,7 @@ gboolean trg_client_update_session(TrgClient * tc, GSourceFunc callback,
                                    gpointer data);
 gboolean trg_client_get_seed_ratio_limited(TrgClient * tc);
 gdouble trg_client_get_seed_ratio_limit(TrgClient * tc);
+TrgMetrics *trg_client_get_metrics(TrgClient * tc);
 
 G_END_DECLS
 #endif                          /* _TRG_CLIENT_H_ */
@@ -230,6 +230,8 @@ load_directory_model(TrgDestinationCombo *self)
 
     GSList *dirs = NULL, *sli;
     GList *li, *list;
+    GtkTreeModel *model;
+    GtkTreeIter iter;
 
     JsonArray *savedDestinations;
     gchar *defaultDir;
@@ -268,33 +270,22 @@ load_directory_model(TrgDestinationCombo *self)
 
 
     /* Add all previously used download dirs */
-    list = g_hash_table_get_values(trg_client_get_torrent_table(client));
-    for (li = list; li; li = g_list_next(li)) {
-        GtkTreeRowReference *rr;
-        GtkTreeModel *model;
-        GtkTreePath *path;
-
-        rr = (GtkTreeRowReference *) li->data;
-        model = gtk_tree_row_reference_get_model(rr);
-        path = gtk_tree_row_reference_get_path(rr);
-
-        if (path) {
-            GtkTreeIter iter;
-
-            if (gtk_tree_model_get_iter(model, &iter, path)) {
-                gchar *dd;
-
-                gtk_tree_model_get(model, &iter,
-                                   TORRENT_COLUMN_DOWNLOADDIR, &dd, -1);
-
-                if (dd && g_strcmp0(dd, defaultDir))
-                    g_slist_str_set_add(&dirs, dd);
-                else
-                    g_free(dd);
-            }
-
-            gtk_tree_path_free(path);
-        }
+    model = GTK_TREE_MODEL(trg_client_get_torrent_model(client));
+    if (gtk_tree_model_get_iter_first(model, &iter)) {
+        do {
+            const trg_torrent_record *rec;
+            gchar *dd;
+
+            gtk_tree_model_get(model, &iter, TORRENT_COLUMN_RECORD, &rec,
+                               -1);
+
+            if (!rec->downloadDir || !g_strcmp0(rec->downloadDir, defaultDir))
+                continue;
+
+            dd = g_strdup(rec->downloadDir);
+            if (!g_slist_str_set_add(&dirs, dd))
+                g_free(dd);
+        } while (gtk_tree_model_iter_next(model, &iter));
     }
 
     for (sli = dirs; sli; sli = g_slist_next(sli))
@@ -304,7 +295,6 @@ load_directory_model(TrgDestinationCombo *self)
                                      DEST_EXISTING);
 
     g_slist_free_full (dirs, g_free);
-    g_list_free(list);
 }
 
 static void set_text_column(GtkCellLayout *layout, guint col)
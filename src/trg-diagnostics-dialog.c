@@ -0,0 +1,562 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+#include <json-glib/json-glib.h>
+
+#include "hig.h"
+#include "util.h"
+#include "trg-client.h"
+#include "trg-metrics.h"
+#include "trg-diagnostics-dialog.h"
+#include "trg-main-window.h"
+#include "trg-tree-view.h"
+
+/* Where each request to the daemon spent its time, from the metrics the
+ * client keeps, so a stalled poll can be put down to the daemon, the
+ * network, the parse or the models. */
+
+enum {
+    METRICCOL_NAME,
+    METRICCOL_LAST,
+    METRICCOL_MEAN,
+    METRICCOL_P50,
+    METRICCOL_P90,
+    METRICCOL_P99,
+    METRICCOL_MAX,
+    METRICCOL_COUNT,
+    METRICCOL_COLUMNS
+};
+
+enum {
+    REQCOL_TIME,
+    REQCOL_METHOD,
+    REQCOL_STATUS,
+    REQCOL_QUEUE,
+    REQCOL_NETWORK,
+    REQCOL_DAEMON,
+    REQCOL_TRANSFER,
+    REQCOL_PARSE,
+    REQCOL_IDLE,
+    REQCOL_APPLY,
+    REQCOL_RECEIVED,
+    REQCOL_COLUMNS
+};
+
+enum {
+    PROP_0,
+    PROP_PARENT,
+    PROP_CLIENT
+};
+
+#define DIAGNOSTICS_UPDATE_INTERVAL 1
+#define DIAGNOSTICS_RECENT 50
+#define DIAGNOSTICS_RESPONSE_EXPORT 1
+#define DIAGNOSTICS_RESPONSE_CLEAR 2
+
+G_DEFINE_TYPE(TrgDiagnosticsDialog, trg_diagnostics_dialog,
+              GTK_TYPE_DIALOG)
+#define TRG_DIAGNOSTICS_DIALOG_GET_PRIVATE(o) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_DIAGNOSTICS_DIALOG, TrgDiagnosticsDialogPrivate))
+typedef struct _TrgDiagnosticsDialogPrivate TrgDiagnosticsDialogPrivate;
+
+struct _TrgDiagnosticsDialogPrivate {
+    TrgClient *client;
+    TrgMainWindow *parent;
+    GtkListStore *metricsModel;
+    GtkListStore *requestsModel;
+    GtkTreeRowReference *rows[TRG_METRIC_COUNT];
+    guint timer;
+};
+
+static GObject *instance = NULL;
+
+static const gchar *metric_names[TRG_METRIC_COUNT] = {
+    N_("Queued"), N_("DNS"), N_("Connect"), N_("TLS"), N_("Daemon"),
+    N_("Transfer"), N_("Parse"), N_("Prepare"), N_("Main loop wait"),
+    N_("Apply"), N_("Sent"), N_("Received")
+};
+
+static void
+trg_diagnostics_dialog_get_property(GObject * object, guint property_id,
+                                    GValue * value, GParamSpec * pspec)
+{
+    G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+}
+
+static void
+trg_diagnostics_dialog_set_property(GObject * object, guint property_id,
+                                    const GValue * value,
+                                    GParamSpec * pspec)
+{
+    TrgDiagnosticsDialogPrivate *priv =
+        TRG_DIAGNOSTICS_DIALOG_GET_PRIVATE(object);
+    switch (property_id) {
+    case PROP_CLIENT:
+        priv->client = g_value_get_pointer(value);
+        break;
+    case PROP_PARENT:
+        priv->parent = g_value_get_object(value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+        break;
+    }
+}
+
+static void diagnostics_format(gchar * buf, gsize len, TrgMetric metric,
+                               gint64 value)
+{
+    if (value < 0)
+        g_strlcpy(buf, "", len);
+    else if (trg_metric_is_size(metric))
+        tr_formatter_size_B(buf, value, len);
+    else
+        g_snprintf(buf, len, "%.1f ms", value / 1000.0);
+}
+
+static void trg_diagnostics_update_metrics(TrgDiagnosticsDialogPrivate *
+                                           priv)
+{
+    TrgMetrics *metrics = trg_client_get_metrics(priv->client);
+    gint i;
+
+    for (i = 0; i < TRG_METRIC_COUNT; i++) {
+        GtkTreePath *path = gtk_tree_row_reference_get_path(priv->rows[i]);
+        gchar last[32], mean[32], p50[32], p90[32], p99[32], max[32];
+        trg_metrics_summary s;
+        GtkTreeIter iter;
+
+        trg_metrics_summarize(metrics, i, &s);
+
+        diagnostics_format(last, sizeof(last), i, s.count ? s.last : -1);
+        diagnostics_format(mean, sizeof(mean), i, s.count ? s.mean : -1);
+        diagnostics_format(p50, sizeof(p50), i, s.count ? s.p50 : -1);
+        diagnostics_format(p90, sizeof(p90), i, s.count ? s.p90 : -1);
+        diagnostics_format(p99, sizeof(p99), i, s.count ? s.p99 : -1);
+        diagnostics_format(max, sizeof(max), i, s.count ? s.max : -1);
+
+        gtk_tree_model_get_iter(GTK_TREE_MODEL(priv->metricsModel), &iter,
+                                path);
+        gtk_list_store_set(priv->metricsModel, &iter, METRICCOL_LAST, last,
+                           METRICCOL_MEAN, mean, METRICCOL_P50, p50,
+                           METRICCOL_P90, p90, METRICCOL_P99, p99,
+                           METRICCOL_MAX, max, METRICCOL_COUNT, s.count,
+                           -1);
+
+        gtk_tree_path_free(path);
+    }
+}
+
+/* The sum of those phases which apply. */
+static gint64 diagnostics_sum(trg_metrics_sample * s, TrgMetric from,
+                              TrgMetric to)
+{
+    gint64 sum = -1;
+    gint i;
+
+    for (i = from; i <= to; i++)
+        if (s->values[i] >= 0)
+            sum = MAX(sum, 0) + s->values[i];
+
+    return sum;
+}
+
+static void trg_diagnostics_update_requests(TrgDiagnosticsDialogPrivate *
+                                            priv)
+{
+    trg_metrics_sample recent[DIAGNOSTICS_RECENT];
+    guint i, n =
+        trg_metrics_get_recent(trg_client_get_metrics(priv->client),
+                               recent, DIAGNOSTICS_RECENT);
+
+    gtk_list_store_clear(priv->requestsModel);
+
+    for (i = 0; i < n; i++) {
+        trg_metrics_sample *s = &recent[i];
+        GDateTime *when =
+            g_date_time_new_from_unix_local(s->when / G_USEC_PER_SEC);
+        gchar *time = g_date_time_format(when, "%X");
+        gchar queue[32], network[32], daemon[32], transfer[32], parse[32],
+            idle[32], apply[32], received[32];
+        GtkTreeIter iter;
+
+        diagnostics_format(queue, sizeof(queue), TRG_METRIC_QUEUE,
+                           s->values[TRG_METRIC_QUEUE]);
+        diagnostics_format(network, sizeof(network), TRG_METRIC_DNS,
+                           diagnostics_sum(s, TRG_METRIC_DNS,
+                                           TRG_METRIC_TLS));
+        diagnostics_format(daemon, sizeof(daemon), TRG_METRIC_DAEMON,
+                           s->values[TRG_METRIC_DAEMON]);
+        diagnostics_format(transfer, sizeof(transfer),
+                           TRG_METRIC_TRANSFER,
+                           s->values[TRG_METRIC_TRANSFER]);
+        diagnostics_format(parse, sizeof(parse), TRG_METRIC_PARSE,
+                           diagnostics_sum(s, TRG_METRIC_PARSE,
+                                           TRG_METRIC_PREPARE));
+        diagnostics_format(idle, sizeof(idle), TRG_METRIC_IDLE,
+                           s->values[TRG_METRIC_IDLE]);
+        diagnostics_format(apply, sizeof(apply), TRG_METRIC_APPLY,
+                           s->values[TRG_METRIC_APPLY]);
+        diagnostics_format(received, sizeof(received),
+                           TRG_METRIC_RECEIVED,
+                           s->values[TRG_METRIC_RECEIVED]);
+
+        gtk_list_store_insert_with_values(priv->requestsModel, &iter, -1,
+                                          REQCOL_TIME, time,
+                                          REQCOL_METHOD, s->method,
+                                          REQCOL_STATUS, s->status,
+                                          REQCOL_QUEUE, queue,
+                                          REQCOL_NETWORK, network,
+                                          REQCOL_DAEMON, daemon,
+                                          REQCOL_TRANSFER, transfer,
+                                          REQCOL_PARSE, parse,
+                                          REQCOL_IDLE, idle,
+                                          REQCOL_APPLY, apply,
+                                          REQCOL_RECEIVED, received, -1);
+
+        g_free(time);
+        g_date_time_unref(when);
+    }
+}
+
+static gboolean trg_diagnostics_timerfunc(gpointer data)
+{
+    TrgDiagnosticsDialogPrivate *priv =
+        TRG_DIAGNOSTICS_DIALOG_GET_PRIVATE(data);
+
+    trg_diagnostics_update_metrics(priv);
+    trg_diagnostics_update_requests(priv);
+
+    return TRUE;
+}
+
+static void trg_diagnostics_export(GtkWindow * parent, TrgClient * client)
+{
+    GtkWidget *w = gtk_file_chooser_dialog_new(_("Export Diagnostics"),
+                                               parent,
+                                               GTK_FILE_CHOOSER_ACTION_SAVE,
+                                               GTK_STOCK_CANCEL,
+                                               GTK_RESPONSE_CANCEL,
+                                               GTK_STOCK_SAVE,
+                                               GTK_RESPONSE_ACCEPT, NULL);
+
+    gtk_dialog_set_alternative_button_order(GTK_DIALOG(w),
+                                            GTK_RESPONSE_ACCEPT,
+                                            GTK_RESPONSE_CANCEL, -1);
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(w),
+                                                   TRUE);
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(w),
+                                      "trg-diagnostics.json");
+
+    if (gtk_dialog_run(GTK_DIALOG(w)) == GTK_RESPONSE_ACCEPT) {
+        gchar *filename =
+            gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(w));
+        JsonGenerator *gen = json_generator_new();
+        JsonNode *root =
+            trg_metrics_to_json(trg_client_get_metrics(client));
+        GError *error = NULL;
+
+        g_object_set(G_OBJECT(gen), "pretty", TRUE, NULL);
+        json_generator_set_root(gen, root);
+
+        if (!json_generator_to_file(gen, filename, &error)) {
+            GtkWidget *dialog = gtk_message_dialog_new(parent,
+                                                       GTK_DIALOG_MODAL,
+                                                       GTK_MESSAGE_ERROR,
+                                                       GTK_BUTTONS_OK,
+                                                       "%s",
+                                                       error->message);
+            gtk_dialog_run(GTK_DIALOG(dialog));
+            gtk_widget_destroy(dialog);
+            g_error_free(error);
+        }
+
+        json_node_free(root);
+        g_object_unref(gen);
+        g_free(filename);
+    }
+
+    gtk_widget_destroy(w);
+}
+
+static void
+trg_diagnostics_response_cb(GtkDialog * dlg, gint res_id,
+                            gpointer data G_GNUC_UNUSED)
+{
+    TrgDiagnosticsDialogPrivate *priv =
+        TRG_DIAGNOSTICS_DIALOG_GET_PRIVATE(dlg);
+
+    if (res_id == DIAGNOSTICS_RESPONSE_EXPORT) {
+        trg_diagnostics_export(GTK_WINDOW(dlg), priv->client);
+    } else if (res_id == DIAGNOSTICS_RESPONSE_CLEAR) {
+        trg_metrics_clear(trg_client_get_metrics(priv->client));
+        trg_diagnostics_timerfunc(dlg);
+    } else {
+        gtk_widget_destroy(GTK_WIDGET(dlg));
+    }
+}
+
+static void trg_diagnostics_destroy_cb(GtkWidget * w,
+                                       gpointer data G_GNUC_UNUSED)
+{
+    TrgDiagnosticsDialogPrivate *priv =
+        TRG_DIAGNOSTICS_DIALOG_GET_PRIVATE(w);
+    gint i;
+
+    if (priv->timer) {
+        g_source_remove(priv->timer);
+        priv->timer = 0;
+    }
+
+    for (i = 0; i < TRG_METRIC_COUNT; i++)
+        gtk_tree_row_reference_free(priv->rows[i]);
+
+    instance = NULL;
+}
+
+static void
+trg_diagnostics_add_column(GtkTreeView * tv, gint index, gchar * title,
+                           gint width)
+{
+    GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
+    GtkTreeViewColumn *column =
+        gtk_tree_view_column_new_with_attributes(title, renderer,
+                                                 "text", index, NULL);
+    gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(column, width);
+
+    gtk_tree_view_append_column(tv, column);
+}
+
+static GtkWidget *trg_diagnostics_scrolled(GtkWidget * tv, gint height)
+{
+    GtkWidget *sw = gtk_scrolled_window_new(NULL, NULL);
+
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(sw),
+                                   GTK_POLICY_AUTOMATIC,
+                                   GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(sw),
+                                        GTK_SHADOW_IN);
+    gtk_container_add(GTK_CONTAINER(sw), tv);
+    gtk_widget_set_size_request(sw, -1, height);
+
+    return sw;
+}
+
+static GtkWidget *trg_diagnostics_metrics_view(TrgDiagnosticsDialogPrivate
+                                               * priv)
+{
+    GtkWidget *tv = trg_tree_view_new();
+    GtkTreeIter iter;
+    gint i;
+
+    priv->metricsModel =
+        gtk_list_store_new(METRICCOL_COLUMNS, G_TYPE_STRING, G_TYPE_STRING,
+                           G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+                           G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT);
+
+    for (i = 0; i < TRG_METRIC_COUNT; i++) {
+        GtkTreePath *path;
+
+        gtk_list_store_insert_with_values(priv->metricsModel, &iter, -1,
+                                          METRICCOL_NAME,
+                                          _(metric_names[i]), -1);
+        path =
+            gtk_tree_model_get_path(GTK_TREE_MODEL(priv->metricsModel),
+                                    &iter);
+        priv->rows[i] =
+            gtk_tree_row_reference_new(GTK_TREE_MODEL(priv->metricsModel),
+                                       path);
+        gtk_tree_path_free(path);
+    }
+
+    gtk_widget_set_sensitive(tv, TRUE);
+
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), METRICCOL_NAME,
+                               _("Phase"), 130);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), METRICCOL_LAST,
+                               _("Last"), 80);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), METRICCOL_MEAN,
+                               _("Mean"), 80);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), METRICCOL_P50,
+                               _("Median"), 80);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), METRICCOL_P90, "90%",
+                               80);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), METRICCOL_P99, "99%",
+                               80);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), METRICCOL_MAX, _("Max"),
+                               80);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), METRICCOL_COUNT,
+                               _("Requests"), 70);
+
+    gtk_tree_view_set_model(GTK_TREE_VIEW(tv),
+                            GTK_TREE_MODEL(priv->metricsModel));
+    g_object_unref(priv->metricsModel);
+
+    return trg_diagnostics_scrolled(tv, 260);
+}
+
+static GtkWidget *trg_diagnostics_requests_view(TrgDiagnosticsDialogPrivate
+                                                * priv)
+{
+    GtkWidget *tv = trg_tree_view_new();
+
+    priv->requestsModel =
+        gtk_list_store_new(REQCOL_COLUMNS, G_TYPE_STRING, G_TYPE_STRING,
+                           G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING,
+                           G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+                           G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+
+    gtk_widget_set_sensitive(tv, TRUE);
+
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_TIME, _("Time"),
+                               70);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_METHOD,
+                               _("Method"), 120);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_STATUS,
+                               _("Status"), 50);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_QUEUE,
+                               _("Queued"), 70);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_NETWORK,
+                               _("Network"), 70);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_DAEMON,
+                               _("Daemon"), 70);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_TRANSFER,
+                               _("Transfer"), 70);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_PARSE,
+                               _("Parse"), 70);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_IDLE,
+                               _("Wait"), 70);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_APPLY,
+                               _("Apply"), 70);
+    trg_diagnostics_add_column(GTK_TREE_VIEW(tv), REQCOL_RECEIVED,
+                               _("Received"), 80);
+
+    gtk_tree_view_set_model(GTK_TREE_VIEW(tv),
+                            GTK_TREE_MODEL(priv->requestsModel));
+    g_object_unref(priv->requestsModel);
+
+    return trg_diagnostics_scrolled(tv, 240);
+}
+
+static GObject *trg_diagnostics_dialog_constructor(GType type,
+                                                   guint
+                                                   n_construct_properties,
+                                                   GObjectConstructParam *
+                                                   construct_params)
+{
+    GObject *obj = G_OBJECT_CLASS
+        (trg_diagnostics_dialog_parent_class)->constructor(type,
+                                                           n_construct_properties,
+                                                           construct_params);
+    TrgDiagnosticsDialogPrivate *priv =
+        TRG_DIAGNOSTICS_DIALOG_GET_PRIVATE(obj);
+    GtkWidget *box = gtk_dialog_get_content_area(GTK_DIALOG(obj));
+
+    gtk_window_set_title(GTK_WINDOW(obj), _("Diagnostics"));
+    gtk_window_set_transient_for(GTK_WINDOW(obj),
+                                 GTK_WINDOW(priv->parent));
+    gtk_window_set_destroy_with_parent(GTK_WINDOW(obj), TRUE);
+    gtk_dialog_add_button(GTK_DIALOG(obj), _("_Export..."),
+                          DIAGNOSTICS_RESPONSE_EXPORT);
+    gtk_dialog_add_button(GTK_DIALOG(obj), GTK_STOCK_CLEAR,
+                          DIAGNOSTICS_RESPONSE_CLEAR);
+    gtk_dialog_add_button(GTK_DIALOG(obj), GTK_STOCK_CLOSE,
+                          GTK_RESPONSE_CLOSE);
+
+    gtk_container_set_border_width(GTK_CONTAINER(obj), GUI_PAD);
+
+    gtk_dialog_set_default_response(GTK_DIALOG(obj), GTK_RESPONSE_CLOSE);
+
+    g_signal_connect(G_OBJECT(obj), "response",
+                     G_CALLBACK(trg_diagnostics_response_cb), NULL);
+    g_signal_connect(G_OBJECT(obj), "destroy",
+                     G_CALLBACK(trg_diagnostics_destroy_cb), NULL);
+
+    gtk_box_set_spacing(GTK_BOX(box), GUI_PAD);
+    gtk_box_pack_start(GTK_BOX(box), trg_diagnostics_metrics_view(priv),
+                       FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(box), trg_diagnostics_requests_view(priv),
+                       TRUE, TRUE, 0);
+
+    trg_diagnostics_timerfunc(obj);
+    priv->timer = g_timeout_add_seconds(DIAGNOSTICS_UPDATE_INTERVAL,
+                                        trg_diagnostics_timerfunc, obj);
+
+    return obj;
+}
+
+static void trg_diagnostics_dialog_class_init(TrgDiagnosticsDialogClass *
+                                              klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    g_type_class_add_private(klass, sizeof(TrgDiagnosticsDialogPrivate));
+
+    object_class->get_property = trg_diagnostics_dialog_get_property;
+    object_class->set_property = trg_diagnostics_dialog_set_property;
+    object_class->constructor = trg_diagnostics_dialog_constructor;
+
+    g_object_class_install_property(object_class,
+                                    PROP_PARENT,
+                                    g_param_spec_object
+                                    ("parent-window", "Parent window",
+                                     "Parent window",
+                                     TRG_TYPE_MAIN_WINDOW,
+                                     G_PARAM_READWRITE |
+                                     G_PARAM_CONSTRUCT_ONLY |
+                                     G_PARAM_STATIC_NAME |
+                                     G_PARAM_STATIC_NICK |
+                                     G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_CLIENT,
+                                    g_param_spec_pointer
+                                    ("trg-client", "TClient",
+                                     "Client",
+                                     G_PARAM_READWRITE |
+                                     G_PARAM_CONSTRUCT_ONLY |
+                                     G_PARAM_STATIC_NAME |
+                                     G_PARAM_STATIC_NICK |
+                                     G_PARAM_STATIC_BLURB));
+}
+
+static void trg_diagnostics_dialog_init(TrgDiagnosticsDialog * self)
+{
+}
+
+TrgDiagnosticsDialog *trg_diagnostics_dialog_get_instance(TrgMainWindow *
+                                                          parent,
+                                                          TrgClient *
+                                                          client)
+{
+    if (instance == NULL) {
+        instance = g_object_new(TRG_TYPE_DIAGNOSTICS_DIALOG,
+                                "trg-client", client,
+                                "parent-window", parent, NULL);
+    }
+
+    return TRG_DIAGNOSTICS_DIALOG(instance);
+}
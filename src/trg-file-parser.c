@@ -28,114 +28,72 @@
 #include <glib/gstdio.h>
 
 #include "bencode.h"
+#include "protocol-constants.h"
 #include "trg-file-parser.h"
 
-static trg_files_tree_node *trg_file_parser_node_insert(trg_files_tree_node
-                                                        * top,
-                                                        trg_files_tree_node
-                                                        * last,
-                                                        be_node *
-                                                        file_node,
-                                                        gint index)
+static gboolean trg_file_parser_node_insert(trg_files_tree * tree,
+                                            be_node * file_node,
+                                            gint index)
 {
     be_node *file_length_node = be_dict_find(file_node, "length", BE_INT);
     be_node *file_path_list = be_dict_find(file_node, "path", BE_LIST);
-    trg_files_tree_node *lastIter = last;
-    GList *parentList = NULL;
-    be_node *path_el_node;
-    GList *li;
+    trg_files_tree_node *parent = tree->top_node;
+    trg_files_tree_node *target_node;
     int i;
 
-    if (!file_path_list || !file_length_node)
-        return NULL;
-
-    if (lastIter)
-        while ((lastIter = lastIter->parent))
-            parentList = g_list_prepend(parentList, lastIter);
-
-    li = parentList;
-    lastIter = top;
+    if (!file_path_list || !file_length_node || !file_path_list->val.l[0])
+        return FALSE;
 
     /* Iterate over the path list which contains each file/directory
-     * component of the path in order.
+     * component of the path in order. The last one is the file.
      */
-    for (i = 0; (path_el_node = file_path_list->val.l[i]); i++) {
-        gboolean isFile = !file_path_list->val.l[i + 1];
-        trg_files_tree_node *target_node = NULL;
-
-        if (li && !isFile) {
-            trg_files_tree_node *lastPathNode = (trg_files_tree_node *) li->data;
-
-            if (!g_strcmp0(lastPathNode->name, path_el_node->val.s)) {
-                target_node = lastPathNode;
-                li = g_list_next(li);
-            } else {
-                li = NULL;
-            }
-        }
-
-        if (!target_node && lastIter && lastIter->childrenHash && !isFile)
-          target_node = g_hash_table_lookup(lastIter->childrenHash, path_el_node->val.s);
-
-        if (!target_node) {
-            target_node = g_new0(trg_files_tree_node, 1);
-            target_node->name = g_strdup(path_el_node->val.s);
-            target_node->parent = lastIter;
-            trg_files_tree_node_add_child(lastIter, target_node);
-        }
-
-        if (isFile) {
-            target_node->length = (gint64) file_length_node->val.i;
-
-            while (lastIter) {
-                lastIter->length += target_node->length;
-                lastIter = lastIter->parent;
-            }
-        }
-
-        target_node->index = isFile ? index : -1;
-        lastIter = target_node;
-    }
-
-    g_list_free(parentList);
-
-    return lastIter;
+    for (i = 0; file_path_list->val.l[i + 1]; i++)
+        parent = trg_files_tree_add_dir(tree, parent,
+                                        file_path_list->val.l[i]->val.s);
+
+    target_node = trg_files_tree_add_file(tree, parent,
+                                          file_path_list->val.l[i]->val.s,
+                                          index);
+    target_node->length = (gint64) file_length_node->val.i;
+    target_node->enabled = TRUE;
+    target_node->priority = TR_PRI_NORMAL;
+
+    return TRUE;
 }
 
 void trg_torrent_file_free(trg_torrent_file * t)
 {
-    trg_files_tree_node_free(t->top_node);
+    if (t->tree)
+        trg_files_tree_free(t->tree);
     g_free(t->name);
     g_free(t);
 }
 
-static trg_files_tree_node *trg_parse_torrent_file_nodes(be_node *
-                                                         info_node)
+static trg_files_tree *trg_parse_torrent_file_nodes(be_node * info_node)
 {
     be_node *files_node = be_dict_find(info_node, "files", BE_LIST);
-    trg_files_tree_node *top_node = g_new0(trg_files_tree_node, 1);
-    trg_files_tree_node *lastNode = NULL;
+    trg_files_tree *tree;
     int i;
 
     /* Probably means single file mode. */
     if (!files_node)
         return NULL;
 
+    tree = trg_files_tree_new();
+
     for (i = 0; files_node->val.l[i]; ++i) {
         be_node *file_node = files_node->val.l[i];
 
         if (!be_validate_node(file_node, BE_DICT)
-            || !(lastNode =
-                 trg_file_parser_node_insert(top_node, lastNode,
-                                             file_node, i))) {
+            || !trg_file_parser_node_insert(tree, file_node, i)) {
             /* Unexpected format. Throw away everything, file indexes need to
              * be correct. */
-            trg_files_tree_node_free(top_node);
+            trg_files_tree_free(tree);
             return NULL;
         }
     }
 
-    return top_node;
+    return tree;
 }
 
 trg_torrent_file *trg_parse_torrent_data(const gchar *data, gsize length) {
@@ -161,21 +119,24 @@ trg_torrent_file *trg_parse_torrent_data(const gchar *data, gsize length) {
     ret = g_new0(trg_torrent_file, 1);
     ret->name = g_strdup(name_node->val.s);
 
-    ret->top_node = trg_parse_torrent_file_nodes(info_node);
-    if (!ret->top_node) {
+    ret->tree = trg_parse_torrent_file_nodes(info_node);
+    if (!ret->tree) {
         trg_files_tree_node *file_node;
         be_node *length_node = be_dict_find(info_node, "length", BE_INT);
 
         if (!length_node) {
+            g_free(ret->name);
             g_free(ret);
             ret = NULL;
             goto out;
         }
 
-        file_node = g_new0(trg_files_tree_node, 1);
+        ret->tree = trg_files_tree_new();
+        file_node = trg_files_tree_add_file(ret->tree, ret->tree->top_node,
+                                            ret->name, 0);
         file_node->length = (gint64) (length_node->val.i);
-        file_node->name = g_strdup(ret->name);
-        ret->top_node = file_node;
+        file_node->enabled = TRUE;
+        file_node->priority = TR_PRI_NORMAL;
     }
 
   out:
@@ -21,7 +21,7 @@
 
 typedef struct {
     char *name;
-    trg_files_tree_node *top_node;
+    trg_files_tree *tree;
 } trg_torrent_file;
 
 void trg_torrent_file_free(trg_torrent_file * t);
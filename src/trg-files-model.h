@@ -24,6 +24,8 @@
 #include <json-glib/json-glib.h>
 
 #include "trg-model.h"
+#include "trg-files-tree-model.h"
+#include "torrent-record.h"
 
 G_BEGIN_DECLS
 #define TRG_TYPE_FILES_MODEL trg_files_model_get_type()
@@ -38,33 +40,26 @@ G_BEGIN_DECLS
 #define TRG_FILES_MODEL_GET_CLASS(obj) \
   (G_TYPE_INSTANCE_GET_CLASS ((obj), TRG_TYPE_FILES_MODEL, TrgFilesModelClass))
     typedef struct {
-    GtkTreeStore parent;
+    TrgFilesTreeModel parent;
 } TrgFilesModel;
 
 typedef struct {
-    GtkTreeStoreClass parent_class;
+    TrgFilesTreeModelClass parent_class;
 } TrgFilesModelClass;
 
 GType trg_files_model_get_type(void);
 
 TrgFilesModel *trg_files_model_new(void);
 
-G_END_DECLS enum {
-    FILESCOL_NAME,
-    FILESCOL_SIZE,
-    FILESCOL_PROGRESS,
-    FILESCOL_ID,
-    FILESCOL_WANTED,
-    FILESCOL_PRIORITY,
-    FILESCOL_BYTESCOMPLETED,
-    FILESCOL_COLUMNS
-};
+G_END_DECLS
 
-#define TRG_FILES_MODEL_CREATE_THREAD_IF_GT 600
+#define TRG_FILES_MODEL_EXPAND_ALL_MAX 5000
 
 void trg_files_model_update(TrgFilesModel * model, GtkTreeView * tv,
-                            gint64 updateSerial, JsonObject * t,
+                            gint64 updateSerial,
+                            const trg_torrent_details * details,
                             gint mode);
+void trg_files_model_clear(TrgFilesModel * model);
 gint64 trg_files_model_get_torrent_id(TrgFilesModel * model);
 void trg_files_model_set_accept(TrgFilesModel * model, gboolean accept);
 
@@ -0,0 +1,800 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* A tree model which shows a trg_files_tree where it is, rather than
+ * copying every node into a GtkTreeStore. Iters point at nodes.
+ *
+ * A directory's rows are only put together, in order, when something
+ * first looks into it, so a collapsed directory costs nothing. Its size,
+ * progress, priority and wanted state are only added up from its children
+ * when asked for, then kept until one of the files under it changes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gtk/gtk.h>
+
+#include "protocol-constants.h"
+#include "torrent.h"
+#include "trg-files-tree.h"
+#include "trg-files-tree-model.h"
+
+static void trg_files_tree_model_tree_model_init(GtkTreeModelIface *
+                                                 iface);
+static void trg_files_tree_model_tree_sortable_init(GtkTreeSortableIface *
+                                                    iface);
+
+G_DEFINE_TYPE_WITH_CODE(TrgFilesTreeModel, trg_files_tree_model,
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,
+                                              trg_files_tree_model_tree_model_init)
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_SORTABLE,
+                                              trg_files_tree_model_tree_sortable_init))
+#define TRG_FILES_TREE_MODEL_GET_PRIVATE(o) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_FILES_TREE_MODEL, TrgFilesTreeModelPrivate))
+typedef struct _TrgFilesTreeModelPrivate TrgFilesTreeModelPrivate;
+
+struct _TrgFilesTreeModelPrivate {
+    trg_files_tree *tree;
+    gint stamp;
+    gint sortColumn;
+    GtkSortType sortOrder;
+    GPtrArray *resortDirs;
+    guint resortSource;
+};
+
+static GType trg_files_tree_model_column_types[FILESCOL_COLUMNS];
+
+/* Add up a directory from its children, only going into the ones which
+ * are stale themselves. Files are never stale.
+ */
+static void trg_files_tree_node_totals(trg_files_tree_node * node)
+{
+    trg_files_tree_node *child;
+
+    if (!node->stale)
+        return;
+
+    node->length = 0;
+    node->bytesCompleted = 0;
+
+    for (child = node->children; child; child = child->next) {
+        trg_files_tree_node_totals(child);
+
+        if (child == node->children) {
+            node->priority = child->priority;
+            node->enabled = child->enabled;
+        } else {
+            if (node->priority != child->priority)
+                node->priority = TR_PRI_MIXED;
+
+            if (node->enabled != child->enabled)
+                node->enabled = TR_PRI_MIXED;
+        }
+
+        node->length += child->length;
+        node->bytesCompleted += child->bytesCompleted;
+    }
+
+    node->stale = FALSE;
+}
+
+static gint trg_files_tree_model_compare_int64(gint64 a, gint64 b)
+{
+    return (a > b) - (a < b);
+}
+
+static gint
+trg_files_tree_model_compare(gconstpointer a, gconstpointer b,
+                             gpointer data)
+{
+    TrgFilesTreeModelPrivate *priv = (TrgFilesTreeModelPrivate *) data;
+    trg_files_tree_node *x = *(trg_files_tree_node * const *) a;
+    trg_files_tree_node *y = *(trg_files_tree_node * const *) b;
+    gint result = 0;
+
+    trg_files_tree_node_totals(x);
+    trg_files_tree_node_totals(y);
+
+    switch (priv->sortColumn) {
+    case FILESCOL_NAME:
+        result = g_utf8_collate(x->name, y->name);
+        break;
+    case FILESCOL_SIZE:
+        result = trg_files_tree_model_compare_int64(x->length, y->length);
+        break;
+    case FILESCOL_PROGRESS:{
+            gdouble px = file_get_progress(x->length, x->bytesCompleted);
+            gdouble py = file_get_progress(y->length, y->bytesCompleted);
+            result = (px > py) - (px < py);
+            break;
+        }
+    case FILESCOL_ID:
+        result = trg_files_tree_model_compare_int64(x->index, y->index);
+        break;
+    case FILESCOL_WANTED:
+        result = trg_files_tree_model_compare_int64(x->enabled,
+                                                    y->enabled);
+        break;
+    case FILESCOL_PRIORITY:
+        result = trg_files_tree_model_compare_int64(x->priority,
+                                                    y->priority);
+        break;
+    case FILESCOL_BYTESCOMPLETED:
+        result = trg_files_tree_model_compare_int64(x->bytesCompleted,
+                                                    y->bytesCompleted);
+        break;
+    }
+
+    return priv->sortOrder == GTK_SORT_DESCENDING ? -result : result;
+}
+
+/* Put the children back in the order they were added, which is the
+ * reverse of how they're listed.
+ */
+static void trg_files_tree_node_unsort(trg_files_tree_node * node)
+{
+    trg_files_tree_node *child;
+    guint i = node->n_rows;
+
+    for (child = node->children; child; child = child->next)
+        node->rows[--i] = child;
+}
+
+/* A directory's rows are only put together when it's first looked into. */
+static void
+trg_files_tree_model_rows(TrgFilesTreeModelPrivate * priv,
+                          trg_files_tree_node * node)
+{
+    trg_files_tree_node *child;
+    guint i;
+
+    if (node->rows || !node->children)
+        return;
+
+    for (child = node->children; child; child = child->next)
+        node->n_rows++;
+
+    node->rows = g_new(trg_files_tree_node *, node->n_rows);
+    trg_files_tree_node_unsort(node);
+
+    if (priv->sortColumn >= 0)
+        g_qsort_with_data(node->rows, node->n_rows,
+                          sizeof(trg_files_tree_node *),
+                          trg_files_tree_model_compare, priv);
+
+    for (i = 0; i < node->n_rows; i++)
+        node->rows[i]->row = i;
+}
+
+static void
+trg_files_tree_model_iter_set(TrgFilesTreeModelPrivate * priv,
+                              GtkTreeIter * iter,
+                              trg_files_tree_node * node)
+{
+    iter->stamp = priv->stamp;
+    iter->user_data = node;
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+}
+
+/* No iter means the top level. */
+static trg_files_tree_node
+    * trg_files_tree_model_iter_node(TrgFilesTreeModelPrivate * priv,
+                                     GtkTreeIter * iter)
+{
+    if (iter)
+        return (trg_files_tree_node *) iter->user_data;
+    else
+        return priv->tree ? priv->tree->top_node : NULL;
+}
+
+static GtkTreeModelFlags
+trg_files_tree_model_get_flags(GtkTreeModel * model G_GNUC_UNUSED)
+{
+    return GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+static gint trg_files_tree_model_get_n_columns(GtkTreeModel *
+                                               model G_GNUC_UNUSED)
+{
+    return FILESCOL_COLUMNS;
+}
+
+static GType
+trg_files_tree_model_get_column_type(GtkTreeModel * model G_GNUC_UNUSED,
+                                     gint index)
+{
+    g_return_val_if_fail(index >= 0 && index < FILESCOL_COLUMNS,
+                         G_TYPE_INVALID);
+    return trg_files_tree_model_column_types[index];
+}
+
+static gboolean
+trg_files_tree_model_get_iter(GtkTreeModel * model, GtkTreeIter * iter,
+                              GtkTreePath * path)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    trg_files_tree_node *node =
+        trg_files_tree_model_iter_node(priv, NULL);
+    gint *indices, depth, i;
+
+    indices = gtk_tree_path_get_indices_with_depth(path, &depth);
+
+    if (!node || depth < 1)
+        return FALSE;
+
+    for (i = 0; i < depth; i++) {
+        trg_files_tree_model_rows(priv, node);
+
+        if (indices[i] < 0 || (guint) indices[i] >= node->n_rows)
+            return FALSE;
+
+        node = node->rows[indices[i]];
+    }
+
+    trg_files_tree_model_iter_set(priv, iter, node);
+    return TRUE;
+}
+
+static GtkTreePath *trg_files_tree_model_get_path(GtkTreeModel *
+                                                  model G_GNUC_UNUSED,
+                                                  GtkTreeIter * iter)
+{
+    trg_files_tree_node *node = (trg_files_tree_node *) iter->user_data;
+    GtkTreePath *path = gtk_tree_path_new();
+
+    for (; node->parent; node = node->parent)
+        gtk_tree_path_prepend_index(path, node->row);
+
+    return path;
+}
+
+static void
+trg_files_tree_model_get_value(GtkTreeModel * model, GtkTreeIter * iter,
+                               gint column, GValue * value)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    trg_files_tree_node *node = (trg_files_tree_node *) iter->user_data;
+
+    g_return_if_fail(iter->stamp == priv->stamp);
+
+    trg_files_tree_node_totals(node);
+    g_value_init(value,
+                 trg_files_tree_model_get_column_type(model, column));
+
+    switch (column) {
+    case FILESCOL_NAME:
+        g_value_set_string(value, node->name);
+        break;
+    case FILESCOL_SIZE:
+        g_value_set_int64(value, node->length);
+        break;
+    case FILESCOL_PROGRESS:
+        g_value_set_double(value,
+                           file_get_progress(node->length,
+                                             node->bytesCompleted));
+        break;
+    case FILESCOL_ID:
+        g_value_set_int(value, node->index);
+        break;
+    case FILESCOL_WANTED:
+        g_value_set_int(value, node->enabled);
+        break;
+    case FILESCOL_PRIORITY:
+        g_value_set_int(value, node->priority);
+        break;
+    case FILESCOL_BYTESCOMPLETED:
+        g_value_set_int64(value, node->bytesCompleted);
+        break;
+    }
+}
+
+static gboolean
+trg_files_tree_model_iter_next(GtkTreeModel * model G_GNUC_UNUSED,
+                               GtkTreeIter * iter)
+{
+    trg_files_tree_node *node = (trg_files_tree_node *) iter->user_data;
+    trg_files_tree_node *parent = node->parent;
+
+    if (node->row + 1 >= parent->n_rows) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->user_data = parent->rows[node->row + 1];
+    return TRUE;
+}
+
+static gboolean
+trg_files_tree_model_iter_previous(GtkTreeModel * model G_GNUC_UNUSED,
+                                   GtkTreeIter * iter)
+{
+    trg_files_tree_node *node = (trg_files_tree_node *) iter->user_data;
+
+    if (node->row == 0) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->user_data = node->parent->rows[node->row - 1];
+    return TRUE;
+}
+
+static gboolean
+trg_files_tree_model_iter_nth_child(GtkTreeModel * model,
+                                    GtkTreeIter * iter,
+                                    GtkTreeIter * parent, gint n)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    trg_files_tree_node *node =
+        trg_files_tree_model_iter_node(priv, parent);
+
+    if (node)
+        trg_files_tree_model_rows(priv, node);
+
+    if (!node || n < 0 || (guint) n >= node->n_rows) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    trg_files_tree_model_iter_set(priv, iter, node->rows[n]);
+    return TRUE;
+}
+
+static gboolean
+trg_files_tree_model_iter_children(GtkTreeModel * model,
+                                   GtkTreeIter * iter,
+                                   GtkTreeIter * parent)
+{
+    return trg_files_tree_model_iter_nth_child(model, iter, parent, 0);
+}
+
+static gboolean
+trg_files_tree_model_iter_has_child(GtkTreeModel * model G_GNUC_UNUSED,
+                                    GtkTreeIter * iter)
+{
+    trg_files_tree_node *node = (trg_files_tree_node *) iter->user_data;
+    return node->children != NULL;
+}
+
+static gint
+trg_files_tree_model_iter_n_children(GtkTreeModel * model,
+                                     GtkTreeIter * iter)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    trg_files_tree_node *node = trg_files_tree_model_iter_node(priv, iter);
+
+    if (!node)
+        return 0;
+
+    trg_files_tree_model_rows(priv, node);
+    return node->n_rows;
+}
+
+static gboolean
+trg_files_tree_model_iter_parent(GtkTreeModel * model, GtkTreeIter * iter,
+                                 GtkTreeIter * child)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    trg_files_tree_node *node = (trg_files_tree_node *) child->user_data;
+
+    if (!node->parent->parent) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    trg_files_tree_model_iter_set(priv, iter, node->parent);
+    return TRUE;
+}
+
+/* Only rows in a directory which has been looked into can be known to a
+ * view, so the rest needn't be signalled.
+ */
+static void
+trg_files_tree_model_node_changed(TrgFilesTreeModel * model,
+                                  trg_files_tree_node * node)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    GtkTreePath *path;
+    GtkTreeIter iter;
+
+    if (!node->parent || !node->parent->rows)
+        return;
+
+    trg_files_tree_model_iter_set(priv, &iter, node);
+    path = trg_files_tree_model_get_path(GTK_TREE_MODEL(model), &iter);
+    gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+}
+
+static void
+trg_files_tree_model_sort_rows(TrgFilesTreeModel * model,
+                               trg_files_tree_node * node)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    gboolean moved = FALSE;
+    gint *new_order;
+    guint i;
+
+    if (node->n_rows < 2)
+        return;
+
+    if (priv->sortColumn >= 0)
+        g_qsort_with_data(node->rows, node->n_rows,
+                          sizeof(trg_files_tree_node *),
+                          trg_files_tree_model_compare, priv);
+    else
+        trg_files_tree_node_unsort(node);
+
+    new_order = g_new(gint, node->n_rows);
+
+    for (i = 0; i < node->n_rows; i++) {
+        new_order[i] = node->rows[i]->row;
+        if (node->rows[i]->row != i)
+            moved = TRUE;
+        node->rows[i]->row = i;
+    }
+
+    if (moved) {
+        GtkTreeIter iter;
+        GtkTreePath *path;
+
+        if (node->parent) {
+            trg_files_tree_model_iter_set(priv, &iter, node);
+            path =
+                trg_files_tree_model_get_path(GTK_TREE_MODEL(model),
+                                              &iter);
+        } else {
+            path = gtk_tree_path_new();
+        }
+
+        gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path,
+                                      node->parent ? &iter : NULL,
+                                      new_order);
+        gtk_tree_path_free(path);
+    }
+
+    g_free(new_order);
+}
+
+static gboolean trg_files_tree_model_resort_idlefunc(gpointer data)
+{
+    TrgFilesTreeModel *model = TRG_FILES_TREE_MODEL(data);
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    guint i;
+
+    for (i = 0; i < priv->resortDirs->len; i++) {
+        trg_files_tree_node *dir =
+            (trg_files_tree_node *) g_ptr_array_index(priv->resortDirs,
+                                                      i);
+        dir->resort = FALSE;
+        trg_files_tree_model_sort_rows(model, dir);
+    }
+
+    g_ptr_array_set_size(priv->resortDirs, 0);
+    priv->resortSource = 0;
+
+    return FALSE;
+}
+
+/* When sorted on something which changes, directories with changes are
+ * put back in order once the current batch of them is done.
+ */
+static void
+trg_files_tree_model_queue_resort(TrgFilesTreeModel * model,
+                                  trg_files_tree_node * dir)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+
+    if (dir->resort || !dir->rows)
+        return;
+
+    switch (priv->sortColumn) {
+    case FILESCOL_PROGRESS:
+    case FILESCOL_WANTED:
+    case FILESCOL_PRIORITY:
+    case FILESCOL_BYTESCOMPLETED:
+        break;
+    default:
+        return;
+    }
+
+    dir->resort = TRUE;
+    g_ptr_array_add(priv->resortDirs, dir);
+
+    if (!priv->resortSource)
+        priv->resortSource =
+            g_idle_add(trg_files_tree_model_resort_idlefunc, model);
+}
+
+/* The directories above a change need adding up again. A directory is only
+ * signalled as it goes stale, it stays so until something reads it.
+ */
+static void
+trg_files_tree_model_parents_changed(TrgFilesTreeModel * model,
+                                     trg_files_tree_node * node)
+{
+    trg_files_tree_node *dir;
+
+    for (dir = node->parent; dir; dir = dir->parent) {
+        trg_files_tree_model_queue_resort(model, dir);
+
+        if (dir->parent && !dir->stale) {
+            dir->stale = TRUE;
+            trg_files_tree_model_node_changed(model, dir);
+        }
+    }
+}
+
+/* For after a file's progress, priority or wanted state have been changed
+ * in its node.
+ */
+void
+trg_files_tree_model_file_changed(TrgFilesTreeModel * model,
+                                  trg_files_tree_node * file)
+{
+    trg_files_tree_model_node_changed(model, file);
+    trg_files_tree_model_parents_changed(model, file);
+}
+
+static void
+trg_files_tree_model_set_node(TrgFilesTreeModel * model,
+                              trg_files_tree_node * node, gint column,
+                              gint value)
+{
+    trg_files_tree_node *child;
+
+    if (column == FILESCOL_PRIORITY)
+        node->priority = value;
+    else
+        node->enabled = value;
+
+    trg_files_tree_model_node_changed(model, node);
+
+    for (child = node->children; child; child = child->next)
+        trg_files_tree_model_set_node(model, child, column, value);
+}
+
+/* Set the priority or wanted state of a row and everything under it. */
+void
+trg_files_tree_model_set_subtree(TrgFilesTreeModel * model,
+                                 GtkTreeIter * iter, gint column,
+                                 gint value)
+{
+    trg_files_tree_node *node = (trg_files_tree_node *) iter->user_data;
+
+    g_return_if_fail(column == FILESCOL_PRIORITY
+                     || column == FILESCOL_WANTED);
+
+    trg_files_tree_model_set_node(model, node, column, value);
+    trg_files_tree_model_parents_changed(model, node);
+}
+
+/* Show another tree, or none, and take ownership of it. Only the top level
+ * rows are signalled, anything under them is found when a view expands
+ * it.
+ */
+void
+trg_files_tree_model_set_tree(TrgFilesTreeModel * model,
+                              trg_files_tree * tree)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    GtkTreeModel *tree_model = GTK_TREE_MODEL(model);
+    trg_files_tree_node *top;
+    GtkTreePath *path;
+    GtkTreeIter iter;
+    guint n_rows;
+
+    if (priv->tree) {
+        top = priv->tree->top_node;
+
+        /* From the end, so the rows before each stay where they were. */
+        while (top->n_rows > 0) {
+            path = gtk_tree_path_new_from_indices((gint) --top->n_rows,
+                                                  -1);
+            gtk_tree_model_row_deleted(tree_model, path);
+            gtk_tree_path_free(path);
+        }
+
+        trg_files_tree_free(priv->tree);
+    }
+
+    g_ptr_array_set_size(priv->resortDirs, 0);
+    priv->tree = tree;
+    priv->stamp++;
+
+    if (!tree)
+        return;
+
+    top = tree->top_node;
+    trg_files_tree_model_rows(priv, top);
+    n_rows = top->n_rows;
+
+    /* Each row is only there once it's been signalled, as if they were
+     * being added one at a time.
+     */
+    for (top->n_rows = 0; top->n_rows < n_rows;) {
+        trg_files_tree_node *node = top->rows[top->n_rows++];
+
+        trg_files_tree_model_iter_set(priv, &iter, node);
+        path = gtk_tree_path_new_from_indices((gint) node->row, -1);
+        gtk_tree_model_row_inserted(tree_model, path, &iter);
+
+        if (node->children)
+            gtk_tree_model_row_has_child_toggled(tree_model, path, &iter);
+
+        gtk_tree_path_free(path);
+    }
+}
+
+trg_files_tree *trg_files_tree_model_get_tree(TrgFilesTreeModel * model)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+    return priv->tree;
+}
+
+static gboolean
+trg_files_tree_model_get_sort_column_id(GtkTreeSortable * sortable,
+                                        gint * sort_column_id,
+                                        GtkSortType * order)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(sortable);
+
+    if (sort_column_id)
+        *sort_column_id = priv->sortColumn;
+
+    if (order)
+        *order = priv->sortOrder;
+
+    return priv->sortColumn >= 0;
+}
+
+/* Only directories which have been looked into have rows to sort, the
+ * rest are sorted as they're opened.
+ */
+static void
+trg_files_tree_model_set_sort_column_id(GtkTreeSortable * sortable,
+                                        gint sort_column_id,
+                                        GtkSortType order)
+{
+    TrgFilesTreeModel *model = TRG_FILES_TREE_MODEL(sortable);
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(model);
+
+    if (priv->sortColumn == sort_column_id && priv->sortOrder == order)
+        return;
+
+    priv->sortColumn = sort_column_id;
+    priv->sortOrder = order;
+
+    if (priv->tree) {
+        GHashTableIter iter;
+        gpointer dir;
+
+        trg_files_tree_model_sort_rows(model, priv->tree->top_node);
+
+        g_hash_table_iter_init(&iter, priv->tree->dirs);
+        while (g_hash_table_iter_next(&iter, &dir, NULL))
+            trg_files_tree_model_sort_rows(model,
+                                           (trg_files_tree_node *) dir);
+    }
+
+    gtk_tree_sortable_sort_column_changed(sortable);
+}
+
+/* Rows are sorted on their own column values, and otherwise left in the
+ * order they were added.
+ */
+static gboolean
+trg_files_tree_model_has_default_sort_func(GtkTreeSortable *
+                                           sortable G_GNUC_UNUSED)
+{
+    return FALSE;
+}
+
+static void trg_files_tree_model_finalize(GObject * object)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(object);
+
+    if (priv->resortSource)
+        g_source_remove(priv->resortSource);
+
+    if (priv->tree)
+        trg_files_tree_free(priv->tree);
+
+    g_ptr_array_free(priv->resortDirs, TRUE);
+
+    G_OBJECT_CLASS(trg_files_tree_model_parent_class)->finalize(object);
+}
+
+static void trg_files_tree_model_class_init(TrgFilesTreeModelClass * klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    g_type_class_add_private(klass, sizeof(TrgFilesTreeModelPrivate));
+    object_class->finalize = trg_files_tree_model_finalize;
+
+    trg_files_tree_model_column_types[FILESCOL_NAME] = G_TYPE_STRING;
+    trg_files_tree_model_column_types[FILESCOL_SIZE] = G_TYPE_INT64;
+    trg_files_tree_model_column_types[FILESCOL_PROGRESS] = G_TYPE_DOUBLE;
+    trg_files_tree_model_column_types[FILESCOL_ID] = G_TYPE_INT;
+    trg_files_tree_model_column_types[FILESCOL_WANTED] = G_TYPE_INT;
+    trg_files_tree_model_column_types[FILESCOL_PRIORITY] = G_TYPE_INT;
+    trg_files_tree_model_column_types[FILESCOL_BYTESCOMPLETED] =
+        G_TYPE_INT64;
+}
+
+static void trg_files_tree_model_init(TrgFilesTreeModel * self)
+{
+    TrgFilesTreeModelPrivate *priv =
+        TRG_FILES_TREE_MODEL_GET_PRIVATE(self);
+
+    priv->stamp = g_random_int();
+    priv->sortColumn = GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID;
+    priv->sortOrder = GTK_SORT_ASCENDING;
+    priv->resortDirs = g_ptr_array_new();
+}
+
+static void trg_files_tree_model_tree_model_init(GtkTreeModelIface *
+                                                 iface)
+{
+    iface->get_flags = trg_files_tree_model_get_flags;
+    iface->get_n_columns = trg_files_tree_model_get_n_columns;
+    iface->get_column_type = trg_files_tree_model_get_column_type;
+    iface->get_iter = trg_files_tree_model_get_iter;
+    iface->get_path = trg_files_tree_model_get_path;
+    iface->get_value = trg_files_tree_model_get_value;
+    iface->iter_next = trg_files_tree_model_iter_next;
+    iface->iter_previous = trg_files_tree_model_iter_previous;
+    iface->iter_children = trg_files_tree_model_iter_children;
+    iface->iter_has_child = trg_files_tree_model_iter_has_child;
+    iface->iter_n_children = trg_files_tree_model_iter_n_children;
+    iface->iter_nth_child = trg_files_tree_model_iter_nth_child;
+    iface->iter_parent = trg_files_tree_model_iter_parent;
+}
+
+static void trg_files_tree_model_tree_sortable_init(GtkTreeSortableIface *
+                                                    iface)
+{
+    iface->get_sort_column_id = trg_files_tree_model_get_sort_column_id;
+    iface->set_sort_column_id = trg_files_tree_model_set_sort_column_id;
+    iface->has_default_sort_func =
+        trg_files_tree_model_has_default_sort_func;
+}
+
+TrgFilesTreeModel *trg_files_tree_model_new(void)
+{
+    return g_object_new(TRG_TYPE_FILES_TREE_MODEL, NULL);
+}
@@ -30,6 +30,7 @@
 #include "protocol-constants.h"
 #include "trg-files-model-common.h"
 #include "trg-files-tree-view-common.h"
+#include "trg-files-tree-model.h"
 
 static void expand_all_cb(GtkWidget * w, gpointer data)
 {
@@ -141,15 +142,15 @@ onViewPathToggled(GtkTreeView * view,
                 priority = TR_PRI_NORMAL;
                 break;
             }
-            trg_files_tree_model_set_subtree(model, path, &iter, pri_id,
-                                             priority);
+            trg_files_tree_model_set_subtree(TRG_FILES_TREE_MODEL(model),
+                                             &iter, pri_id, priority);
         } else if (cid == enabled_id) {
             int enabled;
             gtk_tree_model_get(model, &iter, enabled_id, &enabled, -1);
             enabled = !enabled;
 
-            trg_files_tree_model_set_subtree(model, path, &iter,
-                                             enabled_id, enabled);
+            trg_files_tree_model_set_subtree(TRG_FILES_TREE_MODEL(model),
+                                             &iter, enabled_id, enabled);
         }
 
         handled = TRUE;
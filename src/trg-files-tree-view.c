@@ -51,38 +51,35 @@ static void trg_files_tree_view_class_init(TrgFilesTreeViewClass * klass)
     g_type_class_add_private(klass, sizeof(TrgFilesTreeViewPrivate));
 }
 
-static gboolean
-send_updated_file_prefs_foreachfunc(GtkTreeModel * model,
-                                    GtkTreePath *
-                                    path G_GNUC_UNUSED,
-                                    GtkTreeIter * iter, gpointer data)
+/* Straight from the files, going through the model would look into every
+ * directory.
+ */
+static void
+send_updated_file_prefs_add_files(JsonObject * args, trg_files_tree * tree)
 {
-    JsonObject *args = (JsonObject *) data;
-    gint priority;
-    gint id;
-    gint wanted;
-
-    gtk_tree_model_get(model, iter, FILESCOL_ID, &id, -1);
-
-    if (id < 0)
-        return FALSE;
-
-    gtk_tree_model_get(model, iter, FILESCOL_WANTED, &wanted,
-                       FILESCOL_PRIORITY, &priority, -1);
-
-    if (wanted)
-        add_file_id_to_array(args, FIELD_FILES_WANTED, id);
-    else
-        add_file_id_to_array(args, FIELD_FILES_UNWANTED, id);
-
-    if (priority == TR_PRI_LOW)
-        add_file_id_to_array(args, FIELD_FILES_PRIORITY_LOW, id);
-    else if (priority == TR_PRI_HIGH)
-        add_file_id_to_array(args, FIELD_FILES_PRIORITY_HIGH, id);
-    else
-        add_file_id_to_array(args, FIELD_FILES_PRIORITY_NORMAL, id);
-
-    return FALSE;
+    guint i;
+
+    for (i = 0; tree && i < tree->files->len; i++) {
+        trg_files_tree_node *file = g_ptr_array_index(tree->files, i);
+
+        if (!file)
+            continue;
+
+        if (file->enabled)
+            add_file_id_to_array(args, FIELD_FILES_WANTED, file->index);
+        else
+            add_file_id_to_array(args, FIELD_FILES_UNWANTED, file->index);
+
+        if (file->priority == TR_PRI_LOW)
+            add_file_id_to_array(args, FIELD_FILES_PRIORITY_LOW,
+                                 file->index);
+        else if (file->priority == TR_PRI_HIGH)
+            add_file_id_to_array(args, FIELD_FILES_PRIORITY_HIGH,
+                                 file->index);
+        else
+            add_file_id_to_array(args, FIELD_FILES_PRIORITY_NORMAL,
+                                 file->index);
+    }
 }
 
 static gboolean on_files_update(gpointer data)
@@ -117,8 +114,9 @@ static void send_updated_file_prefs(TrgFilesTreeView * tv)
     req = torrent_set(targetIdArray);
     args = node_get_arguments(req);
 
-    gtk_tree_model_foreach(model, send_updated_file_prefs_foreachfunc,
-                           args);
+    send_updated_file_prefs_add_files(args,
+                                      trg_files_tree_model_get_tree
+                                      (TRG_FILES_TREE_MODEL(model)));
 
     trg_files_model_set_accept(TRG_FILES_MODEL(model), FALSE);
 
@@ -17,8 +17,13 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-/* This is the stuff common between both files trees, built up before
- * populating the model.
+/* This is the stuff common between both files trees, which
+ * TrgFilesTreeModel shows as it is rather than copying into a store.
+ *
+ * Nodes come from blocks rather than one allocation each, and names from a
+ * string chunk. Directory names repeat a lot (every file in a directory
+ * has the whole path), so those are interned, which also lets directories
+ * be found by pointer in a single table keyed on parent and name.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -32,26 +37,147 @@
 
 #include "trg-files-tree.h"
 
-void trg_files_tree_node_add_child(trg_files_tree_node* node, trg_files_tree_node* child)
+#define TRG_FILES_TREE_BLOCK_SIZE 512
+#define TRG_FILES_TREE_NAMES_CHUNK_SIZE 16384
+
+static guint trg_files_tree_dir_hash(gconstpointer key)
+{
+    const trg_files_tree_node *node = (const trg_files_tree_node *) key;
+    return g_direct_hash(node->parent) ^ g_direct_hash(node->name);
+}
+
+static gboolean trg_files_tree_dir_equal(gconstpointer a, gconstpointer b)
+{
+    const trg_files_tree_node *x = (const trg_files_tree_node *) a;
+    const trg_files_tree_node *y = (const trg_files_tree_node *) b;
+    return x->parent == y->parent && x->name == y->name;
+}
+
+static trg_files_tree_node *trg_files_tree_node_new(trg_files_tree * tree)
+{
+    trg_files_tree_node *block;
+
+    if (!tree->blocks || tree->blockUsed == TRG_FILES_TREE_BLOCK_SIZE) {
+        tree->blocks = g_slist_prepend(tree->blocks,
+                                       g_new0(trg_files_tree_node,
+                                              TRG_FILES_TREE_BLOCK_SIZE));
+        tree->blockUsed = 0;
+    }
+
+    block = (trg_files_tree_node *) tree->blocks->data;
+    return &block[tree->blockUsed++];
+}
+
+trg_files_tree *trg_files_tree_new(void)
+{
+    trg_files_tree *tree = g_new0(trg_files_tree, 1);
+
+    tree->names = g_string_chunk_new(TRG_FILES_TREE_NAMES_CHUNK_SIZE);
+    tree->dirs = g_hash_table_new(trg_files_tree_dir_hash,
+                                  trg_files_tree_dir_equal);
+    tree->files = g_ptr_array_new();
+    tree->scratch = g_string_new(NULL);
+    tree->top_node = trg_files_tree_node_new(tree);
+    tree->top_node->index = -1;
+    tree->top_node->stale = TRUE;
+
+    return tree;
+}
+
+void trg_files_tree_free(trg_files_tree * tree)
+{
+    GHashTableIter iter;
+    gpointer dir;
+
+    /* Only directories have rows. */
+    g_hash_table_iter_init(&iter, tree->dirs);
+    while (g_hash_table_iter_next(&iter, &dir, NULL))
+        g_free(((trg_files_tree_node *) dir)->rows);
+    g_free(tree->top_node->rows);
+
+    g_slist_free_full(tree->blocks, g_free);
+    g_hash_table_destroy(tree->dirs);
+    g_ptr_array_free(tree->files, TRUE);
+    g_string_chunk_free(tree->names);
+    g_string_free(tree->scratch, TRUE);
+    g_free(tree);
+}
+
+static void
+trg_files_tree_add_child(trg_files_tree_node * parent,
+                         trg_files_tree_node * child)
+{
+    child->parent = parent;
+    child->next = parent->children;
+    parent->children = child;
+}
+
+/* Directories start out stale, their sizes and whether their files share
+ * a priority are only worked out when something asks.
+ *
+ * Find or create a directory. Files are usually listed a directory at a
+ * time, so the last child added is checked before the table.
+ */
+trg_files_tree_node *trg_files_tree_add_dir(trg_files_tree * tree,
+                                            trg_files_tree_node * parent,
+                                            const gchar * name)
+{
+    trg_files_tree_node key, *dir;
+
+    key.parent = parent;
+    key.name = g_string_chunk_insert_const(tree->names, name);
+
+    if (parent->children && parent->children->name == key.name
+        && parent->children->index < 0)
+        return parent->children;
+
+    dir = g_hash_table_lookup(tree->dirs, &key);
+    if (!dir) {
+        dir = trg_files_tree_node_new(tree);
+        dir->name = key.name;
+        dir->index = -1;
+        dir->stale = TRUE;
+        trg_files_tree_add_child(parent, dir);
+        g_hash_table_add(tree->dirs, dir);
+    }
+
+    return dir;
+}
+
+trg_files_tree_node *trg_files_tree_add_file(trg_files_tree * tree,
+                                             trg_files_tree_node * parent,
+                                             const gchar * name,
+                                             gint index)
 {
-  if (!node->childrenHash) {
-    node->childrenHash = g_hash_table_new(g_str_hash, g_str_equal);
-  }
-  g_hash_table_insert(node->childrenHash, child->name, child);
-  node->children = g_list_append(node->children, child);
+    trg_files_tree_node *file = trg_files_tree_node_new(tree);
+
+    file->name = g_string_chunk_insert(tree->names, name);
+    file->index = index;
+    trg_files_tree_add_child(parent, file);
+
+    if (index >= 0) {
+        if ((guint) index >= tree->files->len)
+            g_ptr_array_set_size(tree->files, index + 1);
+        g_ptr_array_index(tree->files, index) = file;
+    }
+
+    return file;
 }
 
-void trg_files_tree_node_free(trg_files_tree_node * node)
+/* Add a file by its path within the torrent, separated by slashes. */
+trg_files_tree_node *trg_files_tree_add_path(trg_files_tree * tree,
+                                             const gchar * path,
+                                             gint index)
 {
-    GList *li;
+    trg_files_tree_node *parent = tree->top_node;
+    const gchar *slash;
 
-    for (li = node->children; li; li = g_list_next(li))
-        trg_files_tree_node_free((trg_files_tree_node *) li->data);
+    while ((slash = strchr(path, '/'))) {
+        g_string_truncate(tree->scratch, 0);
+        g_string_append_len(tree->scratch, path, slash - path);
+        parent = trg_files_tree_add_dir(tree, parent, tree->scratch->str);
+        path = slash + 1;
+    }
 
-    if (node->childrenHash)
-      g_hash_table_destroy(node->childrenHash);
-    
-    g_list_free(node->children);
-    g_free(node->name);
-    g_free(node);
+    return trg_files_tree_add_file(tree, parent, path, index);
 }
@@ -23,21 +23,51 @@
 #include <glib.h>
 #include <json-glib/json-glib.h>
 
-#include "trg-files-tree.h"
+typedef struct _trg_files_tree_node trg_files_tree_node;
 
-typedef struct {
+struct _trg_files_tree_node {
     gchar *name;
     gint64 length;
     gint64 bytesCompleted;
-    GList *children;
-    GHashTable *childrenHash;
+    /* Most recently added first. */
+    trg_files_tree_node *children;
+    trg_files_tree_node *next;
     gint index;
-    gpointer parent;
+    trg_files_tree_node *parent;
     gint priority;
     gint enabled;
-} trg_files_tree_node;
+    /* Kept by TrgFilesTreeModel as the tree is browsed. */
+    trg_files_tree_node **rows; /* the children in the order shown */
+    guint n_rows;
+    guint row;                  /* position in the parent's rows */
+    gboolean stale;             /* a directory's totals need adding up */
+    gboolean resort;            /* queued to put its rows back in order */
+};
+
+/* A tree of files and the directories they're in. The nodes and names are
+ * allocated in blocks owned by the tree and freed all together.
+ */
+typedef struct {
+    trg_files_tree_node *top_node;
+    GStringChunk *names;
+    GHashTable *dirs;
+    GPtrArray *files;           /* by index */
+    GSList *blocks;
+    guint blockUsed;
+    GString *scratch;
+} trg_files_tree;
 
-void trg_files_tree_node_add_child(trg_files_tree_node* node, trg_files_tree_node* child);
-void trg_files_tree_node_free(trg_files_tree_node * node);
+trg_files_tree *trg_files_tree_new(void);
+void trg_files_tree_free(trg_files_tree * tree);
+trg_files_tree_node *trg_files_tree_add_dir(trg_files_tree * tree,
+                                            trg_files_tree_node * parent,
+                                            const gchar * name);
+trg_files_tree_node *trg_files_tree_add_file(trg_files_tree * tree,
+                                             trg_files_tree_node * parent,
+                                             const gchar * name,
+                                             gint index);
+trg_files_tree_node *trg_files_tree_add_path(trg_files_tree * tree,
+                                             const gchar * path,
+                                             gint index);
 
-#endif                          /* TRG_FILES_MODEL_H_ */
+#endif                          /* TRG_FILES_TREE_H_ */
@@ -118,7 +118,8 @@ static void trg_general_panel_class_init(TrgGeneralPanelClass * klass)
 }
 
 void
-trg_general_panel_update(TrgGeneralPanel * panel, JsonObject * t,
+trg_general_panel_update(TrgGeneralPanel * panel,
+                         const trg_torrent_record * rec,
                          GtkTreeIter * iter)
 {
     TrgGeneralPanelPrivate *priv;
@@ -127,46 +128,44 @@ trg_general_panel_update(TrgGeneralPanel * panel, JsonObject * t,
     const gchar *errorStr;
     gint64 eta, uploaded, corrupted, haveValid, completedAt;
     GtkLabel *keyLabel;
-    gint64 seeders = 0, leechers = 0;
+    gint64 seeders = rec->seeders, leechers = rec->leechers;
 
     priv = TRG_GENERAL_PANEL_GET_PRIVATE(panel);
 
     gtk_tree_model_get(GTK_TREE_MODEL(priv->model), iter,
-                       TORRENT_COLUMN_SEEDS, &seeders,
-                       TORRENT_COLUMN_LEECHERS, &leechers,
                        TORRENT_COLUMN_STATUS, &statusString, -1);
 
-    trg_strlsize(buf, torrent_get_size_when_done(t));
+    trg_strlsize(buf, rec->sizeWhenDone);
     gtk_label_set_text(GTK_LABEL(priv->gen_size_label), buf);
 
-	trg_strlspeed(buf, torrent_get_rate_down(t) / disk_K);
-	if (torrent_get_download_limited(t)){
-		trg_strlspeed(buf1, torrent_get_download_limit(t));
+	trg_strlspeed(buf, rec->rateDownload / disk_K);
+	if (rec->downloadLimited){
+		trg_strlspeed(buf1, rec->downloadLimit);
 		speed = g_strdup_printf("%s [%s]", buf, buf1);
 	} else
 		speed = g_strdup_printf("%s", buf);
     gtk_label_set_text(GTK_LABEL(priv->gen_down_rate_label), speed);
     g_free(speed);
 
-	trg_strlspeed(buf, torrent_get_rate_up(t) / disk_K);
-    if (torrent_get_upload_limited(t)){
-		trg_strlspeed(buf1, torrent_get_upload_limit(t));
+	trg_strlspeed(buf, rec->rateUpload / disk_K);
+    if (rec->uploadLimited){
+		trg_strlspeed(buf1, rec->uploadLimit);
 		speed = g_strdup_printf("%s [%s]", buf, buf1);	
 	} else
 		speed = g_strdup_printf("%s", buf);
     gtk_label_set_text(GTK_LABEL(priv->gen_up_rate_label), speed);
 	g_free(speed);
 
-	corrupted = torrent_get_corrupted(t);
+	corrupted = rec->corruptEver;
 	trg_strlsize(buf, corrupted);
 	gtk_label_set_text(GTK_LABEL(priv->gen_corrupted_label), buf);
 
-    uploaded = torrent_get_uploaded(t);
+    uploaded = rec->uploadedEver;
     trg_strlsize(buf, uploaded);
     gtk_label_set_text(GTK_LABEL(priv->gen_uploaded_label), buf);
 
-    haveValid = torrent_get_have_valid(t);
-    trg_strlsize(buf, torrent_get_downloaded(t));
+    haveValid = rec->haveValid;
+    trg_strlsize(buf, rec->downloadedEver);
     gtk_label_set_text(GTK_LABEL(priv->gen_downloaded_label), buf);
 
     if (uploaded > 0 && haveValid > 0) {
@@ -176,10 +175,10 @@ trg_general_panel_update(TrgGeneralPanel * panel, JsonObject * t,
         gtk_label_set_text(GTK_LABEL(priv->gen_ratio_label), _("N/A"));
     }
 
-	trg_strlratio(buf, torrent_get_seed_ratio_limit(t));
+	trg_strlratio(buf, rec->seedRatioLimit);
 	gtk_label_set_text(GTK_LABEL(priv->gen_limit_label), buf);
 
-    completedAt = torrent_get_done_date(t);
+    completedAt = rec->doneDate;
     if (completedAt > 0) {
         completedAtString = epoch_to_string(completedAt);
         gtk_label_set_text(GTK_LABEL(priv->gen_completedat_label),
@@ -190,14 +189,14 @@ trg_general_panel_update(TrgGeneralPanel * panel, JsonObject * t,
     }
 
     fullStatusString = g_strdup_printf("%s %s", statusString,
-                                       torrent_get_is_private(t) ?
+                                       rec->isPrivate ?
                                        _("(Private)") : _("(Public)"));
     gtk_label_set_text(GTK_LABEL(priv->gen_status_label),
                        fullStatusString);
     g_free(fullStatusString);
     g_free(statusString);
 
-	switch(torrent_get_bandwidth_priority(t)){
+	switch(rec->bandwidthPriority){
 		case TR_PRI_LOW:
 			gtk_label_set_text(GTK_LABEL(priv->gen_priority_label), _("Low"));
 			break;
@@ -209,20 +208,20 @@ trg_general_panel_update(TrgGeneralPanel * panel, JsonObject * t,
 			break;
 	}
 
-    trg_strlpercent(buf, torrent_get_percent_done(t));
+    trg_strlpercent(buf, rec->percentDone);
     gtk_label_set_text(GTK_LABEL(priv->gen_completed_label), buf);
 
     gtk_label_set_text(GTK_LABEL(priv->gen_name_label),
-                       torrent_get_name(t));
+                       rec->name);
 
     gtk_label_set_text(GTK_LABEL(priv->gen_downloaddir_label),
-                       torrent_get_download_dir(t));
+                       rec->downloadDir);
 
-    comment = add_links_to_text(torrent_get_comment(t));
+    comment = add_links_to_text(rec->comment ? rec->comment : "");
     gtk_label_set_markup(GTK_LABEL(priv->gen_comment_label), comment);
     g_free(comment);
 
-    errorStr = torrent_get_errorstr(t);
+    errorStr = rec->errorString ? rec->errorString : "";
     keyLabel =
         gen_panel_label_get_key_label(GTK_LABEL(priv->gen_error_label));
     if (strlen(errorStr) > 0) {
@@ -243,7 +242,7 @@ trg_general_panel_update(TrgGeneralPanel * panel, JsonObject * t,
         gtk_label_clear(keyLabel);
     }
 
-    if ((eta = torrent_get_eta(t)) > 0) {
+    if ((eta = rec->eta) > 0) {
         tr_strltime_long(buf, eta, sizeof(buf));
         gtk_label_set_text(GTK_LABEL(priv->gen_eta_label), buf);
     } else {
@@ -54,7 +54,8 @@ TrgGeneralPanel *trg_general_panel_new(GtkTreeModel * model,
                                        TrgClient * tc);
 
 G_END_DECLS
-    void trg_general_panel_update(TrgGeneralPanel * panel, JsonObject * t,
+    void trg_general_panel_update(TrgGeneralPanel * panel,
+                                  const trg_torrent_record * rec,
                                   GtkTreeIter * iter);
 void trg_general_panel_clear(TrgGeneralPanel * panel);
 
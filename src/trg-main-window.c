@@ -73,6 +73,7 @@
 #include "trg-menu-bar.h"
 #include "trg-status-bar.h"
 #include "trg-stats-dialog.h"
+#include "trg-diagnostics-dialog.h"
 #ifdef HAVE_RSS
 #include "trg-rss-window.h"
 #endif
@@ -131,6 +132,7 @@ static gint confirm_action_dialog(GtkWindow * gtk_win,
                                   const gchar * question_multi,
                                   const gchar * action_stock);
 static void view_stats_toggled_cb(GtkWidget * w, gpointer data);
+static void view_diagnostics_cb(GtkWidget * w, gpointer data);
 static void view_states_toggled_cb(GtkCheckMenuItem * w,
                                    TrgMainWindow * win);
 static void view_notebook_toggled_cb(GtkCheckMenuItem * w,
@@ -143,6 +145,7 @@ static gboolean on_torrent_get_first(gpointer data);
 static gboolean on_torrent_get_active(gpointer data);
 static gboolean on_torrent_get_update(gpointer data);
 static gboolean on_torrent_get_interactive(gpointer data);
+static gboolean on_torrent_get_selected(gpointer data);
 static gboolean trg_session_update_timerfunc(gpointer data);
 static gboolean trg_update_torrents_timerfunc(gpointer data);
 static void open_about_cb(GtkWidget * w, GtkWindow * parent);
@@ -152,8 +155,6 @@ static gboolean trg_torrent_tree_view_visible_func(GtkTreeModel * model,
 static TrgTorrentTreeView
     * trg_main_window_torrent_tree_view_new(TrgMainWindow * win,
                                             GtkTreeModel * model);
-static gboolean trg_dialog_error_handler(TrgMainWindow * win,
-                                         trg_response * response);
 static gboolean torrent_selection_changed(GtkTreeSelection * selection,
                                           TrgMainWindow * win);
 static void trg_main_window_torrent_scrub(TrgMainWindow * win);
@@ -237,6 +238,7 @@ typedef struct
     GtkTreeModel *filteredTorrentModel;
     GtkTreeModel *sortedTorrentModel;
     gint selectedTorrentId;
+    gint detailsTorrentId;
 
     TrgTrackersModel *trackersModel;
     TrgTrackersTreeView *trackersTreeView;
@@ -247,9 +249,7 @@ typedef struct
     TrgPeersModel *peersModel;
     TrgPeersTreeView *peersTreeView;
 
-#if TRG_WITH_GRAPH
     TrgTorrentGraph *graph;
-#endif
     gint graphNotebookIndex;
 
     GtkWidget *hpaned, *vpaned;
@@ -259,6 +259,10 @@ typedef struct
     gint width, height;
     guint timerId;
     guint sessionTimerId;
+    guint idlePolls;
+    gint64 lastFullSync;
+    guint stalePanels;
+    GList *propsDialogs;
     gboolean min_on_start;
     gboolean queuesEnabled;
 
@@ -290,28 +294,128 @@ gint trg_mw_get_selected_torrent_id(TrgMainWindow * win)
     return priv->selectedTorrentId;
 }
 
+/* The notebook panels which are only updated while they're showing. */
+#define TRG_PANEL_TRACKERS (1 << 0)
+#define TRG_PANEL_FILES    (1 << 1)
+#define TRG_PANEL_PEERS    (1 << 2)
+#define TRG_PANEL_ALL      (TRG_PANEL_TRACKERS | TRG_PANEL_FILES \
+                            | TRG_PANEL_PEERS)
+
+static gboolean trg_main_window_panels_showing(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    return !priv->hidden && gtk_widget_get_visible(priv->notebook);
+}
+
+static gboolean
+trg_main_window_panel_showing(TrgMainWindow * win, GtkWidget * panel)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    GtkNotebook *notebook = GTK_NOTEBOOK(priv->notebook);
+    GtkWidget *page;
+
+    if (!trg_main_window_panels_showing(win))
+        return FALSE;
+
+    page = gtk_notebook_get_nth_page(notebook,
+                                     gtk_notebook_get_current_page
+                                     (notebook));
+
+    return page && gtk_widget_is_ancestor(panel, page);
+}
+
+/* A panel which has missed updates, or has another torrent in it, has to
+ * be filled in from scratch. Returns FALSE if the panel isn't showing, and
+ * marks it as having missed this update.
+ */
+static gboolean
+trg_main_window_panel_mode(TrgMainWindow * win, GtkWidget * panel,
+                           guint panelBit, gint64 id, gint * mode)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    if (!trg_main_window_panel_showing(win, panel)) {
+        priv->stalePanels |= panelBit;
+        return FALSE;
+    }
+
+    if (priv->stalePanels & panelBit)
+        *mode = TORRENT_GET_MODE_FIRST;
+
+    priv->stalePanels &= ~panelBit;
+
+    return TRUE;
+}
+
 static void
 update_selected_torrent_notebook(TrgMainWindow * win, gint mode, gint64 id)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     TrgClient *client = priv->client;
     gint64 serial = trg_client_get_serial(client);
-    JsonObject *t;
+    const trg_torrent_record *rec;
+    const trg_torrent_details *details;
     GtkTreeIter iter;
 
     if (id >= 0
-        && get_torrent_data(trg_client_get_torrent_table(client), id, &t,
-                            &iter)) {
+        && trg_torrent_model_get_iter_by_id(priv->torrentModel, id,
+                                            &iter)) {
         trg_toolbar_torrent_actions_sensitive(priv->toolBar, TRUE);
         trg_menu_bar_torrent_actions_sensitive(priv->menuBar, TRUE);
-        trg_general_panel_update(priv->genDetails, t, &iter);
-        trg_trackers_model_update(priv->trackersModel, serial, t, mode);
-        trg_files_model_update(priv->filesModel,
-                               GTK_TREE_VIEW(priv->filesTreeView),
-                               serial, t, mode);
-        trg_peers_model_update(priv->peersModel,
-                               TRG_TREE_VIEW(priv->peersTreeView),
-                               serial, t, mode);
+
+        gint detailsMode;
+
+        /* Another torrent, so leave the panels empty until its details
+         * arrive, and then fill them in from scratch.
+         */
+        if (priv->detailsTorrentId != id) {
+            trg_files_model_clear(priv->filesModel);
+            gtk_list_store_clear(GTK_LIST_STORE(priv->trackersModel));
+            gtk_list_store_clear(GTK_LIST_STORE(priv->peersModel));
+            trg_general_panel_clear(priv->genDetails);
+            priv->stalePanels |= TRG_PANEL_ALL;
+            priv->detailsTorrentId = id;
+        }
+
+        rec = trg_torrent_model_get_record(priv->torrentModel, id);
+        details = trg_torrent_model_get_details(priv->torrentModel, id);
+
+        /* Each panel needs its own field set, which is only fetched while
+         * it's showing. The record keeps the detail set from the last
+         * fetch, but the arrays are only there after a details response.
+         */
+        if (rec->fetched & TORRENT_FIELD_BIT(TORRENT_FIELD_COMMENT))
+            trg_general_panel_update(priv->genDetails, rec, &iter);
+
+        detailsMode = mode;
+        if (details && details->trackerStats
+            && trg_main_window_panel_mode(win,
+                                          GTK_WIDGET
+                                          (priv->trackersTreeView),
+                                          TRG_PANEL_TRACKERS, id,
+                                          &detailsMode))
+            trg_trackers_model_update(priv->trackersModel, serial,
+                                      details, detailsMode);
+
+        detailsMode = mode;
+        if (details && details->files
+            && trg_main_window_panel_mode(win,
+                                          GTK_WIDGET(priv->filesTreeView),
+                                          TRG_PANEL_FILES, id,
+                                          &detailsMode))
+            trg_files_model_update(priv->filesModel,
+                                   GTK_TREE_VIEW(priv->filesTreeView),
+                                   serial, details, detailsMode);
+
+        detailsMode = mode;
+        if (details && details->peers
+            && trg_main_window_panel_mode(win,
+                                          GTK_WIDGET(priv->peersTreeView),
+                                          TRG_PANEL_PEERS, id,
+                                          &detailsMode))
+            trg_peers_model_update(priv->peersModel,
+                                   TRG_TREE_VIEW(priv->peersTreeView),
+                                   serial, details, detailsMode);
     } else {
         trg_main_window_torrent_scrub(win);
     }
@@ -319,6 +423,119 @@ update_selected_torrent_notebook(TrgMainWindow * win, gint mode, gint64 id)
     priv->selectedTorrentId = id;
 }
 
+/*
+ * The fields to poll for every torrent. As well as whatever the showing
+ * columns need, the state selector and its tracker filter need trackers.
+ */
+static guint trg_main_window_get_field_sets(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    guint fieldSets =
+        trg_torrent_tree_view_get_field_sets(priv->torrentTreeView);
+
+    if (trg_state_selector_get_show_trackers(priv->stateSelector))
+        fieldSets |= TORRENT_GET_FIELDS_TRACKERSTATS;
+
+    return fieldSets;
+}
+
+/* Whether an open properties dialog before the given one, or any if it's
+ * NULL, shows the details of this torrent. */
+static gboolean
+trg_main_window_props_showing(TrgMainWindow * win, gint64 id,
+                              GList * before)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    GList *li;
+
+    for (li = priv->propsDialogs; li && li != before; li = g_list_next(li))
+        if (trg_torrent_props_dialog_get_details_id
+            (TRG_TORRENT_PROPS_DIALOG(li->data)) == id)
+            return TRUE;
+
+    return FALSE;
+}
+
+/* The field sets which the showing notebook panel, if it has this torrent,
+ * and the showing pages of any properties dialogs for it need. None if
+ * nothing is showing its details.
+ */
+static guint
+trg_main_window_get_detail_field_sets(TrgMainWindow * win, gint64 id)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    guint fieldSets = 0;
+    GList *li;
+
+    if (id == priv->selectedTorrentId) {
+        if (trg_main_window_panel_showing(win,
+                                          GTK_WIDGET(priv->genDetails)))
+            fieldSets |= TORRENT_GET_FIELDS_DETAIL
+                | TORRENT_GET_FIELDS_PRIORITY | TORRENT_GET_FIELDS_DATES;
+        else if (trg_main_window_panel_showing(win,
+                                               GTK_WIDGET
+                                               (priv->trackersTreeView)))
+            fieldSets |= TORRENT_GET_FIELDS_TRACKERSTATS;
+        else if (trg_main_window_panel_showing(win,
+                                               GTK_WIDGET
+                                               (priv->filesTreeView)))
+            fieldSets |= TORRENT_GET_FIELDS_FILES;
+        else if (trg_main_window_panel_showing(win,
+                                               GTK_WIDGET
+                                               (priv->peersTreeView)))
+            fieldSets |= TORRENT_GET_FIELDS_PEERS;
+    }
+
+    for (li = priv->propsDialogs; li; li = g_list_next(li)) {
+        TrgTorrentPropsDialog *dialog = TRG_TORRENT_PROPS_DIALOG(li->data);
+        if (trg_torrent_props_dialog_get_details_id(dialog) == id)
+            fieldSets |= trg_torrent_props_dialog_get_field_sets(dialog);
+    }
+
+    return fieldSets ? fieldSets | TORRENT_GET_FIELDS_LIST : 0;
+}
+
+static void trg_main_window_get_details(TrgMainWindow * win, gint64 id)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    guint fieldSets = trg_main_window_get_detail_field_sets(win, id);
+
+    if (fieldSets)
+        dispatch_async_prepared(priv->client,
+                                torrent_get_fields(id, fieldSets),
+                                trg_torrent_model_prepare,
+                                priv->torrentModel,
+                                on_torrent_get_selected, win);
+}
+
+/*
+ * Polling only asks for the list field set, so follow it up with a request
+ * for the details of the selected torrent, and of any torrent with a
+ * properties dialog open, but only the fields their showing panels and pages
+ * need. on_torrent_get_selected() refreshes their rows, which the dialogs
+ * update from, and the notebook panels.
+ */
+void trg_main_window_get_selected_details(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    GList *li;
+
+    if (!trg_client_is_connected(priv->client))
+        return;
+
+    if (priv->selectedTorrentId >= 0)
+        trg_main_window_get_details(win, priv->selectedTorrentId);
+
+    for (li = priv->propsDialogs; li; li = g_list_next(li)) {
+        gint64 id = trg_torrent_props_dialog_get_details_id
+            (TRG_TORRENT_PROPS_DIALOG(li->data));
+
+        if (id >= 0 && id != priv->selectedTorrentId
+            && !trg_main_window_props_showing(win, id, li))
+            trg_main_window_get_details(win, id);
+    }
+}
+
 #ifdef HAVE_LIBNOTIFY
 static void
 torrent_event_notification(TrgTorrentModel * model,
@@ -433,6 +650,14 @@ destroy_window(TrgMainWindow * win, gpointer data G_GNUC_UNUSED)
 #endif
 }
 
+static void props_dialog_destroyed_cb(TrgMainWindow * win,
+                                      GtkWidget * dialog)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    priv->propsDialogs = g_list_remove(priv->propsDialogs, dialog);
+}
+
 static void open_props_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
@@ -446,21 +671,34 @@ static void open_props_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
                                           priv->torrentModel,
                                           priv->client);
 
+    /* Keep its torrent's details coming, whether or not the notebook is
+     * showing them. */
+    priv->propsDialogs = g_list_prepend(priv->propsDialogs, dialog);
+    g_signal_connect_object(dialog, "destroy",
+                            G_CALLBACK(props_dialog_destroyed_cb), win,
+                            G_CONNECT_SWAPPED);
+
     gtk_widget_show_all(GTK_WIDGET(dialog));
+
+    if (trg_torrent_props_dialog_get_details_id(dialog) >= 0)
+        trg_main_window_get_details(win,
+                                    trg_torrent_props_dialog_get_details_id
+                                    (dialog));
 }
 
 static void copy_magnetlink_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
-    JsonObject *json = NULL;
+    const trg_torrent_record *rec;
     GtkClipboard *clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
 
     if (priv->selectedTorrentId < 0)
         return;
 
-    if(get_torrent_data(trg_client_get_torrent_table(priv->client),
-                priv->selectedTorrentId, &json, NULL))
-        gtk_clipboard_set_text(clip, torrent_get_magnetlink(json), -1);
+    rec = trg_torrent_model_get_record(priv->torrentModel,
+                                       priv->selectedTorrentId);
+    if (rec && rec->magnetLink)
+        gtk_clipboard_set_text(clip, rec->magnetLink, -1);
 }
 
 static void
@@ -960,6 +1198,16 @@ static void view_stats_toggled_cb(GtkWidget * w, gpointer data)
     }
 }
 
+static void view_diagnostics_cb(GtkWidget * w, gpointer data)
+{
+    TrgMainWindow *win = TRG_MAIN_WINDOW(data);
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgDiagnosticsDialog *dlg =
+        trg_diagnostics_dialog_get_instance(win, priv->client);
+
+    gtk_widget_show_all(GTK_WIDGET(dlg));
+}
+
 #ifdef HAVE_RSS
 static void view_rss_toggled_cb(GtkWidget * w, gpointer data)
 {
@@ -985,6 +1233,33 @@ view_states_toggled_cb(GtkCheckMenuItem * w, TrgMainWindow * win)
                            gtk_check_menu_item_get_active(w));
 }
 
+/* Catch up a panel which has missed updates while it wasn't showing, from
+ * what's known now and then from fresh details.
+ */
+static void trg_main_window_panels_refresh(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    if (priv->selectedTorrentId < 0
+        || !trg_main_window_panels_showing(win))
+        return;
+
+    if (priv->stalePanels)
+        update_selected_torrent_notebook(win, TORRENT_GET_MODE_UPDATE,
+                                         priv->selectedTorrentId);
+
+    trg_main_window_get_selected_details(win);
+}
+
+static void
+trg_main_window_page_switched_cb(GtkNotebook * notebook G_GNUC_UNUSED,
+                                 GtkWidget * page G_GNUC_UNUSED,
+                                 guint page_num G_GNUC_UNUSED,
+                                 TrgMainWindow * win)
+{
+    trg_main_window_panels_refresh(win);
+}
+
 static void
 view_notebook_toggled_cb(GtkCheckMenuItem * w, TrgMainWindow * win)
 {
@@ -992,9 +1267,9 @@ view_notebook_toggled_cb(GtkCheckMenuItem * w, TrgMainWindow * win)
 
     trg_widget_set_visible(priv->notebook,
                            gtk_check_menu_item_get_active(w));
+    trg_main_window_panels_refresh(win);
 }
 
-#if TRG_WITH_GRAPH
 static void
 trg_main_window_toggle_graph_cb(GtkCheckMenuItem * w, gpointer data)
 {
@@ -1010,13 +1285,13 @@ trg_main_window_toggle_graph_cb(GtkCheckMenuItem * w, gpointer data)
         trg_main_window_remove_graph(TRG_MAIN_WINDOW(win));
     }
 }
-#endif
 
 void
 trg_main_window_notebook_set_visible(TrgMainWindow * win, gboolean visible)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     trg_widget_set_visible(priv->notebook, visible);
+    trg_main_window_panels_refresh(win);
 }
 
 static GtkWidget *trg_main_window_notebook_new(TrgMainWindow * win)
@@ -1064,13 +1339,15 @@ static GtkWidget *trg_main_window_notebook_new(TrgMainWindow * win)
                                                 (priv->peersTreeView)),
                              gtk_label_new(_("Peers")));
 
-#if TRG_WITH_GRAPH
     if (trg_prefs_get_bool
         (prefs, TRG_PREFS_KEY_SHOW_GRAPH, TRG_PREFS_GLOBAL))
         trg_main_window_add_graph(win, FALSE);
     else
         priv->graphNotebookIndex = -1;
-#endif
+
+    g_signal_connect_after(notebook, "switch-page",
+                           G_CALLBACK(trg_main_window_page_switched_cb),
+                           win);
 
     return notebook;
 }
@@ -1194,8 +1471,13 @@ TRANSMISSION_MIN_SUPPORTED, version);
         trg_main_window_conn_changed(win, TRUE);
         trg_trackers_tree_view_new_connection(priv->trackersTreeView,
                                               client);
-        dispatch_async(client, torrent_get(TORRENT_GET_TAG_MODE_FULL),
-                       on_torrent_get_first, win);
+        dispatch_async_prepared(client,
+                                torrent_get_fields
+                                (TORRENT_GET_TAG_MODE_FULL,
+                                 trg_main_window_get_field_sets(win)),
+                                trg_torrent_model_prepare,
+                                priv->torrentModel, on_torrent_get_first,
+                                win);
     }
 
     trg_response_free(response);
@@ -1271,6 +1553,55 @@ update_whatever_statusicon(TrgMainWindow * win,
     }
 }
 
+/* While nothing is changing, the polling interval doubles each time up to
+ * this many times, though not past TRG_POLL_IDLE_CEILING seconds unless the
+ * interval itself is longer.
+ */
+#define TRG_POLL_BACKOFF_MAX   4
+#define TRG_POLL_IDLE_CEILING  60
+
+static guint trg_main_window_base_interval(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgPrefs *prefs = trg_client_get_prefs(priv->client);
+    gint interval =
+        gtk_widget_get_visible(GTK_WIDGET(win)) ? trg_prefs_get_int(prefs,
+                                                                    TRG_PREFS_KEY_UPDATE_INTERVAL,
+                                                                    TRG_PREFS_CONNECTION)
+        : trg_prefs_get_int(prefs, TRG_PREFS_KEY_MINUPDATE_INTERVAL,
+                            TRG_PREFS_CONNECTION);
+
+    return interval < 1 ? TRG_INTERVAL_DEFAULT : (guint) interval;
+}
+
+static guint trg_main_window_poll_interval(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    guint base = trg_main_window_base_interval(win);
+    guint interval =
+        base << MIN(priv->idlePolls, TRG_POLL_BACKOFF_MAX);
+
+    return MIN(interval, MAX(base, TRG_POLL_IDLE_CEILING));
+}
+
+/* After the user has done something, go back to polling at the configured
+ * interval, and bring forward a poll which has backed off.
+ */
+static void trg_main_window_poll_soon(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    gboolean backedOff = priv->idlePolls > 0;
+
+    priv->idlePolls = 0;
+
+    if (backedOff && priv->timerId > 0) {
+        g_source_remove(priv->timerId);
+        priv->timerId =
+            g_timeout_add_seconds(trg_main_window_poll_interval(win),
+                                  trg_update_torrents_timerfunc, win);
+    }
+}
+
 /*
  * The callback for a torrent-get response.
  */
@@ -1283,7 +1614,6 @@ static gboolean on_torrent_get(gpointer data, int mode)
     TrgClient *client = priv->client;
     TrgPrefs *prefs = trg_client_get_prefs(client);
     trg_torrent_model_update_stats *stats;
-    guint interval;
     gint old_sort_id;
     GtkSortType old_order;
 
@@ -1293,15 +1623,6 @@ static gboolean on_torrent_get(gpointer data, int mode)
         return FALSE;
     }
 
-    interval =
-        gtk_widget_get_visible(GTK_WIDGET(win)) ? trg_prefs_get_int(prefs,
-                                                                    TRG_PREFS_KEY_UPDATE_INTERVAL,
-                                                                    TRG_PREFS_CONNECTION)
-        : trg_prefs_get_int(prefs, TRG_PREFS_KEY_MINUPDATE_INTERVAL,
-                            TRG_PREFS_CONNECTION);
-    if (interval < 1)
-        interval = TRG_INTERVAL_DEFAULT;
-
     if (response->status != CURLE_OK) {
         gint64 max_retries =
             trg_prefs_get_int(prefs, TRG_PREFS_KEY_RETRIES,
@@ -1321,9 +1642,9 @@ static gboolean on_torrent_get(gpointer data, int mode)
                                                statusBarMsg);
             g_free(msg);
             g_free(statusBarMsg);
-            priv->timerId = g_timeout_add_seconds(interval,
-                                                  trg_update_torrents_timerfunc,
-                                                  win);
+            priv->timerId =
+                g_timeout_add_seconds(trg_main_window_base_interval(win),
+                                      trg_update_torrents_timerfunc, win);
         }
 
         trg_response_free(response);
@@ -1347,7 +1668,7 @@ static gboolean on_torrent_get(gpointer data, int mode)
 
     stats =
         trg_torrent_model_update(priv->torrentModel, client, response->obj,
-                                 mode);
+                                 response->prepared, mode);
 
     gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE
                                          (priv->sortedTorrentModel),
@@ -1356,19 +1677,32 @@ static gboolean on_torrent_get(gpointer data, int mode)
     if (mode != TORRENT_GET_MODE_FIRST)
         gtk_widget_thaw_child_notify(GTK_WIDGET(priv->torrentTreeView));
 
-    update_selected_torrent_notebook(win, mode, priv->selectedTorrentId);
+    /* The selected torrent's panels, and any properties dialogs, are
+     * refreshed once their details arrive. */
+    if (priv->selectedTorrentId < 0)
+        update_selected_torrent_notebook(win, mode, -1);
+
+    trg_main_window_get_selected_details(win);
+
     trg_status_bar_update(priv->statusBar, stats, client);
     update_whatever_statusicon(win, stats);
 
-#if TRG_WITH_GRAPH
     if (priv->graphNotebookIndex >= 0)
         trg_torrent_graph_set_speed(priv->graph, stats);
-#endif
+
+    /* Back off while nothing is transferring or changing. */
+    if (mode == TORRENT_GET_MODE_INTERACTION)
+        trg_main_window_poll_soon(win);
+    else if (stats->changed > 0 || stats->downRateTotal > 0
+             || stats->upRateTotal > 0)
+        priv->idlePolls = 0;
+    else
+        priv->idlePolls++;
 
     if (mode != TORRENT_GET_MODE_INTERACTION)
-        priv->timerId = g_timeout_add_seconds(interval,
-                                              trg_update_torrents_timerfunc,
-                                              win);
+        priv->timerId =
+            g_timeout_add_seconds(trg_main_window_poll_interval(win),
+                                  trg_update_torrents_timerfunc, win);
 
     trg_response_free(response);
     return FALSE;
@@ -1405,6 +1739,37 @@ static gboolean on_torrent_get_update(gpointer data)
     return on_torrent_get(data, TORRENT_GET_MODE_UPDATE);
 }
 
+/*
+ * The callback for a detail request on the selected torrent. Failures are left
+ * to the next list poll to deal with, and the status bar and graph aren't
+ * touched because this response only covers one torrent.
+ */
+static gboolean on_torrent_get_selected(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    TrgMainWindow *win = TRG_MAIN_WINDOW(response->cb_data);
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgClient *client = priv->client;
+
+    if (trg_client_is_connected(client) && response->status == CURLE_OK) {
+        trg_torrent_model_update(priv->torrentModel, client, response->obj,
+                                 response->prepared,
+                                 TORRENT_GET_MODE_INTERACTION);
+
+        /* The selection may have moved on while this was in flight. */
+        if (json_object_has_member(response->obj, PARAM_TAG)
+            && json_object_get_int_member(response->obj,
+                                          PARAM_TAG) ==
+            priv->selectedTorrentId)
+            update_selected_torrent_notebook(win,
+                                             TORRENT_GET_MODE_UPDATE,
+                                             priv->selectedTorrentId);
+    }
+
+    trg_response_free(response);
+    return FALSE;
+}
+
 static gboolean trg_session_update_timerfunc(gpointer data)
 {
     TrgMainWindow *win = TRG_MAIN_WINDOW(data);
@@ -1427,22 +1792,51 @@ static gboolean trg_update_torrents_timerfunc(gpointer data)
     TrgClient *tc = priv->client;
     TrgPrefs *prefs = trg_client_get_prefs(tc);
 
+    priv->timerId = 0;
+
     if (trg_client_is_connected(tc)) {
-        gboolean activeOnly = trg_prefs_get_bool(prefs,
-                                                 TRG_PREFS_KEY_UPDATE_ACTIVE_ONLY,
-                                                 TRG_PREFS_CONNECTION)
+        gint64 now = g_get_monotonic_time();
+        gboolean delta = trg_prefs_get_bool(prefs,
+                                            TRG_PREFS_KEY_DELTA_SYNC,
+                                            TRG_PREFS_CONNECTION);
+        gboolean activeOnly;
+
+        /* Delta sync has the daemon send only recently active torrents,
+         * with the IDs of those removed, and the model drop those which
+         * haven't changed since they were last seen.
+         */
+        trg_torrent_model_set_delta(priv->torrentModel, delta);
+
+        /* Full syncs are due after as long as the configured number of
+         * polls would take at the normal interval, however far apart the
+         * polls have backed off to.
+         */
+        activeOnly = (delta || trg_prefs_get_bool(prefs,
+                                                  TRG_PREFS_KEY_UPDATE_ACTIVE_ONLY,
+                                                  TRG_PREFS_CONNECTION))
             && (!trg_prefs_get_bool(prefs,
                                     TRG_PREFS_ACTIVEONLY_FULLSYNC_ENABLED,
                                     TRG_PREFS_CONNECTION)
-                || (trg_client_get_serial(tc) % trg_prefs_get_int(prefs,
-                                                                  TRG_PREFS_ACTIVEONLY_FULLSYNC_EVERY,
-                                                                  TRG_PREFS_CONNECTION)
-                    != 0));
-        dispatch_async(tc,
-                       torrent_get(activeOnly ? TORRENT_GET_TAG_MODE_UPDATE
-                                   : TORRENT_GET_TAG_MODE_FULL),
-                       activeOnly ? on_torrent_get_active :
-                       on_torrent_get_update, data);
+                || now - priv->lastFullSync <
+                trg_prefs_get_int(prefs,
+                                  TRG_PREFS_ACTIVEONLY_FULLSYNC_EVERY,
+                                  TRG_PREFS_CONNECTION)
+                * trg_main_window_base_interval(win) * G_USEC_PER_SEC);
+
+        if (!activeOnly)
+            priv->lastFullSync = now;
+
+        dispatch_async_prepared(tc,
+                                torrent_get_fields(activeOnly ?
+                                                   TORRENT_GET_TAG_MODE_UPDATE
+                                                   :
+                                                   TORRENT_GET_TAG_MODE_FULL,
+                                                   trg_main_window_get_field_sets
+                                                   (win)),
+                                trg_torrent_model_prepare,
+                                priv->torrentModel,
+                                activeOnly ? on_torrent_get_active :
+                                on_torrent_get_update, data);
     }
 
     return FALSE;
@@ -1456,74 +1850,35 @@ static void open_about_cb(GtkWidget * w G_GNUC_UNUSED, GtkWindow * parent)
     gtk_widget_destroy(aboutDialog);
 }
 
+/* The torrent model works out which torrents pass the filter when it's set
+ * or their rows change, so this is just a lookup.
+ */
 static gboolean
 trg_torrent_tree_view_visible_func(GtkTreeModel * model,
                                    GtkTreeIter * iter, gpointer data)
 {
     TrgMainWindow *win = TRG_MAIN_WINDOW(data);
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
-    guint flags;
-    gboolean visible;
-    const gchar *filterText;
-
-    guint32 criteria = trg_state_selector_get_flag(priv->stateSelector);
-
-    gtk_tree_model_get(model, iter, TORRENT_COLUMN_FLAGS, &flags, -1);
-
-    if (criteria != 0) {
-        if (criteria & FILTER_FLAG_TRACKER) {
-            gchar *text =
-                trg_state_selector_get_selected_text(priv->stateSelector);
-            JsonObject *json = NULL;
-            gboolean matchesTracker;
-            gtk_tree_model_get(model, iter, TORRENT_COLUMN_JSON, &json,
-                               -1);
-            matchesTracker = (!json
-                              || !torrent_has_tracker(json,
-                                                      trg_state_selector_get_url_host_regex
-                                                      (priv->
-                                                       stateSelector),
-                                                      text));
-            g_free(text);
-            if (matchesTracker)
-                return FALSE;
-        } else if (criteria & FILTER_FLAG_DIR) {
-            gchar *text =
-                trg_state_selector_get_selected_text(priv->stateSelector);
-            gchar *dd;
-            int cmp;
-            gtk_tree_model_get(model, iter,
-                               TORRENT_COLUMN_DOWNLOADDIR_SHORT, &dd, -1);
-            cmp = g_strcmp0(text, dd);
-            g_free(dd);
-            g_free(text);
-            if (cmp)
-                return FALSE;
-        } else if (!(flags & criteria)) {
-            return FALSE;
-        }
-    }
-
-    visible = TRUE;
+    gint64 id;
 
-    filterText = gtk_entry_get_text(GTK_ENTRY(priv->filterEntry));
-    if (strlen(filterText) > 0) {
-        gchar *name = NULL;
-        gtk_tree_model_get(model, iter, TORRENT_COLUMN_NAME, &name, -1);
-        if (name) {
-            gchar *filterCmp = g_utf8_casefold(filterText, -1);
-            gchar *nameCmp = g_utf8_casefold(name, -1);
+    gtk_tree_model_get(model, iter, TORRENT_COLUMN_ID, &id, -1);
 
-            if (!strstr(nameCmp, filterCmp))
-                visible = FALSE;
+    return trg_torrent_model_is_visible(priv->torrentModel, id);
+}
 
-            g_free(nameCmp);
-            g_free(filterCmp);
-            g_free(name);
-        }
-    }
+static void trg_main_window_refilter(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
-    return visible;
+    trg_torrent_model_set_filter(priv->torrentModel,
+                                 trg_state_selector_get_flag
+                                 (priv->stateSelector),
+                                 trg_state_selector_get_selected_name
+                                 (priv->stateSelector),
+                                 gtk_entry_get_text(GTK_ENTRY
+                                                    (priv->filterEntry)));
+    gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER
+                                   (priv->filteredTorrentModel));
 }
 
 void trg_main_window_reload_dir_aliases(TrgMainWindow * win)
@@ -1533,6 +1888,38 @@ void trg_main_window_reload_dir_aliases(TrgMainWindow * win)
                                          (priv->torrentModel));
 }
 
+/*
+ * A newly shown column might need fields which weren't being polled for, so
+ * fill it in now rather than waiting for the next update.
+ */
+static void
+torrent_tv_column_added(TrgTreeView * tv G_GNUC_UNUSED,
+                        const gchar * id G_GNUC_UNUSED, TrgMainWindow * win)
+{
+    trg_main_window_reload_torrents(win);
+}
+
+void trg_main_window_reload_torrents(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    if (trg_client_is_connected(priv->client))
+        dispatch_async_prepared(priv->client,
+                                torrent_get_fields
+                                (TORRENT_GET_TAG_MODE_FULL,
+                                 trg_main_window_get_field_sets(win)),
+                                trg_torrent_model_prepare,
+                                priv->torrentModel,
+                                on_torrent_get_interactive, win);
+}
+
+void trg_main_window_push_status_msg(TrgMainWindow * win,
+                                     const gchar * msg)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    trg_status_bar_push_connection_msg(priv->statusBar, msg);
+}
+
 static TrgTorrentTreeView
     * trg_main_window_torrent_tree_view_new(TrgMainWindow * win,
                                             GtkTreeModel * model)
@@ -1547,11 +1934,13 @@ static TrgTorrentTreeView
 
     g_signal_connect(G_OBJECT(selection), "changed",
                      G_CALLBACK(torrent_selection_changed), win);
+    g_signal_connect(torrentTreeView, "column-added",
+                     G_CALLBACK(torrent_tv_column_added), win);
 
     return torrentTreeView;
 }
 
-static gboolean
+gboolean
 trg_dialog_error_handler(TrgMainWindow * win, trg_response * response)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
@@ -1607,6 +1996,8 @@ torrent_selection_changed(GtkTreeSelection * selection,
     g_list_free(selectionList);
 
     update_selected_torrent_notebook(win, TORRENT_GET_MODE_FIRST, id);
+    trg_main_window_get_selected_details(win);
+    trg_main_window_poll_soon(win);
 
     return TRUE;
 }
@@ -1639,8 +2030,13 @@ void on_generic_interactive_action(TrgMainWindow *win, trg_response *response) {
             else
                 id = TORRENT_GET_TAG_MODE_FULL;
 
-            dispatch_async(tc, torrent_get(id), on_torrent_get_interactive,
-                           win);
+            dispatch_async_prepared(tc,
+                                    torrent_get_fields(id,
+                                                       trg_main_window_get_field_sets
+                                                       (win)),
+                                    trg_torrent_model_prepare,
+                                    priv->torrentModel,
+                                    on_torrent_get_interactive, win);
         }
     }
 
@@ -1661,9 +2057,10 @@ static void trg_main_window_torrent_scrub(TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
-    gtk_tree_store_clear(GTK_TREE_STORE(priv->filesModel));
+    trg_files_model_clear(priv->filesModel);
     gtk_list_store_clear(GTK_LIST_STORE(priv->trackersModel));
     gtk_list_store_clear(GTK_LIST_STORE(priv->peersModel));
+    priv->detailsTorrentId = -1;
     trg_general_panel_clear(priv->genDetails);
     trg_trackers_model_set_no_selection(TRG_TRACKERS_MODEL
                                         (priv->trackersModel));
@@ -1677,8 +2074,7 @@ static void entry_filter_changed_cb(GtkWidget * w, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     gboolean clearSensitive = gtk_entry_get_text_length(GTK_ENTRY(w)) > 0;
 
-    gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER
-                                   (priv->filteredTorrentModel));
+    trg_main_window_refilter(win);
 
     g_object_set(priv->filterEntry, "secondary-icon-sensitive",
                  clearSensitive, NULL);
@@ -1689,7 +2085,7 @@ torrent_state_selection_changed(TrgStateSelector *
                                 selector G_GNUC_UNUSED,
                                 guint flag G_GNUC_UNUSED, gpointer data)
 {
-    gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(data));
+    trg_main_window_refilter(TRG_MAIN_WINDOW(data));
 }
 
 static void
@@ -1720,16 +2116,16 @@ trg_main_window_conn_changed(TrgMainWindow * win, gboolean connected)
         trg_main_window_torrent_scrub(win);
         trg_state_selector_disconnect(priv->stateSelector);
 
-#if TRG_WITH_GRAPH
         if (priv->graphNotebookIndex >= 0)
             trg_torrent_graph_set_nothing(priv->graph);
-#endif
 
         trg_torrent_model_remove_all(priv->torrentModel);
 
-        g_source_remove(priv->timerId);
+        if (priv->timerId > 0)
+            g_source_remove(priv->timerId);
         g_source_remove(priv->sessionTimerId);
         priv->sessionTimerId = priv->timerId = 0;
+        priv->idlePolls = 0;
     }
 
     trg_client_status_change(tc, connected);
@@ -1790,12 +2186,10 @@ static TrgMenuBar *trg_main_window_menu_bar_new(TrgMainWindow * win)
     GObject *b_disconnect, *b_add, *b_resume, *b_pause, *b_verify,
         *b_remove, *b_delete, *b_props, *b_local_prefs, *b_remote_prefs,
         *b_about, *b_view_states, *b_view_notebook, *b_view_stats,
-        *b_add_url, *b_quit, *b_move, *b_reannounce, *b_pause_all,
+        *b_view_diagnostics, *b_add_url, *b_quit, *b_move, *b_reannounce, *b_pause_all,
         *b_resume_all, *b_dir_filters, *b_tracker_filters, *b_directories_first,
         *b_up_queue, *b_down_queue, *b_top_queue, *b_bottom_queue,
-#if TRG_WITH_GRAPH
     *b_show_graph,
-#endif
 #ifdef HAVE_RSS
     *b_view_rss,
 #endif
@@ -1821,12 +2215,11 @@ static TrgMenuBar *trg_main_window_menu_bar_new(TrgMainWindow * win)
                  &b_remote_prefs, "local-prefs-button", &b_local_prefs,
                  "view-notebook-button", &b_view_notebook,
                  "view-states-button", &b_view_states, "view-stats-button",
-                 &b_view_stats, "about-button", &b_about, "quit-button",
+                 &b_view_stats, "view-diagnostics-button",
+                 &b_view_diagnostics, "about-button", &b_about, "quit-button",
                  &b_quit, "dir-filters", &b_dir_filters, "tracker-filters",
                  &b_tracker_filters, TRG_PREFS_KEY_DIRECTORIES_FIRST, &b_directories_first,
-#if TRG_WITH_GRAPH
                  "show-graph", &b_show_graph,
-#endif
 #ifdef HAVE_RSS
                  "view-rss-button", &b_view_rss,
 #endif
@@ -1877,14 +2270,14 @@ static TrgMenuBar *trg_main_window_menu_bar_new(TrgMainWindow * win)
                      G_CALLBACK(view_states_toggled_cb), win);
     g_signal_connect(b_view_stats, "activate",
                      G_CALLBACK(view_stats_toggled_cb), win);
+    g_signal_connect(b_view_diagnostics, "activate",
+                     G_CALLBACK(view_diagnostics_cb), win);
 #ifdef HAVE_RSS
     g_signal_connect(b_view_rss, "activate",
                      G_CALLBACK(view_rss_toggled_cb), win);
 #endif
-#if TRG_WITH_GRAPH
     g_signal_connect(b_show_graph, "toggled",
                      G_CALLBACK(trg_main_window_toggle_graph_cb), win);
-#endif
     g_signal_connect(b_props, "activate", G_CALLBACK(open_props_cb), win);
     g_signal_connect(b_copy_magnetlink, "activate", G_CALLBACK(copy_magnetlink_cb), win);
     g_signal_connect(b_quit, "activate", G_CALLBACK(quit_cb), win);
@@ -2068,14 +2461,14 @@ static GtkWidget *priority_menu_item_new(TrgMainWindow * win,
 static GtkWidget *priority_menu_new(TrgMainWindow * win, JsonArray * ids)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
-    TrgClient *client = priv->client;
-    JsonObject *t = NULL;
+    const trg_torrent_record *rec =
+        trg_torrent_model_get_record(priv->torrentModel,
+                                     priv->selectedTorrentId);
     gint selected_pri = TR_PRI_UNSET;
     GtkWidget *toplevel, *menu;
 
-    if (get_torrent_data(trg_client_get_torrent_table(client),
-                         priv->selectedTorrentId, &t, NULL))
-        selected_pri = torrent_get_bandwidth_priority(t);
+    if (rec)
+        selected_pri = rec->bandwidthPriority;
 
     toplevel = gtk_image_menu_item_new_with_label(GTK_STOCK_NETWORK);
     gtk_image_menu_item_set_use_stock(GTK_IMAGE_MENU_ITEM(toplevel), TRUE);
@@ -2106,21 +2499,30 @@ static GtkWidget *limit_menu_new(TrgMainWindow * win, gchar * title,
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     TrgClient *client = priv->client;
-    JsonObject *current = NULL;
-    GtkTreeIter iter;
     GtkWidget *toplevel, *menu, *item;
-    gint64 limit;
-
-    if (ids)
-        get_torrent_data(trg_client_get_torrent_table(client),
-                         priv->selectedTorrentId, &current, &iter);
-    else
-        current = trg_client_get_session(client);
+    gint64 limit = -1;
+
+    if (ids) {
+        const trg_torrent_record *rec =
+            trg_torrent_model_get_record(priv->torrentModel,
+                                         priv->selectedTorrentId);
+        GValue enabled = { 0 }, speed = { 0 };
+
+        if (rec && trg_torrent_record_get_value(rec, enabledKey, &enabled)
+            && trg_torrent_record_get_value(rec, speedKey, &speed)
+            && g_value_get_boolean(&enabled))
+            limit = g_value_get_int64(&speed);
+
+        if (G_IS_VALUE(&enabled))
+            g_value_unset(&enabled);
+        if (G_IS_VALUE(&speed))
+            g_value_unset(&speed);
+    } else {
+        JsonObject *session = trg_client_get_session(client);
 
-    limit =
-        json_object_get_boolean_member(current,
-                                       enabledKey) ?
-        json_object_get_int_member(current, speedKey) : -1;
+        if (json_object_get_boolean_member(session, enabledKey))
+            limit = json_object_get_int_member(session, speedKey);
+    }
     toplevel = gtk_image_menu_item_new_with_label(GTK_STOCK_NETWORK);
     gtk_image_menu_item_set_use_stock(GTK_IMAGE_MENU_ITEM(toplevel), TRUE);
     gtk_image_menu_item_set_always_show_image(GTK_IMAGE_MENU_ITEM
@@ -2486,9 +2888,15 @@ static void trg_main_window_set_hidden_to_tray(TrgMainWindow * win,
 
         if (priv->timerId > 0) {
             g_source_remove(priv->timerId);
-            dispatch_async(priv->client,
-                           torrent_get(TORRENT_GET_TAG_MODE_FULL),
-                           on_torrent_get_update, win);
+            priv->timerId = 0;
+            priv->idlePolls = 0;
+            dispatch_async_prepared(priv->client,
+                                    torrent_get_fields
+                                    (TORRENT_GET_TAG_MODE_FULL,
+                                     trg_main_window_get_field_sets(win)),
+                                    trg_torrent_model_prepare,
+                                    priv->torrentModel,
+                                    on_torrent_get_update, win);
         }
     }
 
@@ -2533,13 +2941,12 @@ void trg_main_window_remove_status_icon(TrgMainWindow * win)
     }
 }
 
-#if TRG_WITH_GRAPH
 void trg_main_window_add_graph(TrgMainWindow * win, gboolean show)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     priv->graph =
-        trg_torrent_graph_new(gtk_widget_get_style(priv->notebook));
+        trg_torrent_graph_new();
     priv->graphNotebookIndex =
         gtk_notebook_append_page(GTK_NOTEBOOK(priv->notebook),
                                  GTK_WIDGET(priv->graph),
@@ -2561,7 +2968,6 @@ void trg_main_window_remove_graph(TrgMainWindow * win)
         priv->graphNotebookIndex = -1;
     }
 }
-#endif
 
 /*static gboolean status_icon_size_changed(GtkStatusIcon *status_icon,
         gint           size,
@@ -2722,6 +3128,8 @@ static GObject *trg_main_window_constructor(GType type,
     TrgPrefs *prefs;
 
     priv->queuesEnabled = TRUE;
+    priv->selectedTorrentId = -1;
+    priv->detailsTorrentId = -1;
 
     prefs = trg_client_get_prefs(priv->client);
 
@@ -2748,8 +3156,8 @@ static GObject *trg_main_window_constructor(GType type,
                      G_CALLBACK(window_key_press_handler), NULL);
 
     priv->torrentModel = trg_torrent_model_new();
-    trg_client_set_torrent_table(priv->client,
-                                 get_torrent_table(priv->torrentModel));
+    trg_client_set_torrent_model(priv->client,
+                                 G_OBJECT(priv->torrentModel));
 
     g_signal_connect(priv->torrentModel, "torrent-completed",
                      G_CALLBACK(on_torrent_completed), self);
@@ -2832,8 +3240,8 @@ static GObject *trg_main_window_constructor(GType type,
 
     g_signal_connect(G_OBJECT(priv->stateSelector),
                      "torrent-state-changed",
-                     G_CALLBACK(torrent_state_selection_changed),
-                     priv->filteredTorrentModel);
+                     G_CALLBACK(torrent_state_selection_changed), self);
+    trg_main_window_refilter(self);
 
     priv->notebook = trg_main_window_notebook_new(self);
     gtk_paned_pack2(GTK_PANED(priv->vpaned), priv->notebook, FALSE, FALSE);
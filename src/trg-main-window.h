@@ -42,6 +42,8 @@ gint trg_add_from_filename(TrgMainWindow * win, gchar ** uris);
 gboolean on_session_set(gpointer data);
 gboolean on_delete_complete(gpointer data);
 void on_generic_interactive_action(TrgMainWindow *win, trg_response *response);
+gboolean trg_dialog_error_handler(TrgMainWindow * win,
+                                  trg_response * response);
 gboolean on_generic_interactive_action_response(gpointer data);
 void auto_connect_if_required(TrgMainWindow * win);
 void trg_main_window_set_start_args(TrgMainWindow * win, gchar ** args);
@@ -57,5 +59,9 @@ void trg_main_window_notebook_set_visible(TrgMainWindow * win,
                                           gboolean visible);
 void connect_cb(GtkWidget * w, gpointer data);
 void trg_main_window_reload_dir_aliases(TrgMainWindow * win);
+void trg_main_window_reload_torrents(TrgMainWindow * win);
+void trg_main_window_get_selected_details(TrgMainWindow * win);
+void trg_main_window_push_status_msg(TrgMainWindow * win,
+                                     const gchar * msg);
 
 G_END_DECLS
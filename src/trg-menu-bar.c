@@ -54,6 +54,7 @@ enum {
     PROP_LOCAL_PREFS_BUTTON,
     PROP_ABOUT_BUTTON,
     PROP_VIEW_STATS_BUTTON,
+    PROP_VIEW_DIAGNOSTICS_BUTTON,
 #ifdef HAVE_RSS
     PROP_VIEW_RSS_BUTTON,
 #endif
@@ -67,9 +68,7 @@ enum {
     PROP_DIR_FILTERS,
     PROP_TRACKER_FILTERS,
     PROP_DIRECTORIES_FIRST,
-#if TRG_WITH_GRAPH
     PROP_VIEW_SHOW_GRAPH,
-#endif
     PROP_MOVE_DOWN_QUEUE,
     PROP_MOVE_UP_QUEUE,
     PROP_MOVE_BOTTOM_QUEUE,
@@ -106,6 +105,7 @@ struct _TrgMenuBarPrivate {
     GtkWidget *mb_view_states;
     GtkWidget *mb_view_notebook;
     GtkWidget *mb_view_stats;
+    GtkWidget *mb_view_diagnostics;
 #ifdef HAVE_RSS
     GtkWidget *mb_view_rss;
 #endif
@@ -114,9 +114,7 @@ struct _TrgMenuBarPrivate {
     GtkWidget *mb_directory_filters;
     GtkWidget *mb_tracker_filters;
     GtkWidget *mb_directory_first;
-#if TRG_WITH_GRAPH
     GtkWidget *mb_view_graph;
-#endif
     GtkWidget *mb_down_queue;
     GtkWidget *mb_up_queue;
     GtkWidget *mb_bottom_queue;
@@ -280,11 +278,9 @@ trg_menu_bar_get_property(GObject * object, guint property_id,
     case PROP_ABOUT_BUTTON:
         g_value_set_object(value, priv->mb_about);
         break;
-#if TRG_WITH_GRAPH
     case PROP_VIEW_SHOW_GRAPH:
         g_value_set_object(value, priv->mb_view_graph);
         break;
-#endif
     case PROP_VIEW_STATES_BUTTON:
         g_value_set_object(value, priv->mb_view_states);
         break;
@@ -294,6 +290,9 @@ trg_menu_bar_get_property(GObject * object, guint property_id,
     case PROP_VIEW_STATS_BUTTON:
         g_value_set_object(value, priv->mb_view_stats);
         break;
+    case PROP_VIEW_DIAGNOSTICS_BUTTON:
+        g_value_set_object(value, priv->mb_view_diagnostics);
+        break;
 #ifdef HAVE_RSS
     case PROP_VIEW_RSS_BUTTON:
         g_value_set_object(value, priv->mb_view_rss);
@@ -565,13 +564,11 @@ static GtkWidget *trg_menu_bar_view_menu_new(TrgMenuBar * mb)
     gtk_menu_shell_append(GTK_MENU_SHELL(viewMenu),
                           priv->mb_view_notebook);
 
-#if TRG_WITH_GRAPH
     priv->mb_view_graph =
         trg_menu_bar_view_item_new(priv->prefs, TRG_PREFS_KEY_SHOW_GRAPH,
                                    _("Graph"), priv->mb_view_notebook);
     trg_menu_bar_accel_add(mb, priv->mb_view_graph, GDK_F6, 0);
     gtk_menu_shell_append(GTK_MENU_SHELL(viewMenu), priv->mb_view_graph);
-#endif
 
     priv->mb_view_stats =
         gtk_menu_item_new_with_mnemonic(_("_Statistics"));
@@ -579,6 +576,11 @@ static GtkWidget *trg_menu_bar_view_menu_new(TrgMenuBar * mb)
     gtk_widget_set_sensitive(priv->mb_view_stats, FALSE);
     gtk_menu_shell_append(GTK_MENU_SHELL(viewMenu), priv->mb_view_stats);
 
+    priv->mb_view_diagnostics =
+        gtk_menu_item_new_with_mnemonic(_("_Diagnostics"));
+    gtk_menu_shell_append(GTK_MENU_SHELL(viewMenu),
+                          priv->mb_view_diagnostics);
+
 #ifdef HAVE_RSS
     priv->mb_view_rss =
         gtk_menu_item_new_with_mnemonic(_("_RSS"));
@@ -924,6 +926,10 @@ static void trg_menu_bar_class_init(TrgMenuBarClass * klass)
     trg_menu_bar_install_widget_prop(object_class, PROP_VIEW_STATS_BUTTON,
                                      "view-stats-button",
                                      "View stats button");
+    trg_menu_bar_install_widget_prop(object_class,
+                                     PROP_VIEW_DIAGNOSTICS_BUTTON,
+                                     "view-diagnostics-button",
+                                     "View diagnostics button");
 #ifdef HAVE_RSS
     trg_menu_bar_install_widget_prop(object_class, PROP_VIEW_RSS_BUTTON,
                                      "view-rss-button",
@@ -951,10 +957,8 @@ static void trg_menu_bar_class_init(TrgMenuBarClass * klass)
                                      "tracker-filters", "Tracker Filters");
 	trg_menu_bar_install_widget_prop(object_class, PROP_DIRECTORIES_FIRST,
 									 TRG_PREFS_KEY_DIRECTORIES_FIRST, "Directories first");
-#if TRG_WITH_GRAPH
     trg_menu_bar_install_widget_prop(object_class, PROP_VIEW_SHOW_GRAPH,
                                      "show-graph", "Show Graph");
-#endif
     trg_menu_bar_install_widget_prop(object_class, PROP_MOVE_DOWN_QUEUE,
                                      "down-queue", "Down Queue");
     trg_menu_bar_install_widget_prop(object_class, PROP_MOVE_UP_QUEUE,
@@ -0,0 +1,284 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+#include "trg-metrics.h"
+
+/* Samples are added from the parse worker as well as the main loop. */
+struct _TrgMetrics {
+    GMutex lock;
+    trg_metrics_sample ring[TRG_METRICS_WINDOW];
+    guint head;                 /* where the next goes */
+    guint count;
+    guint64 total;
+    guint buckets[TRG_METRIC_COUNT][TRG_METRICS_BUCKETS];
+};
+
+static const gchar *trg_metric_keys[TRG_METRIC_COUNT] = {
+    "queue", "dns", "connect", "tls", "daemon", "transfer", "parse",
+    "prepare", "idle", "apply", "sent", "received"
+};
+
+const gchar *trg_metric_get_key(TrgMetric metric)
+{
+    return trg_metric_keys[metric];
+}
+
+gboolean trg_metric_is_size(TrgMetric metric)
+{
+    return metric == TRG_METRIC_SENT || metric == TRG_METRIC_RECEIVED;
+}
+
+TrgMetrics *trg_metrics_new(void)
+{
+    TrgMetrics *m = g_new0(TrgMetrics, 1);
+
+    g_mutex_init(&m->lock);
+
+    return m;
+}
+
+void trg_metrics_free(TrgMetrics * m)
+{
+    g_mutex_clear(&m->lock);
+    g_free(m);
+}
+
+void trg_metrics_clear(TrgMetrics * m)
+{
+    g_mutex_lock(&m->lock);
+    m->head = m->count = 0;
+    m->total = 0;
+    memset(m->buckets, 0, sizeof(m->buckets));
+    g_mutex_unlock(&m->lock);
+}
+
+void trg_metrics_sample_init(trg_metrics_sample * s)
+{
+    gint i;
+
+    memset(s, 0, sizeof(trg_metrics_sample));
+    for (i = 0; i < TRG_METRIC_COUNT; i++)
+        s->values[i] = -1;
+}
+
+/* A request retried after the session ID handshake is timed as the sum of
+ * both attempts. */
+void
+trg_metrics_sample_add(trg_metrics_sample * s, TrgMetric metric,
+                       gint64 value)
+{
+    s->values[metric] = MAX(s->values[metric], 0) + MAX(value, 0);
+}
+
+/* Bucket i holds values below 2^(i + 1). */
+static guint trg_metrics_bucket(gint64 value)
+{
+    guint i = value > 0 ? g_bit_storage((gulong) MIN(value, G_MAXLONG)) - 1 : 0;
+
+    return MIN(i, TRG_METRICS_BUCKETS - 1);
+}
+
+static void
+trg_metrics_count(TrgMetrics * m, const trg_metrics_sample * s,
+                  gint delta)
+{
+    gint i;
+
+    for (i = 0; i < TRG_METRIC_COUNT; i++)
+        if (s->values[i] >= 0)
+            m->buckets[i][trg_metrics_bucket(s->values[i])] += delta;
+}
+
+void trg_metrics_add(TrgMetrics * m, const trg_metrics_sample * s)
+{
+    g_mutex_lock(&m->lock);
+
+    if (m->count == TRG_METRICS_WINDOW)
+        trg_metrics_count(m, &m->ring[m->head], -1);
+    else
+        m->count++;
+
+    m->ring[m->head] = *s;
+    trg_metrics_count(m, s, 1);
+    m->head = (m->head + 1) % TRG_METRICS_WINDOW;
+    m->total++;
+
+    g_mutex_unlock(&m->lock);
+}
+
+/* The i'th most recent, from 0. */
+static trg_metrics_sample *trg_metrics_nth(TrgMetrics * m, guint i)
+{
+    return &m->ring[(m->head + TRG_METRICS_WINDOW - 1 - i) %
+                    TRG_METRICS_WINDOW];
+}
+
+static int trg_metrics_compare(const void *a, const void *b)
+{
+    gint64 x = *(const gint64 *) a, y = *(const gint64 *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+void
+trg_metrics_summarize(TrgMetrics * m, TrgMetric metric,
+                      trg_metrics_summary * out)
+{
+    gint64 values[TRG_METRICS_WINDOW];
+    gint64 sum = 0;
+    guint i, n = 0;
+
+    memset(out, 0, sizeof(trg_metrics_summary));
+
+    g_mutex_lock(&m->lock);
+    for (i = 0; i < m->count; i++) {
+        gint64 value = trg_metrics_nth(m, i)->values[metric];
+        if (value >= 0)
+            values[n++] = value;
+    }
+    g_mutex_unlock(&m->lock);
+
+    if (n == 0)
+        return;
+
+    out->count = n;
+    out->last = values[0];
+
+    for (i = 0; i < n; i++)
+        sum += values[i];
+    out->mean = sum / n;
+
+    qsort(values, n, sizeof(gint64), trg_metrics_compare);
+    out->p50 = values[(n - 1) * 50 / 100];
+    out->p90 = values[(n - 1) * 90 / 100];
+    out->p99 = values[(n - 1) * 99 / 100];
+    out->max = values[n - 1];
+}
+
+/* Copies up to n of the most recent samples, newest first. */
+guint
+trg_metrics_get_recent(TrgMetrics * m, trg_metrics_sample * out, guint n)
+{
+    guint i;
+
+    g_mutex_lock(&m->lock);
+    n = MIN(n, m->count);
+    for (i = 0; i < n; i++)
+        out[i] = *trg_metrics_nth(m, i);
+    g_mutex_unlock(&m->lock);
+
+    return n;
+}
+
+static JsonObject *trg_metrics_metric_to_json(TrgMetrics * m,
+                                              TrgMetric metric)
+{
+    JsonObject *obj = json_object_new();
+    JsonArray *histogram = json_array_new();
+    trg_metrics_summary s;
+    guint i;
+
+    trg_metrics_summarize(m, metric, &s);
+
+    json_object_set_string_member(obj, "unit",
+                                  trg_metric_is_size(metric) ? "bytes" :
+                                  "us");
+    json_object_set_int_member(obj, "count", s.count);
+    json_object_set_int_member(obj, "mean", s.mean);
+    json_object_set_int_member(obj, "p50", s.p50);
+    json_object_set_int_member(obj, "p90", s.p90);
+    json_object_set_int_member(obj, "p99", s.p99);
+    json_object_set_int_member(obj, "max", s.max);
+
+    /* Only the buckets with anything in, each by its upper bound. */
+    g_mutex_lock(&m->lock);
+    for (i = 0; i < TRG_METRICS_BUCKETS; i++) {
+        if (m->buckets[metric][i] > 0) {
+            JsonObject *bucket = json_object_new();
+            json_object_set_int_member(bucket, "below",
+                                       G_GINT64_CONSTANT(1) << (i + 1));
+            json_object_set_int_member(bucket, "count",
+                                       m->buckets[metric][i]);
+            json_array_add_object_element(histogram, bucket);
+        }
+    }
+    g_mutex_unlock(&m->lock);
+
+    json_object_set_array_member(obj, "histogram", histogram);
+
+    return obj;
+}
+
+static JsonObject *trg_metrics_sample_to_json(trg_metrics_sample * s)
+{
+    JsonObject *obj = json_object_new();
+    gint i;
+
+    json_object_set_string_member(obj, "method", s->method);
+    json_object_set_int_member(obj, "status", s->status);
+    json_object_set_int_member(obj, "when", s->when);
+
+    for (i = 0; i < TRG_METRIC_COUNT; i++)
+        if (s->values[i] >= 0)
+            json_object_set_int_member(obj, trg_metric_keys[i],
+                                       s->values[i]);
+
+    return obj;
+}
+
+JsonNode *trg_metrics_to_json(TrgMetrics * m)
+{
+    trg_metrics_sample *recent =
+        g_new(trg_metrics_sample, TRG_METRICS_WINDOW);
+    JsonNode *root = json_node_new(JSON_NODE_OBJECT);
+    JsonObject *obj = json_object_new();
+    JsonObject *metrics = json_object_new();
+    JsonArray *requests = json_array_new();
+    guint i, n;
+
+    for (i = 0; i < TRG_METRIC_COUNT; i++)
+        json_object_set_object_member(metrics, trg_metric_keys[i],
+                                      trg_metrics_metric_to_json(m, i));
+
+    n = trg_metrics_get_recent(m, recent, TRG_METRICS_WINDOW);
+    for (i = 0; i < n; i++)
+        json_array_add_object_element(requests,
+                                      trg_metrics_sample_to_json(&recent
+                                                                 [i]));
+    g_free(recent);
+
+    g_mutex_lock(&m->lock);
+    json_object_set_int_member(obj, "total", m->total);
+    g_mutex_unlock(&m->lock);
+
+    json_object_set_object_member(obj, "metrics", metrics);
+    json_object_set_array_member(obj, "requests", requests);
+    json_node_take_object(root, obj);
+
+    return root;
+}
@@ -0,0 +1,87 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TRG_METRICS_H_
+#define TRG_METRICS_H_
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+/* Where the time of each request went, for the diagnostics dialog. The
+ * last TRG_METRICS_WINDOW requests are kept, so a stall shows up against
+ * recent ones rather than being averaged away. Times are in microseconds.
+ */
+
+#define TRG_METRICS_WINDOW 512
+#define TRG_METRICS_BUCKETS 40  /* powers of two */
+
+typedef enum {
+    TRG_METRIC_QUEUE,           /* dispatched until handed to curl */
+    TRG_METRIC_DNS,
+    TRG_METRIC_CONNECT,
+    TRG_METRIC_TLS,
+    TRG_METRIC_DAEMON,          /* sent until the first byte back */
+    TRG_METRIC_TRANSFER,        /* the rest of the response */
+    TRG_METRIC_PARSE,
+    TRG_METRIC_PREPARE,
+    TRG_METRIC_IDLE,            /* parsed until the main loop got to it */
+    TRG_METRIC_APPLY,           /* the callback, updating models */
+    TRG_METRIC_SENT,            /* bytes of request body */
+    TRG_METRIC_RECEIVED,        /* bytes of response, headers included */
+    TRG_METRIC_COUNT
+} TrgMetric;
+
+typedef struct {
+    gchar method[48];           /* or the URL, for other requests */
+    gint status;
+    gint64 when;                /* real time it was dispatched */
+    gint64 values[TRG_METRIC_COUNT];    /* -1 where it doesn't apply */
+} trg_metrics_sample;
+
+typedef struct {
+    guint count;
+    gint64 last;
+    gint64 mean;
+    gint64 p50;
+    gint64 p90;
+    gint64 p99;
+    gint64 max;
+} trg_metrics_summary;
+
+typedef struct _TrgMetrics TrgMetrics;
+
+TrgMetrics *trg_metrics_new(void);
+void trg_metrics_free(TrgMetrics * m);
+void trg_metrics_clear(TrgMetrics * m);
+
+void trg_metrics_sample_init(trg_metrics_sample * s);
+void trg_metrics_sample_add(trg_metrics_sample * s, TrgMetric metric,
+                            gint64 value);
+
+void trg_metrics_add(TrgMetrics * m, const trg_metrics_sample * s);
+void trg_metrics_summarize(TrgMetrics * m, TrgMetric metric,
+                           trg_metrics_summary * out);
+guint trg_metrics_get_recent(TrgMetrics * m, trg_metrics_sample * out,
+                             guint n);
+JsonNode *trg_metrics_to_json(TrgMetrics * m);
+
+const gchar *trg_metric_get_key(TrgMetric metric);
+gboolean trg_metric_is_size(TrgMetric metric);
+
+#endif                          /* TRG_METRICS_H_ */
@@ -0,0 +1,305 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <json-glib/json-glib.h>
+
+#include "protocol-constants.h"
+#include "trg-client.h"
+#include "trg-synthetic.h"
+#include "trg-mock-daemon.h"
+
+#define MOCK_SESSION_ID_HEADER "X-Transmission-Session-Id"
+#define MOCK_MAX_BODY (16 * 1024 * 1024)
+
+/* Speaks enough HTTP/1.1 for curl: keep-alive, Content-Length bodies and
+ * Expect: 100-continue. Like the real daemon, a request without the
+ * current session ID gets a 409 carrying it. The torrents churn by one
+ * poll for each full or recently-active torrent-get.
+ */
+struct _TrgMockDaemon {
+    GSocketService *service;
+    trg_synthetic_session session;
+    guint latency;              /* ms before each response */
+    guint16 port;
+    gchar *sessionId;
+    gint poll;
+    gint requests;
+};
+
+static gchar *mock_torrent_get(TrgMockDaemon * daemon, JsonObject * args,
+                               gsize * len)
+{
+    JsonNode *ids = args ? json_object_get_member(args, PARAM_IDS) : NULL;
+    gint64 id = TORRENT_GET_TAG_MODE_FULL;
+    guint poll;
+    GString *out;
+
+    if (ids && json_node_get_node_type(ids) == JSON_NODE_VALUE
+        && !g_strcmp0(json_node_get_string(ids), FIELD_RECENTLY_ACTIVE)) {
+        id = TORRENT_GET_TAG_MODE_UPDATE;
+    } else if (ids && json_node_get_node_type(ids) == JSON_NODE_ARRAY
+               && json_array_get_length(json_node_get_array(ids)) > 0) {
+        id = json_array_get_int_element(json_node_get_array(ids), 0);
+    }
+
+    if (id < 0)
+        poll = (guint) g_atomic_int_add(&daemon->poll, 1) + 1;
+    else
+        poll = (guint) g_atomic_int_get(&daemon->poll);
+
+    out = trg_synthetic_torrent_get(&daemon->session, poll, id);
+    *len = out->len;
+
+    return g_string_free(out, FALSE);
+}
+
+static gchar *mock_session_stats(TrgMockDaemon * daemon)
+{
+    guint n = daemon->session.torrents;
+
+    return g_strdup_printf("{\"arguments\":{\"activeTorrentCount\":%u,"
+                           "\"downloadSpeed\":%u,\"pausedTorrentCount\":%u,"
+                           "\"torrentCount\":%u,\"uploadSpeed\":%u,"
+                           "\"cumulative-stats\":{\"downloadedBytes\":0,"
+                           "\"filesAdded\":%u,\"secondsActive\":0,"
+                           "\"sessionCount\":1,\"uploadedBytes\":0},"
+                           "\"current-stats\":{\"downloadedBytes\":0,"
+                           "\"filesAdded\":%u,\"secondsActive\":0,"
+                           "\"sessionCount\":1,\"uploadedBytes\":0}},"
+                           "\"result\":\"success\"}",
+                           (guint) (n * daemon->session.churn),
+                           n * 1024, n / 7, n, n * 512, n, n);
+}
+
+static gchar *mock_handle(TrgMockDaemon * daemon, const gchar * body,
+                          gsize bodyLen, gsize * len)
+{
+    JsonParser *parser = json_parser_new();
+    JsonObject *root = NULL, *args = NULL;
+    const gchar *method = NULL;
+    gchar *out;
+
+    if (json_parser_load_from_data(parser, body, bodyLen, NULL)
+        && JSON_NODE_TYPE(json_parser_get_root(parser)) ==
+        JSON_NODE_OBJECT) {
+        root = json_node_get_object(json_parser_get_root(parser));
+        if (json_object_has_member(root, PARAM_METHOD))
+            method = json_object_get_string_member(root, PARAM_METHOD);
+        if (json_object_has_member(root, PARAM_ARGUMENTS))
+            args = json_object_get_object_member(root, PARAM_ARGUMENTS);
+    }
+
+    if (!g_strcmp0(method, METHOD_TORRENT_GET)) {
+        g_object_unref(parser);
+        return mock_torrent_get(daemon, args, len);
+    } else if (!g_strcmp0(method, METHOD_SESSION_GET)) {
+        out = trg_synthetic_session_get();
+    } else if (!g_strcmp0(method, METHOD_SESSION_STATS)) {
+        out = mock_session_stats(daemon);
+    } else if (!method) {
+        out = g_strdup("{\"arguments\":{},\"result\":\"invalid request\"}");
+    } else if (json_object_has_member(root, PARAM_TAG)) {
+        out = g_strdup_printf("{\"arguments\":{},\"result\":\"success\","
+                              "\"tag\":%" G_GINT64_FORMAT "}",
+                              json_object_get_int_member(root, PARAM_TAG));
+    } else {
+        out = g_strdup("{\"arguments\":{},\"result\":\"success\"}");
+    }
+
+    g_object_unref(parser);
+    *len = strlen(out);
+
+    return out;
+}
+
+static gboolean
+mock_write(GOutputStream * out, const gchar * status,
+           const gchar * sessionId, const gchar * body, gsize len)
+{
+    gchar *head = g_strdup_printf("HTTP/1.1 %s\r\n"
+                                  "Server: trg-mock-daemon\r\n"
+                                  "Content-Type: application/json\r\n"
+                                  "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                                  MOCK_SESSION_ID_HEADER ": %s\r\n\r\n",
+                                  status, len, sessionId);
+    gboolean ok = g_output_stream_write_all(out, head, strlen(head), NULL,
+                                            NULL, NULL)
+        && g_output_stream_write_all(out, body, len, NULL, NULL, NULL);
+
+    g_free(head);
+
+    return ok;
+}
+
+/* One connection, on its own thread, for as many requests as it's kept
+ * open for. */
+static gboolean
+mock_run(GThreadedSocketService * service G_GNUC_UNUSED,
+         GSocketConnection * connection,
+         GObject * source_object G_GNUC_UNUSED, gpointer data)
+{
+    TrgMockDaemon *daemon = (TrgMockDaemon *) data;
+    GOutputStream *out =
+        g_io_stream_get_output_stream(G_IO_STREAM(connection));
+    GDataInputStream *in =
+        g_data_input_stream_new(g_io_stream_get_input_stream
+                                (G_IO_STREAM(connection)));
+    gboolean open = TRUE;
+
+    g_data_input_stream_set_newline_type(in,
+                                         G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+
+    while (open) {
+        gchar *line = g_data_input_stream_read_line(in, NULL, NULL, NULL);
+        gboolean authorised = FALSE, expect = FALSE;
+        gsize contentLength = 0, bodyLen, len;
+        gchar *body, *response;
+
+        if (!line)
+            break;
+
+        g_free(line);
+
+        while ((line = g_data_input_stream_read_line(in, NULL, NULL, NULL))
+               && *line) {
+            gchar *value = strchr(line, ':');
+
+            if (value) {
+                *value++ = '\0';
+                value = g_strstrip(value);
+
+                if (!g_ascii_strcasecmp(line, "Content-Length"))
+                    contentLength = (gsize) g_ascii_strtoull(value, NULL,
+                                                             10);
+                else if (!g_ascii_strcasecmp(line, MOCK_SESSION_ID_HEADER))
+                    authorised = !g_strcmp0(value, daemon->sessionId);
+                else if (!g_ascii_strcasecmp(line, "Expect"))
+                    expect = !g_ascii_strcasecmp(value, "100-continue");
+                else if (!g_ascii_strcasecmp(line, "Connection"))
+                    open = g_ascii_strcasecmp(value, "close") != 0;
+            }
+
+            g_free(line);
+        }
+
+        if (!line || contentLength > MOCK_MAX_BODY) {
+            g_free(line);
+            break;
+        }
+
+        g_free(line);
+
+        if (expect)
+            g_output_stream_write_all(out, "HTTP/1.1 100 Continue\r\n\r\n",
+                                      25, NULL, NULL, NULL);
+
+        body = g_malloc(contentLength + 1);
+        if (!g_input_stream_read_all(G_INPUT_STREAM(in), body,
+                                     contentLength, &bodyLen, NULL, NULL)
+            || bodyLen != contentLength) {
+            g_free(body);
+            break;
+        }
+        body[bodyLen] = '\0';
+
+        g_atomic_int_inc(&daemon->requests);
+
+        if (daemon->latency > 0)
+            g_usleep(daemon->latency * G_TIME_SPAN_MILLISECOND);
+
+        if (authorised) {
+            response = mock_handle(daemon, body, bodyLen, &len);
+            open = mock_write(out, "200 OK", daemon->sessionId, response,
+                              len) && open;
+        } else {
+            response = g_strdup("<h1>409: Conflict</h1>");
+            open = mock_write(out, "409 Conflict", daemon->sessionId,
+                              response, strlen(response)) && open;
+        }
+
+        g_free(response);
+        g_free(body);
+    }
+
+    g_object_unref(in);
+
+    return TRUE;
+}
+
+TrgMockDaemon *trg_mock_daemon_new(const trg_synthetic_session * s,
+                                   guint16 port, guint latency,
+                                   GError ** error)
+{
+    TrgMockDaemon *daemon = g_new0(TrgMockDaemon, 1);
+
+    daemon->session = *s;
+    daemon->latency = latency;
+    daemon->sessionId = g_strdup_printf("mock%08x", g_random_int());
+    daemon->service = g_threaded_socket_service_new(-1);
+
+    if (port == 0) {
+        port = g_socket_listener_add_any_inet_port(G_SOCKET_LISTENER
+                                                   (daemon->service), NULL,
+                                                   error);
+    } else if (!g_socket_listener_add_inet_port(G_SOCKET_LISTENER
+                                                (daemon->service), port,
+                                                NULL, error)) {
+        port = 0;
+    }
+
+    if (port == 0) {
+        trg_mock_daemon_free(daemon);
+        return NULL;
+    }
+
+    daemon->port = port;
+
+    g_signal_connect(daemon->service, "run", G_CALLBACK(mock_run), daemon);
+    g_socket_service_start(daemon->service);
+
+    return daemon;
+}
+
+guint16 trg_mock_daemon_get_port(TrgMockDaemon * daemon)
+{
+    return daemon->port;
+}
+
+guint trg_mock_daemon_get_requests(TrgMockDaemon * daemon)
+{
+    return (guint) g_atomic_int_get(&daemon->requests);
+}
+
+void trg_mock_daemon_free(TrgMockDaemon * daemon)
+{
+    g_socket_service_stop(daemon->service);
+    g_socket_listener_close(G_SOCKET_LISTENER(daemon->service));
+    g_object_unref(daemon->service);
+    g_free(daemon->sessionId);
+    g_free(daemon);
+}
@@ -0,0 +1,41 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef TRG_MOCK_DAEMON_H_
+#define TRG_MOCK_DAEMON_H_
+
+#include <glib.h>
+
+#include "trg-synthetic.h"
+
+/* A stand-in for transmission-daemon's RPC endpoint, serving a synthetic
+ * session. Connections are handled on threads, but accepted from the
+ * default main context, which must be running. */
+
+typedef struct _TrgMockDaemon TrgMockDaemon;
+
+TrgMockDaemon *trg_mock_daemon_new(const trg_synthetic_session * s,
+                                   guint16 port, guint latency,
+                                   GError ** error);
+guint16 trg_mock_daemon_get_port(TrgMockDaemon * daemon);
+guint trg_mock_daemon_get_requests(TrgMockDaemon * daemon);
+void trg_mock_daemon_free(TrgMockDaemon * daemon);
+
+#endif                          /* TRG_MOCK_DAEMON_H_ */
@@ -48,7 +48,7 @@ trg_model_remove_removed_foreachfunc(GtkTreeModel * model,
     gtk_tree_model_get(model, iter, args->serial_column, &rowSerial, -1);
     if (rowSerial != args->currentSerial)
         args->toRemove =
-            g_list_append(args->toRemove, gtk_tree_iter_copy(iter));
+            g_list_prepend(args->toRemove, gtk_tree_iter_copy(iter));
 
     return FALSE;
 }
@@ -67,8 +67,8 @@ trg_model_remove_removed(GtkListStore * model, gint serial_column,
     gtk_tree_model_foreach(GTK_TREE_MODEL(model),
                            trg_model_remove_removed_foreachfunc, &args);
     if (args.toRemove != NULL) {
-        for (li = g_list_last(args.toRemove); li != NULL;
-             li = g_list_previous(li)) {
+        /* Prepended, so this removes from the last row backwards. */
+        for (li = args.toRemove; li != NULL; li = g_list_next(li)) {
             gtk_list_store_remove(model, (GtkTreeIter *) li->data);
             gtk_tree_iter_free((GtkTreeIter *) li->data);
             removed++;
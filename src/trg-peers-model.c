@@ -35,66 +35,126 @@
 #include "torrent.h"
 #include "trg-client.h"
 #include "trg-peers-model.h"
-#include "trg-model.h"
 #include "util.h"
 
 G_DEFINE_TYPE(TrgPeersModel, trg_peers_model, GTK_TYPE_LIST_STORE)
 #define TRG_PEERS_MODEL_GET_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_PEERS_MODEL, TrgPeersModelPrivate))
-#ifdef HAVE_GEOIP
 typedef struct _TrgPeersModelPrivate TrgPeersModelPrivate;
 
 struct _TrgPeersModelPrivate {
+    GHashTable *peersByAddress;
+#ifdef HAVE_GEOIP
     GeoIP *geoip;
     GeoIP *geoipv6;
     GeoIP *geoipcity;
-};
 #endif
+};
+
+/* An entry in the address index. The serial is the last update which listed
+ * the peer, so removed peers can be found without scanning the rows.
+ */
+typedef struct {
+    GtkTreeRowReference *rr;
+    gint64 serial;
+} trg_peers_model_entry;
 
-static void trg_peers_model_class_init(TrgPeersModelClass *
-                                       klass G_GNUC_UNUSED)
+static void trg_peers_model_entry_free(gpointer data)
 {
-#ifdef HAVE_GEOIP
+    trg_peers_model_entry *entry = (trg_peers_model_entry *) data;
+    gtk_tree_row_reference_free(entry->rr);
+    g_free(entry);
+}
+
+static void trg_peers_model_finalize(GObject * object)
+{
+    TrgPeersModelPrivate *priv = TRG_PEERS_MODEL_GET_PRIVATE(object);
+    g_hash_table_destroy(priv->peersByAddress);
+    G_OBJECT_CLASS(trg_peers_model_parent_class)->finalize(object);
+}
+
+static void trg_peers_model_class_init(TrgPeersModelClass * klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
     g_type_class_add_private(klass, sizeof(TrgPeersModelPrivate));
-#endif
+    object_class->finalize = trg_peers_model_finalize;
 }
 
-static gboolean
-find_existing_peer_item_foreachfunc(GtkTreeModel * model,
-                                    GtkTreePath *
-                                    path G_GNUC_UNUSED,
-                                    GtkTreeIter * iter, gpointer data)
+/* The list store can also be cleared from outside, which leaves references
+ * in the index which no longer point anywhere. Treat those as not found, the
+ * caller replaces them.
+ */
+static trg_peers_model_entry *find_existing_peer_item(TrgPeersModel *
+                                                      model,
+                                                      const gchar *
+                                                      address,
+                                                      GtkTreeIter * iter)
 {
-    struct peerAndIter *pi = (struct peerAndIter *) data;
-    gchar *ip;
+    TrgPeersModelPrivate *priv = TRG_PEERS_MODEL_GET_PRIVATE(model);
+    trg_peers_model_entry *entry;
+    GtkTreePath *path;
+    gboolean found = FALSE;
 
-    gtk_tree_model_get(model, iter, PEERSCOL_IP, &ip, -1);
+    if (!address)
+        return NULL;
 
-    if (g_strcmp0(ip, pi->ip) == 0) {
-        pi->iter = *iter;
-        pi->found = TRUE;
-    }
+    entry = g_hash_table_lookup(priv->peersByAddress, address);
+    if (!entry)
+        return NULL;
 
-    g_free(ip);
+    path = gtk_tree_row_reference_get_path(entry->rr);
+    if (path) {
+        found = gtk_tree_model_get_iter(GTK_TREE_MODEL(model), iter, path);
+        gtk_tree_path_free(path);
+    }
 
-    return pi->found;
+    return found ? entry : NULL;
 }
 
-static gboolean
-find_existing_peer_item(TrgPeersModel * model, JsonObject * p,
-                        GtkTreeIter * iter)
+static void
+trg_peers_model_add_to_index(TrgPeersModel * model, const gchar * address,
+                             GtkTreeIter * iter, gint64 updateSerial)
 {
-    struct peerAndIter pi;
-    pi.ip = peer_get_address(p);
-    pi.found = FALSE;
+    TrgPeersModelPrivate *priv = TRG_PEERS_MODEL_GET_PRIVATE(model);
+    trg_peers_model_entry *entry;
+    GtkTreePath *path;
 
-    gtk_tree_model_foreach(GTK_TREE_MODEL(model),
-                           find_existing_peer_item_foreachfunc, &pi);
+    path = gtk_tree_model_get_path(GTK_TREE_MODEL(model), iter);
+    entry = g_new(trg_peers_model_entry, 1);
+    entry->rr = gtk_tree_row_reference_new(GTK_TREE_MODEL(model), path);
+    entry->serial = updateSerial;
+    gtk_tree_path_free(path);
 
-    if (pi.found == TRUE)
-        *iter = pi.iter;
+    g_hash_table_replace(priv->peersByAddress, g_strdup(address), entry);
+}
 
-    return pi.found;
+static void
+trg_peers_model_remove_removed(TrgPeersModel * model, gint64 updateSerial)
+{
+    TrgPeersModelPrivate *priv = TRG_PEERS_MODEL_GET_PRIVATE(model);
+    GHashTableIter hiter;
+    gpointer value;
+
+    g_hash_table_iter_init(&hiter, priv->peersByAddress);
+    while (g_hash_table_iter_next(&hiter, NULL, &value)) {
+        trg_peers_model_entry *entry = (trg_peers_model_entry *) value;
+        GtkTreePath *path;
+
+        if (entry->serial == updateSerial)
+            continue;
+
+        path = gtk_tree_row_reference_get_path(entry->rr);
+        if (path) {
+            GtkTreeIter iter;
+            if (gtk_tree_model_get_iter
+                (GTK_TREE_MODEL(model), &iter, path))
+                gtk_list_store_remove(GTK_LIST_STORE(model), &iter);
+            gtk_tree_path_free(path);
+        }
+
+        g_hash_table_iter_remove(&hiter);
+    }
 }
 
 struct ResolvedDnsIdleData {
@@ -161,10 +221,11 @@ static const gchar* lookup_country(TrgPeersModel *model, const gchar *address) {
 
 void
 trg_peers_model_update(TrgPeersModel * model, TrgTreeView * tv,
-                       gint64 updateSerial, JsonObject * t, gint mode)
+                       gint64 updateSerial,
+                       const trg_torrent_details * details, gint mode)
 {
-#ifdef HAVE_GEOIP
     TrgPeersModelPrivate *priv = TRG_PEERS_MODEL_GET_PRIVATE(model);
+#ifdef HAVE_GEOIP
     gboolean doGeoLookup =
         trg_tree_view_is_column_showing(tv, PEERSCOL_COUNTRY);
     gboolean doGeoCityLookup =
@@ -178,32 +239,39 @@ trg_peers_model_update(TrgPeersModel * model, TrgTreeView * tv,
     GList *li, *peersList;
     gboolean isNew;
 
-    peers = torrent_get_peers(t);
+    peers = details->peers;
 
-    if (mode == TORRENT_GET_MODE_FIRST)
+    if (mode == TORRENT_GET_MODE_FIRST) {
+        g_hash_table_remove_all(priv->peersByAddress);
         gtk_list_store_clear(GTK_LIST_STORE(model));
+    }
 
     peersList = json_array_get_elements(peers);
     for (li = peersList; li; li = g_list_next(li)) {
         JsonObject *peer = json_node_get_object((JsonNode *) li->data);
-        const gchar *address = NULL, *flagStr;
+        const gchar *address = peer_get_address(peer), *flagStr;
+        trg_peers_model_entry *entry = NULL;
 #ifdef HAVE_GEOIP
         const gchar *country = NULL;
         GeoIPRecord *city = NULL;
 #endif
 
-        if (mode == TORRENT_GET_MODE_FIRST
-            || find_existing_peer_item(model, peer, &peerIter) == FALSE) {
-            gtk_list_store_append(GTK_LIST_STORE(model), &peerIter);
+        /* rows are keyed by address, so one without can't be tracked */
+        if (!address)
+            continue;
+
+        if (mode != TORRENT_GET_MODE_FIRST)
+            entry = find_existing_peer_item(model, address, &peerIter);
 
-            address = peer_get_address(peer);
+        if (!entry) {
+            gtk_list_store_append(GTK_LIST_STORE(model), &peerIter);
+            trg_peers_model_add_to_index(model, address, &peerIter,
+                                         updateSerial);
 #ifdef HAVE_GEOIP
-            if (address) {       /* just in case address wasn't set */
-            	if (doGeoLookup)
-            		country = lookup_country(model, address);
-            	if (doGeoCityLookup)
-            		city = GeoIP_record_by_addr(priv->geoipcity, address);
-            }
+            if (doGeoLookup)
+            	country = lookup_country(model, address);
+            if (doGeoCityLookup)
+            	city = GeoIP_record_by_addr(priv->geoipcity, address);
 #endif
             gtk_list_store_set(GTK_LIST_STORE(model), &peerIter,
                                PEERSCOL_ICON, "network-workgroup",
@@ -217,6 +285,7 @@ trg_peers_model_update(TrgPeersModel * model, TrgTreeView * tv,
 
             isNew = TRUE;
         } else {
+            entry->serial = updateSerial;
             isNew = FALSE;
         }
 
@@ -230,8 +299,7 @@ trg_peers_model_update(TrgPeersModel * model, TrgTreeView * tv,
                            PEERSCOL_FLAGS, flagStr, PEERSCOL_PROGRESS,
                            peer_get_progress(peer), PEERSCOL_DOWNSPEED,
                            peer_get_rate_to_client(peer), PEERSCOL_UPSPEED,
-                           peer_get_rate_to_peer(peer),
-                           PEERSCOL_UPDATESERIAL, updateSerial, -1);
+                           peer_get_rate_to_peer(peer), -1);
 
         if (doHostLookup && isNew == TRUE) {
             GtkTreePath *path =
@@ -256,14 +324,13 @@ trg_peers_model_update(TrgPeersModel * model, TrgTreeView * tv,
     g_list_free(peersList);
 
     if (mode != TORRENT_GET_MODE_FIRST)
-        trg_model_remove_removed(GTK_LIST_STORE(model),
-                                 PEERSCOL_UPDATESERIAL, updateSerial);
+        trg_peers_model_remove_removed(model, updateSerial);
 }
 
 static void trg_peers_model_init(TrgPeersModel * self)
 {
-#ifdef HAVE_GEOIP
     TrgPeersModelPrivate *priv = TRG_PEERS_MODEL_GET_PRIVATE(self);
+#ifdef HAVE_GEOIP
     gchar *geoip_db_path = NULL;
     gchar *geoip_v6_db_path = NULL;
     gchar *geoip_city_db_path = NULL;
@@ -284,11 +351,14 @@ static void trg_peers_model_init(TrgPeersModel * self)
     column_types[PEERSCOL_DOWNSPEED] = G_TYPE_INT64;
     column_types[PEERSCOL_UPSPEED] = G_TYPE_INT64;
     column_types[PEERSCOL_CLIENT] = G_TYPE_STRING;
-    column_types[PEERSCOL_UPDATESERIAL] = G_TYPE_INT64;
 
     gtk_list_store_set_column_types(GTK_LIST_STORE(self), PEERSCOL_COLUMNS,
                                     column_types);
 
+    priv->peersByAddress = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                 g_free,
+                                                 trg_peers_model_entry_free);
+
 #ifdef HAVE_GEOIP
 #ifdef WIN32
     geoip_db_path = trg_win32_support_path("GeoIP.dat");
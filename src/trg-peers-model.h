@@ -33,6 +33,7 @@
 #include <glib-object.h>
 
 #include "trg-tree-view.h"
+#include "torrent-record.h"
 
 G_BEGIN_DECLS
 #define TRG_TYPE_PEERS_MODEL trg_peers_model_get_type()
@@ -58,11 +59,7 @@ GType trg_peers_model_get_type(void);
 
 TrgPeersModel *trg_peers_model_new(void);
 
-G_END_DECLS struct peerAndIter {
-    const gchar *ip;
-    GtkTreeIter iter;
-    gboolean found;
-};
+G_END_DECLS
 
 enum {
     PEERSCOL_ICON,
@@ -77,13 +74,13 @@ enum {
     PEERSCOL_DOWNSPEED,
     PEERSCOL_UPSPEED,
     PEERSCOL_CLIENT,
-    PEERSCOL_UPDATESERIAL,
     PEERSCOL_COLUMNS
 };
 
 void trg_peers_model_update(TrgPeersModel * model, TrgTreeView * tv,
-                            gint64 updateSerial, JsonObject * t,
-                            gboolean first);
+                            gint64 updateSerial,
+                            const trg_torrent_details * details,
+                            gint mode);
 
 #if HAVE_GEOIP
 void trg_peers_model_add_city_column(TrgPeersModel *model);
@@ -337,7 +337,6 @@ static void toggle_directories_first(GtkToggleButton * w, gpointer win){
 											gtk_toggle_button_get_active(w));
 }
 
-#if TRG_WITH_GRAPH
 static void toggle_graph(GtkToggleButton * w, gpointer win)
 {
     if (gtk_toggle_button_get_active(w))
@@ -345,7 +344,6 @@ static void toggle_graph(GtkToggleButton * w, gpointer win)
     else
         trg_main_window_remove_graph(TRG_MAIN_WINDOW(win));
 }
-#endif
 
 static void toggle_tray_icon(GtkToggleButton * w, gpointer win)
 {
@@ -427,6 +425,10 @@ static GtkWidget *trg_prefs_generalPage(TrgPreferencesDialog * dlg)
 
     hig_workarea_add_row_w(t, &row, priv->fullUpdateCheck, w, NULL);
 
+    w = trgp_check_new(dlg, _("Skip unchanged torrents (delta sync)"),
+                       TRG_PREFS_KEY_DELTA_SYNC, TRG_PREFS_PROFILE, NULL);
+    hig_workarea_add_wide_control(t, &row, w);
+
     w = trgp_spin_new(dlg, TRG_PREFS_KEY_UPDATE_INTERVAL, 1, INT_MAX, 1,
                       TRG_PREFS_PROFILE, NULL);
     hig_workarea_add_row(t, &row, _("Update interval:"), w, NULL);
@@ -456,6 +458,10 @@ static GtkWidget *trg_prefs_generalPage(TrgPreferencesDialog * dlg)
                        TRG_PREFS_GLOBAL, NULL);
     hig_workarea_add_wide_control(t, &row, w);
 
+    w = trgp_spin_new(dlg, TRG_PREFS_KEY_ADD_CONCURRENCY, 1, 64, 1,
+                      TRG_PREFS_GLOBAL, NULL);
+    hig_workarea_add_row(t, &row, _("Concurrent adds:"), w, NULL);
+
 
     return t;
 }
@@ -750,13 +756,11 @@ static GtkWidget *trg_prefs_viewPage(TrgPreferencesDialog * dlg)
                      G_CALLBACK(notebook_toggled_cb), priv->win);
     hig_workarea_add_wide_control(t, &row, w);
 
-#if TRG_WITH_GRAPH
     w = trgp_check_new(dlg, _("Show graph"), TRG_PREFS_KEY_SHOW_GRAPH,
                        TRG_PREFS_GLOBAL, GTK_TOGGLE_BUTTON(w));
     g_signal_connect(G_OBJECT(w), "toggled", G_CALLBACK(toggle_graph),
                      priv->win);
     hig_workarea_add_wide_control(t, &row, w);
-#endif
 
 	hig_workarea_add_section_title(t, &row, _("System Tray"));
 
@@ -880,6 +884,12 @@ static GtkWidget *trg_prefs_serverPage(TrgPreferencesDialog * dlg)
 
 #endif
 
+    w = trgp_check_new(dlg,
+                       _("Compress large requests (if a proxy accepts them)"),
+                       TRG_PREFS_KEY_COMPRESS_REQUESTS, TRG_PREFS_PROFILE,
+                       NULL);
+    hig_workarea_add_wide_control(t, &row, w);
+
     w = trgp_spin_new(dlg, TRG_PREFS_KEY_TIMEOUT, 1, 3600, 1,
                       TRG_PREFS_PROFILE, NULL);
     hig_workarea_add_row(t, &row, _("Timeout:"), w, NULL);
@@ -43,6 +43,7 @@
 #define TRG_PREFS_KEY_AUTO_CONNECT  "auto-connect"
 #define TRG_PREFS_KEY_SSL            "ssl"
 #define TRG_PREFS_KEY_SSL_VALIDATE   "ssl-validate"
+#define TRG_PREFS_KEY_COMPRESS_REQUESTS "compress-requests"
 #define TRG_PREFS_KEY_TIMEOUT            "timeout"
 #define TRG_PREFS_KEY_RETRIES            "retries"
 #define TRG_PREFS_KEY_UPDATE_INTERVAL "update-interval"
@@ -64,7 +65,9 @@
 #define TRG_PREFS_KEY_ADD_OPTIONS_DIALOG "add-options-dialog"
 #define TRG_PREFS_KEY_START_PAUSED "start-paused"
 #define TRG_PREFS_KEY_UPDATE_ACTIVE_ONLY "update-active-only"
+#define TRG_PREFS_KEY_DELTA_SYNC "delta-sync"
 #define TRG_PREFS_KEY_DELETE_LOCAL_TORRENT "delete-local-torrent"
+#define TRG_PREFS_KEY_ADD_CONCURRENCY "add-concurrency"
 #define TRG_PREFS_STATE_SELECTOR_LAST "state-selector-last"
 #define TRG_PREFS_ACTIVEONLY_FULLSYNC_ENABLED   "activeonly-fullsync-enabled"
 #define TRG_PREFS_ACTIVEONLY_FULLSYNC_EVERY     "activeonly-fullsync-every"
@@ -58,7 +58,8 @@ struct _TrgStateSelectorPrivate {
     TrgPrefs *prefs;
     GHashTable *trackers;
     GHashTable *directories;
-    GRegex *urlHostRegex;
+    TrgTorrentModel *torrentModel;
+    GQuark selectedName;
     gint n_categories;
     GtkListStore *store;
     GtkTreeRowReference *error_rr;
@@ -74,10 +75,11 @@ struct _TrgStateSelectorPrivate {
     GtkTreeRowReference *down_wait_rr;
 };
 
-GRegex *trg_state_selector_get_url_host_regex(TrgStateSelector * s)
+/* The selected tracker or directory, so filtering doesn't need its name. */
+GQuark trg_state_selector_get_selected_name(TrgStateSelector * s)
 {
     TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
-    return priv->urlHostRegex;
+    return priv->selectedName;
 }
 
 guint32 trg_state_selector_get_flag(TrgStateSelector * s)
@@ -93,15 +95,22 @@ state_selection_changed(GtkTreeSelection * selection, gpointer data)
     GtkTreeIter iter;
     GtkTreeModel *stateModel;
     guint index = 0;
+    gchar *name = NULL;
 
     priv = TRG_STATE_SELECTOR_GET_PRIVATE(data);
 
     if (gtk_tree_selection_get_selected(selection, &stateModel, &iter))
         gtk_tree_model_get(stateModel, &iter, STATE_SELECTOR_BIT,
-                           &priv->flag, STATE_SELECTOR_INDEX, &index, -1);
+                           &priv->flag, STATE_SELECTOR_INDEX, &index,
+                           STATE_SELECTOR_NAME, &name, -1);
     else
         priv->flag = 0;
 
+    priv->selectedName =
+        (priv->flag & (FILTER_FLAG_TRACKER | FILTER_FLAG_DIR)) && name ?
+        g_quark_from_string(name) : 0;
+    g_free(name);
+
     trg_prefs_set_int(priv->prefs, TRG_PREFS_STATE_SELECTOR_LAST, index,
                       TRG_PREFS_GLOBAL);
 
@@ -160,42 +169,6 @@ gchar *trg_state_selector_get_selected_text(TrgStateSelector * s)
     return name;
 }
 
-static void
-trg_state_selector_update_dynamic_filter(GtkTreeModel * model,
-                                         GtkTreeRowReference *
-                                         rr, gint64 serial)
-{
-    GtkTreeIter iter;
-    GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
-    gint64 oldSerial;
-    GValue gvalue = G_VALUE_INIT;
-    gint oldCount;
-
-    gtk_tree_model_get_iter(model, &iter, path);
-    gtk_tree_model_get(model, &iter, STATE_SELECTOR_SERIAL, &oldSerial,
-                       STATE_SELECTOR_COUNT, &oldCount, -1);
-
-    if (oldSerial != serial) {
-        g_value_init(&gvalue, G_TYPE_INT);
-        g_value_set_int(&gvalue, 1);
-        gtk_list_store_set_value(GTK_LIST_STORE(model), &iter,
-                                 STATE_SELECTOR_COUNT, &gvalue);
-
-        memset(&gvalue, 0, sizeof(GValue));
-        g_value_init(&gvalue, G_TYPE_INT64);
-        g_value_set_int64(&gvalue, serial);
-        gtk_list_store_set_value(GTK_LIST_STORE(model), &iter,
-                                 STATE_SELECTOR_SERIAL, &gvalue);
-    } else {
-        g_value_init(&gvalue, G_TYPE_INT);
-        g_value_set_int(&gvalue, ++oldCount);
-        gtk_list_store_set_value(GTK_LIST_STORE(model), &iter,
-                                 STATE_SELECTOR_COUNT, &gvalue);
-    }
-
-    gtk_tree_path_free(path);
-}
-
 static void refresh_statelist_cb(GtkWidget * w, gpointer data)
 {
     TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(data);
@@ -297,143 +270,105 @@ trg_state_selector_insert(TrgStateSelector * s, int offset,
     gtk_list_store_insert(GTK_LIST_STORE(model), iter, args.pos);
 }
 
-void trg_state_selector_update(TrgStateSelector * s, guint whatsChanged)
+/* Tracker and directory counts come straight from the torrent model's
+ * indexes, rather than going through every torrent.
+ */
+static void
+trg_state_selector_update_index(TrgStateSelector * s, GHashTable * index,
+                                guint32 bit, gint64 updateSerial)
 {
     TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
     GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(s));
-    TrgClient *client = priv->client;
-    gint64 updateSerial = trg_client_get_serial(client);
-    GList *torrentItemRefs;
-    GtkTreeIter torrentIter, iter;
-    GList *trackersList, *trackerItem, *li;
-    GtkTreeRowReference *rr;
-    GtkTreePath *path;
-    GtkTreeModel *torrentModel;
-    gpointer result;
-    struct cruft_remove_args cruft;
+    gboolean isTracker = bit == FILTER_FLAG_TRACKER;
+    GHashTable *rows = isTracker ? priv->trackers : priv->directories;
+    GHashTableIter hiter;
+    gpointer key, value;
+    GtkTreeIter iter;
 
-    if (!trg_client_is_connected(client))
-        return;
+    g_hash_table_iter_init(&hiter, index);
 
-    torrentItemRefs =
-        g_hash_table_get_values(trg_client_get_torrent_table(client));
+    while (g_hash_table_iter_next(&hiter, &key, &value)) {
+        const gchar *name = g_quark_to_string(GPOINTER_TO_UINT(key));
+        gint count = ((trg_torrent_category *) value)->count;
+        GtkTreeRowReference *rr = g_hash_table_lookup(rows, name);
 
-    for (li = torrentItemRefs; li; li = g_list_next(li)) {
-        JsonObject *t = NULL;
-        rr = (GtkTreeRowReference *) li->data;
-        path = gtk_tree_row_reference_get_path(rr);
-        torrentModel = gtk_tree_row_reference_get_model(rr);
+        if (rr) {
+            GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
 
-        if (path) {
-            if (gtk_tree_model_get_iter(torrentModel, &torrentIter, path)) {
-                gtk_tree_model_get(torrentModel, &torrentIter,
-                                   TORRENT_COLUMN_JSON, &t, -1);
-            }
+            gtk_tree_model_get_iter(model, &iter, path);
+            gtk_list_store_set(GTK_LIST_STORE(model), &iter,
+                               STATE_SELECTOR_COUNT, count,
+                               STATE_SELECTOR_SERIAL, updateSerial, -1);
             gtk_tree_path_free(path);
-        }
-
-        if (!t)
             continue;
-
-        if (priv->showTrackers
-            && (whatsChanged & TORRENT_UPDATE_ADDREMOVE)) {
-            trackersList =
-                json_array_get_elements(torrent_get_tracker_stats(t));
-            for (trackerItem = trackersList; trackerItem;
-                 trackerItem = g_list_next(trackerItem)) {
-                JsonObject *tracker =
-                    json_node_get_object((JsonNode *) trackerItem->data);
-                const gchar *announceUrl =
-                    tracker_stats_get_announce(tracker);
-                gchar *announceHost =
-                    trg_gregex_get_first(priv->urlHostRegex,
-                                         announceUrl);
-
-                if (!announceHost)
-                    continue;
-
-                result = g_hash_table_lookup(priv->trackers, announceHost);
-
-                if (result) {
-                    trg_state_selector_update_dynamic_filter(model,
-                                                             (GtkTreeRowReference
-                                                              *) result,
-                                                             updateSerial);
-                    g_free(announceHost);
-                } else {
-					if (priv->dirsFirst){
-							trg_state_selector_insert(s, priv->n_categories +
-										g_hash_table_size(priv->directories), -1, announceHost, &iter);
-					} else {
-						trg_state_selector_insert(s, priv->n_categories,
-										g_hash_table_size(priv->trackers), announceHost, &iter);
-					}
-                    gtk_list_store_set(GTK_LIST_STORE(model), &iter,
-                                       STATE_SELECTOR_ICON,
-                                       GTK_STOCK_NETWORK,
-                                       STATE_SELECTOR_NAME, announceHost,
-                                       STATE_SELECTOR_SERIAL, updateSerial,
-                                       STATE_SELECTOR_COUNT, 1,
-                                       STATE_SELECTOR_BIT,
-                                       FILTER_FLAG_TRACKER,
-                                       STATE_SELECTOR_INDEX, 0, -1);
-                    g_hash_table_insert(priv->trackers, announceHost,
-                                        quick_tree_ref_new(model, &iter));
-                }
-            }
-            g_list_free(trackersList);
         }
 
-        if (priv->showDirs && ((whatsChanged & TORRENT_UPDATE_ADDREMOVE)
-                               || (whatsChanged &
-                                   TORRENT_UPDATE_PATH_CHANGE))) {
-            gchar *dir;
-            gtk_tree_model_get(torrentModel, &torrentIter,
-                               TORRENT_COLUMN_DOWNLOADDIR_SHORT, &dir, -1);
-
-            result = g_hash_table_lookup(priv->directories, dir);
-            if (result) {
-                trg_state_selector_update_dynamic_filter(model,
-                                                         (GtkTreeRowReference
-                                                          *) result,
-                                                         updateSerial);
-            } else {
-                if (priv->dirsFirst){
-					trg_state_selector_insert(s, priv->n_categories,
-								g_hash_table_size(priv->directories), dir, &iter);
-				} else {
-					trg_state_selector_insert(s, priv->n_categories +
-									g_hash_table_size(priv->trackers), -1, dir, &iter);
-				}
-                gtk_list_store_set(GTK_LIST_STORE(model), &iter,
-                                   STATE_SELECTOR_ICON,
-                                   GTK_STOCK_DIRECTORY,
-                                   STATE_SELECTOR_NAME, dir,
-                                   STATE_SELECTOR_SERIAL, updateSerial,
-                                   STATE_SELECTOR_BIT, FILTER_FLAG_DIR,
-                                   STATE_SELECTOR_COUNT, 1,
-                                   STATE_SELECTOR_INDEX, 0, -1);
-                g_hash_table_insert(priv->directories, g_strdup(dir),
-                                    quick_tree_ref_new(model, &iter));
-            }
-
-            g_free(dir);
+        if (isTracker == priv->dirsFirst) {
+            trg_state_selector_insert(s, priv->n_categories +
+                                      g_hash_table_size(isTracker ?
+                                                        priv->directories
+                                                        : priv->trackers),
+                                      -1, name, &iter);
+        } else {
+            trg_state_selector_insert(s, priv->n_categories,
+                                      g_hash_table_size(rows), name,
+                                      &iter);
         }
+
+        gtk_list_store_set(GTK_LIST_STORE(model), &iter,
+                           STATE_SELECTOR_ICON,
+                           isTracker ? GTK_STOCK_NETWORK :
+                           GTK_STOCK_DIRECTORY,
+                           STATE_SELECTOR_NAME, name,
+                           STATE_SELECTOR_SERIAL, updateSerial,
+                           STATE_SELECTOR_COUNT, count,
+                           STATE_SELECTOR_BIT, bit,
+                           STATE_SELECTOR_INDEX, 0, -1);
+        g_hash_table_insert(rows, g_strdup(name),
+                            quick_tree_ref_new(model, &iter));
     }
+}
+
+void trg_state_selector_update(TrgStateSelector * s, guint whatsChanged)
+{
+    TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
+    TrgClient *client = priv->client;
+    gint64 updateSerial = trg_client_get_serial(client);
+    struct cruft_remove_args cruft;
+    gboolean updateTrackers, updateDirs;
+
+    if (!trg_client_is_connected(client))
+        return;
+
+    updateTrackers = priv->showTrackers
+        && (whatsChanged & (TORRENT_UPDATE_ADDREMOVE |
+                            TORRENT_UPDATE_TRACKER_CHANGE));
+    updateDirs = priv->showDirs
+        && (whatsChanged & (TORRENT_UPDATE_ADDREMOVE |
+                            TORRENT_UPDATE_PATH_CHANGE));
+
+    if (updateTrackers)
+        trg_state_selector_update_index(s,
+                                        trg_torrent_model_get_tracker_index
+                                        (priv->torrentModel),
+                                        FILTER_FLAG_TRACKER, updateSerial);
 
-    g_list_free(torrentItemRefs);
+    if (updateDirs)
+        trg_state_selector_update_index(s,
+                                        trg_torrent_model_get_dir_index
+                                        (priv->torrentModel),
+                                        FILTER_FLAG_DIR, updateSerial);
 
-    cruft.serial = trg_client_get_serial(client);
+    cruft.serial = updateSerial;
 
-    if (priv->showTrackers && ((whatsChanged & TORRENT_UPDATE_ADDREMOVE))) {
+    if (updateTrackers) {
         cruft.table = priv->trackers;
         g_hash_table_foreach_remove(priv->trackers,
                                     trg_state_selector_remove_cruft,
                                     &cruft);
     }
 
-    if (priv->showDirs && ((whatsChanged & TORRENT_UPDATE_ADDREMOVE)
-                           || (whatsChanged & TORRENT_UPDATE_PATH_CHANGE))) {
+    if (updateDirs) {
         cruft.table = priv->directories;
         g_hash_table_foreach_remove(priv->directories,
                                     trg_state_selector_remove_cruft,
@@ -465,6 +400,12 @@ on_torrents_state_change(TrgTorrentModel * model,
                                         (model));
 }
 
+gboolean trg_state_selector_get_show_trackers(TrgStateSelector * s)
+{
+    TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
+    return priv->showTrackers;
+}
+
 void
 trg_state_selector_set_show_trackers(TrgStateSelector * s, gboolean show)
 {
@@ -610,6 +551,10 @@ TrgStateSelector *trg_state_selector_new(TrgClient * client,
     TrgStateSelector *selector =
         g_object_new(TRG_TYPE_STATE_SELECTOR, "client",
                      client, NULL);
+    TrgStateSelectorPrivate *priv =
+        TRG_STATE_SELECTOR_GET_PRIVATE(selector);
+
+    priv->torrentModel = tmodel;
     g_signal_connect(tmodel, "torrents-state-change",
                      G_CALLBACK(on_torrents_state_change), selector);
     return selector;
@@ -639,7 +584,6 @@ static GObject *trg_state_selector_constructor(GType type,
     selector = TRG_STATE_SELECTOR(object);
     priv = TRG_STATE_SELECTOR_GET_PRIVATE(object);
 
-    priv->urlHostRegex = trg_uri_host_regex_new();
     priv->trackers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
                                            (GDestroyNotify)
                                            remove_row_ref_and_free);
@@ -67,8 +67,9 @@ TrgStateSelector *trg_state_selector_new(TrgClient * client,
 G_END_DECLS guint32 trg_state_selector_get_flag(TrgStateSelector * s);
 void trg_state_selector_update(TrgStateSelector * s, guint whatsChanged);
 gchar *trg_state_selector_get_selected_text(TrgStateSelector * s);
-GRegex *trg_state_selector_get_url_host_regex(TrgStateSelector * s);
+GQuark trg_state_selector_get_selected_name(TrgStateSelector * s);
 void trg_state_selector_disconnect(TrgStateSelector * s);
+gboolean trg_state_selector_get_show_trackers(TrgStateSelector * s);
 void trg_state_selector_set_show_trackers(TrgStateSelector * s,
                                           gboolean show);
 void trg_state_selector_set_directories_first(TrgStateSelector * s, gboolean _dirsFirst);
@@ -0,0 +1,246 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+
+#include "trg-client.h"
+#include "trg-synthetic.h"
+
+#define SYNTHETIC_DIRS 20
+#define SYNTHETIC_TRACKERS 50
+#define SYNTHETIC_PIECE 262144
+
+/* The same torrents are active in a poll every time it's generated. */
+gboolean
+trg_synthetic_is_active(const trg_synthetic_session * s, guint i,
+                        guint poll)
+{
+    guint32 h = (i * 2654435761u) ^ (poll * 40503u);
+
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+
+    return (h % 10000) < (guint32) (s->churn * 10000);
+}
+
+gchar *trg_synthetic_session_get(void)
+{
+    return g_strdup("{\"arguments\":{"
+                    "\"alt-speed-down\":50,\"alt-speed-enabled\":false,"
+                    "\"alt-speed-time-begin\":540,"
+                    "\"alt-speed-time-enabled\":false,"
+                    "\"alt-speed-time-end\":1020,"
+                    "\"alt-speed-time-day\":127,\"alt-speed-up\":50,"
+                    "\"blocklist-enabled\":false,\"blocklist-size\":0,"
+                    "\"blocklist-url\":\"http://www.example.com/blocklist\","
+                    "\"cache-size-mb\":4,\"dht-enabled\":true,"
+                    "\"download-dir\":\"/downloads\","
+                    "\"download-dir-free-space\":1099511627776,"
+                    "\"download-queue-enabled\":true,"
+                    "\"download-queue-size\":5,\"encryption\":\"preferred\","
+                    "\"incomplete-dir\":\"/downloads/incomplete\","
+                    "\"incomplete-dir-enabled\":false,\"lpd-enabled\":false,"
+                    "\"peer-limit-global\":200,"
+                    "\"peer-limit-per-torrent\":50,\"peer-port\":51413,"
+                    "\"peer-port-random-on-start\":false,"
+                    "\"pex-enabled\":true,\"port-forwarding-enabled\":false,"
+                    "\"queue-stalled-enabled\":true,"
+                    "\"queue-stalled-minutes\":30,"
+                    "\"rename-partial-files\":true,\"rpc-version\":15,"
+                    "\"rpc-version-minimum\":1,"
+                    "\"script-torrent-done-enabled\":false,"
+                    "\"script-torrent-done-filename\":\"\","
+                    "\"seed-queue-enabled\":false,\"seed-queue-size\":10,"
+                    "\"seedRatioLimit\":2,\"seedRatioLimited\":false,"
+                    "\"speed-limit-down\":100,"
+                    "\"speed-limit-down-enabled\":false,"
+                    "\"speed-limit-up\":100,\"speed-limit-up-enabled\":false,"
+                    "\"start-added-torrents\":true,"
+                    "\"trash-original-torrent-files\":false,"
+                    "\"version\":\"2.94 (synthetic)\"},"
+                    "\"result\":\"success\"}");
+}
+
+static void
+synthetic_details(GString * out, const trg_synthetic_session * s,
+                  guint poll)
+{
+    guint i;
+
+    g_string_append(out, ",\"files\":[");
+    for (i = 0; i < s->files; i++)
+        g_string_append_printf(out,
+                               "%s{\"bytesCompleted\":%u,\"length\":%u,"
+                               "\"name\":\"synthetic/dir%u/file%u.bin\"}",
+                               i ? "," : "",
+                               (i * 7919u + poll * 4096u) % 1048576u,
+                               1048576u, i / 100, i);
+
+    g_string_append(out, "],\"wanted\":[");
+    for (i = 0; i < s->files; i++)
+        g_string_append_printf(out, "%s%d", i ? "," : "", (i % 10) != 0);
+
+    g_string_append(out, "],\"priorities\":[");
+    for (i = 0; i < s->files; i++)
+        g_string_append_printf(out, "%s%d", i ? "," : "",
+                               (gint) (i % 3) - 1);
+
+    g_string_append(out, "],\"peers\":[");
+    for (i = 0; i < s->peers; i++)
+        g_string_append_printf(out,
+                               "%s{\"address\":\"10.%u.%u.%u\","
+                               "\"clientName\":\"Synthetic 1.0\","
+                               "\"flagStr\":\"DEX\",\"isEncrypted\":%s,"
+                               "\"isDownloadingFrom\":true,"
+                               "\"isUploadingTo\":false,\"port\":51413,"
+                               "\"progress\":%.3f,\"rateToClient\":%u,"
+                               "\"rateToPeer\":%u}",
+                               i ? "," : "", (i >> 16) & 0xff,
+                               (i >> 8) & 0xff, i & 0xff,
+                               i % 2 ? "true" : "false",
+                               (i % 1000) / 1000.0,
+                               ((i + poll) * 1031u) % 500000u,
+                               ((i + poll) * 733u) % 100000u);
+
+    g_string_append(out, "],\"comment\":\"\",\"creator\":\"synthetic\","
+                    "\"dateCreated\":1500000000,\"isPrivate\":false,"
+                    "\"magnetLink\":\"magnet:?xt=urn:btih:0\","
+                    "\"corruptEver\":0,\"honorsSessionLimits\":true,"
+                    "\"uploadLimit\":100,\"uploadLimited\":false,"
+                    "\"downloadLimit\":100,\"downloadLimited\":false,"
+                    "\"peer-limit\":50");
+}
+
+static void
+synthetic_torrent(GString * out, const trg_synthetic_session * s,
+                  guint i, guint poll, gboolean details)
+{
+    gboolean active = trg_synthetic_is_active(s, i, poll);
+    guint status = i % 7;
+    guint64 size = (guint64) (1 + i % 4096) * SYNTHETIC_PIECE * 16;
+    gdouble done = status == 6 ? 1.0 : ((i * 37u + poll) % 1000) / 1000.0;
+    guint tracker = i % SYNTHETIC_TRACKERS;
+
+    g_string_append_printf(out,
+                           "{\"id\":%u,\"name\":\"Synthetic torrent %u "
+                           "linux-%u.iso\",\"status\":%u,\"error\":0,"
+                           "\"errorString\":\"\",\"isFinished\":false,"
+                           "\"rateUpload\":%u,\"rateDownload\":%u,"
+                           "\"eta\":%d,\"percentDone\":%.4f,"
+                           "\"recheckProgress\":0,"
+                           "\"metadataPercentComplete\":1,"
+                           "\"sizeWhenDone\":%" G_GUINT64_FORMAT
+                           ",\"totalSize\":%" G_GUINT64_FORMAT
+                           ",\"haveValid\":%" G_GUINT64_FORMAT
+                           ",\"haveUnchecked\":0,\"downloadedEver\":%"
+                           G_GUINT64_FORMAT ",\"uploadedEver\":%"
+                           G_GUINT64_FORMAT ",\"leftUntilDone\":%"
+                           G_GUINT64_FORMAT ",\"peersConnected\":%u,"
+                           "\"peersSendingToUs\":%u,"
+                           "\"peersGettingFromUs\":%u,"
+                           "\"webseedsSendingToUs\":0,"
+                           "\"addedDate\":%u,\"doneDate\":0,"
+                           "\"activityDate\":%u,"
+                           "\"downloadDir\":\"/downloads/dir%u\","
+                           "\"seedRatioLimit\":2,\"seedRatioMode\":0,"
+                           "\"hashString\":\"%040x\","
+                           "\"bandwidthPriority\":0,\"queuePosition\":%u,"
+                           "\"peersFrom\":{\"fromCache\":0,\"fromDht\":%u,"
+                           "\"fromIncoming\":0,\"fromLpd\":0,"
+                           "\"fromLtep\":0,\"fromPex\":%u,"
+                           "\"fromTracker\":%u},\"trackerStats\":[{"
+                           "\"id\":0,\"tier\":0,"
+                           "\"host\":\"tracker%u.example.org\","
+                           "\"announce\":\"http://tracker%u.example.org/"
+                           "announce\",\"scrape\":\"http://tracker%u."
+                           "example.org/scrape\",\"seederCount\":%u,"
+                           "\"leecherCount\":%u,\"downloadCount\":%u,"
+                           "\"lastAnnounceResult\":\"Success\","
+                           "\"lastAnnouncePeerCount\":%u,"
+                           "\"lastAnnounceTime\":%u,"
+                           "\"lastScrapeTime\":%u}]",
+                           i, i, i, status,
+                           active ? (i * 131u + poll) % 200000u : 0,
+                           active && status == 4 ?
+                           (i * 977u + poll) % 2000000u : 0,
+                           status == 4 ? (gint) (i % 86400) : -1, done,
+                           size, size, (guint64) (size * done),
+                           (guint64) (size * done), (guint64) (size / 3),
+                           (guint64) (size * (1.0 - done)),
+                           active ? 1 + i % 30 : 0, active ? i % 10 : 0,
+                           active ? i % 5 : 0, 1400000000u + i,
+                           1500000000u + (active ? poll : 0),
+                           i % SYNTHETIC_DIRS, i, i, active ? i % 7 : 0,
+                           active ? i % 3 : 0, active ? 1 + i % 20 : 0,
+                           tracker, tracker, tracker, i % 500, i % 200,
+                           i % 10000, i % 50, 1500000000u + poll,
+                           1500000000u + poll);
+
+    if (details)
+        synthetic_details(out, s, poll);
+
+    g_string_append_c(out, '}');
+}
+
+/* A torrent-get response as the daemon would send it for the request tag:
+ * all torrents (TORRENT_GET_TAG_MODE_FULL), those active in this poll
+ * (TORRENT_GET_TAG_MODE_UPDATE) or one with its details.
+ */
+GString *trg_synthetic_torrent_get(const trg_synthetic_session * s,
+                                   guint poll, gint64 id)
+{
+    GString *out = g_string_sized_new(s->torrents * 1024 + 256);
+    gboolean first = TRUE;
+    guint i;
+
+    g_string_append(out, "{\"arguments\":{\"torrents\":[");
+
+    for (i = 0; i < s->torrents; i++) {
+        if (id >= 0 && (gint64) i != id)
+            continue;
+        else if (id == TORRENT_GET_TAG_MODE_UPDATE
+                 && !trg_synthetic_is_active(s, i, poll))
+            continue;
+
+        if (!first)
+            g_string_append_c(out, ',');
+
+        synthetic_torrent(out, s, i, poll, id >= 0);
+        first = FALSE;
+    }
+
+    g_string_append(out, "]");
+
+    if (id == TORRENT_GET_TAG_MODE_UPDATE)
+        g_string_append(out, ",\"removed\":[]");
+
+    g_string_append(out, "},\"result\":\"success\"");
+
+    if (id >= 0)
+        g_string_append_printf(out, ",\"tag\":%" G_GINT64_FORMAT, id);
+
+    g_string_append(out, "}");
+
+    return out;
+}
@@ -0,0 +1,41 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TRG_SYNTHETIC_H_
+#define TRG_SYNTHETIC_H_
+
+#include <glib.h>
+
+/* Made up daemon responses, for the benchmark to replay. Torrent 0 is the
+ * one with files and peers. */
+
+typedef struct {
+    guint torrents;
+    guint files;                /* per detailed torrent */
+    guint peers;
+    gdouble churn;              /* share of torrents active each poll */
+} trg_synthetic_session;
+
+gchar *trg_synthetic_session_get(void);
+GString *trg_synthetic_torrent_get(const trg_synthetic_session * s,
+                                   guint poll, gint64 id);
+gboolean trg_synthetic_is_active(const trg_synthetic_session * s,
+                                 guint i, guint poll);
+
+#endif                          /* TRG_SYNTHETIC_H_ */
@@ -39,6 +39,7 @@
 #include "trg-torrent-add-dialog.h"
 #include "trg-files-tree-view-common.h"
 #include "trg-files-model-common.h"
+#include "trg-files-tree-model.h"
 #include "trg-cell-renderer-size.h"
 #include "trg-cell-renderer-priority.h"
 #include "trg-cell-renderer-file-icon.h"
@@ -55,10 +56,6 @@ enum {
     PROP_0, PROP_FILENAME, PROP_PARENT, PROP_CLIENT, PROP_UPLOAD
 };
 
-enum {
-    FC_INDEX, FC_LABEL, FC_SIZE, FC_PRIORITY, FC_ENABLED, N_FILE_COLS
-};
-
 G_DEFINE_TYPE(TrgTorrentAddDialog, trg_torrent_add_dialog, GTK_TYPE_DIALOG)
 #define TRG_TORRENT_ADD_DIALOG_GET_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_TORRENT_ADD_DIALOG, TrgTorrentAddDialogPrivate))
@@ -73,7 +70,7 @@ struct _TrgTorrentAddDialogPrivate {
     GtkWidget *dest_combo;
     GtkWidget *priority_combo;
     GtkWidget *file_list;
-    GtkTreeStore *store;
+    TrgFilesTreeModel *store;
     GtkWidget *paused_check;
     GtkWidget *delete_check;
     guint n_files;
@@ -125,25 +122,23 @@ trg_torrent_add_dialog_get_property(GObject * object,
     }
 }
 
-static gboolean
-add_file_indexes_foreachfunc(GtkTreeModel * model,
-                             GtkTreePath *
-                             path G_GNUC_UNUSED,
-                             GtkTreeIter * iter, gpointer data)
+/* Every file is in the tree by its index, nothing needs looking up in the
+ * model.
+ */
+static void
+add_file_indexes(trg_upload * upload, trg_files_tree * tree)
 {
-    trg_upload *upload = (trg_upload *) data;
-    gint priority, index, wanted;
+    guint i;
 
-    gtk_tree_model_get(model, iter, FC_PRIORITY, &priority, FC_ENABLED,
-                       &wanted, FC_INDEX, &index, -1);
+    for (i = 0; tree && i < tree->files->len && i < upload->n_files; i++) {
+        trg_files_tree_node *file = g_ptr_array_index(tree->files, i);
 
-    if (gtk_tree_model_iter_has_child(model, iter) || index < 0)
-        return FALSE;
+        if (!file)
+            continue;
 
-    upload->file_wanted[index] = wanted;
-    upload->file_priorities[index] = priority;
-
-    return FALSE;
+        upload->file_wanted[i] = file->enabled;
+        upload->file_priorities[i] = file->priority;
+    }
 }
 
 static void
@@ -187,8 +182,8 @@ trg_torrent_add_response_cb(GtkDialog * dlg, gint res_id, gpointer data)
         upload->file_priorities = g_new0(gint, priv->n_files);
         upload->file_wanted = g_new0(gint, priv->n_files);
 
-        gtk_tree_model_foreach(GTK_TREE_MODEL(priv->store),
-                                               add_file_indexes_foreachfunc, upload);
+        add_file_indexes(upload,
+                         trg_files_tree_model_get_tree(priv->store));
 
         trg_do_upload(upload);
 
@@ -203,37 +198,37 @@ trg_torrent_add_response_cb(GtkDialog * dlg, gint res_id, gpointer data)
 
 static void set_low(GtkWidget * w G_GNUC_UNUSED, gpointer data)
 {
-    trg_files_tree_model_set_priority(GTK_TREE_VIEW(data), FC_PRIORITY,
+    trg_files_tree_model_set_priority(GTK_TREE_VIEW(data), FILESCOL_PRIORITY,
                                       TR_PRI_LOW);
 }
 
 static void set_normal(GtkWidget * w G_GNUC_UNUSED, gpointer data)
 {
-    trg_files_tree_model_set_priority(GTK_TREE_VIEW(data), FC_PRIORITY,
+    trg_files_tree_model_set_priority(GTK_TREE_VIEW(data), FILESCOL_PRIORITY,
                                       TR_PRI_NORMAL);
 }
 
 static void set_high(GtkWidget * w G_GNUC_UNUSED, gpointer data)
 {
-    trg_files_tree_model_set_priority(GTK_TREE_VIEW(data), FC_PRIORITY,
+    trg_files_tree_model_set_priority(GTK_TREE_VIEW(data), FILESCOL_PRIORITY,
                                       TR_PRI_HIGH);
 }
 
 static void set_unwanted(GtkWidget * w G_GNUC_UNUSED, gpointer data)
 {
-    trg_files_model_set_wanted(GTK_TREE_VIEW(data), FC_ENABLED, FALSE);
+    trg_files_model_set_wanted(GTK_TREE_VIEW(data), FILESCOL_WANTED, FALSE);
 }
 
 static void set_wanted(GtkWidget * w G_GNUC_UNUSED, gpointer data)
 {
-    trg_files_model_set_wanted(GTK_TREE_VIEW(data), FC_ENABLED, TRUE);
+    trg_files_model_set_wanted(GTK_TREE_VIEW(data), FILESCOL_WANTED, TRUE);
 }
 
 static gboolean
 onViewButtonPressed(GtkWidget * w, GdkEventButton * event, gpointer gdata)
 {
-    return trg_files_tree_view_onViewButtonPressed(w, event, FC_PRIORITY,
-                                                   FC_ENABLED,
+    return trg_files_tree_view_onViewButtonPressed(w, event, FILESCOL_PRIORITY,
+                                                   FILESCOL_WANTED,
                                                    G_CALLBACK(set_low),
                                                    G_CALLBACK(set_normal),
                                                    G_CALLBACK(set_high),
@@ -242,7 +237,7 @@ onViewButtonPressed(GtkWidget * w, GdkEventButton * event, gpointer gdata)
                                                    (set_unwanted), gdata);
 }
 
-static GtkWidget *gtr_file_list_new(GtkTreeStore ** store)
+static GtkWidget *gtr_file_list_new(TrgFilesTreeModel ** store)
 {
     int size;
     int width;
@@ -276,7 +271,7 @@ static GtkWidget *gtr_file_list_new(GtkTreeStore ** store)
     sel = gtk_tree_view_get_selection(tree_view);
     gtk_tree_selection_set_mode(sel, GTK_SELECTION_MULTIPLE);
     gtk_tree_view_expand_all(tree_view);
-    gtk_tree_view_set_search_column(tree_view, FC_LABEL);
+    gtk_tree_view_set_search_column(tree_view, FILESCOL_NAME);
 
     /* add file column */
     col = GTK_TREE_VIEW_COLUMN(g_object_new(GTK_TYPE_TREE_VIEW_COLUMN,
@@ -285,16 +280,16 @@ static GtkWidget *gtr_file_list_new(GtkTreeStore ** store)
     gtk_tree_view_column_set_resizable(col, TRUE);
     rend = trg_cell_renderer_file_icon_new();
     gtk_tree_view_column_pack_start(col, rend, FALSE);
-    gtk_tree_view_column_set_attributes(col, rend, "file-name", FC_LABEL,
-                                        "file-id", FC_INDEX, NULL);
+    gtk_tree_view_column_set_attributes(col, rend, "file-name", FILESCOL_NAME,
+                                        "file-id", FILESCOL_ID, NULL);
 
     /* add text renderer */
     rend = gtk_cell_renderer_text_new();
     g_object_set(rend, "ellipsize", PANGO_ELLIPSIZE_END, "font-desc",
                  pango_font_description, NULL);
     gtk_tree_view_column_pack_start(col, rend, TRUE);
-    gtk_tree_view_column_set_attributes(col, rend, "text", FC_LABEL, NULL);
-    gtk_tree_view_column_set_sort_column_id(col, FC_LABEL);
+    gtk_tree_view_column_set_attributes(col, rend, "text", FILESCOL_NAME, NULL);
+    gtk_tree_view_column_set_sort_column_id(col, FILESCOL_NAME);
     gtk_tree_view_append_column(tree_view, col);
 
     /* add "size" column */
@@ -306,8 +301,8 @@ static GtkWidget *gtr_file_list_new(GtkTreeStore ** store)
                  "yalign", 0.5f, NULL);
     col = gtk_tree_view_column_new_with_attributes(title, rend, NULL);
     gtk_tree_view_column_set_sizing(col, GTK_TREE_VIEW_COLUMN_GROW_ONLY);
-    gtk_tree_view_column_set_sort_column_id(col, FC_SIZE);
-    gtk_tree_view_column_set_attributes(col, rend, "size-value", FC_SIZE,
+    gtk_tree_view_column_set_sort_column_id(col, FILESCOL_SIZE);
+    gtk_tree_view_column_set_attributes(col, rend, "size-value", FILESCOL_SIZE,
                                         NULL);
     gtk_tree_view_append_column(tree_view, col);
 
@@ -321,10 +316,10 @@ static GtkWidget *gtr_file_list_new(GtkTreeStore ** store)
     col =
         gtk_tree_view_column_new_with_attributes(title, rend,
                                                  "wanted-value",
-                                                 FC_ENABLED, NULL);
+                                                 FILESCOL_WANTED, NULL);
     gtk_tree_view_column_set_fixed_width(col, width);
     gtk_tree_view_column_set_sizing(col, GTK_TREE_VIEW_COLUMN_FIXED);
-    gtk_tree_view_column_set_sort_column_id(col, FC_ENABLED);
+    gtk_tree_view_column_set_sort_column_id(col, FILESCOL_WANTED);
     gtk_tree_view_append_column(tree_view, col);
 
     /* add priority column */
@@ -336,17 +331,13 @@ static GtkWidget *gtr_file_list_new(GtkTreeStore ** store)
     rend = trg_cell_renderer_priority_new();
     col = gtk_tree_view_column_new_with_attributes(title, rend,
                                                    "priority-value",
-                                                   FC_PRIORITY, NULL);
+                                                   FILESCOL_PRIORITY, NULL);
     gtk_tree_view_column_set_fixed_width(col, width);
     gtk_tree_view_column_set_sizing(col, GTK_TREE_VIEW_COLUMN_FIXED);
-    gtk_tree_view_column_set_sort_column_id(col, FC_PRIORITY);
+    gtk_tree_view_column_set_sort_column_id(col, FILESCOL_PRIORITY);
     gtk_tree_view_append_column(tree_view, col);
 
-    *store = gtk_tree_store_new(N_FILE_COLS, G_TYPE_INT,        /* index */
-                                G_TYPE_STRING,  /* label */
-                                G_TYPE_INT64,   /* size */
-                                G_TYPE_INT,     /* priority */
-                                G_TYPE_INT);    /* dl enabled */
+    *store = trg_files_tree_model_new();
 
     gtk_tree_view_set_model(tree_view, GTK_TREE_MODEL(*store));
     g_object_unref(G_OBJECT(*store));
@@ -399,27 +390,14 @@ static void addTorrentFilters(GtkFileChooser * chooser)
     gtk_file_chooser_add_filter(chooser, filter);
 }
 
+/* The model takes the tree over and shows it as it is. */
 static void
-store_add_node(GtkTreeStore * store, GtkTreeIter * parent,
-               trg_files_tree_node * node, guint *n_files)
+trg_torrent_add_dialog_fill_store(TrgTorrentAddDialogPrivate * priv,
+                                  trg_torrent_file * tor_data)
 {
-    GtkTreeIter child;
-    GList *li;
-
-    if (node->name) {
-        gtk_tree_store_append(store, &child, parent);
-        gtk_tree_store_set(store, &child, FC_LABEL, node->name, FC_ENABLED,
-                           1, FC_INDEX, node->index,
-                           FC_PRIORITY, TR_PRI_NORMAL,
-                           FC_SIZE, node->length, -1);
-
-        if (!node->children)
-            *n_files = *n_files + 1;
-    }
-
-    for (li = node->children; li; li = g_list_next(li))
-        store_add_node(store, node->name ? &child : NULL,
-                       (trg_files_tree_node *) li->data, n_files);
+    priv->n_files = tor_data->tree->files->len;
+    trg_files_tree_model_set_tree(priv->store, tor_data->tree);
+    tor_data->tree = NULL;
 }
 
 static void torrent_not_parsed_warning(GtkWindow * parent)
@@ -464,7 +442,7 @@ trg_torrent_add_dialog_set_upload(TrgTorrentAddDialog *d, trg_upload *upload) {
     if (!tor_data) {
       torrent_not_parsed_warning(GTK_WINDOW(priv->parent));
     } else {
-      store_add_node(priv->store, NULL, tor_data->top_node, &priv->n_files);
+      trg_torrent_add_dialog_fill_store(priv, tor_data);
       trg_torrent_file_free(tor_data);
     }
 
@@ -480,7 +458,8 @@ trg_torrent_add_dialog_set_filenames(TrgTorrentAddDialog * d,
     GtkButton *chooser = GTK_BUTTON(priv->source_chooser);
     gint nfiles = filenames ? g_slist_length(filenames) : 0;
 
-    gtk_tree_store_clear(priv->store);
+    trg_files_tree_model_set_tree(priv->store, NULL);
+    priv->n_files = 0;
 
     if (priv->upload) {
     	trg_upload_free(priv->upload);
@@ -522,7 +501,7 @@ trg_torrent_add_dialog_set_filenames(TrgTorrentAddDialog * d,
                 if (!tor_data) {
                     torrent_not_parsed_warning(GTK_WINDOW(priv->parent));
                 } else {
-                    store_add_node(priv->store, NULL, tor_data->top_node, &priv->n_files);
+                    trg_torrent_add_dialog_fill_store(priv, tor_data);
                     trg_torrent_file_free(tor_data);
                 }
             } else {
@@ -608,37 +587,32 @@ trg_torrent_add_dialog_source_click_cb(GtkWidget * w, gpointer data)
     gtk_widget_destroy(GTK_WIDGET(d));
 }
 
-static gboolean
-apply_all_changed_foreachfunc(GtkTreeModel * model,
-                              GtkTreePath * path,
-                              GtkTreeIter * iter, gpointer data)
+/* Setting each top level row sets everything under it too. */
+static void
+trg_torrent_add_dialog_apply_all_changed_cb(GtkWidget * w, gpointer data)
 {
-    GtkComboBox *combo = GTK_COMBO_BOX(data);
+    TrgTorrentAddDialogPrivate *priv =
+        TRG_TORRENT_ADD_DIALOG_GET_PRIVATE(data);
+    GtkComboBox *combo = GTK_COMBO_BOX(w);
     GtkTreeModel *combo_model = gtk_combo_box_get_model(combo);
-    GtkTreeIter selection_iter;
-    if (gtk_combo_box_get_active_iter(combo, &selection_iter)) {
-        gint column;
+    GtkTreeModel *model = GTK_TREE_MODEL(priv->store);
+    GtkTreeIter selection_iter, iter;
+
+    if (gtk_combo_box_get_active_iter(combo, &selection_iter)
+        && gtk_tree_model_get_iter_first(model, &iter)) {
+        guint column;
         gint value;
-        GValue gvalue = { 0 };
-        g_value_init(&gvalue, G_TYPE_INT);
+
         gtk_tree_model_get(combo_model, &selection_iter, 2, &column, 3,
                            &value, -1);
-        g_value_set_int(&gvalue, value);
-        gtk_tree_store_set_value(GTK_TREE_STORE(model), iter, column,
-                                 &gvalue);
+
+        do {
+            trg_files_tree_model_set_subtree(priv->store, &iter, column,
+                                             value);
+        } while (gtk_tree_model_iter_next(model, &iter));
     }
-    return FALSE;
-}
 
-static void
-trg_torrent_add_dialog_apply_all_changed_cb(GtkWidget * w, gpointer data)
-{
-    TrgTorrentAddDialogPrivate *priv =
-        TRG_TORRENT_ADD_DIALOG_GET_PRIVATE(data);
-    GtkWidget *tv = gtk_bin_get_child(GTK_BIN(priv->file_list));
-    GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(tv));
-    gtk_tree_model_foreach(model, apply_all_changed_foreachfunc, w);
-    gtk_combo_box_set_active(GTK_COMBO_BOX(w), -1);
+    gtk_combo_box_set_active(combo, -1);
 }
 
 static GtkWidget
@@ -653,20 +627,20 @@ static GtkWidget
     GtkCellRenderer *renderer;
 
     gtk_list_store_append(model, &iter);
-    gtk_list_store_set(model, &iter, 1, _("High Priority"), 2, FC_PRIORITY,
+    gtk_list_store_set(model, &iter, 1, _("High Priority"), 2, FILESCOL_PRIORITY,
                        3, TR_PRI_HIGH, -1);
     gtk_list_store_append(model, &iter);
     gtk_list_store_set(model, &iter, 1, _("Normal Priority"), 2,
-                       FC_PRIORITY, 3, TR_PRI_NORMAL, -1);
+                       FILESCOL_PRIORITY, 3, TR_PRI_NORMAL, -1);
     gtk_list_store_append(model, &iter);
-    gtk_list_store_set(model, &iter, 1, _("Low Priority"), 2, FC_PRIORITY,
+    gtk_list_store_set(model, &iter, 1, _("Low Priority"), 2, FILESCOL_PRIORITY,
                        3, TR_PRI_LOW, -1);
     gtk_list_store_append(model, &iter);
     gtk_list_store_set(model, &iter, 0, GTK_STOCK_APPLY, 1, _("Download"),
-                       2, FC_ENABLED, 3, TRUE, -1);
+                       2, FILESCOL_WANTED, 3, TRUE, -1);
     gtk_list_store_append(model, &iter);
     gtk_list_store_set(model, &iter, 0, GTK_STOCK_CANCEL, 1, _("Skip"), 2,
-                       FC_ENABLED, 3, FALSE, -1);
+                       FILESCOL_WANTED, 3, FALSE, -1);
 
     renderer = gtk_cell_renderer_pixbuf_new();
     gtk_cell_layout_pack_start(GTK_CELL_LAYOUT(combo), renderer, FALSE);
@@ -22,9 +22,9 @@
  * Converted the class from C++ to GObject, substituted out some STL (C++)
  * functions, and removed the unecessary parts for memory/cpu.
  *
- * Would be nice if it supported configurable timespans. This could possibly
- * be replaced with ubergraph, which is a graphing widget for GTK (C) also based
- * on this widget but with some improvements I didn't do.
+ * This could possibly be replaced with ubergraph, which is a graphing widget
+ * for GTK (C) also based on this widget but with some improvements I didn't
+ * do.
  */
 
 
@@ -34,9 +34,8 @@
 
 #include "trg-torrent-graph.h"
 
-#if TRG_WITH_GRAPH
-
 #include <math.h>
+#include <string.h>
 #include <glib.h>
 #include <cairo.h>
 #include <glib/gi18n.h>
@@ -47,19 +46,41 @@
 #define log2(x) (log(x)/0.69314718055994530942)
 
 #define GRAPH_NUM_POINTS 62
+#define GRAPH_DAY_POINTS 26
+#define GRAPH_BUCKET_SAMPLES 60
 #define GRAPH_MIN_HEIGHT 40
 #define GRAPH_NUM_LINES 2
-#define GRAPH_NUM_DATA_BLOCK_ELEMENTS GRAPH_NUM_POINTS * GRAPH_NUM_LINES
 #define GRAPH_OUT_COLOR "#2D7DB3"
 #define GRAPH_IN_COLOR "#844798"
 #define GRAPH_LINE_WIDTH 3
 #define GRAPH_FRAME_WIDTH 4
 
-G_DEFINE_TYPE(TrgTorrentGraph, trg_torrent_graph, GTK_TYPE_VBOX)
+G_DEFINE_TYPE(TrgTorrentGraph, trg_torrent_graph, GTK_TYPE_BOX)
 #define TRG_TORRENT_GRAPH_GET_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_TORRENT_GRAPH, TrgTorrentGraphPrivate))
 typedef struct _TrgTorrentGraphPrivate TrgTorrentGraphPrivate;
 
+/* Speeds are kept per tick (second), per minute and per hour, each level in
+ * a ring of GRAPH_NUM_POINTS. A bucket is the average of GRAPH_BUCKET_SAMPLES
+ * from the level below, so a day is covered in bounded memory. The largest
+ * speed in the window shown from each level is tracked in a monotonic deque
+ * (peaks decreasing from the head), so appending never rescans.
+ */
+typedef struct {
+    guint64 samples[GRAPH_NUM_LINES][GRAPH_NUM_POINTS];
+    guint64 count;
+    guint window;
+    const gchar *unit_name;
+
+    guint64 sum[GRAPH_NUM_LINES];       /* towards the next level's bucket */
+    guint summed;
+
+    guint64 peak_index[GRAPH_NUM_POINTS];
+    guint64 peak_value[GRAPH_NUM_POINTS];
+    guint peak_head;
+    guint peak_len;
+} trg_graph_level;
+
 struct _TrgTorrentGraphPrivate {
     double fontsize;
     double rmargin;
@@ -73,21 +94,18 @@ struct _TrgTorrentGraphPrivate {
     double graph_delx;
     guint graph_buffer_offset;
 
-    GdkColor colors[GRAPH_NUM_LINES];
+    GdkRGBA colors[GRAPH_NUM_LINES];
 
-    float data_block[GRAPH_NUM_POINTS * GRAPH_NUM_LINES];
-    GList *points;
+    trg_graph_level levels[TRG_GRAPH_SPAN_COUNT];
+    TrgGraphSpan span;
+    guint64 drawn_count;
 
     GtkWidget *disp;
-    GdkGC *gc;
-    GdkDrawable *background;
+    cairo_surface_t *background;
     guint timer_index;
     gboolean draw;
     guint64 out, in;
     unsigned int max;
-    unsigned values[GRAPH_NUM_POINTS];
-    size_t cur;
-    GtkStyle *style;
 
     GtkWidget *label_in;
     GtkWidget *label_out;
@@ -95,6 +113,58 @@ struct _TrgTorrentGraphPrivate {
 
 static int trg_torrent_graph_update(gpointer user_data);
 
+static void
+trg_graph_level_init(trg_graph_level * level, guint window,
+                     const gchar * unit_name)
+{
+    memset(level, 0, sizeof(trg_graph_level));
+    level->window = window;
+    level->unit_name = unit_name;
+}
+
+/* The sample of a line age samples before the last. */
+static guint64
+trg_graph_level_get(trg_graph_level * level, guint line, guint age)
+{
+    return level->samples[line][(level->count - 1 - age) %
+                                GRAPH_NUM_POINTS];
+}
+
+static guint64 trg_graph_level_max(trg_graph_level * level)
+{
+    return level->peak_len > 0 ? level->peak_value[level->peak_head] : 0;
+}
+
+static void
+trg_graph_level_append(trg_graph_level * level, guint64 out, guint64 in)
+{
+    guint64 peak = MAX(out, in);
+    guint slot = level->count % GRAPH_NUM_POINTS;
+
+    level->samples[0][slot] = out;
+    level->samples[1][slot] = in;
+    level->count++;
+
+    /* Drop peaks which have scrolled out of the window... */
+    while (level->peak_len > 0
+           && level->peak_index[level->peak_head] + level->window <
+           level->count) {
+        level->peak_head = (level->peak_head + 1) % GRAPH_NUM_POINTS;
+        level->peak_len--;
+    }
+
+    /* ...and those which this one is at least as large as. */
+    while (level->peak_len > 0
+           && level->peak_value[(level->peak_head + level->peak_len - 1)
+                                % GRAPH_NUM_POINTS] <= peak)
+        level->peak_len--;
+
+    slot = (level->peak_head + level->peak_len) % GRAPH_NUM_POINTS;
+    level->peak_index[slot] = level->count - 1;
+    level->peak_value[slot] = peak;
+    level->peak_len++;
+}
+
 static void
 trg_torrent_graph_get_property(GObject * object, guint property_id,
                                GValue * value, GParamSpec * pspec)
@@ -129,27 +199,37 @@ void trg_torrent_graph_draw_background(TrgTorrentGraph * g)
     char *caption;
     cairo_text_extents_t extents;
     unsigned rate;
-    unsigned total_seconds;
+    gdouble total;
+    trg_graph_level *level;
+    GtkStyleContext *context;
+    GdkRGBA fg;
 
     priv = TRG_TORRENT_GRAPH_GET_PRIVATE(g);
+    level = &priv->levels[priv->span];
+    context = gtk_widget_get_style_context(priv->disp);
+    gtk_style_context_get_color(context,
+                                gtk_style_context_get_state(context), &fg);
 
     num_bars = trg_torrent_graph_get_num_bars(g);
     priv->graph_dely = (priv->draw_height - 15) / num_bars;     /* round to int to avoid AA blur */
     priv->real_draw_height = priv->graph_dely * num_bars;
     priv->graph_delx =
         (priv->draw_width - 2.0 - priv->rmargin -
-         priv->indent) / (GRAPH_NUM_POINTS - 3);
+         priv->indent) / (level->window - 3);
     priv->graph_buffer_offset =
         (int) (1.5 * priv->graph_delx) + GRAPH_FRAME_WIDTH;
 
     gtk_widget_get_allocation(priv->disp, &allocation);
     priv->background =
-        gdk_pixmap_new(GDK_DRAWABLE(gtk_widget_get_window(priv->disp)),
-                       allocation.width, allocation.height, -1);
-    cr = gdk_cairo_create(priv->background);
-
-    gdk_cairo_set_source_color(cr, &priv->style->bg[GTK_STATE_NORMAL]);
-    cairo_paint(cr);
+        gdk_window_create_similar_surface(gtk_widget_get_window
+                                          (priv->disp),
+                                          CAIRO_CONTENT_COLOR_ALPHA,
+                                          allocation.width,
+                                          allocation.height);
+    cr = cairo_create(priv->background);
+
+    gtk_render_background(context, cr, 0, 0, allocation.width,
+                          allocation.height);
     cairo_translate(cr, GRAPH_FRAME_WIDTH, GRAPH_FRAME_WIDTH);
     cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
     cairo_rectangle(cr, priv->rmargin + priv->indent, 0,
@@ -173,7 +253,7 @@ void trg_torrent_graph_draw_background(TrgTorrentGraph * g)
         else
             y = i * priv->graph_dely + priv->fontsize / 2.0;
 
-        gdk_cairo_set_source_color(cr, &priv->style->fg[GTK_STATE_NORMAL]);
+        gdk_cairo_set_source_rgba(cr, &fg);
         rate = priv->max - (i * priv->max / num_bars);
         trg_strlspeed(caption, (gint64) (rate / 1024));
         cairo_text_extents(cr, caption, &extents);
@@ -185,11 +265,12 @@ void trg_torrent_graph_draw_background(TrgTorrentGraph * g)
 
     cairo_set_dash(cr, dash, 2, 1.5);
 
-    total_seconds = priv->speed * (GRAPH_NUM_POINTS - 2) / 1000;
+    /* A sample is a tick at each level, in that level's own unit, as the
+     * buckets hold as many ticks as there are seconds in the unit. */
+    total = (level->window - 2) * priv->speed / 1000.0;
 
     for (i = 0; i < 7; i++) {
-        unsigned seconds;
-        const char *format;
+        unsigned units;
         double x =
             (i) * (priv->draw_width - priv->rmargin - priv->indent) / 6;
         cairo_set_source_rgba(cr, 0, 0, 0, 0.75);
@@ -198,17 +279,16 @@ void trg_torrent_graph_draw_background(TrgTorrentGraph * g)
         cairo_line_to(cr, (ceil(x) + 0.5) + priv->rmargin + priv->indent,
                       priv->real_draw_height + 4.5);
         cairo_stroke(cr);
-        seconds = total_seconds - i * total_seconds / 6;
+        units = (unsigned) (total - i * total / 6 + 0.5);
         if (i == 0)
-            format = "%u seconds";
+            caption = g_strdup_printf("%u %s", units, level->unit_name);
         else
-            format = "%u";
-        caption = g_strdup_printf(format, seconds);
+            caption = g_strdup_printf("%u", units);
         cairo_text_extents(cr, caption, &extents);
         cairo_move_to(cr,
                       ((ceil(x) + 0.5) + priv->rmargin + priv->indent) -
                       (extents.width / 2), priv->draw_height);
-        gdk_cairo_set_source_color(cr, &priv->style->fg[GTK_STATE_NORMAL]);
+        gdk_cairo_set_source_rgba(cr, &fg);
         cairo_show_text(cr, caption);
         g_free(caption);
     }
@@ -234,62 +314,63 @@ trg_torrent_graph_set_speed(TrgTorrentGraph * g,
     priv->out = (guint64) stats->upRateTotal;
 }
 
-static gboolean
-trg_torrent_graph_configure(GtkWidget * widget,
-                            GdkEventConfigure * event, gpointer data_ptr)
+static void
+trg_torrent_graph_size_allocate(GtkWidget * widget G_GNUC_UNUSED,
+                                GdkRectangle * allocation,
+                                gpointer data_ptr)
 {
-    GtkAllocation allocation;
     TrgTorrentGraph *g = TRG_TORRENT_GRAPH(data_ptr);
     TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(data_ptr);
 
-    gtk_widget_get_allocation(widget, &allocation);
-    priv->draw_width = allocation.width - 2 * GRAPH_FRAME_WIDTH;
-    priv->draw_height = allocation.height - 2 * GRAPH_FRAME_WIDTH;
+    priv->draw_width = allocation->width - 2 * GRAPH_FRAME_WIDTH;
+    priv->draw_height = allocation->height - 2 * GRAPH_FRAME_WIDTH;
 
     trg_torrent_graph_clear_background(g);
+    trg_torrent_graph_draw(g);
+}
 
-    if (priv->gc == NULL)
-        priv->gc = gdk_gc_new(GDK_DRAWABLE(gtk_widget_get_window(widget)));
+/* Also redraw the axes, which use the theme's colours, if it changes. */
+static void
+trg_torrent_graph_style_updated(GtkWidget * widget G_GNUC_UNUSED,
+                                gpointer data_ptr)
+{
+    TrgTorrentGraph *g = TRG_TORRENT_GRAPH(data_ptr);
 
+    trg_torrent_graph_clear_background(g);
     trg_torrent_graph_draw(g);
-
-    return TRUE;
 }
 
 static gboolean
-trg_torrent_graph_expose(GtkWidget * widget,
-                         GdkEventExpose * event, gpointer data_ptr)
+trg_torrent_graph_draw_cb(GtkWidget * widget G_GNUC_UNUSED, cairo_t * cr,
+                          gpointer data_ptr)
 {
     TrgTorrentGraph *g = TRG_TORRENT_GRAPH(data_ptr);
     TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(data_ptr);
 
-    GtkAllocation allocation;
-    GdkWindow *window;
-    cairo_t *cr;
-
-    guint i, j;
-    float *fp;
+    trg_graph_level *level = &priv->levels[priv->span];
+    guint i, j, n;
+    guint scroll;
     gdouble sample_width, x_offset;
 
     if (priv->background == NULL)
         trg_torrent_graph_draw_background(g);
 
-    window = gtk_widget_get_window(priv->disp);
-    gtk_widget_get_allocation(priv->disp, &allocation);
-    gdk_draw_drawable(window,
-                      priv->gc,
-                      priv->background,
-                      0, 0, 0, 0, allocation.width, allocation.height);
+    cairo_save(cr);
+    cairo_set_source_surface(cr, priv->background, 0, 0);
+    cairo_paint(cr);
 
     sample_width =
         (float) (priv->draw_width - priv->rmargin -
-                 priv->indent) / (float) GRAPH_NUM_POINTS;
+                 priv->indent) / (float) level->window;
+
+    /* Only the per-tick view scrolls between samples. */
+    scroll = priv->span == TRG_GRAPH_SPAN_MINUTE ? priv->render_counter : 0;
     x_offset = priv->draw_width - priv->rmargin + (sample_width * 2);
     x_offset +=
         priv->rmargin -
-        ((sample_width / priv->frames_per_unit) * priv->render_counter);
+        ((sample_width / priv->frames_per_unit) * scroll);
 
-    cr = gdk_cairo_create(window);
+    n = (guint) MIN(level->count, (guint64) level->window);
 
     cairo_set_line_width(cr, GRAPH_LINE_WIDTH);
     cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
@@ -301,36 +382,31 @@ trg_torrent_graph_expose(GtkWidget * widget,
                     priv->real_draw_height + GRAPH_FRAME_WIDTH - 1);
     cairo_clip(cr);
 
-    for (j = 0; j < GRAPH_NUM_LINES; ++j) {
-        GList *li = priv->points;
-        fp = (float *) li->data;
-        cairo_move_to(cr, x_offset,
-                      (1.0f - fp[j]) * priv->real_draw_height);
-        gdk_cairo_set_source_color(cr, &(priv->colors[j]));
-
-        i = 0;
-        for (li = g_list_next(li); li != NULL; li = g_list_next(li)) {
-            GList *lli = g_list_previous(li);
-            float *lfp = (float *) lli->data;
-            fp = (float *) li->data;
+    for (j = 0; j < GRAPH_NUM_LINES && n > 0; ++j) {
+        float last = trg_graph_level_get(level, j, 0) / (float) priv->max;
 
-            i++;
+        cairo_move_to(cr, x_offset,
+                      (1.0f - last) * priv->real_draw_height);
+        gdk_cairo_set_source_rgba(cr, &(priv->colors[j]));
 
-            if (fp[j] == -1.0f)
-                continue;
+        for (i = 1; i < n; i++) {
+            float fp = trg_graph_level_get(level, j, i) / (float) priv->max;
 
             cairo_curve_to(cr,
                            x_offset - ((i - 0.5f) * priv->graph_delx),
-                           (1.0f - lfp[j]) * priv->real_draw_height + 3.5f,
+                           (1.0f - last) * priv->real_draw_height + 3.5f,
                            x_offset - ((i - 0.5f) * priv->graph_delx),
-                           (1.0f - fp[j]) * priv->real_draw_height + 3.5f,
+                           (1.0f - fp) * priv->real_draw_height + 3.5f,
                            x_offset - (i * priv->graph_delx),
-                           (1.0f - fp[j]) * priv->real_draw_height + 3.5f);
+                           (1.0f - fp) * priv->real_draw_height + 3.5f);
+            last = fp;
         }
         cairo_stroke(cr);
     }
 
-    cairo_destroy(cr);
+    priv->drawn_count = level->count;
+
+    cairo_restore(cr);
 
     return TRUE;
 }
@@ -372,41 +448,77 @@ void trg_torrent_graph_start(TrgTorrentGraph * g)
     priv->draw = TRUE;
 }
 
-static unsigned get_max_value_element(TrgTorrentGraph * g)
+/* Append a tick's speeds, and roll them up into the coarser levels. */
+static void trg_torrent_graph_append(TrgTorrentGraph * g)
 {
     TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(g);
-    unsigned r = 0;
-    int i;
+    guint64 out = priv->out, in = priv->in;
+    guint l;
 
-    for (i = 0; i < GRAPH_NUM_POINTS; i++)
-        if (priv->values[i] > r)
-            r = priv->values[i];
+    for (l = 0; l < TRG_GRAPH_SPAN_COUNT; l++) {
+        trg_graph_level *level = &priv->levels[l];
 
-    return r;
+        trg_graph_level_append(level, out, in);
+
+        if (l + 1 == TRG_GRAPH_SPAN_COUNT)
+            break;
+
+        level->sum[0] += out;
+        level->sum[1] += in;
+
+        if (++level->summed < GRAPH_BUCKET_SAMPLES)
+            break;
+
+        out = level->sum[0] / GRAPH_BUCKET_SAMPLES;
+        in = level->sum[1] / GRAPH_BUCKET_SAMPLES;
+        level->sum[0] = level->sum[1] = 0;
+        level->summed = 0;
+    }
 }
 
-static void trg_torrent_graph_update_net(TrgTorrentGraph * g)
+/* Pick a round maximum for the shown window, with some headroom. */
+static void trg_torrent_graph_rescale(TrgTorrentGraph * g, gboolean force)
 {
     TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(g);
+    unsigned new_max, bak_max, pow2, base10, coef10, factor10, num_bars;
 
-    unsigned max, new_max, bak_max, pow2, base10, coef10, factor10,
-        num_bars;
+    new_max = (unsigned) trg_graph_level_max(&priv->levels[priv->span]);
 
-    float scale;
-    char speed[32];
-    gchar *labelMarkup;
-    GList *li;
+    bak_max = new_max;
+    new_max = 1.1 * new_max;
+    new_max = MAX(new_max, 1024U);
+    pow2 = floor(log2(new_max));
+    base10 = pow2 / 10;
+    coef10 = ceil(new_max / (double) (1UL << (base10 * 10)));
+    factor10 = pow(10.0, floor(log10(coef10)));
+    coef10 = ceil(coef10 / (double) (factor10)) * factor10;
+
+    num_bars = trg_torrent_graph_get_num_bars(g);
+
+    if (coef10 % num_bars != 0)
+        coef10 = coef10 + (num_bars - coef10 % num_bars);
+
+    new_max = coef10 * (1UL << (base10 * 10));
 
-    float *fp = (float *) (priv->points->data);
+    if (bak_max > new_max) {
+        new_max = bak_max;
+    }
 
-    GList *last = g_list_last(priv->points);
-    float *lastData = last->data;
+    if (!force && (0.8 * priv->max) < new_max && new_max <= priv->max)
+        return;
 
-    priv->points = g_list_delete_link(priv->points, last);
-    priv->points = g_list_prepend(priv->points, lastData);
+    priv->max = new_max;
 
-    fp[0] = 1.0f * priv->out / priv->max;
-    fp[1] = 1.0f * priv->in / priv->max;
+    trg_torrent_graph_clear_background(g);
+}
+
+static void trg_torrent_graph_update_net(TrgTorrentGraph * g)
+{
+    TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(g);
+    char speed[32];
+    gchar *labelMarkup;
+
+    trg_torrent_graph_append(g);
 
     trg_strlspeed(speed, (gint64) (priv->out / disk_K));
     labelMarkup =
@@ -424,51 +536,61 @@ static void trg_torrent_graph_update_net(TrgTorrentGraph * g)
     gtk_label_set_markup(GTK_LABEL(priv->label_in), labelMarkup);
     g_free(labelMarkup);
 
-    max = MAX(priv->in, priv->out);
-    priv->values[priv->cur] = max;
-    priv->cur = (priv->cur + 1) % GRAPH_NUM_POINTS;
-
-    if (max >= priv->max)
-        new_max = max;
-    else
-        new_max = get_max_value_element(g);
-
-    bak_max = new_max;
-    new_max = 1.1 * new_max;
-    new_max = MAX(new_max, 1024U);
-    pow2 = floor(log2(new_max));
-    base10 = pow2 / 10;
-    coef10 = ceil(new_max / (double) (1UL << (base10 * 10)));
-    factor10 = pow(10.0, floor(log10(coef10)));
-    coef10 = ceil(coef10 / (double) (factor10)) * factor10;
+    trg_torrent_graph_rescale(g, FALSE);
+}
 
-    num_bars = trg_torrent_graph_get_num_bars(g);
+void trg_torrent_graph_set_timespan(TrgTorrentGraph * g, TrgGraphSpan span)
+{
+    TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(g);
 
-    if (coef10 % num_bars != 0)
-        coef10 = coef10 + (num_bars - coef10 % num_bars);
+    priv->span = span;
+    trg_torrent_graph_rescale(g, TRUE);
+    trg_torrent_graph_draw(g);
+}
 
-    new_max = coef10 * (1UL << (base10 * 10));
+static void trg_torrent_graph_span_toggled(GtkCheckMenuItem * item,
+                                           gpointer data)
+{
+    if (gtk_check_menu_item_get_active(item))
+        trg_torrent_graph_set_timespan(TRG_TORRENT_GRAPH(data),
+                                       GPOINTER_TO_INT(g_object_get_data
+                                                       (G_OBJECT(item),
+                                                        "span")));
+}
 
-    if (bak_max > new_max) {
-        new_max = bak_max;
+static gboolean
+trg_torrent_graph_button_press(GtkWidget * widget G_GNUC_UNUSED,
+                               GdkEventButton * event, gpointer data)
+{
+    TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(data);
+    const gchar *labels[TRG_GRAPH_SPAN_COUNT] =
+        { N_("Last Minute"), N_("Last Hour"), N_("Last Day") };
+    GtkWidget *menu, *item;
+    GSList *group = NULL;
+    gint i;
+
+    if (event->type != GDK_BUTTON_PRESS || event->button != 3)
+        return FALSE;
+
+    menu = gtk_menu_new();
+
+    for (i = 0; i < TRG_GRAPH_SPAN_COUNT; i++) {
+        item = gtk_radio_menu_item_new_with_label(group, _(labels[i]));
+        group = gtk_radio_menu_item_get_group(GTK_RADIO_MENU_ITEM(item));
+        g_object_set_data(G_OBJECT(item), "span", GINT_TO_POINTER(i));
+        gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(item),
+                                       i == (gint) priv->span);
+        g_signal_connect(item, "toggled",
+                         G_CALLBACK(trg_torrent_graph_span_toggled), data);
+        gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
     }
 
-    if ((0.8 * priv->max) < new_max && new_max <= priv->max)
-        return;
-
-    scale = 1.0f * priv->max / new_max;
-
-    for (li = priv->points; li != NULL; li = g_list_next(li)) {
-        float *fp = (float *) li->data;
-        if (fp[0] >= 0.0f) {
-            fp[0] *= scale;
-            fp[1] *= scale;
-        }
-    }
+    gtk_widget_show_all(menu);
 
-    priv->max = new_max;
+    gtk_menu_popup(GTK_MENU(menu), NULL, NULL, NULL, NULL,
+                   event->button, gdk_event_get_time((GdkEvent *) event));
 
-    trg_torrent_graph_clear_background(g);
+    return TRUE;
 }
 
 static GObject *trg_torrent_graph_constructor(GType type,
@@ -480,7 +602,6 @@ static GObject *trg_torrent_graph_constructor(GType type,
     GObject *object;
     TrgTorrentGraphPrivate *priv;
     GtkWidget *hbox;
-    int i;
 
     object =
         G_OBJECT_CLASS
@@ -497,7 +618,6 @@ static GObject *trg_torrent_graph_constructor(GType type,
     priv->graph_delx = 0.0;
     priv->graph_buffer_offset = 0;
     priv->disp = NULL;
-    priv->gc = NULL;
     priv->background = NULL;
     priv->timer_index = 0;
     priv->draw = FALSE;
@@ -508,12 +628,14 @@ static GObject *trg_torrent_graph_constructor(GType type,
     priv->indent = 24.0;
     priv->out = 0;
     priv->in = 0;
-    priv->cur = 0;
 
     priv->speed = 1000;
     priv->max = 1024;
 
-    hbox = gtk_hbox_new(FALSE, 0);
+    gtk_orientable_set_orientation(GTK_ORIENTABLE(object),
+                                   GTK_ORIENTATION_VERTICAL);
+
+    hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
 
     priv->label_in = gtk_label_new(NULL);
     priv->label_out = gtk_label_new(NULL);
@@ -523,8 +645,8 @@ static GObject *trg_torrent_graph_constructor(GType type,
 
     gtk_box_pack_start(GTK_BOX(object), hbox, FALSE, FALSE, 2);
 
-    gdk_color_parse(GRAPH_OUT_COLOR, &priv->colors[0]);
-    gdk_color_parse(GRAPH_IN_COLOR, &priv->colors[1]);
+    gdk_rgba_parse(&priv->colors[0], GRAPH_OUT_COLOR);
+    gdk_rgba_parse(&priv->colors[1], GRAPH_IN_COLOR);
 
     priv->timer_index = 0;
     priv->render_counter = (priv->frames_per_unit - 1);
@@ -533,22 +655,26 @@ static GObject *trg_torrent_graph_constructor(GType type,
     gtk_box_set_homogeneous(GTK_BOX(object), FALSE);
 
     priv->disp = gtk_drawing_area_new();
-    g_signal_connect(G_OBJECT(priv->disp), "expose_event",
-                     G_CALLBACK(trg_torrent_graph_expose), object);
-    g_signal_connect(G_OBJECT(priv->disp), "configure_event",
-                     G_CALLBACK(trg_torrent_graph_configure), object);
+    g_signal_connect(G_OBJECT(priv->disp), "draw",
+                     G_CALLBACK(trg_torrent_graph_draw_cb), object);
+    g_signal_connect(G_OBJECT(priv->disp), "size-allocate",
+                     G_CALLBACK(trg_torrent_graph_size_allocate), object);
+    g_signal_connect(G_OBJECT(priv->disp), "style-updated",
+                     G_CALLBACK(trg_torrent_graph_style_updated), object);
+    g_signal_connect(G_OBJECT(priv->disp), "button-press-event",
+                     G_CALLBACK(trg_torrent_graph_button_press), object);
 
-    gtk_widget_set_events(priv->disp, GDK_EXPOSURE_MASK);
+    gtk_widget_add_events(priv->disp, GDK_BUTTON_PRESS_MASK);
 
     gtk_box_pack_start(GTK_BOX(object), priv->disp, TRUE, TRUE, 0);
 
-    priv->points = NULL;
-    for (i = 0; i < GRAPH_NUM_DATA_BLOCK_ELEMENTS; i++) {
-        priv->data_block[i] = -1.0f;
-        if (i % GRAPH_NUM_LINES == 0)
-            priv->points =
-                g_list_append(priv->points, &priv->data_block[i]);
-    }
+    trg_graph_level_init(&priv->levels[TRG_GRAPH_SPAN_MINUTE],
+                         GRAPH_NUM_POINTS, "seconds");
+    trg_graph_level_init(&priv->levels[TRG_GRAPH_SPAN_HOUR],
+                         GRAPH_NUM_POINTS, "minutes");
+    trg_graph_level_init(&priv->levels[TRG_GRAPH_SPAN_DAY],
+                         GRAPH_DAY_POINTS, "hours");
+    priv->span = TRG_GRAPH_SPAN_MINUTE;
 
     return object;
 }
@@ -569,14 +695,9 @@ static void trg_torrent_graph_init(TrgTorrentGraph * self)
 {
 }
 
-TrgTorrentGraph *trg_torrent_graph_new(GtkStyle * style)
+TrgTorrentGraph *trg_torrent_graph_new(void)
 {
-    GObject *obj = g_object_new(TRG_TYPE_TORRENT_GRAPH, NULL);
-    TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(obj);
-
-    priv->style = style;
-
-    return TRG_TORRENT_GRAPH(obj);
+    return TRG_TORRENT_GRAPH(g_object_new(TRG_TYPE_TORRENT_GRAPH, NULL));
 }
 
 void trg_torrent_graph_draw(TrgTorrentGraph * g)
@@ -591,7 +712,7 @@ void trg_torrent_graph_clear_background(TrgTorrentGraph * g)
     TrgTorrentGraphPrivate *priv = TRG_TORRENT_GRAPH_GET_PRIVATE(g);
 
     if (priv->background) {
-        g_object_unref(priv->background);
+        cairo_surface_destroy(priv->background);
         priv->background = NULL;
     }
 }
@@ -606,7 +727,10 @@ static gboolean trg_torrent_graph_update(gpointer user_data)
     if (priv->render_counter == priv->frames_per_unit - 1)
         trg_torrent_graph_update_net(g);
 
-    if (priv->draw)
+    /* The coarser views only move when a bucket is added. */
+    if (priv->draw && (priv->span == TRG_GRAPH_SPAN_MINUTE
+                       || priv->levels[priv->span].count !=
+                       priv->drawn_count))
         trg_torrent_graph_draw(g);
 
     priv->render_counter++;
@@ -641,5 +765,3 @@ unsigned trg_torrent_graph_get_num_bars(TrgTorrentGraph * g)
 
     return n;
 }
-
-#endif
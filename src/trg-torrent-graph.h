@@ -4,11 +4,6 @@
 #define _TRG_TORRENT_GRAPH
 
 #include <gtk/gtk.h>
-
-#define TRG_WITH_GRAPH !GTK_CHECK_VERSION( 3, 0, 0 )
-
-#if TRG_WITH_GRAPH
-
 #include <glib-object.h>
 #include "trg-torrent-model.h"
 
@@ -25,20 +20,27 @@ G_BEGIN_DECLS
 #define TRG_TORRENT_GRAPH_GET_CLASS(obj) \
   (G_TYPE_INSTANCE_GET_CLASS ((obj), TRG_TYPE_TORRENT_GRAPH, TrgTorrentGraphClass))
     typedef struct {
-    GtkVBox parent;
+    GtkBox parent;
 } TrgTorrentGraph;
 
+typedef enum {
+    TRG_GRAPH_SPAN_MINUTE,
+    TRG_GRAPH_SPAN_HOUR,
+    TRG_GRAPH_SPAN_DAY,
+    TRG_GRAPH_SPAN_COUNT
+} TrgGraphSpan;
+
 typedef struct {
-    GtkVBoxClass parent_class;
+    GtkBoxClass parent_class;
 } TrgTorrentGraphClass;
 
 GType trg_torrent_graph_get_type(void);
 
-TrgTorrentGraph *trg_torrent_graph_new(GtkStyle * style);
+TrgTorrentGraph *trg_torrent_graph_new(void);
 
 unsigned trg_torrent_graph_get_num_bars(TrgTorrentGraph * g);
 
-void trg_torrent_graph_clear_background();
+void trg_torrent_graph_clear_background(TrgTorrentGraph * g);
 
 void trg_torrent_graph_draw(TrgTorrentGraph * g);
 
@@ -51,7 +53,7 @@ void trg_torrent_graph_change_speed(TrgTorrentGraph * g, guint new_speed);
 void trg_torrent_graph_set_speed(TrgTorrentGraph * g,
                                  trg_torrent_model_update_stats * stats);
 void trg_torrent_graph_set_nothing(TrgTorrentGraph * g);
+void trg_torrent_graph_set_timespan(TrgTorrentGraph * g, TrgGraphSpan span);
 
 G_END_DECLS
-#endif
 #endif                          /* _TRG_TORRENT_GRAPH */
@@ -27,15 +27,18 @@
 #include <glib/gi18n.h>
 
 #include "torrent.h"
+#include "torrent-record.h"
 #include "json.h"
 #include "trg-torrent-model.h"
 #include "protocol-constants.h"
 #include "trg-model.h"
 #include "util.h"
 
-/* An extension of TrgModel (which is an extension of GtkListStore) which
- * updates from a JSON torrent-get response. It handles a number of different
- * update modes.
+/* A flat tree model over the torrents, kept as packed records in an array
+ * indexed by torrent ID, which it updates from a torrent-get response. Each
+ * column is read straight out of a record when it's asked for, and the cell
+ * renderer and panels can have the whole record. It handles a number of
+ * different update modes.
  *   1) The first update.
  *   2) A full update.
  *   3) An active-only update.
@@ -47,11 +50,13 @@
  *   2) Emits signals if something is added or removed. This is used by the state
  *      selector so it doesn't have to refresh itself on every update.
  *   3) Added or completed signals, for libnotify notifications.
- *   4) Maintains the torrent hash table (by ID).
- *      (and provide a lookup function which outputs an iter and/or JSON object.)
+ *   4) Keeps the per-file, per-peer and per-tracker arrays of torrents whose
+ *      details were asked for.
  *   5) If the download directory is new/changed, create a short version if there
  *      is one (duplicate it not) for the state selector to filter/populate against.
  *   6) Shorten the tracker announce URL.
+ *   7) With delta sync, leaves out torrents which are exactly as they were
+ *      in the last list update, before they reach the records.
  */
 
 enum {
@@ -66,36 +71,101 @@ enum {
 
 static guint signals[TMODEL_SIGNAL_COUNT] = { 0 };
 
-G_DEFINE_TYPE(TrgTorrentModel, trg_torrent_model, GTK_TYPE_LIST_STORE)
+static void trg_torrent_model_tree_model_init(GtkTreeModelIface * iface);
+
+G_DEFINE_TYPE_WITH_CODE(TrgTorrentModel, trg_torrent_model,
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,
+                                              trg_torrent_model_tree_model_init))
 #define TRG_TORRENT_MODEL_GET_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_TORRENT_MODEL, TrgTorrentModelPrivate))
 typedef struct _TrgTorrentModelPrivate TrgTorrentModelPrivate;
 
+/* A torrent's record, with what filtering needs to know about it. The slots
+ * are indexed by torrent ID, which the daemon hands out in order from 1, so
+ * each filter category can be a bitset over the IDs. A slot is only in use
+ * if its ID is in the used bitset, and then row is its position in the list.
+ */
+typedef struct {
+    trg_torrent_record rec;
+    guint row;
+    GQuark dir;
+    gchar *nameKey;
+    guint n_trigrams;
+    gchar *announces;
+    GQuark *hosts;
+    guint n_hosts;
+    trg_torrent_details *details;
+} trg_torrent_slot;
+
 struct _TrgTorrentModelPrivate {
-    GHashTable *ht;
+    gint stamp;
+    gint64 rpcv;
+    GArray *slots;
+    GArray *rows;               /* the IDs in list order */
+    trg_string_pool *strings;
     GRegex *urlHostRegex;
+    trg_bitset *used;
+    /* A category for each torrent flag bit, and host or directory quark. */
+    trg_torrent_category *flagCategories[32];
+    GHashTable *trackerIndex;
+    GHashTable *dirIndex;
+    /* The current filter, and the torrents which pass it. */
+    guint32 filterFlag;
+    GQuark filterName;
+    gchar **filterTerms;
+    trg_bitset *visible;
+    /* Trigrams of casefolded names, to the IDs which had them. Entries
+     * for renamed or removed torrents are left until there are as many of
+     * those as live ones, searches check the name anyway.
+     */
+    GHashTable *trigrams;
+    guint trigramsLive;
+    guint trigramsStale;
     trg_torrent_model_update_stats stats;
+    /* For delta sync, the fingerprint of each torrent as its record was
+     * last updated from a list update. Written on the main loop once a
+     * record is, and read by the parse worker. */
+    gint delta;
+    GMutex fingerprintsLock;
+    GHashTable *fingerprints;
 };
 
-static void trg_torrent_model_dispose(GObject * object)
+typedef struct {
+    gint64 id;
+    guint64 fingerprint;
+} trg_torrent_fingerprint;
+
+static GType trg_torrent_model_column_types[TORRENT_COLUMN_COLUMNS];
+
+static void trg_torrent_model_slots_clear(TrgTorrentModelPrivate * priv);
+
+static void trg_torrent_model_finalize(GObject * object)
 {
     TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(object);
-    g_hash_table_destroy(priv->ht);
-    G_OBJECT_CLASS(trg_torrent_model_parent_class)->dispose(object);
+    trg_torrent_model_slots_clear(priv);
+    g_hash_table_destroy(priv->trackerIndex);
+    g_hash_table_destroy(priv->dirIndex);
+    g_array_free(priv->slots, TRUE);
+    g_array_free(priv->rows, TRUE);
+    trg_string_pool_free(priv->strings);
+    g_regex_unref(priv->urlHostRegex);
+    trg_bitset_free(priv->used);
+    trg_bitset_free(priv->visible);
+    g_strfreev(priv->filterTerms);
+    g_hash_table_destroy(priv->trigrams);
+    g_hash_table_destroy(priv->fingerprints);
+    g_mutex_clear(&priv->fingerprintsLock);
+    G_OBJECT_CLASS(trg_torrent_model_parent_class)->finalize(object);
 }
 
-static void
-update_torrent_iter(TrgTorrentModel * model, TrgClient * tc, gint64 rpcv,
-                    gint64 serial, GtkTreeIter * iter, JsonObject * t,
-                    trg_torrent_model_update_stats * stats,
-                    guint * whatsChanged);
-
 static void trg_torrent_model_class_init(TrgTorrentModelClass * klass)
 {
     GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    GType *column_types = trg_torrent_model_column_types;
 
     g_type_class_add_private(klass, sizeof(TrgTorrentModelPrivate));
-    object_class->dispose = trg_torrent_model_dispose;
+    object_class->finalize = trg_torrent_model_finalize;
 
     signals[TMODEL_TORRENT_COMPLETED] = g_signal_new("torrent-completed",
                                                      G_TYPE_FROM_CLASS
@@ -147,71 +217,6 @@ static void trg_torrent_model_class_init(TrgTorrentModelClass * klass)
                                                  g_cclosure_marshal_VOID__UINT,
                                                  G_TYPE_NONE, 1,
                                                  G_TYPE_UINT);
-}
-
-trg_torrent_model_update_stats *trg_torrent_model_get_stats(TrgTorrentModel
-                                                            * model)
-{
-    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
-    return &(priv->stats);
-}
-
-static void
-trg_torrent_model_count_peers(TrgTorrentModel * model,
-                              GtkTreeIter * iter, JsonObject * t)
-{
-    GList *trackersList =
-        json_array_get_elements(torrent_get_tracker_stats(t));
-    gint64 seeders = 0;
-    gint64 leechers = 0;
-    gint64 downloads = 0;
-    GList *li;
-
-    for (li = trackersList; li; li = g_list_next(li)) {
-        JsonObject *tracker = json_node_get_object((JsonNode *) li->data);
-
-        seeders += tracker_stats_get_seeder_count(tracker);
-        leechers += tracker_stats_get_leecher_count(tracker);
-        downloads += tracker_stats_get_download_count(tracker);
-    }
-
-    g_list_free(trackersList);
-
-    gtk_list_store_set(GTK_LIST_STORE(model), iter, TORRENT_COLUMN_SEEDS,
-                       seeders, TORRENT_COLUMN_LEECHERS, leechers,
-                       TORRENT_COLUMN_DOWNLOADS, downloads, -1);
-}
-
-static void trg_torrent_model_ref_free(gpointer data)
-{
-    GtkTreeRowReference *rr = (GtkTreeRowReference *) data;
-    GtkTreeModel *model = gtk_tree_row_reference_get_model(rr);
-    GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
-    if (path) {
-        GtkTreeIter iter;
-        JsonObject *json;
-        if (gtk_tree_model_get_iter(model, &iter, path)) {
-            gtk_tree_model_get(model, &iter, TORRENT_COLUMN_JSON, &json,
-                               -1);
-            json_object_unref(json);
-            g_object_set_data(G_OBJECT(model), PROP_REMOVE_IN_PROGRESS,
-                              GINT_TO_POINTER(TRUE));
-            gtk_list_store_remove(GTK_LIST_STORE(model), &iter);
-            g_object_set_data(G_OBJECT(model), PROP_REMOVE_IN_PROGRESS,
-                              GINT_TO_POINTER(FALSE));
-        }
-
-        gtk_tree_path_free(path);
-    }
-
-    gtk_tree_row_reference_free(rr);
-}
-
-static void trg_torrent_model_init(TrgTorrentModel * self)
-{
-    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(self);
-
-    GType column_types[TORRENT_COLUMN_COLUMNS];
 
     column_types[TORRENT_COLUMN_ICON] = G_TYPE_STRING;
     column_types[TORRENT_COLUMN_NAME] = G_TYPE_STRING;
@@ -234,8 +239,7 @@ static void trg_torrent_model_init(TrgTorrentModel * self)
     column_types[TORRENT_COLUMN_HAVE_VALID] = G_TYPE_INT64;
     column_types[TORRENT_COLUMN_RATIO] = G_TYPE_DOUBLE;
     column_types[TORRENT_COLUMN_ID] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_JSON] = G_TYPE_POINTER;
-    column_types[TORRENT_COLUMN_UPDATESERIAL] = G_TYPE_INT64;
+    column_types[TORRENT_COLUMN_RECORD] = G_TYPE_POINTER;
     column_types[TORRENT_COLUMN_FLAGS] = G_TYPE_INT;
     column_types[TORRENT_COLUMN_DOWNLOADDIR] = G_TYPE_STRING;
     column_types[TORRENT_COLUMN_DOWNLOADDIR_SHORT] = G_TYPE_STRING;
@@ -258,478 +262,667 @@ static void trg_torrent_model_init(TrgTorrentModel * self)
     column_types[TORRENT_COLUMN_QUEUE_POSITION] = G_TYPE_INT64;
     column_types[TORRENT_COLUMN_LASTACTIVE] = G_TYPE_INT64;
     column_types[TORRENT_COLUMN_FILECOUNT] = G_TYPE_UINT;
+}
+
+trg_torrent_model_update_stats *trg_torrent_model_get_stats(TrgTorrentModel
+                                                            * model)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return &(priv->stats);
+}
+
+static inline trg_torrent_slot *trg_torrent_model_slot(TrgTorrentModelPrivate
+                                                       * priv, guint id)
+{
+    return &g_array_index(priv->slots, trg_torrent_slot, id);
+}
 
-    gtk_list_store_set_column_types(GTK_LIST_STORE(self),
-                                    TORRENT_COLUMN_COLUMNS, column_types);
+/* A torrent's slot, or NULL if there's no such torrent. */
+static trg_torrent_slot *trg_torrent_model_lookup(TrgTorrentModelPrivate *
+                                                  priv, gint64 id)
+{
+    if (id < 0 || id >= priv->slots->len
+        || !trg_bitset_get(priv->used, (guint) id))
+        return NULL;
 
-    priv->ht = g_hash_table_new_full(g_int64_hash, g_int64_equal,
-                                     (GDestroyNotify) g_free,
-                                     trg_torrent_model_ref_free);
+    return trg_torrent_model_slot(priv, (guint) id);
+}
 
-    g_object_set_data(G_OBJECT(self), PROP_REMOVE_IN_PROGRESS,
-                      GINT_TO_POINTER(FALSE));
+static void
+trg_torrent_model_iter_set(TrgTorrentModelPrivate * priv,
+                           GtkTreeIter * iter, guint id)
+{
+    iter->stamp = priv->stamp;
+    iter->user_data = GUINT_TO_POINTER(id);
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+}
 
-    priv->urlHostRegex = trg_uri_host_regex_new();
+static inline trg_torrent_slot *trg_torrent_model_iter_slot(TrgTorrentModelPrivate
+                                                            * priv,
+                                                            GtkTreeIter *
+                                                            iter)
+{
+    return trg_torrent_model_slot(priv, GPOINTER_TO_UINT(iter->user_data));
 }
 
-gboolean trg_torrent_model_is_remove_in_progress(TrgTorrentModel * model)
+static GtkTreeModelFlags
+trg_torrent_model_get_flags(GtkTreeModel * model G_GNUC_UNUSED)
 {
-    return (gboolean) GPOINTER_TO_INT(g_object_get_data
-                                      (G_OBJECT(model),
-                                       PROP_REMOVE_IN_PROGRESS));
+    return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint trg_torrent_model_get_n_columns(GtkTreeModel *
+                                            model G_GNUC_UNUSED)
+{
+    return TORRENT_COLUMN_COLUMNS;
+}
+
+static GType
+trg_torrent_model_get_column_type(GtkTreeModel * model G_GNUC_UNUSED,
+                                  gint index)
+{
+    g_return_val_if_fail(index >= 0 && index < TORRENT_COLUMN_COLUMNS,
+                         G_TYPE_INVALID);
+    return trg_torrent_model_column_types[index];
 }
 
 static gboolean
-trg_torrent_model_reload_dir_aliases_foreachfunc(GtkTreeModel * model,
-                                                 GtkTreePath *
-                                                 path G_GNUC_UNUSED,
-                                                 GtkTreeIter * iter,
-                                                 gpointer gdata)
+trg_torrent_model_iter_nth_child(GtkTreeModel * model,
+                                 GtkTreeIter * iter,
+                                 GtkTreeIter * parent, gint n)
 {
-    gchar *downloadDir, *shortDownloadDir;
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+
+    if (parent || n < 0 || (guint) n >= priv->rows->len) {
+        iter->stamp = 0;
+        return FALSE;
+    }
 
-    gtk_tree_model_get(model, iter, TORRENT_COLUMN_DOWNLOADDIR,
-                       &downloadDir, -1);
+    trg_torrent_model_iter_set(priv, iter,
+                               g_array_index(priv->rows, guint, n));
+    return TRUE;
+}
 
-    shortDownloadDir =
-        shorten_download_dir((TrgClient *) gdata, downloadDir);
+static gboolean
+trg_torrent_model_get_iter(GtkTreeModel * model, GtkTreeIter * iter,
+                           GtkTreePath * path)
+{
+    gint *indices, depth;
 
-    gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                       TORRENT_COLUMN_DOWNLOADDIR_SHORT, shortDownloadDir,
-                       -1);
+    indices = gtk_tree_path_get_indices_with_depth(path, &depth);
 
-    g_free(downloadDir);
-    g_free(shortDownloadDir);
+    if (depth != 1)
+        return FALSE;
 
-    return FALSE;
+    return trg_torrent_model_iter_nth_child(model, iter, NULL, indices[0]);
 }
 
-void
-trg_torrent_model_reload_dir_aliases(TrgClient * tc, GtkTreeModel * model)
+static GtkTreePath *trg_torrent_model_get_path(GtkTreeModel * model,
+                                               GtkTreeIter * iter)
 {
-    gtk_tree_model_foreach(model,
-                           trg_torrent_model_reload_dir_aliases_foreachfunc,
-                           tc);
-    g_signal_emit(model, signals[TMODEL_STATE_CHANGED], 0,
-                  TORRENT_UPDATE_PATH_CHANGE);
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+
+    return gtk_tree_path_new_from_indices(trg_torrent_model_iter_slot
+                                          (priv, iter)->row, -1);
 }
 
-static gboolean
-trg_torrent_model_stats_scan_foreachfunc(GtkTreeModel *
-                                         model,
-                                         GtkTreePath *
-                                         path
-                                         G_GNUC_UNUSED,
-                                         GtkTreeIter * iter,
-                                         gpointer gdata)
+static void
+trg_torrent_model_get_value(GtkTreeModel * model, GtkTreeIter * iter,
+                            gint column, GValue * value)
 {
-    trg_torrent_model_update_stats *stats =
-        (trg_torrent_model_update_stats *) gdata;
-    guint flags;
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    trg_torrent_record *rec;
+
+    g_return_if_fail(iter->stamp == priv->stamp);
+
+    rec = &trg_torrent_model_iter_slot(priv, iter)->rec;
+    g_value_init(value, trg_torrent_model_get_column_type(model, column));
+
+    switch (column) {
+    case TORRENT_COLUMN_ICON:
+        g_value_take_string(value,
+                            torrent_get_status_icon(priv->rpcv,
+                                                    rec->flags));
+        break;
+    case TORRENT_COLUMN_NAME:
+        g_value_set_static_string(value, rec->name);
+        break;
+    case TORRENT_COLUMN_SIZEWHENDONE:
+        g_value_set_int64(value, rec->sizeWhenDone);
+        break;
+    case TORRENT_COLUMN_PERCENTDONE:
+        g_value_set_double(value, trg_torrent_record_get_progress(rec));
+        break;
+    case TORRENT_COLUMN_METADATAPERCENTCOMPLETE:
+        g_value_set_double(value, rec->metadataPercentComplete);
+        break;
+    case TORRENT_COLUMN_STATUS:
+        g_value_take_string(value,
+                            torrent_get_status_string(priv->rpcv,
+                                                      rec->status,
+                                                      rec->flags));
+        break;
+    case TORRENT_COLUMN_SEEDS:
+        g_value_set_int64(value, rec->seeders);
+        break;
+    case TORRENT_COLUMN_LEECHERS:
+        g_value_set_int64(value, rec->leechers);
+        break;
+    case TORRENT_COLUMN_DOWNLOADS:
+        g_value_set_int64(value, rec->downloads);
+        break;
+    case TORRENT_COLUMN_PEERS_CONNECTED:
+        g_value_set_int64(value, rec->peersConnected);
+        break;
+    case TORRENT_COLUMN_PEERS_FROM_US:
+        g_value_set_int64(value, rec->peersGettingFromUs);
+        break;
+    case TORRENT_COLUMN_WEB_SEEDS_TO_US:
+        g_value_set_int64(value, rec->webseedsSendingToUs);
+        break;
+    case TORRENT_COLUMN_PEERS_TO_US:
+        g_value_set_int64(value, rec->peersSendingToUs);
+        break;
+    case TORRENT_COLUMN_DOWNSPEED:
+        g_value_set_int64(value, rec->rateDownload);
+        break;
+    case TORRENT_COLUMN_UPSPEED:
+        g_value_set_int64(value, rec->rateUpload);
+        break;
+    case TORRENT_COLUMN_ETA:
+        g_value_set_int64(value, rec->eta);
+        break;
+    case TORRENT_COLUMN_UPLOADED:
+        g_value_set_int64(value, rec->uploadedEver);
+        break;
+    case TORRENT_COLUMN_DOWNLOADED:
+        g_value_set_int64(value, rec->downloadedEver);
+        break;
+    case TORRENT_COLUMN_TOTALSIZE:
+        g_value_set_int64(value, rec->totalSize);
+        break;
+    case TORRENT_COLUMN_HAVE_UNCHECKED:
+        g_value_set_int64(value, rec->haveUnchecked);
+        break;
+    case TORRENT_COLUMN_HAVE_VALID:
+        g_value_set_int64(value, rec->haveValid);
+        break;
+    case TORRENT_COLUMN_RATIO:
+        g_value_set_double(value, trg_torrent_record_get_ratio(rec));
+        break;
+    case TORRENT_COLUMN_ADDED:
+        g_value_set_int64(value, rec->addedDate);
+        break;
+    case TORRENT_COLUMN_ID:
+        g_value_set_int64(value, rec->id);
+        break;
+    case TORRENT_COLUMN_RECORD:
+        g_value_set_pointer(value, rec);
+        break;
+    case TORRENT_COLUMN_FLAGS:
+        g_value_set_int(value, rec->flags);
+        break;
+    case TORRENT_COLUMN_DOWNLOADDIR:
+        g_value_set_static_string(value, rec->downloadDir);
+        break;
+    case TORRENT_COLUMN_DOWNLOADDIR_SHORT:
+        g_value_set_static_string(value, rec->shortDownloadDir);
+        break;
+    case TORRENT_COLUMN_BANDWIDTH_PRIORITY:
+        g_value_set_int64(value, rec->bandwidthPriority);
+        break;
+    case TORRENT_COLUMN_DONE_DATE:
+        g_value_set_int64(value, rec->doneDate);
+        break;
+    case TORRENT_COLUMN_FROMPEX:
+        g_value_set_int64(value, rec->fromPex);
+        break;
+    case TORRENT_COLUMN_FROMDHT:
+        g_value_set_int64(value, rec->fromDht);
+        break;
+    case TORRENT_COLUMN_FROMTRACKERS:
+        g_value_set_int64(value, rec->fromTrackers);
+        break;
+    case TORRENT_COLUMN_FROMLTEP:
+        g_value_set_int64(value, rec->fromLtep);
+        break;
+    case TORRENT_COLUMN_FROMRESUME:
+        g_value_set_int64(value, rec->fromResume);
+        break;
+    case TORRENT_COLUMN_FROMINCOMING:
+        g_value_set_int64(value, rec->fromIncoming);
+        break;
+    case TORRENT_COLUMN_PEER_SOURCES:
+        g_value_take_string(value,
+                            trg_torrent_record_get_peer_sources(rec));
+        break;
+    case TORRENT_COLUMN_TRACKERHOST:
+        g_value_set_static_string(value, rec->trackerHost);
+        break;
+    case TORRENT_COLUMN_QUEUE_POSITION:
+        g_value_set_int64(value, rec->queuePosition);
+        break;
+    case TORRENT_COLUMN_LASTACTIVE:
+        g_value_set_int64(value, rec->activityDate);
+        break;
+    case TORRENT_COLUMN_FILECOUNT:
+        g_value_set_uint(value, rec->fileCount);
+        break;
+    case TORRENT_COLUMN_ERROR:
+        g_value_set_int64(value, rec->error);
+        break;
+    case TORRENT_COLUMN_SEED_RATIO_MODE:
+        g_value_set_int64(value, rec->seedRatioMode);
+        break;
+    case TORRENT_COLUMN_SEED_RATIO_LIMIT:
+        g_value_set_double(value, rec->seedRatioLimit);
+        break;
+    }
+}
 
-    gtk_tree_model_get(model, iter, TORRENT_COLUMN_FLAGS, &flags, -1);
+static gboolean
+trg_torrent_model_iter_next(GtkTreeModel * model, GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    guint row = trg_torrent_model_iter_slot(priv, iter)->row + 1;
 
-    if (flags & TORRENT_FLAG_SEEDING)
-        stats->seeding++;
-    else if (flags & TORRENT_FLAG_DOWNLOADING)
-        stats->down++;
-    else if (flags & TORRENT_FLAG_PAUSED)
-        stats->paused++;
+    if (row >= priv->rows->len) {
+        iter->stamp = 0;
+        return FALSE;
+    }
 
-    if (flags & TORRENT_FLAG_ERROR)
-        stats->error++;
+    iter->user_data =
+        GUINT_TO_POINTER(g_array_index(priv->rows, guint, row));
+    return TRUE;
+}
 
-    if (flags & TORRENT_FLAG_COMPLETE)
-        stats->complete++;
-    else
-        stats->incomplete++;
+static gboolean
+trg_torrent_model_iter_previous(GtkTreeModel * model, GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    guint row = trg_torrent_model_iter_slot(priv, iter)->row;
 
-    if (flags & TORRENT_FLAG_CHECKING)
-        stats->checking++;
+    if (row == 0) {
+        iter->stamp = 0;
+        return FALSE;
+    }
 
-    if (flags & TORRENT_FLAG_ACTIVE)
-        stats->active++;
+    iter->user_data =
+        GUINT_TO_POINTER(g_array_index(priv->rows, guint, row - 1));
+    return TRUE;
+}
 
-    if (flags & TORRENT_FLAG_SEEDING_WAIT)
-        stats->seed_wait++;
+static gboolean
+trg_torrent_model_iter_children(GtkTreeModel * model,
+                                GtkTreeIter * iter, GtkTreeIter * parent)
+{
+    return trg_torrent_model_iter_nth_child(model, iter, parent, 0);
+}
 
-    if (flags & TORRENT_FLAG_DOWNLOADING_WAIT)
-        stats->down_wait++;
+static gboolean
+trg_torrent_model_iter_has_child(GtkTreeModel * model G_GNUC_UNUSED,
+                                 GtkTreeIter * iter G_GNUC_UNUSED)
+{
+    return FALSE;
+}
 
-    stats->count++;
+static gint
+trg_torrent_model_iter_n_children(GtkTreeModel * model, GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return iter ? 0 : (gint) priv->rows->len;
+}
 
+static gboolean
+trg_torrent_model_iter_parent(GtkTreeModel * model G_GNUC_UNUSED,
+                              GtkTreeIter * iter,
+                              GtkTreeIter * child G_GNUC_UNUSED)
+{
+    iter->stamp = 0;
     return FALSE;
 }
 
-void trg_torrent_model_remove_all(TrgTorrentModel * model)
+static void trg_torrent_model_row_changed(TrgTorrentModel * model,
+                                          guint id)
 {
     TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
-    g_hash_table_remove_all(priv->ht);
-    gtk_list_store_clear(GTK_LIST_STORE(model));
+    GtkTreePath *path =
+        gtk_tree_path_new_from_indices(trg_torrent_model_slot(priv, id)->
+                                       row, -1);
+    GtkTreeIter iter;
+
+    trg_torrent_model_iter_set(priv, &iter, id);
+    gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
 }
 
-gchar *shorten_download_dir(TrgClient * tc, const gchar * downloadDir)
+/* What a torrent gets from an update, decoded on the parse worker along
+ * with what can be worked out from the response alone, so the main loop
+ * only has to merge it into the torrent's record.
+ */
+typedef struct {
+    trg_torrent_update update;
+    gchar *nameKey;
+    gboolean hasTrackers;
+    gint32 seeders;
+    gint32 leechers;
+    gint32 downloads;
+    gchar *firstTrackerHost;
+    gchar *announces;
+    GQuark *hosts;
+    guint n_hosts;
+    guint64 fingerprint;        /* for delta sync, if fingerprinted */
+    gboolean fingerprinted;
+    gboolean unchanged;         /* so only the ID was decoded */
+} trg_torrent_prepared;
+
+static void trg_torrent_prepared_free(gpointer data)
 {
-    TrgPrefs *prefs = trg_client_get_prefs(tc);
-    JsonArray *labels =
-        trg_prefs_get_array(prefs, TRG_PREFS_KEY_DESTINATIONS,
-                            TRG_PREFS_CONNECTION);
-    JsonObject *session = trg_client_get_session(tc);
-    const gchar *defaultDownloadDir = session_get_download_dir(session);
-    gchar *shortDownloadDir = NULL;
+    trg_torrent_prepared *prep = (trg_torrent_prepared *) data;
+
+    trg_torrent_update_clear(&prep->update);
+    g_free(prep->nameKey);
+    g_free(prep->firstTrackerHost);
+    g_free(prep->announces);
+    g_free(prep->hosts);
+    g_free(prep);
+}
 
-    if (labels) {
-        GList *labelsList = json_array_get_elements(labels);
-        if (labelsList) {
-            GList *li;
-            for (li = labelsList; li; li = g_list_next(li)) {
-                JsonObject *labelObj = json_node_get_object((JsonNode *)
-                                                            li->data);
-                const gchar *labelDir =
-                    json_object_get_string_member(labelObj,
-                                                  TRG_PREFS_KEY_DESTINATIONS_SUBKEY_DIR);
-                if (!g_strcmp0(downloadDir, labelDir)) {
-                    const gchar *labelLabel =
-                        json_object_get_string_member(labelObj,
-                                                      TRG_PREFS_SUBKEY_LABEL);
-                    shortDownloadDir = g_strdup(labelLabel);
-                    break;
-                }
-            }
-            g_list_free(labelsList);
-        }
-    }
+/* Sum up the tracker counts, and extract the hosts of the trackers for the
+ * tracker index along with the announce URLs to tell if they've changed.
+ */
+static void
+trg_torrent_prepare_trackers(trg_torrent_prepared * prep,
+                             GRegex * hostRegex, JsonArray * trackerStats)
+{
+    guint n = json_array_get_length(trackerStats);
+    GString *announces = g_string_new(NULL);
+    guint i, j;
 
-    if (shortDownloadDir) {
-        return shortDownloadDir;
-    } else {
-        if (!g_strcmp0(defaultDownloadDir, downloadDir))
-            return g_strdup(_("Default"));
+    prep->hasTrackers = TRUE;
+    prep->hosts = g_new(GQuark, MAX(n, 1));
 
-        if (g_str_has_prefix(downloadDir, defaultDownloadDir)) {
-            int offset = strlen(defaultDownloadDir);
-            if (*(downloadDir + offset) == '/')
-                offset++;
+    for (i = 0; i < n; i++) {
+        JsonObject *tracker =
+            json_array_get_object_element(trackerStats, i);
+        const gchar *announce = tracker_stats_get_announce(tracker);
+        gchar *host = NULL;
+        GQuark quark;
 
-            if (offset < strlen(downloadDir))
-                return g_strdup(downloadDir + offset);
-        }
+        prep->seeders += tracker_stats_get_seeder_count(tracker);
+        prep->leechers += tracker_stats_get_leecher_count(tracker);
+        prep->downloads += tracker_stats_get_download_count(tracker);
+
+        if (announce)
+            g_string_append(announces, announce);
+        g_string_append_c(announces, '\n');
+
+        if (i == 0)
+            prep->firstTrackerHost =
+                trg_gregex_get_first(hostRegex,
+                                     tracker_stats_get_host(tracker));
+
+        if (announce)
+            host = trg_gregex_get_first(hostRegex, announce);
+
+        if (!host)
+            continue;
+
+        quark = g_quark_from_string(host);
+        g_free(host);
+
+        for (j = 0; j < prep->n_hosts && prep->hosts[j] != quark; j++);
+        if (j == prep->n_hosts)
+            prep->hosts[prep->n_hosts++] = quark;
     }
 
-    return g_strdup(downloadDir);
+    prep->announces = g_string_free(announces, FALSE);
 }
 
-static inline void
-update_torrent_iter(TrgTorrentModel * model,
-                    TrgClient * tc, gint64 rpcv,
-                    gint64 serial, GtkTreeIter * iter,
-                    JsonObject * t,
-                    trg_torrent_model_update_stats *
-                    stats, guint * whatsChanged)
+/* Work out what can be from a decoded torrent. */
+static void
+trg_torrent_prepare(trg_torrent_prepared * prep, GRegex * hostRegex)
 {
-    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
-    GtkListStore *ls = GTK_LIST_STORE(model);
-    guint lastFlags, newFlags;
-    JsonObject *lastJson, *pf;
-    JsonArray *trackerStats;
-    gchar *statusString, *statusIcon, *downloadDir;
-    gint64 downRate, upRate, haveValid, uploaded, downloaded, id, status,
-        lpd;
-    guint fileCount;
-    gchar *firstTrackerHost = NULL;
-    gchar *peerSources = NULL;
-    gchar *lastDownloadDir = NULL;
-
-    downRate = torrent_get_rate_down(t);
-    stats->downRateTotal += downRate;
-
-    upRate = torrent_get_rate_up(t);
-    stats->upRateTotal += upRate;
-
-    uploaded = torrent_get_uploaded(t);
-    downloaded = torrent_get_downloaded(t);
-    haveValid = torrent_get_have_valid(t);
-
-    downloadDir = (gchar *) torrent_get_download_dir(t);
-    rm_trailing_slashes(downloadDir);
-
-    id = torrent_get_id(t);
-    status = torrent_get_status(t);
-    fileCount = json_array_get_length(torrent_get_files(t));
-    newFlags =
-        torrent_get_flags(t, rpcv, status, fileCount, downRate, upRate);
-    statusString = torrent_get_status_string(rpcv, status, newFlags);
-    statusIcon = torrent_get_status_icon(rpcv, newFlags);
-    pf = torrent_get_peersfrom(t);
-    trackerStats = torrent_get_tracker_stats(t);
-
-    gtk_tree_model_get(GTK_TREE_MODEL(model), iter, TORRENT_COLUMN_FLAGS,
-                       &lastFlags, TORRENT_COLUMN_JSON, &lastJson,
-                       TORRENT_COLUMN_DOWNLOADDIR, &lastDownloadDir, -1);
-
-    json_object_ref(t);
-
-    if (json_array_get_length(trackerStats) > 0) {
-        JsonObject *firstTracker =
-            json_array_get_object_element(trackerStats,
-                                          0);
-        firstTrackerHost = trg_gregex_get_first(priv->urlHostRegex,
-                                                tracker_stats_get_host
-                                                (firstTracker));
-    }
-
-    lpd = peerfrom_get_lpd(pf);
-    if (newFlags & TORRENT_FLAG_ACTIVE) {
-        if (lpd >= 0) {
-            peerSources =
-                g_strdup_printf("%" G_GINT64_FORMAT " / %" G_GINT64_FORMAT
-                                " / %" G_GINT64_FORMAT " / %"
-                                G_GINT64_FORMAT " / %" G_GINT64_FORMAT
-                                " / %" G_GINT64_FORMAT " / %"
-                                G_GINT64_FORMAT, peerfrom_get_trackers(pf),
-                                peerfrom_get_incoming(pf),
-                                peerfrom_get_ltep(pf),
-                                peerfrom_get_dht(pf), peerfrom_get_pex(pf),
-                                lpd, peerfrom_get_resume(pf));
-        } else {
-            peerSources =
-                g_strdup_printf("%" G_GINT64_FORMAT " / %" G_GINT64_FORMAT
-                                " / %" G_GINT64_FORMAT " / %"
-                                G_GINT64_FORMAT " / %" G_GINT64_FORMAT
-                                " / N/A / %" G_GINT64_FORMAT,
-                                peerfrom_get_trackers(pf),
-                                peerfrom_get_incoming(pf),
-                                peerfrom_get_ltep(pf),
-                                peerfrom_get_dht(pf), peerfrom_get_pex(pf),
-                                peerfrom_get_resume(pf));
-        }
-    }
-#ifdef TRG_DEBUG
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ICON, statusIcon, -1);
-    gtk_list_store_set(ls, iter,
-                       TORRENT_COLUMN_NAME, torrent_get_name(t), -1);
-    gtk_list_store_set(ls, iter,
-                       TORRENT_COLUMN_SIZEWHENDONE,
-                       torrent_get_size_when_done(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_PERCENTDONE,
-                       (newFlags & TORRENT_FLAG_CHECKING) ?
-                       torrent_get_recheck_progress(t)
-                       : torrent_get_percent_done(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_STATUS, statusString, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_DOWNSPEED, downRate, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_FLAGS, newFlags, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_UPSPEED, upRate, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ETA, torrent_get_eta(t),
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_UPLOADED, uploaded, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_DOWNLOADED, downloaded,
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_RATIO, uploaded > 0
-                       && downloaded >
-                       0 ? (double) uploaded / (double) downloaded : 0,
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ID, id, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_JSON, t, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_UPDATESERIAL, serial, -1);
-    gtk_list_store_set(ls, iter,
-                       TORRENT_COLUMN_ADDED, torrent_get_added_date(t),
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_DOWNLOADDIR, downloadDir,
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_PEERS_CONNECTED, torrent_get_peers_connected(t),
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ETA, torrent_get_eta(t),
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_BANDWIDTH_PRIORITY,
-                       torrent_get_bandwidth_priority(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_TOTALSIZE,
-                       torrent_get_total_size(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_HAVE_UNCHECKED,
-                       torrent_get_have_unchecked(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_METADATAPERCENTCOMPLETE,
-                       torrent_get_metadata_percent_complete(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_PEERS_TO_US,
-                       torrent_get_peers_sending_to_us(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_PEERS_FROM_US,
-                       torrent_get_peers_getting_from_us(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_WEB_SEEDS_TO_US,
-                       torrent_get_web_seeds_sending_to_us(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_SEED_RATIO_LIMIT,
-                       torrent_get_seed_ratio_limit(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_SEED_RATIO_MODE,
-                       torrent_get_seed_ratio_mode(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_FILECOUNT, fileCount, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_HAVE_VALID, haveValid, -1);
-#else
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ICON, statusIcon,
-                       TORRENT_COLUMN_ADDED, torrent_get_added_date(t),
-                       TORRENT_COLUMN_FILECOUNT,
-                       fileCount,
-                       TORRENT_COLUMN_DONE_DATE, torrent_get_done_date(t),
-                       TORRENT_COLUMN_NAME, torrent_get_name(t),
-                       TORRENT_COLUMN_ERROR, torrent_get_error(t),
-                       TORRENT_COLUMN_SIZEWHENDONE,
-                       torrent_get_size_when_done(t),
-                       TORRENT_COLUMN_PERCENTDONE,
-                       (newFlags & TORRENT_FLAG_CHECKING) ?
-                       torrent_get_recheck_progress(t)
-                       : torrent_get_percent_done(t),
-                       TORRENT_COLUMN_METADATAPERCENTCOMPLETE,
-                       torrent_get_metadata_percent_complete(t),
-                       TORRENT_COLUMN_STATUS, statusString,
-                       TORRENT_COLUMN_DOWNSPEED, downRate,
-                       TORRENT_COLUMN_FLAGS, newFlags,
-                       TORRENT_COLUMN_UPSPEED, upRate, TORRENT_COLUMN_ETA,
-                       torrent_get_eta(t), TORRENT_COLUMN_UPLOADED,
-                       uploaded, TORRENT_COLUMN_DOWNLOADED, downloaded,
-                       TORRENT_COLUMN_TOTALSIZE, torrent_get_total_size(t),
-                       TORRENT_COLUMN_HAVE_UNCHECKED,
-                       torrent_get_have_unchecked(t),
-                       TORRENT_COLUMN_HAVE_VALID, haveValid,
-                       TORRENT_COLUMN_FROMPEX, peerfrom_get_pex(pf),
-                       TORRENT_COLUMN_FROMDHT, peerfrom_get_dht(pf),
-                       TORRENT_COLUMN_FROMTRACKERS,
-                       peerfrom_get_trackers(pf), TORRENT_COLUMN_FROMLTEP,
-                       peerfrom_get_ltep(pf), TORRENT_COLUMN_FROMRESUME,
-                       peerfrom_get_resume(pf),
-                       TORRENT_COLUMN_FROMINCOMING,
-                       peerfrom_get_incoming(pf),
-                       TORRENT_COLUMN_PEER_SOURCES, peerSources,
-                       TORRENT_COLUMN_PEERS_CONNECTED,
-                       torrent_get_peers_connected(t),
-                       TORRENT_COLUMN_PEERS_TO_US,
-                       torrent_get_peers_sending_to_us(t),
-                       TORRENT_COLUMN_PEERS_FROM_US,
-                       torrent_get_peers_getting_from_us(t),
-                       TORRENT_COLUMN_WEB_SEEDS_TO_US,
-                       torrent_get_web_seeds_sending_to_us(t),
-                       TORRENT_COLUMN_QUEUE_POSITION,
-                       torrent_get_queue_position(t),
-                       TORRENT_COLUMN_SEED_RATIO_LIMIT,
-                       torrent_get_seed_ratio_limit(t),
-                       TORRENT_COLUMN_SEED_RATIO_MODE,
-                       torrent_get_seed_ratio_mode(t),
-                       TORRENT_COLUMN_LASTACTIVE,
-                       torrent_get_activity_date(t), TORRENT_COLUMN_RATIO,
-                       uploaded > 0
-                       && haveValid >
-                       0 ? (double) uploaded / (double) haveValid : 0,
-                       TORRENT_COLUMN_DOWNLOADDIR, downloadDir,
-                       TORRENT_COLUMN_BANDWIDTH_PRIORITY,
-                       torrent_get_bandwidth_priority(t),
-                       TORRENT_COLUMN_ID, id, TORRENT_COLUMN_JSON, t,
-                       TORRENT_COLUMN_TRACKERHOST,
-                       firstTrackerHost ? firstTrackerHost : "",
-                       TORRENT_COLUMN_UPDATESERIAL, serial, -1);
-#endif
+    if (prep->update.rec.name)
+        prep->nameKey = g_utf8_casefold(prep->update.rec.name, -1);
 
-    if (!lastDownloadDir || g_strcmp0(downloadDir, lastDownloadDir)) {
-        gchar *shortDownloadDir = shorten_download_dir(tc, downloadDir);
-        gtk_list_store_set(ls, iter, TORRENT_COLUMN_DOWNLOADDIR_SHORT,
-                           shortDownloadDir, -1);
-        g_free(shortDownloadDir);
-        *whatsChanged |= TORRENT_UPDATE_PATH_CHANGE;
-    }
+    if (prep->update.trackerStats)
+        trg_torrent_prepare_trackers(prep, hostRegex,
+                                     prep->update.trackerStats);
+}
 
-    if (lastJson)
-        json_object_unref(lastJson);
+/* Whether a torrent's record was last updated from one just like this. */
+static gboolean
+trg_torrent_model_fingerprint_matches(TrgTorrentModelPrivate * priv,
+                                      gint64 id, guint64 fingerprint)
+{
+    trg_torrent_fingerprint *fp;
+    gboolean matches;
 
-    if ((lastFlags & TORRENT_FLAG_DOWNLOADING)
-        && (!(newFlags & TORRENT_FLAG_DOWNLOADING))
-        && (newFlags & TORRENT_FLAG_COMPLETE))
-        g_signal_emit(model, signals[TMODEL_TORRENT_COMPLETED], 0, iter);
+    g_mutex_lock(&priv->fingerprintsLock);
+    fp = g_hash_table_lookup(priv->fingerprints, &id);
+    matches = fp && fp->fingerprint == fingerprint;
+    g_mutex_unlock(&priv->fingerprintsLock);
 
-    if (lastFlags != newFlags)
-        *whatsChanged |= TORRENT_UPDATE_STATE_CHANGE;
+    return matches;
+}
+
+/* Remember what a record was updated from, once it has been. A response
+ * with details, or for an interaction, is applied on top of a record without
+ * being a list update, so the next list update can't be compared with the
+ * one before and is always applied.
+ */
+static void
+trg_torrent_model_commit_fingerprint(TrgTorrentModelPrivate * priv,
+                                     trg_torrent_prepared * prep,
+                                     gint mode)
+{
+    gint64 id = prep->update.rec.id;
+    trg_torrent_fingerprint *fp;
+
+    g_mutex_lock(&priv->fingerprintsLock);
+
+    if (mode == TORRENT_GET_MODE_INTERACTION
+        || (prep->update.present &
+            TORRENT_FIELD_BIT(TORRENT_FIELD_FILES))) {
+        g_hash_table_remove(priv->fingerprints, &id);
+    } else if (prep->fingerprinted) {
+        fp = g_hash_table_lookup(priv->fingerprints, &id);
+        if (!fp) {
+            fp = g_new(trg_torrent_fingerprint, 1);
+            fp->id = id;
+            g_hash_table_insert(priv->fingerprints, &fp->id, fp);
+        }
+        fp->fingerprint = prep->fingerprint;
+    }
 
-    trg_torrent_model_count_peers(model, iter, t);
+    g_mutex_unlock(&priv->fingerprintsLock);
+}
 
-    if (firstTrackerHost)
-        g_free(firstTrackerHost);
+/* Takes over the contents of the update. */
+static trg_torrent_prepared *trg_torrent_model_prepare_update(TrgTorrentModelPrivate
+                                                              * priv,
+                                                              trg_torrent_update
+                                                              * update,
+                                                              gboolean
+                                                              fingerprinted,
+                                                              guint64
+                                                              fingerprint)
+{
+    trg_torrent_prepared *prep = g_new0(trg_torrent_prepared, 1);
+
+    prep->update = *update;
+    trg_torrent_update_init(update);
+
+    /* The main loop checks again when it gets to the record, in case an
+     * earlier response changed it in the meantime. */
+    if (fingerprinted
+        && trg_torrent_model_fingerprint_matches(priv,
+                                                 prep->update.rec.id,
+                                                 fingerprint)) {
+        gint64 id = prep->update.rec.id;
+
+        trg_torrent_update_clear(&prep->update);
+        prep->update.rec.id = id;
+        prep->unchanged = TRUE;
+    } else {
+        trg_torrent_prepare(prep, priv->urlHostRegex);
+    }
 
-    if (peerSources)
-        g_free(peerSources);
+    prep->fingerprint = fingerprint;
+    prep->fingerprinted = fingerprinted;
 
-    g_free(lastDownloadDir);
-    g_free(statusString);
-    g_free(statusIcon);
+    return prep;
 }
 
-TrgTorrentModel *trg_torrent_model_new(void)
+/* For a response which was decoded as a whole, and not fingerprinted. */
+static GPtrArray *trg_torrent_model_prepare_torrents(TrgTorrentModelPrivate
+                                                     * priv,
+                                                     JsonArray * torrents)
 {
-    return g_object_new(TRG_TYPE_TORRENT_MODEL, NULL);
+    guint i, n = json_array_get_length(torrents);
+    GPtrArray *prepared = g_ptr_array_new_full(n,
+                                               trg_torrent_prepared_free);
+
+    for (i = 0; i < n; i++) {
+        trg_torrent_update update;
+
+        trg_torrent_update_init(&update);
+        trg_torrent_update_from_json(&update,
+                                     json_array_get_object_element
+                                     (torrents, i));
+        g_ptr_array_add(prepared,
+                        trg_torrent_model_prepare_update(priv, &update,
+                                                         FALSE, 0));
+    }
+
+    return prepared;
 }
 
-struct TrgModelRemoveData {
-    GList *toRemove;
-    gint64 currentSerial;
-};
+/* Prepares each torrent of a torrent-get response as it's decoded, in the
+ * same order. With delta sync, one which has the same text as the last
+ * time it was applied is left as just its ID. That isn't done with the
+ * details, which are kept apart from the record.
+ */
+void
+trg_torrent_model_prepare(TrgClient * tc G_GNUC_UNUSED,
+                          trg_response * response,
+                          trg_torrent_update * update,
+                          guint64 fingerprint, gpointer data)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(data);
+    gboolean fingerprinted = g_atomic_int_get(&priv->delta)
+        && !(update->present & TORRENT_FIELD_BIT(TORRENT_FIELD_FILES));
+
+    if (!response->prepared) {
+        response->prepared =
+            g_ptr_array_new_with_free_func(trg_torrent_prepared_free);
+        response->prepared_free = (GDestroyNotify) g_ptr_array_unref;
+    }
+
+    g_ptr_array_add((GPtrArray *) response->prepared,
+                    trg_torrent_model_prepare_update(priv, update,
+                                                     fingerprinted,
+                                                     fingerprint));
+}
 
-GHashTable *get_torrent_table(TrgTorrentModel * model)
+static trg_torrent_category *trg_torrent_category_new(void)
 {
-    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
-    return priv->ht;
+    trg_torrent_category *cat = g_new0(trg_torrent_category, 1);
+    cat->members = trg_bitset_new();
+    return cat;
 }
 
-static gboolean
-trg_model_find_removed_foreachfunc(GtkTreeModel * model,
-                                   GtkTreePath *
-                                   path G_GNUC_UNUSED,
-                                   GtkTreeIter * iter, gpointer gdata)
+static void trg_torrent_category_free(gpointer data)
 {
-    struct TrgModelRemoveData *args = (struct TrgModelRemoveData *) gdata;
-    gint64 rowSerial;
+    trg_torrent_category *cat = (trg_torrent_category *) data;
+    trg_bitset_free(cat->members);
+    g_free(cat);
+}
 
-    gtk_tree_model_get(model, iter, TORRENT_COLUMN_UPDATESERIAL,
-                       &rowSerial, -1);
+static void
+trg_torrent_category_add(GHashTable * index, GQuark key, guint id)
+{
+    trg_torrent_category *cat =
+        g_hash_table_lookup(index, GUINT_TO_POINTER(key));
 
-    if (rowSerial != args->currentSerial) {
-        gint64 *id = g_new(gint64, 1);
-        gtk_tree_model_get(model, iter, TORRENT_COLUMN_ID, id, -1);
-        args->toRemove = g_list_append(args->toRemove, id);
+    if (!cat) {
+        cat = trg_torrent_category_new();
+        g_hash_table_insert(index, GUINT_TO_POINTER(key), cat);
     }
 
-    return FALSE;
+    trg_bitset_set(cat->members, id, TRUE);
+    cat->count++;
 }
 
-static GList *trg_torrent_model_find_removed(GtkTreeModel * model,
-                                      gint64 currentSerial)
+static void
+trg_torrent_category_remove(GHashTable * index, GQuark key, guint id)
 {
-    struct TrgModelRemoveData args;
-    args.toRemove = NULL;
-    args.currentSerial = currentSerial;
+    trg_torrent_category *cat =
+        g_hash_table_lookup(index, GUINT_TO_POINTER(key));
+
+    if (cat) {
+        trg_bitset_set(cat->members, id, FALSE);
+        if (--cat->count < 1)
+            g_hash_table_remove(index, GUINT_TO_POINTER(key));
+    }
+}
 
-    gtk_tree_model_foreach(GTK_TREE_MODEL(model),
-                           trg_model_find_removed_foreachfunc, &args);
+#define TRG_TRIGRAM(c) (((guint) (c)[0] << 16) | ((guint) (c)[1] << 8) \
+                        | (guint) (c)[2])
 
-    return args.toRemove;
+static void trg_torrent_model_postings_free(GArray * postings)
+{
+    g_array_free(postings, TRUE);
 }
 
-gboolean
-get_torrent_data(GHashTable * table, gint64 id, JsonObject ** t,
-                 GtkTreeIter * out_iter)
+/* Every space separated search term has to be in the name. */
+static gboolean
+trg_torrent_model_name_matches(trg_torrent_slot * ts, gchar ** terms)
 {
-    gpointer result = g_hash_table_lookup(table, &id);
-    gboolean found = FALSE;
+    gchar **term;
 
-    if (result) {
-        GtkTreeRowReference *rr = (GtkTreeRowReference *) result;
-        GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
-        GtkTreeIter iter;
-        if (path) {
-            GtkTreeModel *model = gtk_tree_row_reference_get_model(rr);
-            gtk_tree_model_get_iter(model, &iter, path);
-            if (out_iter)
-                *out_iter = iter;
-            if (t)
-                gtk_tree_model_get(model, &iter, TORRENT_COLUMN_JSON, t,
-                                   -1);
-            found = TRUE;
-            gtk_tree_path_free(path);
-        }
+    if (!terms)
+        return TRUE;
+    else if (!ts->nameKey)
+        return FALSE;
+
+    for (term = terms; *term; term++)
+        if (**term && !strstr(ts->nameKey, *term))
+            return FALSE;
+
+    return TRUE;
+}
+
+/* Whether a torrent passes the current filter, from its slot alone. */
+static gboolean
+trg_torrent_model_slot_matches(TrgTorrentModelPrivate * priv, guint id)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+    guint32 criteria = priv->filterFlag;
+
+    if (criteria & FILTER_FLAG_TRACKER) {
+        trg_torrent_category *cat =
+            g_hash_table_lookup(priv->trackerIndex,
+                                GUINT_TO_POINTER(priv->filterName));
+        if (!cat || !trg_bitset_get(cat->members, id))
+            return FALSE;
+    } else if (criteria & FILTER_FLAG_DIR) {
+        if (ts->dir != priv->filterName)
+            return FALSE;
+    } else if (criteria != 0 && !(ts->rec.flags & criteria)) {
+        return FALSE;
     }
 
-    return found;
+    return trg_torrent_model_name_matches(ts, priv->filterTerms);
+}
+
+static void
+trg_torrent_model_slot_refilter(TrgTorrentModelPrivate * priv, guint id)
+{
+    trg_bitset_set(priv->visible, id,
+                   trg_torrent_model_slot_matches(priv, id));
 }
 
 static void
@@ -741,113 +934,1011 @@ trg_torrent_model_stat_counts_clear(trg_torrent_model_update_stats * stats)
         stats->down_wait = 0;
 }
 
-trg_torrent_model_update_stats *trg_torrent_model_update(TrgTorrentModel *
-                                                         model,
-                                                         TrgClient * tc,
-                                                         JsonObject *
-                                                         response,
-                                                         gint mode)
+/* Count a torrent's flags in or out of the totals, so a change only costs
+ * taking away the old flags and adding the new ones.
+ */
+static void
+trg_torrent_model_stats_count(trg_torrent_model_update_stats * stats,
+                              guint flags, gint delta)
 {
-    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    if (flags & TORRENT_FLAG_SEEDING)
+        stats->seeding += delta;
+    else if (flags & TORRENT_FLAG_DOWNLOADING)
+        stats->down += delta;
+    else if (flags & TORRENT_FLAG_PAUSED)
+        stats->paused += delta;
 
-    GList *torrentList;
-    JsonObject *args, *t;
-    GList *li;
-    gint64 id;
-    gint64 serial = trg_client_get_serial(tc);
-    JsonArray *removedTorrents;
-    GtkTreeIter iter;
-    GtkTreePath *path;
-    GtkTreeRowReference *rr;
-    gpointer *result;
-    guint whatsChanged = 0;
+    if (flags & TORRENT_FLAG_ERROR)
+        stats->error += delta;
 
-    gint64 rpcv = trg_client_get_rpc_version(tc);
+    if (flags & TORRENT_FLAG_COMPLETE)
+        stats->complete += delta;
+    else
+        stats->incomplete += delta;
 
-    args = get_arguments(response);
-    torrentList = json_array_get_elements(get_torrents(args));
+    if (flags & TORRENT_FLAG_CHECKING)
+        stats->checking += delta;
+
+    if (flags & TORRENT_FLAG_ACTIVE)
+        stats->active += delta;
+
+    if (flags & TORRENT_FLAG_SEEDING_WAIT)
+        stats->seed_wait += delta;
+
+    if (flags & TORRENT_FLAG_DOWNLOADING_WAIT)
+        stats->down_wait += delta;
+
+    stats->count += delta;
+}
+
+/* Take a torrent's slot, growing the array up to its ID if need be. The
+ * row is added once its record has been filled in.
+ */
+static trg_torrent_slot *trg_torrent_model_slot_new(TrgTorrentModelPrivate
+                                                    * priv, guint id)
+{
+    trg_torrent_slot *ts;
+
+    if (id >= priv->slots->len)
+        g_array_set_size(priv->slots, id + 1);
+
+    ts = trg_torrent_model_slot(priv, id);
+    memset(ts, 0, sizeof(trg_torrent_slot));
+    trg_torrent_record_init(&ts->rec);
+    ts->rec.id = id;
+    trg_bitset_set(priv->used, id, TRUE);
+    trg_torrent_model_stats_count(&priv->stats, 0, 1);
+
+    return ts;
+}
+
+static void
+trg_torrent_model_slot_set_flags(TrgTorrentModelPrivate * priv,
+                                 guint id, guint flags)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+    guint changed = ts->rec.flags ^ flags;
+    guint bit;
+
+    if (changed) {
+        trg_torrent_model_stats_count(&priv->stats, ts->rec.flags, -1);
+        trg_torrent_model_stats_count(&priv->stats, flags, 1);
+    }
+
+    for (bit = 0; changed; bit++, changed >>= 1) {
+        if (changed & 1) {
+            trg_torrent_category *cat = priv->flagCategories[bit];
+
+            if (!cat)
+                cat = priv->flagCategories[bit] =
+                    trg_torrent_category_new();
+
+            if (flags & (1u << bit)) {
+                trg_bitset_set(cat->members, id, TRUE);
+                cat->count++;
+            } else {
+                trg_bitset_set(cat->members, id, FALSE);
+                cat->count--;
+            }
+        }
+    }
+
+    ts->rec.flags = flags;
+}
+
+/* Returns TRUE if the short directory changed. */
+static gboolean
+trg_torrent_model_slot_set_dir(TrgTorrentModelPrivate * priv, guint id,
+                               const gchar * shortDownloadDir)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+    GQuark dir = g_quark_from_string(shortDownloadDir);
+
+    trg_string_pool_set(priv->strings, &ts->rec.shortDownloadDir,
+                        shortDownloadDir);
+
+    if (ts->dir == dir)
+        return FALSE;
+
+    if (ts->dir)
+        trg_torrent_category_remove(priv->dirIndex, ts->dir, id);
+    if (dir)
+        trg_torrent_category_add(priv->dirIndex, dir, id);
+    ts->dir = dir;
+
+    return TRUE;
+}
+
+static void
+trg_torrent_model_index_name(TrgTorrentModelPrivate * priv, guint id)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+    const guchar *c;
+
+    ts->n_trigrams = 0;
+
+    if (!ts->nameKey)
+        return;
+
+    for (c = (const guchar *) ts->nameKey; c[0] && c[1] && c[2]; c++) {
+        gpointer key = GUINT_TO_POINTER(TRG_TRIGRAM(c));
+        GArray *postings = g_hash_table_lookup(priv->trigrams, key);
+
+        if (!postings) {
+            postings = g_array_new(FALSE, FALSE, sizeof(guint));
+            g_hash_table_insert(priv->trigrams, key, postings);
+        } else if (postings->len > 0
+                   && g_array_index(postings, guint,
+                                    postings->len - 1) == id) {
+            /* Repeated in this name. */
+            continue;
+        }
+
+        g_array_append_val(postings, id);
+        ts->n_trigrams++;
+    }
+
+    priv->trigramsLive += ts->n_trigrams;
+}
+
+static void trg_torrent_model_reindex_names(TrgTorrentModelPrivate * priv)
+{
+    gint id;
+
+    g_hash_table_remove_all(priv->trigrams);
+    priv->trigramsLive = priv->trigramsStale = 0;
+
+    for (id = trg_bitset_next(priv->used, 0); id >= 0;
+         id = trg_bitset_next(priv->used, id + 1))
+        trg_torrent_model_index_name(priv, id);
+}
+
+/* Rebuild the trigram index once most of its postings are stale, so renames
+ * and removals don't grow it without bound.
+ */
+static void trg_torrent_model_compact_names(TrgTorrentModelPrivate * priv)
+{
+    if (priv->trigramsStale > 4096
+        && priv->trigramsStale > priv->trigramsLive)
+        trg_torrent_model_reindex_names(priv);
+}
+
+/* A torrent's old trigrams are just counted as stale. */
+static void
+trg_torrent_model_unindex_name(TrgTorrentModelPrivate * priv, guint id)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+
+    priv->trigramsLive -= ts->n_trigrams;
+    priv->trigramsStale += ts->n_trigrams;
+    ts->n_trigrams = 0;
+}
+
+/* After the record's name has changed. The worker usually folded it. */
+static void
+trg_torrent_model_slot_set_name(TrgTorrentModelPrivate * priv, guint id,
+                                gchar * nameKey)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+
+    trg_torrent_model_unindex_name(priv, id);
+    g_free(ts->nameKey);
+    ts->nameKey = nameKey ? nameKey : g_utf8_casefold(ts->rec.name, -1);
+    trg_torrent_model_index_name(priv, id);
+}
+
+static void
+trg_torrent_model_unindex_trackers(TrgTorrentModelPrivate * priv, guint id)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+    guint i;
+
+    for (i = 0; i < ts->n_hosts; i++)
+        trg_torrent_category_remove(priv->trackerIndex, ts->hosts[i], id);
+
+    g_free(ts->hosts);
+    g_free(ts->announces);
+    ts->hosts = NULL;
+    ts->announces = NULL;
+    ts->n_hosts = 0;
+}
+
+/* Index the hosts of a torrent's trackers, but only when its announce URLs
+ * have changed. Returns TRUE if they had.
+ */
+static gboolean
+trg_torrent_model_index_trackers(TrgTorrentModelPrivate * priv, guint id,
+                                 trg_torrent_prepared * prep)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+    guint i;
+
+    if (ts->announces && !strcmp(ts->announces, prep->announces))
+        return FALSE;
+
+    trg_torrent_model_unindex_trackers(priv, id);
+
+    /* Taken over from the prepared update. */
+    ts->announces = prep->announces;
+    ts->hosts = prep->hosts;
+    ts->n_hosts = prep->n_hosts;
+    prep->announces = NULL;
+    prep->hosts = NULL;
+
+    for (i = 0; i < ts->n_hosts; i++)
+        trg_torrent_category_add(priv->trackerIndex, ts->hosts[i], id);
+
+    return TRUE;
+}
+
+static void trg_torrent_model_details_free(trg_torrent_details * details)
+{
+    if (details) {
+        trg_torrent_details_clear(details);
+        g_free(details);
+    }
+}
+
+static void
+trg_torrent_model_slot_free(TrgTorrentModelPrivate * priv, guint id)
+{
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+
+    trg_torrent_model_unindex_trackers(priv, id);
+    trg_torrent_model_unindex_name(priv, id);
+    trg_torrent_model_slot_set_flags(priv, id, 0);
+    trg_torrent_model_stats_count(&priv->stats, 0, -1);
+    if (ts->dir)
+        trg_torrent_category_remove(priv->dirIndex, ts->dir, id);
+
+    g_free(ts->nameKey);
+    trg_torrent_model_details_free(ts->details);
+    trg_torrent_record_clear(&ts->rec, priv->strings);
+    memset(ts, 0, sizeof(trg_torrent_slot));
+
+    trg_bitset_set(priv->used, id, FALSE);
+    trg_bitset_set(priv->visible, id, FALSE);
+}
+
+/* Give a filled in slot its row, at the end. */
+static void trg_torrent_model_insert_row(TrgTorrentModel * model, guint id,
+                                         GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    GtkTreePath *path;
+
+    trg_torrent_model_slot(priv, id)->row = priv->rows->len;
+    g_array_append_val(priv->rows, id);
+
+    trg_torrent_model_iter_set(priv, iter, id);
+    path = gtk_tree_path_new_from_indices(priv->rows->len - 1, -1);
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, iter);
+    gtk_tree_path_free(path);
+}
+
+static void trg_torrent_model_delete_row(TrgTorrentModel * model, guint id)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    guint row = trg_torrent_model_slot(priv, id)->row;
+    GtkTreePath *path;
+    guint i;
+
+    g_array_remove_index(priv->rows, row);
+    for (i = row; i < priv->rows->len; i++)
+        trg_torrent_model_slot(priv,
+                               g_array_index(priv->rows, guint, i))->row =
+            i;
+
+    path = gtk_tree_path_new_from_indices(row, -1);
+    g_object_set_data(G_OBJECT(model), PROP_REMOVE_IN_PROGRESS,
+                      GINT_TO_POINTER(TRUE));
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+    g_object_set_data(G_OBJECT(model), PROP_REMOVE_IN_PROGRESS,
+                      GINT_TO_POINTER(FALSE));
+    gtk_tree_path_free(path);
+}
+
+/* Remove a torrent's row, and its slot with its category memberships. */
+static void
+trg_torrent_model_remove_torrent(TrgTorrentModel * model, gint64 id)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+
+    if (trg_torrent_model_lookup(priv, id)) {
+        trg_torrent_model_delete_row(model, (guint) id);
+        trg_torrent_model_slot_free(priv, (guint) id);
+        priv->stats.changed++;
+    }
+
+    g_mutex_lock(&priv->fingerprintsLock);
+    g_hash_table_remove(priv->fingerprints, &id);
+    g_mutex_unlock(&priv->fingerprintsLock);
+}
+
+static void trg_torrent_model_slots_clear(TrgTorrentModelPrivate * priv)
+{
+    gint id;
+    guint i;
+
+    for (id = trg_bitset_next(priv->used, 0); id >= 0;
+         id = trg_bitset_next(priv->used, id + 1)) {
+        trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+        g_free(ts->nameKey);
+        g_free(ts->announces);
+        g_free(ts->hosts);
+        trg_torrent_model_details_free(ts->details);
+        trg_torrent_record_clear(&ts->rec, priv->strings);
+    }
+
+    g_array_set_size(priv->slots, 0);
+    g_array_set_size(priv->rows, 0);
+
+    for (i = 0; i < G_N_ELEMENTS(priv->flagCategories); i++) {
+        if (priv->flagCategories[i]) {
+            trg_torrent_category_free(priv->flagCategories[i]);
+            priv->flagCategories[i] = NULL;
+        }
+    }
+
+    g_hash_table_remove_all(priv->trackerIndex);
+    g_hash_table_remove_all(priv->dirIndex);
+    g_hash_table_remove_all(priv->trigrams);
+    priv->trigramsLive = priv->trigramsStale = 0;
+    trg_bitset_clear(priv->used);
+    trg_bitset_clear(priv->visible);
+    trg_torrent_model_stat_counts_clear(&priv->stats);
+}
+
+static void trg_torrent_model_init(TrgTorrentModel * self)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(self);
+
+    priv->stamp = g_random_int();
+    priv->fingerprints = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                               g_free, NULL);
+    g_mutex_init(&priv->fingerprintsLock);
+    priv->slots = g_array_new(FALSE, TRUE, sizeof(trg_torrent_slot));
+    priv->rows = g_array_new(FALSE, FALSE, sizeof(guint));
+    priv->strings = trg_string_pool_new();
+    priv->used = trg_bitset_new();
+    priv->visible = trg_bitset_new();
+    priv->trackerIndex =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                              trg_torrent_category_free);
+    priv->dirIndex =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                              trg_torrent_category_free);
+    priv->trigrams =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                              (GDestroyNotify) trg_torrent_model_postings_free);
+
+    g_object_set_data(G_OBJECT(self), PROP_REMOVE_IN_PROGRESS,
+                      GINT_TO_POINTER(FALSE));
+
+    priv->urlHostRegex = trg_uri_host_regex_new();
+}
+
+static void trg_torrent_model_tree_model_init(GtkTreeModelIface * iface)
+{
+    iface->get_flags = trg_torrent_model_get_flags;
+    iface->get_n_columns = trg_torrent_model_get_n_columns;
+    iface->get_column_type = trg_torrent_model_get_column_type;
+    iface->get_iter = trg_torrent_model_get_iter;
+    iface->get_path = trg_torrent_model_get_path;
+    iface->get_value = trg_torrent_model_get_value;
+    iface->iter_next = trg_torrent_model_iter_next;
+    iface->iter_previous = trg_torrent_model_iter_previous;
+    iface->iter_children = trg_torrent_model_iter_children;
+    iface->iter_has_child = trg_torrent_model_iter_has_child;
+    iface->iter_n_children = trg_torrent_model_iter_n_children;
+    iface->iter_nth_child = trg_torrent_model_iter_nth_child;
+    iface->iter_parent = trg_torrent_model_iter_parent;
+}
+
+gboolean trg_torrent_model_is_remove_in_progress(TrgTorrentModel * model)
+{
+    return (gboolean) GPOINTER_TO_INT(g_object_get_data
+                                      (G_OBJECT(model),
+                                       PROP_REMOVE_IN_PROGRESS));
+}
+
+void
+trg_torrent_model_reload_dir_aliases(TrgClient * tc, GtkTreeModel * model)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    guint i;
+
+    for (i = 0; i < priv->rows->len; i++) {
+        guint id = g_array_index(priv->rows, guint, i);
+        trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+        gchar *shortDownloadDir;
+
+        if (!ts->rec.downloadDir)
+            continue;
+
+        shortDownloadDir = shorten_download_dir(tc, ts->rec.downloadDir);
+        if (trg_torrent_model_slot_set_dir(priv, id, shortDownloadDir)) {
+            trg_torrent_model_slot_refilter(priv, id);
+            trg_torrent_model_row_changed(TRG_TORRENT_MODEL(model), id);
+        }
+        g_free(shortDownloadDir);
+    }
+
+    g_signal_emit(model, signals[TMODEL_STATE_CHANGED], 0,
+                  TORRENT_UPDATE_PATH_CHANGE);
+}
+
+static void trg_torrent_model_forget_fingerprints(TrgTorrentModelPrivate *
+                                                  priv)
+{
+    g_mutex_lock(&priv->fingerprintsLock);
+    g_hash_table_remove_all(priv->fingerprints);
+    g_mutex_unlock(&priv->fingerprintsLock);
+}
+
+/* Turn delta sync on or off. What was remembered from before it was last
+ * turned off is out of date by now. */
+void trg_torrent_model_set_delta(TrgTorrentModel * model, gboolean delta)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+
+    if (g_atomic_int_get(&priv->delta) != delta) {
+        trg_torrent_model_forget_fingerprints(priv);
+        g_atomic_int_set(&priv->delta, delta);
+    }
+}
+
+void trg_torrent_model_remove_all(TrgTorrentModel * model)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+
+    trg_torrent_model_forget_fingerprints(priv);
+
+    while (priv->rows->len > 0)
+        trg_torrent_model_delete_row(model,
+                                     g_array_index(priv->rows, guint,
+                                                   priv->rows->len - 1));
+
+    trg_torrent_model_slots_clear(priv);
+}
+
+/* The postings of the term's rarest trigram, or NULL if a term has one
+ * which isn't in any name. Terms shorter than a trigram can't use the index.
+ */
+static GArray *trg_torrent_model_term_postings(TrgTorrentModelPrivate *
+                                               priv, const gchar * term,
+                                               gboolean * none)
+{
+    GArray *best = NULL;
+    const guchar *c;
+
+    for (c = (const guchar *) term; c[0] && c[1] && c[2]; c++) {
+        GArray *postings = g_hash_table_lookup(priv->trigrams,
+                                               GUINT_TO_POINTER
+                                               (TRG_TRIGRAM(c)));
+        if (!postings) {
+            *none = TRUE;
+            return NULL;
+        } else if (!best || postings->len < best->len) {
+            best = postings;
+        }
+    }
+
+    return best;
+}
+
+/* Narrow the visible torrents to those whose names have every term. The
+ * candidates come from the shortest list of IDs for any trigram in the
+ * terms, and are then checked against the names.
+ */
+static void trg_torrent_model_search_names(TrgTorrentModelPrivate * priv)
+{
+    GArray *best = NULL;
+    gboolean none = FALSE;
+    trg_bitset *result;
+    gchar **term;
+    gint id;
+    guint i;
+
+    trg_torrent_model_compact_names(priv);
+
+    for (term = priv->filterTerms; *term && !none; term++) {
+        GArray *postings =
+            trg_torrent_model_term_postings(priv, *term, &none);
+        if (postings && (!best || postings->len < best->len))
+            best = postings;
+    }
+
+    if (none) {
+        trg_bitset_clear(priv->visible);
+        return;
+    }
+
+    result = trg_bitset_new();
+
+    if (best) {
+        for (i = 0; i < best->len; i++) {
+            guint candidate = g_array_index(best, guint, i);
+            if (trg_bitset_get(priv->visible, candidate)
+                && trg_torrent_model_name_matches(trg_torrent_model_slot
+                                                  (priv, candidate),
+                                                  priv->filterTerms))
+                trg_bitset_set(result, candidate, TRUE);
+        }
+    } else {
+        for (id = trg_bitset_next(priv->visible, 0); id >= 0;
+             id = trg_bitset_next(priv->visible, id + 1))
+            if (trg_torrent_model_name_matches(trg_torrent_model_slot
+                                               (priv, id),
+                                               priv->filterTerms))
+                trg_bitset_set(result, id, TRUE);
+    }
 
+    trg_bitset_copy(priv->visible, result);
+    trg_bitset_free(result);
+}
+
+/* Set the filter for trg_torrent_model_is_visible(). The criteria is a state
+ * selector flag, with the name of the tracker or directory for those. The
+ * caller then refilters, which is only a bit test per row.
+ */
+void
+trg_torrent_model_set_filter(TrgTorrentModel * model, guint32 criteria,
+                             GQuark name, const gchar * text)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    trg_torrent_category *cat;
+    guint bit;
+
+    priv->filterFlag = criteria;
+    priv->filterName = name;
+    g_strfreev(priv->filterTerms);
+    priv->filterTerms = NULL;
+
+    if (text && *text) {
+        gchar *folded = g_utf8_casefold(text, -1);
+        priv->filterTerms = g_strsplit(folded, " ", -1);
+        g_free(folded);
+    }
+
+    trg_bitset_clear(priv->visible);
+
+    if (criteria & FILTER_FLAG_TRACKER) {
+        cat = g_hash_table_lookup(priv->trackerIndex,
+                                  GUINT_TO_POINTER(name));
+        if (cat)
+            trg_bitset_copy(priv->visible, cat->members);
+    } else if (criteria & FILTER_FLAG_DIR) {
+        cat = g_hash_table_lookup(priv->dirIndex, GUINT_TO_POINTER(name));
+        if (cat)
+            trg_bitset_copy(priv->visible, cat->members);
+    } else if (criteria != 0) {
+        for (bit = 0; bit < G_N_ELEMENTS(priv->flagCategories); bit++)
+            if ((criteria & (1u << bit)) && priv->flagCategories[bit])
+                trg_bitset_or(priv->visible,
+                              priv->flagCategories[bit]->members);
+    } else {
+        trg_bitset_copy(priv->visible, priv->used);
+    }
+
+    if (priv->filterTerms)
+        trg_torrent_model_search_names(priv);
+}
+
+gboolean trg_torrent_model_is_visible(TrgTorrentModel * model, gint64 id)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return id >= 0 && trg_bitset_get(priv->visible, (guint) id);
+}
+
+GHashTable *trg_torrent_model_get_tracker_index(TrgTorrentModel * model)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return priv->trackerIndex;
+}
+
+GHashTable *trg_torrent_model_get_dir_index(TrgTorrentModel * model)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return priv->dirIndex;
+}
+
+const trg_torrent_record *trg_torrent_model_get_record(TrgTorrentModel *
+                                                      model, gint64 id)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    trg_torrent_slot *ts = trg_torrent_model_lookup(priv, id);
+
+    return ts ? &ts->rec : NULL;
+}
+
+/* The per-file, per-peer and per-tracker arrays from the last response
+ * which asked for a torrent's details, if the one after hasn't dropped them.
+ */
+const trg_torrent_details *trg_torrent_model_get_details(TrgTorrentModel
+                                                         * model,
+                                                         gint64 id)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    trg_torrent_slot *ts = trg_torrent_model_lookup(priv, id);
+
+    return ts ? ts->details : NULL;
+}
+
+gboolean
+trg_torrent_model_get_iter_by_id(TrgTorrentModel * model, gint64 id,
+                                 GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+
+    if (!trg_torrent_model_lookup(priv, id))
+        return FALSE;
+
+    trg_torrent_model_iter_set(priv, iter, (guint) id);
+    return TRUE;
+}
+
+gchar *shorten_download_dir(TrgClient * tc, const gchar * downloadDir)
+{
+    TrgPrefs *prefs = trg_client_get_prefs(tc);
+    JsonArray *labels =
+        trg_prefs_get_array(prefs, TRG_PREFS_KEY_DESTINATIONS,
+                            TRG_PREFS_CONNECTION);
+    JsonObject *session = trg_client_get_session(tc);
+    const gchar *defaultDownloadDir = session_get_download_dir(session);
+    gchar *shortDownloadDir = NULL;
+
+    if (labels) {
+        GList *labelsList = json_array_get_elements(labels);
+        if (labelsList) {
+            GList *li;
+            for (li = labelsList; li; li = g_list_next(li)) {
+                JsonObject *labelObj = json_node_get_object((JsonNode *)
+                                                            li->data);
+                const gchar *labelDir =
+                    json_object_get_string_member(labelObj,
+                                                  TRG_PREFS_KEY_DESTINATIONS_SUBKEY_DIR);
+                if (!g_strcmp0(downloadDir, labelDir)) {
+                    const gchar *labelLabel =
+                        json_object_get_string_member(labelObj,
+                                                      TRG_PREFS_SUBKEY_LABEL);
+                    shortDownloadDir = g_strdup(labelLabel);
+                    break;
+                }
+            }
+            g_list_free(labelsList);
+        }
+    }
+
+    if (shortDownloadDir) {
+        return shortDownloadDir;
+    } else {
+        if (!g_strcmp0(defaultDownloadDir, downloadDir))
+            return g_strdup(_("Default"));
+
+        if (g_str_has_prefix(downloadDir, defaultDownloadDir)) {
+            int offset = strlen(defaultDownloadDir);
+            if (*(downloadDir + offset) == '/')
+                offset++;
+
+            if (offset < strlen(downloadDir))
+                return g_strdup(downloadDir + offset);
+        }
+    }
+
+    return g_strdup(downloadDir);
+}
+
+#define TORRENT_DETAIL_FIELDS \
+    (TORRENT_FIELD_BIT(TORRENT_FIELD_TRACKER_STATS) \
+     | TORRENT_FIELD_BIT(TORRENT_FIELD_FILES) \
+     | TORRENT_FIELD_BIT(TORRENT_FIELD_WANTED) \
+     | TORRENT_FIELD_BIT(TORRENT_FIELD_PRIORITIES) \
+     | TORRENT_FIELD_BIT(TORRENT_FIELD_PEERS))
+
+static void trg_torrent_details_set(JsonArray ** member, JsonArray * array)
+{
+    if (*member)
+        json_array_unref(*member);
+
+    *member = array ? json_array_ref(array) : NULL;
+}
+
+/* The arrays are only kept from a response which asked for this torrent's
+ * details, and only until the next response about it, which asks again if
+ * they're still showing. A list update has tracker stats for every torrent,
+ * but only the hosts and counts are kept from those.
+ */
+static void
+trg_torrent_model_set_details(trg_torrent_slot * ts,
+                              trg_torrent_update * update, gint mode)
+{
+    if (mode != TORRENT_GET_MODE_INTERACTION
+        || !(update->present & TORRENT_DETAIL_FIELDS)) {
+        trg_torrent_model_details_free(ts->details);
+        ts->details = NULL;
+        return;
+    }
+
+    if (!ts->details) {
+        ts->details = g_new0(trg_torrent_details, 1);
+        ts->details->id = ts->rec.id;
+    }
+
+    trg_torrent_details_set(&ts->details->trackerStats,
+                            update->trackerStats);
+    trg_torrent_details_set(&ts->details->files, update->files);
+    trg_torrent_details_set(&ts->details->wanted, update->wanted);
+    trg_torrent_details_set(&ts->details->priorities, update->priorities);
+    trg_torrent_details_set(&ts->details->peers, update->peers);
+}
+
+/* The file count is only known from the files, so keep the one from the
+ * last update which had them.
+ */
+static guint
+trg_torrent_model_file_count(trg_torrent_record * rec,
+                             trg_torrent_update * update)
+{
+    if (update->files)
+        return json_array_get_length(update->files);
+    else if (rec->fileCount > 0)
+        return rec->fileCount;
+    else
+        return rec->metadataPercentComplete >= 1.0 ?
+            TORRENT_FILE_COUNT_UNKNOWN : 0;
+}
+
+/* Merge an update into a torrent's record, and bring its indexes and
+ * derived values up to date. Returns whether the row has changed.
+ */
+static gboolean
+trg_torrent_model_apply(TrgTorrentModel * model, TrgClient * tc,
+                        guint id, trg_torrent_prepared * prep, gint mode,
+                        gboolean added, guint * whatsChanged)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    trg_torrent_slot *ts = trg_torrent_model_slot(priv, id);
+    trg_torrent_record *rec = &ts->rec;
+    guint64 changed =
+        trg_torrent_record_merge(rec, &prep->update, priv->strings);
+    guint lastFlags = rec->flags, newFlags;
+    guint fileCount = trg_torrent_model_file_count(rec, &prep->update);
+
+    if (fileCount != rec->fileCount) {
+        rec->fileCount = fileCount;
+        changed |= TORRENT_FIELD_BIT(TORRENT_FIELD_FILES);
+    }
+
+    trg_torrent_model_set_details(ts, &prep->update, mode);
+
+    if (prep->hasTrackers) {
+        const gchar *trackerHost = rec->trackerHost;
+
+        if (rec->seeders != prep->seeders
+            || rec->leechers != prep->leechers
+            || rec->downloads != prep->downloads)
+            changed |= TORRENT_FIELD_BIT(TORRENT_FIELD_TRACKER_STATS);
+
+        rec->seeders = prep->seeders;
+        rec->leechers = prep->leechers;
+        rec->downloads = prep->downloads;
+        trg_string_pool_set(priv->strings, &rec->trackerHost,
+                            prep->firstTrackerHost ?
+                            prep->firstTrackerHost : "");
+
+        if (rec->trackerHost != trackerHost)
+            changed |= TORRENT_FIELD_BIT(TORRENT_FIELD_TRACKER_STATS);
+
+        if (trg_torrent_model_index_trackers(priv, id, prep))
+            *whatsChanged |= TORRENT_UPDATE_TRACKER_CHANGE;
+    }
+
+    if ((changed & TORRENT_FIELD_BIT(TORRENT_FIELD_DOWNLOAD_DIR))
+        && rec->downloadDir) {
+        gchar *shortDownloadDir =
+            shorten_download_dir(tc, rec->downloadDir);
+        trg_torrent_model_slot_set_dir(priv, id, shortDownloadDir);
+        g_free(shortDownloadDir);
+        *whatsChanged |= TORRENT_UPDATE_PATH_CHANGE;
+    }
+
+    if (changed & TORRENT_FIELD_BIT(TORRENT_FIELD_NAME)) {
+        trg_torrent_model_slot_set_name(priv, id, prep->nameKey);
+        prep->nameKey = NULL;
+    }
+
+    /* The filter bit has to be right before the row changes. */
+    newFlags = trg_torrent_record_get_flags(rec, priv->rpcv);
+    trg_torrent_model_slot_set_flags(priv, id, newFlags);
+    trg_torrent_model_slot_refilter(priv, id);
+
+    if (added)
+        lastFlags = newFlags;
+    else if (lastFlags != newFlags)
+        *whatsChanged |= TORRENT_UPDATE_STATE_CHANGE;
+
+    if ((lastFlags & TORRENT_FLAG_DOWNLOADING)
+        && (!(newFlags & TORRENT_FLAG_DOWNLOADING))
+        && (newFlags & TORRENT_FLAG_COMPLETE)) {
+        GtkTreeIter iter;
+
+        trg_torrent_model_iter_set(priv, &iter, id);
+        g_signal_emit(model, signals[TMODEL_TORRENT_COMPLETED], 0, &iter);
+    }
+
+    return changed != 0 || lastFlags != newFlags;
+}
+
+TrgTorrentModel *trg_torrent_model_new(void)
+{
+    return g_object_new(TRG_TYPE_TORRENT_MODEL, NULL);
+}
+
+/* A full update lists every torrent, so any which weren't in it have been
+ * removed. Records aren't written to just to mark them as seen, that would
+ * mean touching every one on every update.
+ */
+static GArray *trg_torrent_model_find_removed(TrgTorrentModelPrivate *
+                                              priv, trg_bitset * seen,
+                                              guint n_seen)
+{
+    GArray *toRemove;
+    guint i;
+
+    /* Everything seen has a row, so if there are as many nothing's gone. */
+    if (n_seen == priv->rows->len)
+        return NULL;
+
+    toRemove = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    for (i = 0; i < priv->rows->len; i++) {
+        guint id = g_array_index(priv->rows, guint, i);
+        if (!trg_bitset_get(seen, id))
+            g_array_append_val(toRemove, id);
+    }
+
+    return toRemove;
+}
+
+trg_torrent_model_update_stats *trg_torrent_model_update(TrgTorrentModel *
+                                                         model,
+                                                         TrgClient * tc,
+                                                         JsonObject *
+                                                         response,
+                                                         gpointer prepared,
+                                                         gint mode)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    GPtrArray *preps = (GPtrArray *) prepared;
+    JsonObject *args = get_arguments(response);
+    JsonArray *torrents = get_torrents(args);
+    JsonArray *removedTorrents;
+    trg_bitset *seen = NULL;
+    guint n_seen = 0;
+    guint whatsChanged = 0;
+    gint64 downRateTotal, upRateTotal;
+    GtkTreeIter iter;
+    guint i;
+
+    priv->rpcv = trg_client_get_rpc_version(tc);
+
+    /* Not prepared on the worker, so do it here. */
+    if (!preps && torrents)
+        preps = trg_torrent_model_prepare_torrents(priv, torrents);
+    else if (preps)
+        g_ptr_array_ref(preps);
+
+    downRateTotal = priv->stats.downRateTotal;
+    upRateTotal = priv->stats.upRateTotal;
     priv->stats.downRateTotal = 0;
     priv->stats.upRateTotal = 0;
+    priv->stats.changed = 0;
 
-    for (li = torrentList; li; li = g_list_next(li)) {
-        t = json_node_get_object((JsonNode *) li->data);
-        id = torrent_get_id(t);
+    if (mode == TORRENT_GET_MODE_UPDATE)
+        seen = trg_bitset_new();
 
-        result =
-            mode == TORRENT_GET_MODE_FIRST ? NULL :
-            g_hash_table_lookup(priv->ht, &id);
+    for (i = 0; preps && i < preps->len; i++) {
+        trg_torrent_prepared *prep = g_ptr_array_index(preps, i);
+        gint64 id = prep->update.rec.id;
+        trg_torrent_slot *ts;
 
-        if (!result) {
-            gint64 *idCopy;
-            gtk_list_store_append(GTK_LIST_STORE(model), &iter);
-            whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
+        if (id < 0 || id > G_MAXINT32)
+            continue;
 
-            update_torrent_iter(model, tc, rpcv, serial,
-                                &iter, t, &(priv->stats), &whatsChanged);
+        ts = trg_torrent_model_lookup(priv, id);
 
-            path = gtk_tree_model_get_path(GTK_TREE_MODEL(model), &iter);
-            rr = gtk_tree_row_reference_new(GTK_TREE_MODEL(model), path);
-            idCopy = g_new(gint64, 1);
-            *idCopy = id;
-            g_hash_table_insert(priv->ht, idCopy, rr);
-            gtk_tree_path_free(path);
+        if (ts && mode == TORRENT_GET_MODE_FIRST) {
+            trg_torrent_model_remove_torrent(model, id);
+            ts = NULL;
+        }
+
+        if (!ts) {
+            if (prep->unchanged) {
+                /* Only the ID was decoded, and there's nothing to compare
+                 * it with now. Left for the next update. */
+                trg_torrent_model_commit_fingerprint(priv, prep,
+                                                     TORRENT_GET_MODE_INTERACTION);
+                continue;
+            }
+
+            ts = trg_torrent_model_slot_new(priv, (guint) id);
+            trg_torrent_model_apply(model, tc, (guint) id, prep, mode,
+                                    TRUE, &whatsChanged);
+            trg_torrent_model_commit_fingerprint(priv, prep, mode);
+            trg_torrent_model_insert_row(model, (guint) id, &iter);
+            whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
+            priv->stats.changed++;
 
             if (mode != TORRENT_GET_MODE_FIRST)
                 g_signal_emit(model, signals[TMODEL_TORRENT_ADDED], 0,
                               &iter);
-        } else {
-            path = gtk_tree_row_reference_get_path((GtkTreeRowReference *)
-                                                   result);
-            if (path) {
-                if (gtk_tree_model_get_iter(GTK_TREE_MODEL(model), &iter,
-                                            path)) {
-                    update_torrent_iter(model, tc, rpcv,
-                                        serial, &iter,
-                                        t, &(priv->stats), &whatsChanged);
-                }
-                gtk_tree_path_free(path);
+        } else if (prep->unchanged
+                   && trg_torrent_model_fingerprint_matches(priv, id,
+                                                            prep->
+                                                            fingerprint)) {
+            /* Delta sync, and its record is already just like this. */
+        } else if (!prep->unchanged) {
+            if (trg_torrent_model_apply(model, tc, (guint) id, prep, mode,
+                                        FALSE, &whatsChanged)) {
+                trg_torrent_model_row_changed(model, (guint) id);
+                priv->stats.changed++;
             }
+            trg_torrent_model_commit_fingerprint(priv, prep, mode);
+        }
+
+        ts = trg_torrent_model_slot(priv, (guint) id);
+        priv->stats.downRateTotal += ts->rec.rateDownload;
+        priv->stats.upRateTotal += ts->rec.rateUpload;
+
+        if (seen && !trg_bitset_get(seen, (guint) id)) {
+            trg_bitset_set(seen, (guint) id, TRUE);
+            n_seen++;
         }
     }
 
-    g_list_free(torrentList);
+    if (preps)
+        g_ptr_array_unref(preps);
+
+    /* An interactive or selected torrent response only covers some torrents,
+     * so keep the session totals from the last list update.
+     */
+    if (mode == TORRENT_GET_MODE_INTERACTION) {
+        priv->stats.downRateTotal = downRateTotal;
+        priv->stats.upRateTotal = upRateTotal;
+    }
 
     if (mode == TORRENT_GET_MODE_UPDATE) {
-        GList *hitlist =
-            trg_torrent_model_find_removed(GTK_TREE_MODEL(model), serial);
+        GArray *hitlist =
+            trg_torrent_model_find_removed(priv, seen, n_seen);
+        trg_bitset_free(seen);
         if (hitlist) {
-            for (li = hitlist; li; li = g_list_next(li)) {
-                g_hash_table_remove(priv->ht, li->data);
-                g_free(li->data);
-            }
-            whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
-            g_list_free(hitlist);
+            for (i = 0; i < hitlist->len; i++)
+                trg_torrent_model_remove_torrent(model,
+                                                 g_array_index(hitlist,
+                                                               guint, i));
+            if (hitlist->len > 0)
+                whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
+            g_array_free(hitlist, TRUE);
         }
     } else if (mode > TORRENT_GET_MODE_FIRST) {
         removedTorrents = get_torrents_removed(args);
         if (removedTorrents) {
-            GList *hitlist = json_array_get_elements(removedTorrents);
-            for (li = hitlist; li; li = g_list_next(li)) {
-                id = json_node_get_int((JsonNode *) li->data);
-                g_hash_table_remove(priv->ht, &id);
+            guint n = json_array_get_length(removedTorrents);
+            for (i = 0; i < n; i++) {
+                trg_torrent_model_remove_torrent(model,
+                                                 json_array_get_int_element
+                                                 (removedTorrents, i));
                 whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
             }
-            g_list_free(hitlist);
         }
     }
 
-    if (whatsChanged != 0) {
-        if ((whatsChanged & TORRENT_UPDATE_ADDREMOVE)
-            || (whatsChanged & TORRENT_UPDATE_STATE_CHANGE)) {
-            trg_torrent_model_stat_counts_clear(&priv->stats);
-            gtk_tree_model_foreach(GTK_TREE_MODEL(model),
-                                   trg_torrent_model_stats_scan_foreachfunc,
-                                   &(priv->stats));
-        }
+    trg_torrent_model_compact_names(priv);
+
+    if (whatsChanged != 0)
         g_signal_emit(model, signals[TMODEL_STATE_CHANGED], 0,
                       whatsChanged);
-    }
 
     g_signal_emit(model, signals[TMODEL_UPDATE], 0);
 
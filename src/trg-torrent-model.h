@@ -24,6 +24,8 @@
 #include <json-glib/json-glib.h>
 
 #include "trg-client.h"
+#include "bitset.h"
+#include "torrent-record.h"
 
 G_BEGIN_DECLS
 #define TRG_TYPE_TORRENT_MODEL trg_torrent_model_get_type()
@@ -38,11 +40,11 @@ G_BEGIN_DECLS
 #define TRG_TORRENT_MODEL_GET_CLASS(obj) \
   (G_TYPE_INSTANCE_GET_CLASS ((obj), TRG_TYPE_TORRENT_MODEL, TrgTorrentModelClass))
     typedef struct {
-    GtkListStore parent;
+    GObject parent;
 } TrgTorrentModel;
 
 typedef struct {
-    GtkListStoreClass parent_class;
+    GObjectClass parent_class;
     void (*torrent_completed) (TrgTorrentModel * model,
                                GtkTreeIter * iter, gpointer data);
     void (*update) (TrgTorrentModel * model, gpointer data);
@@ -66,37 +68,57 @@ typedef struct {
     gint active;
     gint seed_wait;
     gint down_wait;
+    gint changed;               /* rows changed by the last update */
 } trg_torrent_model_update_stats;
 
 #define TORRENT_UPDATE_STATE_CHANGE        (1 << 0)
 #define TORRENT_UPDATE_PATH_CHANGE         (1 << 1)
 #define TORRENT_UPDATE_ADDREMOVE           (1 << 2)
+#define TORRENT_UPDATE_TRACKER_CHANGE      (1 << 3)
+
+/* The torrents in a state, directory or tracker, by their ID. */
+typedef struct {
+    trg_bitset *members;
+    gint count;
+} trg_torrent_category;
 
 GType trg_torrent_model_get_type(void);
 
 TrgTorrentModel *trg_torrent_model_new(void);
 
 G_END_DECLS
-    gboolean
-find_existing_peer_item(GtkListStore * model, JsonObject * p,
-                        GtkTreeIter * iter);
-
 trg_torrent_model_update_stats *trg_torrent_model_update(TrgTorrentModel *
                                                          model,
                                                          TrgClient * tc,
                                                          JsonObject *
                                                          response,
+                                                         gpointer prepared,
                                                          gint mode);
+void trg_torrent_model_prepare(TrgClient * tc, trg_response * response,
+                               trg_torrent_update * update,
+                               guint64 fingerprint, gpointer data);
+void trg_torrent_model_set_delta(TrgTorrentModel * model, gboolean delta);
 trg_torrent_model_update_stats *trg_torrent_model_get_stats(TrgTorrentModel
                                                             * model);
 
-GHashTable *get_torrent_table(TrgTorrentModel * model);
 void trg_torrent_model_remove_all(TrgTorrentModel * model);
 
 gboolean trg_torrent_model_is_remove_in_progress(TrgTorrentModel * model);
 
-gboolean get_torrent_data(GHashTable * table, gint64 id, JsonObject ** t,
-                          GtkTreeIter * out_iter);
+void trg_torrent_model_set_filter(TrgTorrentModel * model,
+                                  guint32 criteria, GQuark name,
+                                  const gchar * text);
+gboolean trg_torrent_model_is_visible(TrgTorrentModel * model, gint64 id);
+GHashTable *trg_torrent_model_get_tracker_index(TrgTorrentModel * model);
+GHashTable *trg_torrent_model_get_dir_index(TrgTorrentModel * model);
+
+const trg_torrent_record *trg_torrent_model_get_record(TrgTorrentModel *
+                                                      model, gint64 id);
+const trg_torrent_details *trg_torrent_model_get_details(TrgTorrentModel
+                                                         * model,
+                                                         gint64 id);
+gboolean trg_torrent_model_get_iter_by_id(TrgTorrentModel * model,
+                                          gint64 id, GtkTreeIter * iter);
 
 gchar *shorten_download_dir(TrgClient * tc, const gchar * downloadDir);
 void trg_torrent_model_reload_dir_aliases(TrgClient * tc,
@@ -127,8 +149,7 @@ enum {
     TORRENT_COLUMN_RATIO,
     TORRENT_COLUMN_ADDED,
     TORRENT_COLUMN_ID,
-    TORRENT_COLUMN_JSON,
-    TORRENT_COLUMN_UPDATESERIAL,
+    TORRENT_COLUMN_RECORD,
     TORRENT_COLUMN_FLAGS,
     TORRENT_COLUMN_DOWNLOADDIR,
     TORRENT_COLUMN_DOWNLOADDIR_SHORT,
@@ -156,14 +156,14 @@ static GObject *trg_torrent_move_dialog_constructor(GType type,
     priv->ids = build_json_id_array(priv->treeview);
 
     if (count == 1) {
-        JsonObject *json;
-        const gchar *name;
-
-        get_torrent_data(trg_client_get_torrent_table(priv->client),
-                         trg_mw_get_selected_torrent_id(priv->win), &json,
-                         NULL);
-        name = torrent_get_name(json);
-        msg = g_strdup_printf(_("Move %s"), name);
+        const trg_torrent_record *rec =
+            trg_torrent_model_get_record(TRG_TORRENT_MODEL
+                                         (trg_client_get_torrent_model
+                                          (priv->client)),
+                                         trg_mw_get_selected_torrent_id
+                                         (priv->win));
+
+        msg = g_strdup_printf(_("Move %s"), rec ? rec->name : "");
     } else {
         msg = g_strdup_printf(_("Move %d torrents"), count);
     }
@@ -63,6 +63,11 @@ enum {
     PROP_CLIENT
 };
 
+/* The detail pages, in the order they're added. */
+enum {
+    PAGE_INFORMATION, PAGE_FILES, PAGE_PEERS, PAGE_TRACKERS
+};
+
 #define GET_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_TORRENT_PROPS_DIALOG, TrgTorrentPropsDialogPrivate))
 typedef struct _TrgTorrentPropsDialogPrivate TrgTorrentPropsDialogPrivate;
@@ -84,7 +89,6 @@ struct _TrgTorrentPropsDialogPrivate {
     TrgTrackersModel *trackersModel;
     TrgFilesTreeView *filesTv;
     TrgFilesModel *filesModel;
-    JsonObject *lastJson;
 
     GtkWidget *size_lb;
     GtkWidget *have_lb;
@@ -100,6 +104,7 @@ struct _TrgTorrentPropsDialogPrivate {
     GtkWidget *privacy_lb;
     GtkWidget *origin_lb;
     GtkTextBuffer *comment_buffer;
+    GtkWidget *notebook;
     gboolean show_details;
 };
 
@@ -295,33 +300,20 @@ static GtkWidget *info_page_new(TrgTorrentPropsDialog * dialog)
 }
 
 static void info_page_update(TrgTorrentPropsDialog * dialog,
-                             JsonObject * t,
+                             const trg_torrent_record * rec,
                              TrgTorrentModel * torrentModel,
                              GtkTreeIter * iter)
 {
     TrgTorrentPropsDialogPrivate *priv = GET_PRIVATE(dialog);
-    GtkTreeModel *model = GTK_TREE_MODEL(torrentModel);
-    gint64 sizeWhenDone, haveValid, downloaded, uploaded, percentDone, eta,
-        activityDate, error;
     gchar *statusString;
-    guint flags;
     const gchar *str;
 
     char buf[512];
 
-    gtk_tree_model_get(model, iter,
-                       TORRENT_COLUMN_SIZEWHENDONE, &sizeWhenDone,
-                       TORRENT_COLUMN_UPLOADED, &uploaded,
-                       TORRENT_COLUMN_DOWNLOADED, &downloaded,
-                       TORRENT_COLUMN_HAVE_VALID, &haveValid,
-                       TORRENT_COLUMN_PERCENTDONE, &percentDone,
-                       TORRENT_COLUMN_ETA, &eta,
-                       TORRENT_COLUMN_LASTACTIVE, &activityDate,
-                       TORRENT_COLUMN_STATUS, &statusString,
-                       TORRENT_COLUMN_FLAGS, &flags,
-                       TORRENT_COLUMN_ERROR, &error, -1);
-
-    if (torrent_get_is_private(t))
+    gtk_tree_model_get(GTK_TREE_MODEL(torrentModel), iter,
+                       TORRENT_COLUMN_STATUS, &statusString, -1);
+
+    if (rec->isPrivate)
         str = _("Private to this tracker -- DHT and PEX disabled");
     else
         str = _("Public torrent");
@@ -329,8 +321,8 @@ static void info_page_update(TrgTorrentPropsDialog * dialog,
     gtk_label_set_text(GTK_LABEL(priv->privacy_lb), str);
 
     {
-        const gchar *creator = torrent_get_creator(t);
-        gint64 dateCreated = torrent_get_date_created(t);
+        const gchar *creator = rec->creator;
+        gint64 dateCreated = rec->dateCreated;
         gchar *dateStr = epoch_to_string(dateCreated);
 
         if (creator && strlen(creator) > 0 && dateCreated > 0)
@@ -347,59 +339,90 @@ static void info_page_update(TrgTorrentPropsDialog * dialog,
         gtk_label_set_text(GTK_LABEL(priv->origin_lb), buf);
     }
 
-    gtk_text_buffer_set_text(priv->comment_buffer, torrent_get_comment(t),
-                             -1);
-    gtk_label_set_text(GTK_LABEL(priv->destination_lb),
-                       torrent_get_download_dir(t));
+    gtk_text_buffer_set_text(priv->comment_buffer,
+                             rec->comment ? rec->comment : "", -1);
+    gtk_label_set_text(GTK_LABEL(priv->destination_lb), rec->downloadDir);
 
     gtk_label_set_text(GTK_LABEL(priv->state_lb), statusString);
     g_free(statusString);
 
     {
-        gchar *addedStr = epoch_to_string(torrent_get_added_date(t));
+        gchar *addedStr = epoch_to_string(rec->addedDate);
         gtk_label_set_text(GTK_LABEL(priv->date_started_lb), addedStr);
         g_free(addedStr);
     }
 
     /* eta */
 
-    if (eta > 0) {
-        tr_strltime_long(buf, eta, sizeof(buf));
+    if (rec->eta > 0) {
+        tr_strltime_long(buf, rec->eta, sizeof(buf));
         gtk_label_set_text(GTK_LABEL(priv->eta_lb), buf);
     } else {
         gtk_label_set_text(GTK_LABEL(priv->eta_lb), "");
     }
 
-    gtk_label_set_text(GTK_LABEL(priv->hash_lb), torrent_get_hash(t));
+    gtk_label_set_text(GTK_LABEL(priv->hash_lb), rec->hashString);
     gtk_label_set_text(GTK_LABEL(priv->error_lb),
-                       error ? torrent_get_errorstr(t) : _("No errors"));
+                       rec->error ? rec->errorString : _("No errors"));
 
-    if (flags & TORRENT_FLAG_ACTIVE) {
+    if (rec->flags & TORRENT_FLAG_ACTIVE) {
         gtk_label_set_text(GTK_LABEL(priv->last_activity_lb),
                            _("Active now"));
     } else {
-        gchar *activityStr = epoch_to_string(activityDate);
+        gchar *activityStr = epoch_to_string(rec->activityDate);
         gtk_label_set_text(GTK_LABEL(priv->last_activity_lb), activityStr);
         g_free(activityStr);
     }
 
-    tr_strlsize(buf, sizeWhenDone, sizeof(buf));
+    tr_strlsize(buf, rec->sizeWhenDone, sizeof(buf));
     gtk_label_set_text(GTK_LABEL(priv->size_lb), buf);
 
-    tr_strlsize(buf, downloaded, sizeof(buf));
+    tr_strlsize(buf, rec->downloadedEver, sizeof(buf));
     gtk_label_set_text(GTK_LABEL(priv->dl_lb), buf);
 
-    tr_strlsize(buf, uploaded, sizeof(buf));
+    tr_strlsize(buf, rec->uploadedEver, sizeof(buf));
     gtk_label_set_text(GTK_LABEL(priv->ul_lb), buf);
 
-    tr_strlsize(buf, haveValid, sizeof(buf));
+    tr_strlsize(buf, rec->haveValid, sizeof(buf));
     gtk_label_set_text(GTK_LABEL(priv->have_lb), buf);
 }
 
+/* The limits as the JSON widgets want them, from the selected record. */
+static JsonObject *trg_props_limits_json(const trg_torrent_record * rec)
+{
+    JsonObject *json = json_object_new();
+
+    if (!rec)
+        return json;
+
+    json_object_set_boolean_member(json, FIELD_HONORS_SESSION_LIMITS,
+                                   rec->honorsSessionLimits);
+    json_object_set_int_member(json, FIELD_BANDWIDTH_PRIORITY,
+                               rec->bandwidthPriority);
+    if (rec->fetched & TORRENT_FIELD_BIT(TORRENT_FIELD_QUEUE_POSITION))
+        json_object_set_int_member(json, FIELD_QUEUE_POSITION,
+                                   rec->queuePosition);
+    json_object_set_boolean_member(json, FIELD_DOWNLOAD_LIMITED,
+                                   rec->downloadLimited);
+    json_object_set_int_member(json, FIELD_DOWNLOAD_LIMIT,
+                               rec->downloadLimit);
+    json_object_set_boolean_member(json, FIELD_UPLOAD_LIMITED,
+                                   rec->uploadLimited);
+    json_object_set_int_member(json, FIELD_UPLOAD_LIMIT, rec->uploadLimit);
+    json_object_set_int_member(json, FIELD_SEED_RATIO_MODE,
+                               rec->seedRatioMode);
+    json_object_set_double_member(json, FIELD_SEED_RATIO_LIMIT,
+                                  rec->seedRatioLimit);
+    json_object_set_int_member(json, FIELD_PEER_LIMIT, rec->peerLimit);
+
+    return json;
+}
+
 static GtkWidget *trg_props_limits_page_new(TrgTorrentPropsDialog * win,
-                                            JsonObject * json)
+                                            const trg_torrent_record * rec)
 {
     TrgTorrentPropsDialogPrivate *priv = GET_PRIVATE(win);
+    JsonObject *json = trg_props_limits_json(rec);
     GtkWidget *w, *tb, *t;
     guint row = 0;
 
@@ -417,7 +440,7 @@ static GtkWidget *trg_props_limits_page_new(TrgTorrentPropsDialog * win,
                                                               1, _("High"),
                                                               2, NULL);
     gtk_combo_box_set_active(GTK_COMBO_BOX(w),
-                             torrent_get_bandwidth_priority(json) + 1);
+                             rec ? rec->bandwidthPriority + 1 : 1);
 
     hig_workarea_add_row(t, &row, _("Torrent priority:"), w, NULL);
 
@@ -450,7 +473,7 @@ static GtkWidget *trg_props_limits_page_new(TrgTorrentPropsDialog * win,
                                _("Stop seeding at ratio"), 1,
                                _("Seed regardless of ratio"), 2, NULL);
     gtk_combo_box_set_active(GTK_COMBO_BOX(w),
-                             torrent_get_seed_ratio_mode(json));
+                             rec ? rec->seedRatioMode : 0);
     hig_workarea_add_row(t, &row, _("Seed ratio mode:"), w, NULL);
 
     w = trg_json_widget_spin_double_new(&priv->widgets, json,
@@ -467,39 +490,56 @@ static GtkWidget *trg_props_limits_page_new(TrgTorrentPropsDialog * win,
                                      NULL, 0, INT_MAX, 5);
     hig_workarea_add_row(t, &row, _("Peer limit:"), w, w);
 
+    json_object_unref(json);
+
     return t;
 }
 
 static void models_updated(TrgTorrentModel * model, gpointer data)
 {
     TrgTorrentPropsDialogPrivate *priv = GET_PRIVATE(data);
-    GHashTable *ht = get_torrent_table(model);
     gint64 serial = trg_client_get_serial(priv->client);
-    JsonObject *t = NULL;
+    gint64 id = json_array_get_int_element(priv->targetIds, 0);
+    const trg_torrent_record *rec = trg_torrent_model_get_record(model, id);
+    const trg_torrent_details *details =
+        trg_torrent_model_get_details(model, id);
+    gboolean exists = rec != NULL;
     GtkTreeIter iter;
-    gboolean exists = get_torrent_data(ht,
-                                       json_array_get_int_element(priv->
-                                                                  targetIds,
-                                                                  0), &t,
-                                       &iter);
-
-    if (exists && priv->lastJson != t) {
-        trg_files_model_update(priv->filesModel,
-                               GTK_TREE_VIEW(priv->filesTv), serial, t,
-                               TORRENT_GET_MODE_UPDATE);
-        trg_peers_model_update(priv->peersModel,
-                               TRG_TREE_VIEW(priv->peersTv), serial, t,
-                               TORRENT_GET_MODE_UPDATE);
-        trg_trackers_model_update(priv->trackersModel, serial, t,
-                                  TORRENT_GET_MODE_UPDATE);
-        info_page_update(TRG_TORRENT_PROPS_DIALOG(data), t, model, &iter);
+
+    /* Only the showing page's field set is fetched. */
+    if (details) {
+        if (details->files)
+            trg_files_model_update(priv->filesModel,
+                                   GTK_TREE_VIEW(priv->filesTv), serial,
+                                   details, TORRENT_GET_MODE_UPDATE);
+        if (details->peers)
+            trg_peers_model_update(priv->peersModel,
+                                   TRG_TREE_VIEW(priv->peersTv), serial,
+                                   details, TORRENT_GET_MODE_UPDATE);
+        if (details->trackerStats)
+            trg_trackers_model_update(priv->trackersModel, serial,
+                                      details, TORRENT_GET_MODE_UPDATE);
     }
 
+    if (exists && (rec->fetched & TORRENT_FIELD_BIT(TORRENT_FIELD_COMMENT))
+        && trg_torrent_model_get_iter_by_id(model, id, &iter))
+        info_page_update(TRG_TORRENT_PROPS_DIALOG(data), rec, model,
+                         &iter);
+
     gtk_widget_set_sensitive(GTK_WIDGET(priv->filesTv), exists);
     gtk_widget_set_sensitive(GTK_WIDGET(priv->trackersTv), exists);
     gtk_widget_set_sensitive(GTK_WIDGET(priv->peersTv), exists);
+}
+
+/* Fetch what the new page needs now, rather than on the next update. */
+static void
+props_page_switched_cb(GtkNotebook * notebook G_GNUC_UNUSED,
+                       GtkWidget * page G_GNUC_UNUSED,
+                       guint page_num G_GNUC_UNUSED, gpointer data)
+{
+    TrgTorrentPropsDialogPrivate *priv = GET_PRIVATE(data);
 
-    priv->lastJson = t;
+    trg_main_window_get_selected_details(priv->parent);
 }
 
 static GObject *trg_torrent_props_dialog_constructor(GType type,
@@ -527,13 +567,14 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
 
     gint64 width, height;
 
-    JsonObject *json;
+    gint64 id = trg_mw_get_selected_torrent_id(priv->parent);
+    const trg_torrent_record *rec =
+        trg_torrent_model_get_record(priv->torrentModel, id);
+    const trg_torrent_details *details =
+        trg_torrent_model_get_details(priv->torrentModel, id);
     GtkTreeIter iter;
     GtkWidget *notebook, *contentvbox;
 
-    get_torrent_data(trg_client_get_torrent_table(priv->client),
-                     trg_mw_get_selected_torrent_id(priv->parent), &json,
-                     &iter);
     priv->targetIds = build_json_id_array(priv->tv);
 
     if (rowCount > 1) {
@@ -542,8 +583,8 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
                             rowCount);
         gtk_window_set_title(window, windowTitle);
         g_free(windowTitle);
-    } else if (rowCount == 1) {
-        gtk_window_set_title(window, torrent_get_name(json));
+    } else if (rowCount == 1 && rec) {
+        gtk_window_set_title(window, rec->name);
     }
 
     gtk_window_set_transient_for(window, GTK_WINDOW(priv->parent));
@@ -561,7 +602,7 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
     g_signal_connect(G_OBJECT(object), "response",
                      G_CALLBACK(trg_torrent_props_response_cb), NULL);
 
-    notebook = gtk_notebook_new();
+    notebook = priv->notebook = gtk_notebook_new();
 
     if (priv->show_details) {
         gint64 serial = trg_client_get_serial(priv->client);
@@ -571,7 +612,10 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
         gtk_notebook_append_page(GTK_NOTEBOOK(notebook),
                                  info_page_new(propsDialog),
                                  gtk_label_new(_("Information")));
-        info_page_update(propsDialog, json, priv->torrentModel, &iter);
+        if (rec && (rec->fetched & TORRENT_FIELD_BIT(TORRENT_FIELD_COMMENT))
+            && trg_torrent_model_get_iter_by_id(priv->torrentModel, id,
+                                                &iter))
+            info_page_update(propsDialog, rec, priv->torrentModel, &iter);
 
         /* Files */
 
@@ -580,9 +624,10 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
             trg_files_tree_view_new(priv->filesModel, priv->parent,
                                     priv->client,
                                     "TrgFilesTreeView-dialog");
-        trg_files_model_update(priv->filesModel,
-                               GTK_TREE_VIEW(priv->filesTv), serial, json,
-                               TORRENT_GET_MODE_FIRST);
+        if (details && details->files)
+            trg_files_model_update(priv->filesModel,
+                                   GTK_TREE_VIEW(priv->filesTv), serial,
+                                   details, TORRENT_GET_MODE_FIRST);
         gtk_widget_set_sensitive(GTK_WIDGET(priv->filesTv), TRUE);
         gtk_notebook_append_page(GTK_NOTEBOOK(notebook),
                                  my_scrolledwin_new(GTK_WIDGET
@@ -594,9 +639,10 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
         priv->peersModel = trg_peers_model_new();
         priv->peersTv = trg_peers_tree_view_new(prefs, priv->peersModel,
                                                 "TrgPeersTreeView-dialog");
-        trg_peers_model_update(priv->peersModel,
-                               TRG_TREE_VIEW(priv->peersTv), serial, json,
-                               TORRENT_GET_MODE_FIRST);
+        if (details && details->peers)
+            trg_peers_model_update(priv->peersModel,
+                                   TRG_TREE_VIEW(priv->peersTv), serial,
+                                   details, TORRENT_GET_MODE_FIRST);
         gtk_widget_set_sensitive(GTK_WIDGET(priv->peersTv), TRUE);
         gtk_notebook_append_page(GTK_NOTEBOOK(notebook),
                                  my_scrolledwin_new(GTK_WIDGET
@@ -612,8 +658,9 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
                                                       "TrgTrackersTreeView-dialog");
         trg_trackers_tree_view_new_connection(priv->trackersTv,
                                               priv->client);
-        trg_trackers_model_update(priv->trackersModel, serial, json,
-                                  TORRENT_GET_MODE_FIRST);
+        if (details && details->trackerStats)
+            trg_trackers_model_update(priv->trackersModel, serial, details,
+                                      TORRENT_GET_MODE_FIRST);
         gtk_widget_set_sensitive(GTK_WIDGET(priv->trackersTv), TRUE);
         gtk_notebook_append_page(GTK_NOTEBOOK(notebook),
                                  my_scrolledwin_new(GTK_WIDGET
@@ -626,12 +673,12 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
 
         g_signal_connect_object(priv->torrentModel, "update", G_CALLBACK
                                 (models_updated), object, G_CONNECT_AFTER);
-
-        priv->lastJson = json;
+        g_signal_connect_after(notebook, "switch-page",
+                               G_CALLBACK(props_page_switched_cb), object);
     }
 
     gtk_notebook_append_page(GTK_NOTEBOOK(notebook),
-                             trg_props_limits_page_new(propsDialog, json),
+                             trg_props_limits_page_new(propsDialog, rec),
                              gtk_label_new(_("Limits")));
 
     gtk_container_set_border_width(GTK_CONTAINER(notebook), GUI_PAD);
@@ -730,6 +777,40 @@ static void trg_torrent_props_dialog_init(TrgTorrentPropsDialog *
 {
 }
 
+/* The torrent whose details the dialog shows, or -1 if it has no detail
+ * pages. */
+gint64 trg_torrent_props_dialog_get_details_id(TrgTorrentPropsDialog *
+                                               dialog)
+{
+    TrgTorrentPropsDialogPrivate *priv = GET_PRIVATE(dialog);
+
+    return priv->show_details ?
+        json_array_get_int_element(priv->targetIds, 0) : -1;
+}
+
+/* The torrent-get field sets which the showing page needs. */
+guint trg_torrent_props_dialog_get_field_sets(TrgTorrentPropsDialog *
+                                              dialog)
+{
+    TrgTorrentPropsDialogPrivate *priv = GET_PRIVATE(dialog);
+
+    if (!priv->show_details)
+        return 0;
+
+    switch (gtk_notebook_get_current_page(GTK_NOTEBOOK(priv->notebook))) {
+    case PAGE_INFORMATION:
+        return TORRENT_GET_FIELDS_DETAIL;
+    case PAGE_FILES:
+        return TORRENT_GET_FIELDS_FILES;
+    case PAGE_PEERS:
+        return TORRENT_GET_FIELDS_PEERS;
+    case PAGE_TRACKERS:
+        return TORRENT_GET_FIELDS_TRACKERSTATS;
+    default:
+        return 0;
+    }
+}
+
 TrgTorrentPropsDialog *trg_torrent_props_dialog_new(GtkWindow * window,
                                                     TrgTorrentTreeView *
                                                     treeview,
@@ -53,6 +53,10 @@ TrgTorrentPropsDialog *trg_torrent_props_dialog_new(GtkWindow * window,
                                                     TrgTorrentModel *
                                                     torrentModel,
                                                     TrgClient * client);
+gint64 trg_torrent_props_dialog_get_details_id(TrgTorrentPropsDialog *
+                                               dialog);
+guint trg_torrent_props_dialog_get_field_sets(TrgTorrentPropsDialog *
+                                              dialog);
 
 G_END_DECLS
 #endif                          /* TRG_TORRENT_PROPS_DIALOG_H_ */
@@ -25,6 +25,7 @@
 #include <gtk/gtk.h>
 
 #include "trg-prefs.h"
+#include "requests.h"
 #include "trg-tree-view.h"
 #include "trg-torrent-model.h"
 #include "torrent-cell-renderer.h"
@@ -189,6 +190,66 @@ JsonArray *build_json_id_array(TrgTorrentTreeView * tv)
     return ids;
 }
 
+/* The optional torrent-get field sets which fill each model column. Columns
+ * not listed are filled from the list field set, which is always requested.
+ */
+static const struct {
+    gint column;
+    guint fieldSets;
+} trg_torrent_tree_view_column_fields[] = {
+    {TORRENT_COLUMN_SEEDS, TORRENT_GET_FIELDS_TRACKERSTATS},
+    {TORRENT_COLUMN_LEECHERS, TORRENT_GET_FIELDS_TRACKERSTATS},
+    {TORRENT_COLUMN_DOWNLOADS, TORRENT_GET_FIELDS_TRACKERSTATS},
+    {TORRENT_COLUMN_TRACKERHOST, TORRENT_GET_FIELDS_TRACKERSTATS},
+    {TORRENT_COLUMN_FROMPEX, TORRENT_GET_FIELDS_PEERSFROM},
+    {TORRENT_COLUMN_FROMDHT, TORRENT_GET_FIELDS_PEERSFROM},
+    {TORRENT_COLUMN_FROMTRACKERS, TORRENT_GET_FIELDS_PEERSFROM},
+    {TORRENT_COLUMN_FROMLTEP, TORRENT_GET_FIELDS_PEERSFROM},
+    {TORRENT_COLUMN_FROMRESUME, TORRENT_GET_FIELDS_PEERSFROM},
+    {TORRENT_COLUMN_FROMINCOMING, TORRENT_GET_FIELDS_PEERSFROM},
+    {TORRENT_COLUMN_PEER_SOURCES, TORRENT_GET_FIELDS_PEERSFROM},
+    {TORRENT_COLUMN_BANDWIDTH_PRIORITY, TORRENT_GET_FIELDS_PRIORITY},
+    {TORRENT_COLUMN_QUEUE_POSITION, TORRENT_GET_FIELDS_QUEUE},
+    {TORRENT_COLUMN_DONE_DATE, TORRENT_GET_FIELDS_DATES},
+    {TORRENT_COLUMN_LASTACTIVE, TORRENT_GET_FIELDS_DATES}
+};
+
+/* Work out which torrent-get field sets are needed to fill the columns which
+ * are showing, and the column being sorted on (which might not be).
+ * The Transmission style layout only uses columns from the list set.
+ */
+guint trg_torrent_tree_view_get_field_sets(TrgTorrentTreeView * tv)
+{
+    TrgTorrentTreeViewPrivate *priv = GET_PRIVATE(tv);
+    TrgPrefs *prefs = trg_client_get_prefs(priv->client);
+    GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(tv));
+    gboolean classic = trg_prefs_get_int(prefs, TRG_PREFS_KEY_STYLE,
+                                         TRG_PREFS_GLOBAL) ==
+        TRG_STYLE_CLASSIC;
+    guint fieldSets = TORRENT_GET_FIELDS_LIST;
+    gint sortColumn = GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID;
+    guint i;
+
+    if (GTK_IS_TREE_MODEL_FILTER(model))
+        gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE
+                                             (gtk_tree_model_filter_get_model
+                                              (GTK_TREE_MODEL_FILTER
+                                               (model))), &sortColumn,
+                                             NULL);
+
+    for (i = 0; i < G_N_ELEMENTS(trg_torrent_tree_view_column_fields);
+         i++) {
+        gint column = trg_torrent_tree_view_column_fields[i].column;
+        if (column == sortColumn
+            || (classic
+                && trg_tree_view_is_column_showing(TRG_TREE_VIEW(tv),
+                                                   column)))
+            fieldSets |= trg_torrent_tree_view_column_fields[i].fieldSets;
+    }
+
+    return fieldSets;
+}
+
 static void setup_classic_layout(TrgTorrentTreeView * tv)
 {
     gtk_tree_view_set_rubber_banding(GTK_TREE_VIEW(tv), TRUE);
@@ -224,47 +285,8 @@ static void setup_transmission_layout(TrgTorrentTreeView * tv,
     GtkTreeViewColumn *column =
         gtk_tree_view_column_new_with_attributes("",
                                                  renderer,
-                                                 "status",
-                                                 TORRENT_COLUMN_FLAGS,
-                                                 "error",
-                                                 TORRENT_COLUMN_ERROR,
-                                                 "fileCount",
-                                                 TORRENT_COLUMN_FILECOUNT,
-                                                 "totalSize",
-                                                 TORRENT_COLUMN_TOTALSIZE,
-                                                 "ratio",
-                                                 TORRENT_COLUMN_RATIO,
-                                                 "downloaded",
-                                                 TORRENT_COLUMN_DOWNLOADED,
-                                                 "haveValid",
-                                                 TORRENT_COLUMN_HAVE_VALID,
-                                                 "sizeWhenDone",
-                                                 TORRENT_COLUMN_SIZEWHENDONE,
-                                                 "uploaded",
-                                                 TORRENT_COLUMN_UPLOADED,
-                                                 "percentComplete",
-                                                 TORRENT_COLUMN_PERCENTDONE,
-                                                 "metadataPercentComplete",
-                                                 TORRENT_COLUMN_METADATAPERCENTCOMPLETE,
-                                                 "upSpeed",
-                                                 TORRENT_COLUMN_UPSPEED,
-                                                 "downSpeed",
-                                                 TORRENT_COLUMN_DOWNSPEED,
-                                                 "peersToUs",
-                                                 TORRENT_COLUMN_PEERS_TO_US,
-                                                 "peersGettingFromUs",
-                                                 TORRENT_COLUMN_PEERS_FROM_US,
-                                                 "webSeedsToUs",
-                                                 TORRENT_COLUMN_WEB_SEEDS_TO_US,
-                                                 "eta", TORRENT_COLUMN_ETA,
-                                                 "json",
-                                                 TORRENT_COLUMN_JSON,
-                                                 "seedRatioMode",
-                                                 TORRENT_COLUMN_SEED_RATIO_MODE,
-                                                 "seedRatioLimit",
-                                                 TORRENT_COLUMN_SEED_RATIO_LIMIT,
-                                                 "connected",
-                                                 TORRENT_COLUMN_PEERS_CONNECTED,
+                                                 "record",
+                                                 TORRENT_COLUMN_RECORD,
                                                  NULL);
 
     g_object_set(G_OBJECT(renderer), "client", priv->client,
@@ -2,16 +2,20 @@
 #include "config.h"
 #endif
 
+#include <glib/gi18n.h>
+
 #include "protocol-constants.h"
 #include "requests.h"
 #include "trg-client.h"
 #include "util.h"
+#include "trg-prefs.h"
 #include "trg-main-window.h"
 #include "json.h"
 #include "upload.h"
 
 static gboolean upload_complete_callback(gpointer data);
 static void next_upload(trg_upload *upload);
+static void upload_advance(trg_upload *upload);
 
 static void
 add_set_common_args(JsonObject * args, gint priority, gchar * dir)
@@ -55,30 +59,146 @@ static void add_wanteds(JsonObject *args, gint* wanteds, gint n_files) {
 	}
 }
 
-static void next_upload(trg_upload *upload) {
-	JsonNode *req = NULL;
+/* Files are mapped on a worker while up to
+ * TRG_PREFS_KEY_ADD_CONCURRENCY torrent-add requests are in flight. */
+
+typedef struct {
+	trg_upload *upload;
+	const gchar *filename;
+	JsonNode *req;
+	GBytes *metainfo;
+} trg_upload_item;
+
+static GThreadPool *upload_read_pool = NULL;
+
+static void add_extra_args(trg_upload *upload, JsonNode *req)
+{
+	JsonObject *args = node_get_arguments(req);
+
+	if (upload->extra_args)
+		add_set_common_args(args, upload->priority, upload->dir);
 
-	if (upload->upload_response && upload->progress_index < 1)
-		req = torrent_add_from_response(upload->upload_response, upload->flags);
-	else if (upload->list && upload->progress_index < g_slist_length(upload->list))
-		req = torrent_add_from_file((gchar*)g_slist_nth_data(upload->list, upload->progress_index), upload->flags);
+	if (upload->file_wanted)
+		add_wanteds(args, upload->file_wanted, upload->n_files);
 
-	if (req) {
-		JsonObject *args = node_get_arguments(req);
+	if (upload->file_priorities)
+		add_priorities(args, upload->file_priorities, upload->n_files);
+}
 
-		if (upload->extra_args)
-			add_set_common_args(args, upload->priority, upload->dir);
+static void upload_send(trg_upload *upload, JsonNode *req, GBytes *metainfo)
+{
+	upload->in_flight++;
+	dispatch_async_payload(upload->client, req, PARAM_METAINFO, metainfo,
+			upload_complete_callback, upload);
+}
 
-		if (upload->file_wanted)
-			add_wanteds(args, upload->file_wanted, upload->n_files);
+static void upload_progress(trg_upload *upload)
+{
+	gchar *msg;
+
+	if (!upload->main_window || upload->n_total < 2)
+		return;
+
+	if (upload->n_done < upload->n_total)
+		msg = g_strdup_printf(_("Adding torrents: %u of %u"),
+				upload->n_done, upload->n_total);
+	else if (upload->n_failed > 0)
+		msg = g_strdup_printf(_("Added %u of %u torrents, %u failed"),
+				upload->n_done - upload->n_failed, upload->n_total,
+				upload->n_failed);
+	else
+		msg = g_strdup_printf(_("Added %u torrents"), upload->n_total);
+
+	trg_main_window_push_status_msg(upload->main_window, msg);
+	g_free(msg);
+}
+
+static void upload_advance(trg_upload *upload)
+{
+	next_upload(upload);
+	upload_progress(upload);
+
+	if (upload->next || upload->reading > 0 || upload->in_flight > 0)
+		return;
+
+	/* One refresh for the whole batch, rather than one per torrent. */
+	if (upload->main_window && upload->n_done > upload->n_failed)
+		trg_main_window_reload_torrents(upload->main_window);
+
+	trg_upload_free(upload);
+}
+
+/* Like RPC failures, only the first failure of a batch gets a dialog. */
+static void upload_read_failed(trg_upload *upload, const gchar *filename)
+{
+	GtkWidget *dialog;
+
+	if (!upload->main_window || upload->error_shown)
+		return;
+
+	upload->error_shown = TRUE;
+
+	dialog = gtk_message_dialog_new(GTK_WINDOW(upload->main_window),
+			GTK_DIALOG_MODAL, GTK_MESSAGE_ERROR, GTK_BUTTONS_OK,
+			_("Unable to open torrent file: %s"), filename);
+	gtk_window_set_title(GTK_WINDOW(dialog), _("Error"));
+	gtk_dialog_run(GTK_DIALOG(dialog));
+	gtk_widget_destroy(dialog);
+}
 
-		if (upload->file_priorities)
-			add_priorities(args, upload->file_priorities, upload->n_files);
+static gboolean upload_item_ready(gpointer data)
+{
+	trg_upload_item *item = (trg_upload_item*)data;
+	trg_upload *upload = item->upload;
 
-		upload->progress_index++;
-		dispatch_async(upload->client, req, upload_complete_callback, upload);
+	if (item->req) {
+		upload_send(upload, item->req, item->metainfo);
 	} else {
-		trg_upload_free(upload);
+		upload->n_done++;
+		upload->n_failed++;
+		/* Still counted as reading, so the batch outlives the dialog's
+		 * nested main loop. */
+		upload_read_failed(upload, item->filename);
+	}
+
+	upload->reading--;
+	g_free(item);
+
+	upload_advance(upload);
+
+	return FALSE;
+}
+
+static void upload_read_threadfunc(gpointer data, gpointer user_data G_GNUC_UNUSED)
+{
+	trg_upload_item *item = (trg_upload_item*)data;
+
+	item->req = torrent_add_from_file((gchar*)item->filename,
+			item->upload->flags, &item->metainfo);
+	if (item->req)
+		add_extra_args(item->upload, item->req);
+
+	g_idle_add(upload_item_ready, item);
+}
+
+static void next_upload(trg_upload *upload) {
+	TrgPrefs *prefs = trg_client_get_prefs(upload->client);
+	guint concurrency = (guint)MAX(1, trg_prefs_get_int(prefs,
+			TRG_PREFS_KEY_ADD_CONCURRENCY, TRG_PREFS_GLOBAL));
+
+	if (!upload_read_pool)
+		upload_read_pool = g_thread_pool_new(upload_read_threadfunc, NULL,
+				2, FALSE, NULL);
+
+	while (upload->next && upload->reading + upload->in_flight < concurrency) {
+		trg_upload_item *item = g_new0(trg_upload_item, 1);
+
+		item->upload = upload;
+		item->filename = (const gchar*)upload->next->data;
+		upload->next = g_slist_next(upload->next);
+		upload->reading++;
+
+		g_thread_pool_push(upload_read_pool, item, NULL);
 	}
 }
 
@@ -86,22 +206,47 @@ static gboolean upload_complete_callback(gpointer data) {
 	trg_response *response = (trg_response*)data;
 	trg_upload *upload = (trg_upload*)response->cb_data;
 
+	upload->n_done++;
+
+	if (response->status != CURLE_OK)
+		upload->n_failed++;
+
 	if (upload->callback)
 		upload->callback(data);
 
-	/* the callback we're delegating to will destroy the response */
+	/* Only the first failure of a batch gets a dialog, the rest are
+	 * counted in the status bar. The dialog runs a nested main loop, so
+	 * this request stays in flight until it closes. */
+	if (response->status != CURLE_OK && upload->main_window
+			&& !upload->error_shown
+			&& trg_client_is_connected(upload->client)) {
+		upload->error_shown = TRUE;
+		trg_dialog_error_handler(upload->main_window, response);
+	}
 
-	if (upload->main_window)
-		on_generic_interactive_action(upload->main_window, response);
-	else
-		trg_response_free(response);
+	trg_response_free(response);
 
-	next_upload(upload);
+	upload->in_flight--;
+	upload_advance(upload);
 
 	return FALSE;
 }
 
 void trg_do_upload(trg_upload *upload)
 {
-	next_upload(upload);
+	if (upload->upload_response) {
+		GBytes *metainfo;
+		JsonNode *req = torrent_add_from_response(upload->upload_response,
+				upload->flags, &metainfo);
+
+		add_extra_args(upload, req);
+		upload->n_total = 1;
+		upload_send(upload, req, metainfo);
+		return;
+	}
+
+	upload->next = upload->list;
+	upload->n_total = g_slist_length(upload->list);
+
+	upload_advance(upload);
 }
@@ -19,7 +19,13 @@ typedef struct {
     gint* file_wanted;
     guint n_files;
     gboolean extra_args;
-    guint progress_index;
+    GSList *next; // the next filename to read
+    guint n_total;
+    guint n_done;
+    guint n_failed;
+    gboolean error_shown; // a failure in this batch already got a dialog
+    guint reading; // files being read and encoded on a worker
+    guint in_flight; // torrent-add requests awaiting a response
     GSourceFunc callback;
     gchar *uid;
 } trg_upload;
@@ -188,24 +188,23 @@ gboolean is_url(const gchar * string)
  * Glib-ish Utility functions.
  */
 
-gchar *trg_base64encode(const gchar * filename)
+/* The bytes of a file, mapped rather than read in. */
+GBytes *trg_map_file(const gchar * filename)
 {
     GError *error = NULL;
     GMappedFile *mf = g_mapped_file_new(filename, FALSE, &error);
-    gchar *b64out = NULL;
+    GBytes *bytes;
 
     if (error) {
-        g_error("%s", error->message);
+        g_message("%s", error->message);
         g_error_free(error);
-    } else {
-        b64out =
-            g_base64_encode((guchar *) g_mapped_file_get_contents(mf),
-                            g_mapped_file_get_length(mf));
+        return NULL;
     }
 
+    bytes = g_mapped_file_get_bytes(mf);
     g_mapped_file_unref(mf);
 
-    return b64out;
+    return bytes;
 }
 
 gchar *trg_gregex_get_first(GRegex * rx, const gchar * src)
@@ -83,7 +83,7 @@ double tr_truncd(double x, int decimal_places);
 char *tr_strlsize(char *buf, guint64 bytes, size_t buflen);
 void rm_trailing_slashes(gchar * str);
 void trg_widget_set_visible(GtkWidget * w, gboolean visible);
-gchar *trg_base64encode(const gchar * filename);
+GBytes *trg_map_file(const gchar * filename);
 GtkWidget *my_scrolledwin_new(GtkWidget * child);
 gboolean is_url(const gchar * string);
 gboolean is_magnet(const gchar * string);